@@ -10,18 +10,26 @@
 #include "pch.h"
 #include "Animation.h"
 #include "Math/Interpolation/InterpolationFunctions.h"
+#include "Composition/SceneNode.h"
 #include <gltf/tiny_gltf.h>
 
 
 namespace cs460
 {
 	AnimationProperty::AnimationProperty()
-		:	m_property(nullptr),
+		:	m_targetNode(nullptr),
+			m_propertyOffset(0),
 			m_animIdx(0),
 			m_animDataIdx(0),
 			m_interpolationMode(INTERPOLATION_MODE::LERP)
 	{
 	}
+
+	// The local transforms move in memory when the scene changes, so the property is looked up every time
+	float* AnimationProperty::get_property() const
+	{
+		return reinterpret_cast<float*>(&m_targetNode->modify_local_tr()) + m_propertyOffset;
+	}
 	
 
 
@@ -18,6 +18,9 @@ namespace tinygltf
 
 namespace cs460
 {
+	class SceneNode;
+
+
 	enum class INTERPOLATION_MODE
 	{
 		LERP,
@@ -27,13 +30,17 @@ namespace cs460
 	};
 
 
-	// Holds a pointer to the property to interpolate, as well as a reference to
+	// Holds the node and the offset of the property to interpolate, as well as a reference to
 	// the resource with the keyframe data, and the function used to interpolate
 	struct AnimationProperty
 	{
 		AnimationProperty();
 
-		float* m_property;
+		// The local transforms move in memory when the scene changes, so the property is looked up every time
+		float* get_property() const;
+
+		SceneNode* m_targetNode;
+		unsigned m_propertyOffset;		// In floats from the start of the local transform
 		int m_animIdx;
 		int m_animDataIdx;
 		INTERPOLATION_MODE m_interpolationMode;
@@ -17,6 +17,11 @@
 #include "Graphics/GLTF/Model.h"
 #include "Components/Animation/AnimationReference.h"
 #include "Components/Animation/IKChainRoot.h"
+#include "Components/Models/MeshRenderable.h"
+#include "Animation/Skinning/CpuSkinning.h"
+#include "Animation/Skinning/PaletteAtlas.h"
+#include "Platform/JobSystem.h"
+#include <chrono>
 
 
 namespace cs460
@@ -60,74 +65,326 @@ namespace cs460
 	}
 
 
-	// Adds an animation reference component to the internal vector
+	// Adds an animation reference component to the internal registry
 	void Animator::add_animation_ref(AnimationReference* animComp)
 	{
-		m_animReferences.push_back(animComp);
+		animComp->set_registry_handle(m_animReferences.add(animComp));
 	}
 
-	// Removes an animation reference component from the internal vector
+	// Removes an animation reference component from the internal registry (O(1))
 	void Animator::remove_animation_ref(AnimationReference* animComp)
 	{
-		auto foundIt = std::find(m_animReferences.begin(), m_animReferences.end(), animComp);
-
-		// Nothing to remove if not in the vector
-		if (foundIt == m_animReferences.end())
-			return;
-
-		m_animReferences.erase(foundIt);
+		m_animReferences.remove(animComp->get_registry_handle());
+		animComp->set_registry_handle(RegistryHandle());
 	}
 
 
-	// Adds an ik chain root component to the internal vector
+	// Adds an ik chain root component to the internal registry
 	void Animator::add_ik_chain(IKChainRoot* ikChainComp)
 	{
-		m_ikChains.push_back(ikChainComp);
+		ikChainComp->set_registry_handle(m_ikChains.add(ikChainComp));
 	}
 
-	// Removes an ik chain root component from the internal vector
+	// Removes an ik chain root component from the internal registry (O(1))
 	void Animator::remove_ik_chain(IKChainRoot* ikChainComp)
 	{
-		auto foundIt = std::find(m_ikChains.begin(), m_ikChains.end(), ikChainComp);
-
-		// Nothing to remove if not in the vector
-		if (foundIt == m_ikChains.end())
-			return;
-
-		m_ikChains.erase(foundIt);
+		m_ikChains.remove(ikChainComp->get_registry_handle());
+		ikChainComp->set_registry_handle(RegistryHandle());
 	}
 
 
-	// Adds a skin reference component to the internal vector
+	// Adds a skin reference component to the internal registry
 	void Animator::add_skin_ref(SkinReference* skinComp)
 	{
-		m_skinReferences.push_back(skinComp);
+		skinComp->set_registry_handle(m_skinReferences.add(skinComp));
 	}
 
-	// Removes a skin reference component from the internal vector
+	// Removes a skin reference component from the internal registry (O(1))
 	void Animator::remove_skin_ref(SkinReference* skinComp)
 	{
-		auto foundIt = std::find(m_skinReferences.begin(), m_skinReferences.end(), skinComp);
+		m_skinReferences.remove(skinComp->get_registry_handle());
+		skinComp->set_registry_handle(RegistryHandle());
+	}
+
 
-		// Nothing to remove if not in the vector
-		if (foundIt == m_skinReferences.end())
-			return;
+	// Whether the characters are updated in parallel by the job system
+	void Animator::set_parallel_update(bool parallel)
+	{
+		m_parallelUpdate = parallel;
+	}
 
-		m_skinReferences.erase(foundIt);
+	bool Animator::get_parallel_update() const
+	{
+		return m_parallelUpdate;
 	}
 
 
-	// Update each animation
-	void Animator::update_animations()
+	// Whether the characters of the current scene sample the palettes baked for their animations (applied to all of them)
+	void Animator::set_baked_palettes(bool bakedPalettes)
 	{
+		m_bakedPalettes = bakedPalettes;
+		for (AnimationReference* animRef : m_animReferences)
+			animRef->set_baked_palettes(bakedPalettes);
+	}
+
+	bool Animator::get_baked_palettes() const
+	{
+		return m_bakedPalettes;
+	}
+
+
+	// Time the update of the current scene using from 1 to the given number of threads (0 = hardware threads), and check
+	// that every thread count produces the same local transforms and joint matrices as the serial update
+	void Animator::benchmark_thread_scaling(unsigned maxThreads, unsigned iterations)
+	{
+		JobSystem& jobSystem = JobSystem::get_instance();
+		Scene& scene = Scene::get_instance();
+		unsigned previousThreadCount = jobSystem.get_thread_count();
+		bool previousParallel = m_parallelUpdate;
+
+		if (maxThreads == 0)
+			maxThreads = glm::max(std::thread::hardware_concurrency(), 1u);
+		iterations = glm::max(iterations, 1u);
+
+		unsigned jointCount = 0;
+		for (SkinReference* skinRef : m_skinReferences)
+			jointCount += (unsigned)skinRef->get_joint_matrices().size();
+
+		std::cout << "Animator thread scaling: " << m_animReferences.size() << " animations, " << m_skinReferences.size()
+			<< " skins, " << jointCount << " joints, " << iterations << " iterations\n";
+
+		// Every run starts from the same animation times, so all of them must produce the same transforms and matrices
+		std::vector<float> startTimes(m_animReferences.size());
 		for (int i = 0; i < m_animReferences.size(); ++i)
+			startTimes[i] = m_animReferences[i]->get_anim_timer();
+
+		std::vector<TransformData> serialLocals;
+		JointPalette serialMatrices;
+		double serialMs = 0.0;
+
+		for (unsigned threadCount = 1; threadCount <= maxThreads; ++threadCount)
+		{
+			jobSystem.set_thread_count(threadCount);
+			m_parallelUpdate = threadCount > 1;
+
+			for (int i = 0; i < m_animReferences.size(); ++i)
+				m_animReferences[i]->set_anim_timer(startTimes[i]);
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (unsigned it = 0; it < iterations; ++it)
+			{
+				// The skins only recompute their matrices when the world transforms of their joints change
+				update_animations();
+				scene.update();
+				update_skins();
+			}
+			auto end = std::chrono::high_resolution_clock::now();
+			double ms = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+
+			// Gather the animated local transforms and the resulting matrices to compare them against the serial ones
+			TransformHierarchy& transforms = scene.get_transforms();
+			std::vector<TransformData> locals(transforms.get_size());
+			for (unsigned i = 0; i < transforms.get_size(); ++i)
+				locals[i] = transforms.get_local(i);
+
+			JointPalette matrices;
+			matrices.reserve(jointCount);
+			for (SkinReference* skinRef : m_skinReferences)
+				matrices.insert(matrices.end(), skinRef->get_joint_matrices().begin(), skinRef->get_joint_matrices().end());
+
+			if (threadCount == 1)
+			{
+				serialLocals = locals;
+				serialMatrices = matrices;
+				serialMs = ms;
+			}
+
+			bool identicalLocals = locals.size() == serialLocals.size() &&
+				std::memcmp(locals.data(), serialLocals.data(), locals.size() * sizeof(TransformData)) == 0;
+			bool identicalMatrices = matrices.size() == serialMatrices.size() &&
+				std::memcmp(matrices.data(), serialMatrices.data(), matrices.size() * sizeof(AffineTransform)) == 0;
+
+			std::cout << "  " << threadCount << " threads: " << ms << " ms/frame, speedup " << serialMs / ms
+				<< (identicalLocals ? "" : "  (WARNING: local transforms differ from the serial update)")
+				<< (identicalMatrices ? "" : "  (WARNING: joint matrices differ from the serial update)") << "\n";
+		}
+
+		// Restore the previous state
+		for (int i = 0; i < m_animReferences.size(); ++i)
+			m_animReferences[i]->set_anim_timer(startTimes[i]);
+		jobSystem.set_thread_count(previousThreadCount);
+		m_parallelUpdate = previousParallel;
+	}
+
+
+	// Deform the meshes of every skin of the current scene on the cpu with linear blend and
+	// dual quaternion skinning, and print how far apart the vertices of both modes end up
+	void Animator::compare_skinning_modes()
+	{
+		std::cout << "Skinning modes comparison (" << m_skinReferences.size() << " skins, deviation relative to the mesh size):\n";
+
+		std::vector<glm::vec3> linearPositions;
+		std::vector<glm::vec3> dualQuatPositions;
+		DualQuatPalette dualQuats;
+
+		for (SkinReference* skinRef : m_skinReferences)
 		{
-			AnimationReference* animComp = m_animReferences[i];
-			animComp->update();
+			MeshRenderable* meshComp = skinRef->get_owner()->get_component<MeshRenderable>();
+			Model* model = skinRef->get_owner()->get_model();
+			if (meshComp == nullptr || model == nullptr || meshComp->get_mesh_idx() < 0)
+				continue;
+
+			// Both modes use the same palette, so any difference comes from the blending
+			skinRef->update_joint_matrices();
+			const JointPalette& palette = skinRef->get_joint_matrices();
+			dualQuats.resize(palette.size());
+			convert_palette_to_dual_quats(palette.data(), dualQuats.data(), (unsigned)palette.size());
+
+			const Mesh& mesh = model->m_meshes[meshComp->get_mesh_idx()];
+			for (const Primitive& primitive : mesh.m_primitives)
+			{
+				const SkinnedVertices& vertices = primitive.get_skinned_vertices();
+				if (vertices.is_empty())
+					continue;
+
+				unsigned vertexCount = vertices.get_vertex_count();
+				linearPositions.resize(vertexCount);
+				dualQuatPositions.resize(vertexCount);
+				skin_vertices_linear(palette.data(), vertices, linearPositions.data());
+				skin_vertices_dual_quat(dualQuats.data(), vertices, dualQuatPositions.data());
+
+				// Measure the deviation against the size of the deformed mesh, so that models of any scale can be compared
+				glm::vec3 minPos(FLT_MAX);
+				glm::vec3 maxPos(-FLT_MAX);
+				float maxDeviation = 0.0f;
+				double totalDeviation = 0.0;
+				for (unsigned i = 0; i < vertexCount; ++i)
+				{
+					minPos = glm::min(minPos, linearPositions[i]);
+					maxPos = glm::max(maxPos, linearPositions[i]);
+
+					float deviation = glm::length(linearPositions[i] - dualQuatPositions[i]);
+					maxDeviation = glm::max(maxDeviation, deviation);
+					totalDeviation += deviation;
+				}
+
+				float size = glm::max(glm::length(maxPos - minPos), FLT_EPSILON);
+				std::cout << "  skin " << skinRef->get_skin_idx() << ", " << palette.size() << " joints, " << vertexCount << " vertices: max "
+					<< 100.0f * maxDeviation / size << "%, mean " << 100.0 * totalDeviation / vertexCount / size << "%\n";
+			}
 		}
 	}
 
-	// Update each ik chain
+
+	// Time the cpu skinning of the meshes of every skin of the current scene (each model is only measured once)
+	void Animator::benchmark_cpu_skinning(unsigned iterations)
+	{
+		std::cout << "CPU skinning (" << get_cpu_skinning_isa() << ", " << iterations << " iterations):\n";
+
+		std::vector<const Primitive*> measured;
+		for (SkinReference* skinRef : m_skinReferences)
+		{
+			MeshRenderable* meshComp = skinRef->get_owner()->get_component<MeshRenderable>();
+			Model* model = skinRef->get_owner()->get_model();
+			if (meshComp == nullptr || model == nullptr || meshComp->get_mesh_idx() < 0)
+				continue;
+
+			skinRef->update_joint_matrices();
+			const JointPalette& palette = skinRef->get_joint_matrices();
+
+			const Mesh& mesh = model->m_meshes[meshComp->get_mesh_idx()];
+			for (const Primitive& primitive : mesh.m_primitives)
+			{
+				if (primitive.get_skinned_vertices().is_empty() || std::find(measured.begin(), measured.end(), &primitive) != measured.end())
+					continue;
+
+				measured.push_back(&primitive);
+				cs460::benchmark_cpu_skinning(palette.data(), primitive.get_skinned_vertices(), iterations);
+			}
+		}
+	}
+
+	// Print the palette uploaded for each skinned primitive of the current scene before (the whole
+	// skin) and after compacting it to the joints used by each partition (each model printed once)
+	void Animator::print_skin_palette_sizes()
+	{
+		std::cout << "Skin palette sizes (joints uploaded per draw, at most " << SkinPartition::MAX_JOINTS << " per partition):\n";
+
+		std::vector<const Primitive*> printed;
+		for (SkinReference* skinRef : m_skinReferences)
+		{
+			MeshRenderable* meshComp = skinRef->get_owner()->get_component<MeshRenderable>();
+			Model* model = skinRef->get_owner()->get_model();
+			if (meshComp == nullptr || model == nullptr || meshComp->get_mesh_idx() < 0)
+				continue;
+
+			size_t skinJoints = model->m_skins[skinRef->get_skin_idx()].m_joints.size();
+			const Mesh& mesh = model->m_meshes[meshComp->get_mesh_idx()];
+			for (unsigned i = 0; i < mesh.m_primitives.size(); ++i)
+			{
+				const Primitive& primitive = mesh.m_primitives[i];
+				if (primitive.get_skin_partitions().empty() || std::find(printed.begin(), printed.end(), &primitive) != printed.end())
+					continue;
+
+				printed.push_back(&primitive);
+				std::cout << "  " << model->m_fileName << " mesh " << meshComp->get_mesh_idx() << " primitive " << i << ": " << skinJoints << " -> ";
+				for (unsigned p = 0; p < primitive.get_skin_partitions().size(); ++p)
+					std::cout << (p > 0 ? " + " : "") << primitive.get_skin_partitions()[p].m_joints.size();
+				std::cout << " joints\n";
+			}
+		}
+	}
+
+	// Print for each skinned primitive of the current scene how many vertices ended up with 1, 2 and 4 influences after
+	// the weight preprocessing, and the memory of the joints and weights before and after it (each model printed once)
+	void Animator::print_skin_weight_stats()
+	{
+		std::cout << "Skin weight stats (influences evaluated per vertex and bytes of the joints and weights, before -> after):\n";
+
+		std::vector<const Primitive*> printed;
+		for (SkinReference* skinRef : m_skinReferences)
+		{
+			MeshRenderable* meshComp = skinRef->get_owner()->get_component<MeshRenderable>();
+			Model* model = skinRef->get_owner()->get_model();
+			if (meshComp == nullptr || model == nullptr || meshComp->get_mesh_idx() < 0)
+				continue;
+
+			const Mesh& mesh = model->m_meshes[meshComp->get_mesh_idx()];
+			for (unsigned i = 0; i < mesh.m_primitives.size(); ++i)
+			{
+				const Primitive& primitive = mesh.m_primitives[i];
+				const SkinnedVertices& vertices = primitive.get_skinned_vertices();
+				if (vertices.m_influenceOrder.empty() || std::find(printed.begin(), printed.end(), &primitive) != printed.end())
+					continue;
+
+				printed.push_back(&primitive);
+				const unsigned* groupEnds = vertices.m_influenceGroupEnds;
+				unsigned influences = groupEnds[0] + 2 * (groupEnds[1] - groupEnds[0]) + 4 * (groupEnds[2] - groupEnds[1]);
+				std::cout << "  " << model->m_fileName << " mesh " << meshComp->get_mesh_idx() << " primitive " << i << ": "
+					<< vertices.get_vertex_count() << " vertices with 1/2/4 influences " << groupEnds[0] << "/" << groupEnds[1] - groupEnds[0]
+					<< "/" << groupEnds[2] - groupEnds[1] << ", influences 4 -> " << (float)influences / vertices.get_vertex_count()
+					<< ", bytes " << primitive.get_file_skin_bytes() << " -> " << primitive.get_skin_bytes() << "\n";
+			}
+		}
+	}
+
+
+	// Update each animation (each character only writes to its own nodes, so they are updated in parallel)
+	void Animator::update_animations()
+	{
+		auto updateRange = [this](unsigned begin, unsigned end)
+		{
+			for (unsigned i = begin; i < end; ++i)
+				m_animReferences[i]->update();
+		};
+
+		if (m_parallelUpdate)
+			JobSystem::get_instance().parallel_for((unsigned)m_animReferences.size(), 4, updateRange);
+		else
+			updateRange(0, (unsigned)m_animReferences.size());
+	}
+
+	// Update each ik chain (serially, as the chains can read the world transforms of other nodes, like their targets)
 	void Animator::update_ik_chains()
 	{
 		for (int i = 0; i < m_ikChains.size(); ++i)
@@ -137,40 +394,50 @@ namespace cs460
 		}
 	}
 
-	// Update the joint matrices of each skin
+	// Update the joint matrices (and cpu skinned vertices) of each skin (in parallel, as they only read the scene)
 	void Animator::update_skins()
 	{
-		Scene& scene = Scene::get_instance();
-
-		for (int i = 0; i < m_skinReferences.size(); ++i)
+		auto updateRange = [this](unsigned begin, unsigned end)
 		{
-			// TODO: Put all of this inside a function of SkinReference and make skinRef->get_joint_matrices function const
-
-			SkinReference* skinRef = m_skinReferences[i];
-			ModelInstance* rootModelInst = skinRef->get_owner()->get_model_root_node()->get_component<ModelInstance>();
-			int modelInstanceId = rootModelInst->get_instance_id();
-			int skinIdx = skinRef->get_skin_idx();
+			for (unsigned i = begin; i < end; ++i)
+			{
+				SkinReference* skinRef = m_skinReferences[i];
+				bool changed = skinRef->update_joint_matrices();
 
-			// Get the model resource, the skin, and the "dictionary" of nodes of this model instance
-			Model* modelResource = skinRef->get_owner()->get_model();
-			Skin& skin = modelResource->m_skins[skinIdx];
-			auto& modelInstanceNodes = scene.get_model_inst_nodes(modelInstanceId);
+				// Big meshes are split again among the threads (only if a joint moved)
+				if (changed && skinRef->is_cpu_skinned())
+					skinRef->update_deformed_vertices(m_parallelUpdate);
+			}
+		};
 
+		if (m_parallelUpdate)
+			JobSystem::get_instance().parallel_for((unsigned)m_skinReferences.size(), 4, updateRange);
+		else
+			updateRange(0, (unsigned)m_skinReferences.size());
+	}
 
-			// Get the skeleton root inverse model to world matrix
-			SceneNode* skeletonRootNode = modelInstanceNodes[skin.m_commonRootIdx];
-			const glm::mat4& rootInvModelMtx = skeletonRootNode->m_worldTr.get_inv_model_mtx();
+	// Bake the palettes of every skin of the current scene (each model printed once) and print the size of
+	// the atlases, the error against evaluating the animations and the time saved per palette
+	void Animator::print_palette_atlas_stats()
+	{
+		std::vector<std::pair<const Model*, int>> printed;
+		for (SkinReference* skinRef : m_skinReferences)
+		{
+			Model* model = skinRef->get_owner()->get_model();
+			std::pair<const Model*, int> key(model, skinRef->get_skin_idx());
+			if (model == nullptr || key.second < 0 || std::find(printed.begin(), printed.end(), key) != printed.end())
+				continue;
 
-			// For each joint, update its joint matrix
-			std::vector<glm::mat4>& jointMatrices = skinRef->get_joint_matrices();
-			for (int j = 0; j < jointMatrices.size(); ++j)
+			printed.push_back(key);
+			for (PaletteAtlasFormat format : { PaletteAtlasFormat::FLOAT32, PaletteAtlasFormat::UNORM16 })
 			{
-				// Get the model to world matrix of the current joint
-				SceneNode* jointNode = modelInstanceNodes[skin.m_joints[j]];
-				const glm::mat4& jointModelMtx = jointNode->m_worldTr.get_model_mtx();
+				PaletteAtlas atlas;
+				PaletteAtlasStats stats;
+				if (!atlas.bake(*model, key.second, PaletteAtlas::DEFAULT_SAMPLE_RATE, format, &stats))
+					continue;
 
-				// Update the joint matrix
-				jointMatrices[j] = skeletonRootNode->m_localTr.get_model_mtx() * rootInvModelMtx * jointModelMtx * skin.m_invBindMatrices[j];
+				std::cout << model->m_fileName << " skin " << key.second << (format == PaletteAtlasFormat::UNORM16 ? " (16 bit)" : " (float)") << ": ";
+				stats.print(std::cout);
 			}
 		}
 	}
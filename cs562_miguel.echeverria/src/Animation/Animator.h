@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include "Composition/ComponentRegistry.h"
+
 
 namespace cs460
 {
@@ -31,33 +33,61 @@ namespace cs460
 		void update();
 		void close();
 
-		void add_animation_ref(AnimationReference* animComp);		// Adds an animation reference component to the internal vector
-		void remove_animation_ref(AnimationReference* animComp);	// Removes an animation reference component from the internal vector
+		// The stages of the update, used separately by the frame task graph
+		void update_animations();		// Update each animation (each character only writes to its own nodes, so they are updated in parallel)
+		void update_ik_chains();		// Update each ik chain
+		void update_skins();			// Update the joint matrices (and cpu skinned vertices) of each skin (in parallel, as they only read the scene)
 
-		void add_ik_chain(IKChainRoot* ikChainComp);				// Adds an ik chain root component to the internal vector
-		void remove_ik_chain(IKChainRoot* ikChainComp);				// Removes an ik chain root component from the internal vector
+		void add_animation_ref(AnimationReference* animComp);		// Adds an animation reference component to the internal registry
+		void remove_animation_ref(AnimationReference* animComp);	// Removes an animation reference component from the internal registry (O(1))
 
-		void add_skin_ref(SkinReference* skinComp);					// Adds a skin reference component to the internal vector
-		void remove_skin_ref(SkinReference* skinComp);				// Removes a skin reference component from the internal vector
+		void add_ik_chain(IKChainRoot* ikChainComp);				// Adds an ik chain root component to the internal registry
+		void remove_ik_chain(IKChainRoot* ikChainComp);				// Removes an ik chain root component from the internal registry (O(1))
 
-	private:
+		void add_skin_ref(SkinReference* skinComp);					// Adds a skin reference component to the internal registry
+		void remove_skin_ref(SkinReference* skinComp);				// Removes a skin reference component from the internal registry (O(1))
 
-		std::vector<AnimationReference*> m_animReferences;
-		std::vector<IKChainRoot*> m_ikChains;
-		std::vector<SkinReference*> m_skinReferences;
+		// Whether the characters are updated in parallel by the job system
+		void set_parallel_update(bool parallel);
+		bool get_parallel_update() const;
 
-		Animator();
-		Animator(const Animator&) = delete;
-		Animator& operator=(const Animator&) = delete;
+		// Whether the characters of the current scene sample the palettes baked for their animations (applied to all of them)
+		void set_baked_palettes(bool bakedPalettes);
+		bool get_baked_palettes() const;
+
+		// Time the update of the current scene using from 1 to the given number of threads (0 = hardware threads), and check
+		// that every thread count produces the same local transforms and joint matrices as the serial update
+		void benchmark_thread_scaling(unsigned maxThreads, unsigned iterations);
+
+		// Deform the meshes of every skin of the current scene on the cpu with linear blend and
+		// dual quaternion skinning, and print how far apart the vertices of both modes end up
+		void compare_skinning_modes();
 
+		// Time the cpu skinning of the meshes of every skin of the current scene (each model is only measured once)
+		void benchmark_cpu_skinning(unsigned iterations);
 
-		// Update each animation
-		void update_animations();
+		// Print the palette uploaded for each skinned primitive of the current scene before (the whole
+		// skin) and after compacting it to the joints used by each partition (each model printed once)
+		void print_skin_palette_sizes();
 
-		// Update each ik chain
-		void update_ik_chains();
+		// Print for each skinned primitive of the current scene how many vertices ended up with 1, 2 and 4 influences after
+		// the weight preprocessing, and the memory of the joints and weights before and after it (each model printed once)
+		void print_skin_weight_stats();
 
-		// Update the joint matrices of each skin
-		void update_skins();
+		// Bake the palettes of every skin of the current scene (each model printed once) and print the size of
+		// the atlases, the error against evaluating the animations and the time saved per palette
+		void print_palette_atlas_stats();
+
+	private:
+
+		ComponentRegistry<AnimationReference> m_animReferences;
+		ComponentRegistry<IKChainRoot> m_ikChains;
+		ComponentRegistry<SkinReference> m_skinReferences;
+		bool m_parallelUpdate = true;
+		bool m_bakedPalettes = false;
+
+		Animator();
+		Animator(const Animator&) = delete;
+		Animator& operator=(const Animator&) = delete;
 	};
 }
\ No newline at end of file
@@ -22,22 +22,13 @@ namespace cs460
 		// Sets the animation component owner and adds two default childs
 		Blend1D(AnimationReference* animCompOwner);
 
-        // Finds the segment in which m_blendParam lies (returns in out-parameters
-        // from and to, the blend nodes that form this segment).
-        void find_segment(IBlendNode*& from, IBlendNode*& to);
-
-		// Produces a poses by blending between its children.
-		void produce_pose(float time) override;
-
-		// Sort the children based on their position in the 1D blend space (smallest x to biggest x)
+		// Sort the children based on their position in the 1D blend space (smallest x to biggest x).
+		// Called automatically whenever the children change, so they are always kept sorted.
 		void sort_children();
 
 	private:
 
-        // Performs one dimensional blending using the children nodes.
-		void blend_children(float time) override;
-
-		// Normalize the blend parameter to the range [0, 1] (0=at from, 1=at to)
-		float get_normalized_blend_param(IBlendNode* from, IBlendNode* to);
+		// Keeps the children sorted (the compiled blend program relies on it)
+		void on_children_changed() override;
 	};
 }
\ No newline at end of file
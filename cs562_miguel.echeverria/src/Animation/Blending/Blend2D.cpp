@@ -24,32 +24,29 @@ namespace cs460
 		:	IBlendNode(animCompOwner)
 	{
 		BlendAnim* animNode0 = static_cast<BlendAnim*>(add_child(BlendNodeTypes::BLEND_ANIM));
-		animNode0->m_blendPos = glm::vec2(-0.5f, -0.5f);
+		animNode0->set_blend_pos(glm::vec2(-0.5f, -0.5f));
 		animNode0->m_animSource = &m_animCompOwner->get_owner()->get_model()->m_animations[0];
 		
 		BlendAnim* animNode1 = static_cast<BlendAnim*>(add_child(BlendNodeTypes::BLEND_ANIM));
-		animNode1->m_blendPos = glm::vec2(0.5f, -0.5f);
+		animNode1->set_blend_pos(glm::vec2(0.5f, -0.5f));
 		animNode1->m_animSource = &m_animCompOwner->get_owner()->get_model()->m_animations[0];
 		
 		BlendAnim* animNode2 = static_cast<BlendAnim*>(add_child(BlendNodeTypes::BLEND_ANIM));
-		animNode2->m_blendPos = glm::vec2(0.0f, 0.5f);
+		animNode2->set_blend_pos(glm::vec2(0.0f, 0.5f));
 		animNode2->m_animSource = &m_animCompOwner->get_owner()->get_model()->m_animations[0];
 	}
 
 
-	void Blend2D::produce_pose(float time)
-	{
-		if (m_children.empty())
-			return;
-
-		blend_children(time);
-	}
-
-
 	// Generates the triangles using delaunay triangulation 
 	// based on the children's blendPosition
 	void Blend2D::generate_triangles()
 	{
+		m_triangles.clear();
+
+		// At least three nodes are needed to form a triangle
+		if (m_children.size() < 3)
+			return;
+
 		// Prepare all the blend coordinates for the triangulation
 		std::vector<double> childCoords;
 		childCoords.resize(m_children.size() * 2);
@@ -60,60 +57,29 @@ namespace cs460
 			childCoords[1 + i * 2] = (double)m_children[i]->m_blendPos.y;
 		}
 
-		// Perform delaunay triangulation
-		delaunator::Delaunator triangulator(childCoords);
+		// Perform delaunay triangulation (the nodes might be collinear while they are being placed)
+		std::vector<std::size_t> triangles;
+		try
+		{
+			delaunator::Delaunator triangulator(childCoords);
+			triangles = std::move(triangulator.triangles);
+		}
+		catch (const std::runtime_error&)
+		{
+			return;
+		}
 
 		// Store the triangles in our own data structure
-		size_t numberOfTriangles = triangulator.triangles.size() / 3;
+		size_t numberOfTriangles = triangles.size() / 3;
 		m_triangles.resize(numberOfTriangles);
 		for (int i = 0; i < numberOfTriangles; ++i)
 		{
-			m_triangles[i][0] = (unsigned)triangulator.triangles[i * 3];
-			m_triangles[i][1] = (unsigned)triangulator.triangles[i * 3 + 1];
-			m_triangles[i][2] = (unsigned)triangulator.triangles[i * 3 + 2];
-		}
-	}
-
-	// Determine in which triangle the param is located and find n0, n1, n2
-	// perform barycentric compute to extract a0,a1,a2
-	void Blend2D::find_nodes_barycentric(IBlendNode*& node0, IBlendNode*& node1, IBlendNode*& node2, float& a0, float& a1, float& a2)
-	{
-		for (int i = 0; i < m_triangles.size(); ++i)
-		{
-			const auto& indices = m_triangles[i];
-			glm::vec2 v0(m_children[indices[0]]->m_blendPos.x, m_children[indices[0]]->m_blendPos.y);
-			glm::vec2 v1(m_children[indices[1]]->m_blendPos.x, m_children[indices[1]]->m_blendPos.y);
-			glm::vec2 v2(m_children[indices[2]]->m_blendPos.x, m_children[indices[2]]->m_blendPos.y);
-
-			float area0 = cross_2d(v1 - m_blendParam, v2 - m_blendParam);
-			if (area0 > 0.0f)
-				continue;
-
-			float area1 = cross_2d(v2 - m_blendParam, v0 - m_blendParam);
-			if (area1 > 0.0f)
-				continue;
-
-			float area2 = cross_2d(v0 - m_blendParam, v1 - m_blendParam);
-			if (area2 > 0.0f)
-				continue;
-
-			// Return the nodes of the triangle that blend param is contained in
-			node0 = m_children[indices[0]];
-			node1 = m_children[indices[1]];
-			node2 = m_children[indices[2]];
-
-			float totalArea = cross_2d(v1 - v0, v2 - v0);
-
-			// Return the barycentric coordinates of blend param
-			a0 = area0 / totalArea;
-			a1 = area1 / totalArea;
-			a2 = area2 / totalArea;
-
-			return;
+			m_triangles[i][0] = (unsigned)triangles[i * 3];
+			m_triangles[i][1] = (unsigned)triangles[i * 3 + 1];
+			m_triangles[i][2] = (unsigned)triangles[i * 3 + 2];
 		}
 	}
 
-
 	// Return the minimum and maximum positions
 	glm::vec2 Blend2D::get_min_pos() const
 	{
@@ -168,39 +134,9 @@ namespace cs460
 	}
 
 
-	// Performs two dimensional blending using the children nodes.
-	void Blend2D::blend_children(float time)
+	// Regenerates the triangles, since they only change when the children do
+	void Blend2D::on_children_changed()
 	{
-		// Generate the triangles in case they have changed
 		generate_triangles();
-
-		// we assume that the children are sorted incrementally by their blend position
-		IBlendNode* node0, * node1, * node2;
-		node0 = node1 = node2 = nullptr;
-		float a0, a1, a2;
-		a0 = a1 = a2 = 0.0f;
-		find_nodes_barycentric(node0, node1, node2, a0, a1, a2);
-
-		if (!node0 || !node1 || !node2)
-			return;
-
-		// produce the pose from each
-		node0->produce_pose(time);
-		node1->produce_pose(time);
-		node2->produce_pose(time);
-
-		// blend the pose into ours
-		blend_pose_barycentric(
-			node0->m_pose, node1->m_pose, node2->m_pose,
-			a0, a1, a2,
-			m_pose,
-			nullptr);
-	}
-
-
-	// Returns the z component of the cross product with z=0, but without unnecessary computations
-	float Blend2D::cross_2d(const glm::vec2& v0, const glm::vec2& v1) const
-	{
-		return v0.x * v1.y - v0.y * v1.x;
 	}
 }
\ No newline at end of file
@@ -27,26 +27,17 @@ namespace cs460
         // Sets the animation component owner and adds three default childs
         Blend2D(AnimationReference* animCompOwner);
 
-        void produce_pose(float time) override;
-
         // Generates the triangles using delaunay triangulation 
         // based on the children's blendPosition
         void generate_triangles();
 
-        // Determine in which triangle the param is located and find n0, n1, n2
-        // perform barycentric compute to extract a0,a1,a2
-        void find_nodes_barycentric(IBlendNode*& node0, IBlendNode*& node1, IBlendNode*& node2, float& a0, float& a1, float& a2);
-
         // Return the minimum and maximum positions
         glm::vec2 get_min_pos() const;
         glm::vec2 get_max_pos() const;
 
 	private:
 
-        // Performs two dimensional blending using the children nodes.
-		void blend_children(float time) override;
-
-        // Returns the z component of the cross product with z=0, but without unnecessary computations
-        float cross_2d(const glm::vec2& v0, const glm::vec2& v1) const;
+        // Regenerates the triangles, since they only change when the children do
+        void on_children_changed() override;
 	};
 }
\ No newline at end of file
@@ -10,8 +10,7 @@
 
 #include "pch.h"
 #include "BlendAnim.h"
-#include "BlendingCore.h"
-#include "Animation/Animation.h"
+#include "Components/Animation/AnimationReference.h"
 
 
 namespace cs460
@@ -23,10 +22,12 @@ namespace cs460
 	}
 
 
-	// Produce a pose for the internal animation at the given time and store it in m_pose.
-	void BlendAnim::produce_pose(float time)
+	// Change the animation of this node (the owner's compiled blend tree is regenerated)
+	void BlendAnim::set_anim_source(Animation* anim)
 	{
-		float realTime = glm::mod(time, m_animSource->m_duration);
-		::cs460::produce_pose(m_animSource, m_pose, realTime);
+		m_animSource = anim;
+
+		if (m_animCompOwner)
+			m_animCompOwner->invalidate_blend_program();
 	}
 }
\ No newline at end of file
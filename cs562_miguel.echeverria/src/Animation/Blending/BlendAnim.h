@@ -26,8 +26,8 @@ namespace cs460
 		
 		// Sets the animation component owner
 		BlendAnim(AnimationReference* animCompOwner);
-		
-		// Produce a pose for the internal animation at the given time and store it in m_pose.
-		void produce_pose(float time) override;
+
+		// Change the animation of this node (the owner's compiled blend tree is regenerated)
+		void set_anim_source(Animation* anim);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+/**
+* @file BlendLayer.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Blend node that layers the poses of its children on top of each other.
+*		 The first child is the base pose, and every other child overrides the
+*		 joints given by its blend mask (e.g. an upper body layer over locomotion).
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "BlendLayer.h"
+#include "BlendAnim.h"
+#include "Components/Animation/AnimationReference.h"
+#include "Composition/SceneNode.h"
+#include "Graphics/GLTF/Model.h"
+
+
+namespace cs460
+{
+	// Sets the animation component owner and adds the base and one layer as default childs
+	BlendLayer::BlendLayer(AnimationReference* animCompOwner)
+		:	IBlendNode(animCompOwner)
+	{
+		BlendAnim* baseNode = static_cast<BlendAnim*>(add_child(BlendNodeTypes::BLEND_ANIM));
+		baseNode->m_animSource = &m_animCompOwner->get_owner()->get_model()->m_animations[0];
+
+		BlendAnim* layerNode = static_cast<BlendAnim*>(add_child(BlendNodeTypes::BLEND_ANIM));
+		layerNode->m_animSource = &m_animCompOwner->get_owner()->get_model()->m_animations[0];
+	}
+}
\ No newline at end of file
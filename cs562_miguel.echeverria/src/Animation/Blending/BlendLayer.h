@@ -0,0 +1,24 @@
+/**
+* @file BlendLayer.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Blend node that layers the poses of its children on top of each other.
+*		 The first child is the base pose, and every other child overrides the
+*		 joints given by its blend mask (e.g. an upper body layer over locomotion).
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "IBlendNode.h"
+
+
+namespace cs460
+{
+	struct BlendLayer : public IBlendNode
+	{
+		// Sets the animation component owner and adds the base and one layer as default childs
+		BlendLayer(AnimationReference* animCompOwner);
+	};
+}
\ No newline at end of file
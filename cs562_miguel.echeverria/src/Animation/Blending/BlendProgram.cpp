@@ -0,0 +1,671 @@
+/**
+* @file BlendProgram.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Flat version of a blend tree. The tree is compiled into a list of
+*		 instructions that read and write pose slots, so that it can be evaluated
+*		 every frame without recursion or virtual calls.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "BlendProgram.h"
+#include "BlendingCore.h"
+#include "Blend1D.h"
+#include "Blend2D.h"
+#include "BlendAnim.h"
+#include "BlendLayer.h"
+#include "Animation/Animation.h"
+#include "Graphics/GLTF/Model.h"
+#include "Components/Animation/AnimationReference.h"
+#include "Components/Models/ModelInstance.h"
+#include "Composition/Scene.h"
+#include "Composition/SceneNode.h"
+
+
+namespace cs460
+{
+	// Walk the given tree and generate the instructions. If sourceNodes is given,
+	// it is filled with the tree node that corresponds to each compiled node.
+	void BlendProgram::compile(IBlendNode* root, Model* model, std::vector<IBlendNode*>* sourceNodes)
+	{
+		clear();
+		if (sourceNodes)
+			sourceNodes->clear();
+
+		if (root == nullptr || model == nullptr)
+			return;
+
+		CompileContext context;
+		context.m_model = model;
+		context.m_sourceNodes = sourceNodes;
+
+		collect_joints(root, context);
+		sort_joints(context);
+
+		// The first mask affects the whole skeleton
+		compile_mask(nullptr, 0);
+		unsigned rootIdx = compile_node(root, 0, context);
+
+		// The final pose is the one of the root
+		BlendInstruction apply;
+		apply.m_opCode = BlendOpCode::APPLY;
+		apply.m_node = rootIdx;
+		apply.m_slot = m_nodes[rootIdx].m_slot;
+		m_instructions.push_back(apply);
+	}
+
+	void BlendProgram::clear()
+	{
+		m_instructions.clear();
+		m_nodes.clear();
+		m_childIndices.clear();
+		m_triangles.clear();
+		m_channels.clear();
+		m_slotCount = 0;
+		m_masks.clear();
+		m_maskRanges.clear();
+		m_maskWeights.clear();
+		m_jointNodeIndices.clear();
+		m_jointProperties.clear();
+		m_restPose.clear();
+	}
+
+
+	// Allocate the slots and per node data that this program needs in the given instance,
+	// and find the scene nodes of the skeleton of the given component
+	void BlendProgram::init_instance(BlendProgramInstance& instance, AnimationReference* animComp) const
+	{
+		instance.m_animComp = animComp;
+		instance.m_params.assign(m_nodes.size(), glm::vec2(0.0f, 0.0f));
+		instance.m_slots.assign(m_slotCount, m_restPose);
+		instance.m_selections.assign(m_nodes.size(), BlendSelection());
+		instance.m_lastSegments.assign(m_nodes.size(), 0);
+		instance.m_active.assign(m_nodes.size(), 0);
+		instance.m_jointNodes.assign(m_jointNodeIndices.size(), nullptr);
+
+		ModelInstance* modelInst = animComp->get_owner()->get_component<ModelInstance>();
+		if (modelInst == nullptr)
+			return;
+
+		auto& modelInstNodes = Scene::get_instance().get_model_inst_nodes(modelInst->get_instance_id());
+		for (unsigned i = 0; i < m_jointNodeIndices.size(); ++i)
+			if (m_jointNodeIndices[i] >= 0 && m_jointNodeIndices[i] < (int)modelInstNodes.size())
+				instance.m_jointNodes[i] = modelInstNodes[m_jointNodeIndices[i]];
+	}
+
+	// Copy the blend parameters of the given tree nodes (obtained from compile) into the instance
+	void BlendProgram::gather_params(const std::vector<IBlendNode*>& sourceNodes, BlendProgramInstance& instance) const
+	{
+		for (unsigned i = 0; i < m_nodes.size(); ++i)
+		{
+			if (m_nodes[i].m_type == BlendNodeTypes::BLEND_1D)
+				instance.m_params[i].x = static_cast<Blend1D*>(sourceNodes[i])->m_blendParam;
+			else if (m_nodes[i].m_type == BlendNodeTypes::BLEND_2D)
+				instance.m_params[i] = static_cast<Blend2D*>(sourceNodes[i])->m_blendParam;
+		}
+	}
+
+
+	// Evaluate the program and apply the resulting pose to the skeleton of the instance
+	void BlendProgram::execute(BlendProgramInstance& instance) const
+	{
+		select_children(instance);
+
+		for (const BlendInstruction& instruction : m_instructions)
+			run_instruction(instruction, instance);
+	}
+
+
+	bool BlendProgram::is_empty() const
+	{
+		return m_instructions.empty();
+	}
+
+	unsigned BlendProgram::get_slot_count() const
+	{
+		return m_slotCount;
+	}
+
+	unsigned BlendProgram::get_instruction_count() const
+	{
+		return (unsigned)m_instructions.size();
+	}
+
+	unsigned BlendProgram::get_joint_count() const
+	{
+		return (unsigned)m_jointNodeIndices.size();
+	}
+
+
+	// Compile the subtree of the given node, returns the index of the compiled node
+	unsigned BlendProgram::compile_node(IBlendNode* node, unsigned mask, CompileContext& context)
+	{
+		BlendProgramNode compiled;
+		compiled.m_blendPos = node->m_blendPos;
+		compiled.m_mask = mask;
+
+		BlendInstruction instruction;
+
+		// Leaf nodes just sample their animation
+		BlendAnim* animNode = dynamic_cast<BlendAnim*>(node);
+		if (animNode)
+		{
+			compiled.m_type = BlendNodeTypes::BLEND_ANIM;
+			compiled.m_animSource = animNode->m_animSource;
+			compiled.m_slot = allocate_slot(context);
+			compile_channels(animNode->m_animSource, compiled, context);
+			instruction.m_opCode = BlendOpCode::SAMPLE;
+		}
+		else
+		{
+			Blend2D* node2D = dynamic_cast<Blend2D*>(node);
+			BlendLayer* layerNode = dynamic_cast<BlendLayer*>(node);
+			if (node2D)
+				compiled.m_type = BlendNodeTypes::BLEND_2D;
+			else if (layerNode)
+				compiled.m_type = BlendNodeTypes::BLEND_LAYER;
+			else
+				compiled.m_type = BlendNodeTypes::BLEND_1D;
+
+			// Compile the children first. Their slots stay in use until this node has blended them.
+			// The layers (every child of a layer node but the base) only evaluate the joints of their mask.
+			std::vector<unsigned> children;
+			children.reserve(node->m_children.size());
+			for (unsigned i = 0; i < node->m_children.size(); ++i)
+			{
+				IBlendNode* child = node->m_children[i];
+
+				unsigned childMask = mask;
+				if (layerNode && i > 0 && !child->m_blendMask.empty())
+					childMask = compile_mask(&child->m_blendMask, mask);
+
+				children.push_back(compile_node(child, childMask, context));
+			}
+
+			compiled.m_slot = allocate_slot(context);
+			compiled.m_firstChild = (unsigned)m_childIndices.size();
+			compiled.m_childCount = (unsigned)children.size();
+			m_childIndices.insert(m_childIndices.end(), children.begin(), children.end());
+
+			// The children of 1D nodes are sorted, so the range is given by the first and last
+			if (compiled.m_type == BlendNodeTypes::BLEND_1D && !children.empty())
+			{
+				compiled.m_minPos = m_nodes[children.front()].m_blendPos.x;
+				compiled.m_maxPos = m_nodes[children.back()].m_blendPos.x;
+			}
+
+			// Store the triangles in terms of compiled nodes
+			if (node2D)
+			{
+				compiled.m_firstTriangle = (unsigned)m_triangles.size();
+				compiled.m_triangleCount = (unsigned)node2D->m_triangles.size();
+				for (const auto& triangle : node2D->m_triangles)
+					m_triangles.push_back({ children[triangle[0]], children[triangle[1]], children[triangle[2]] });
+			}
+
+			// The slots of the children can now be reused by the rest of the program
+			for (unsigned child : children)
+				context.m_freeSlots.push_back(m_nodes[child].m_slot);
+
+			if (node2D)
+				instruction.m_opCode = BlendOpCode::BARYCENTRIC;
+			else if (layerNode)
+				instruction.m_opCode = BlendOpCode::LAYER;
+			else
+				instruction.m_opCode = BlendOpCode::LERP;
+		}
+
+		unsigned nodeIdx = (unsigned)m_nodes.size();
+		m_nodes.push_back(compiled);
+		if (context.m_sourceNodes)
+			context.m_sourceNodes->push_back(node);
+
+		instruction.m_node = nodeIdx;
+		instruction.m_slot = compiled.m_slot;
+		m_instructions.push_back(instruction);
+
+		return nodeIdx;
+	}
+
+	// Generate the channels that the given anim node samples
+	void BlendProgram::compile_channels(Animation* anim, BlendProgramNode& compiled, CompileContext& context)
+	{
+		compiled.m_firstChannel = (unsigned)m_channels.size();
+		if (anim == nullptr)
+			return;
+
+		const float* maskWeights = m_maskWeights.data() + compiled.m_mask * m_jointNodeIndices.size();
+
+		for (int i = 0; i < anim->m_channels.size(); ++i)
+		{
+			const AnimationChannel& channel = anim->m_channels[i];
+
+			BlendChannel compiledChannel;
+			compiledChannel.m_channelIdx = i;
+			if (channel.m_targetProperty == "translation")
+				compiledChannel.m_property = TargetProperty::TRANSLATION;
+			else if (channel.m_targetProperty == "rotation")
+				compiledChannel.m_property = TargetProperty::ROTATION;
+			else if (channel.m_targetProperty == "scale")
+				compiledChannel.m_property = TargetProperty::SCALE;
+			else
+				continue;
+
+			// Don't sample the joints outside of the mask
+			compiledChannel.m_joint = context.m_jointLookup[channel.m_targetNodeIdx];
+			if (maskWeights[compiledChannel.m_joint] <= 0.0f)
+				continue;
+
+			m_jointProperties[compiledChannel.m_joint] |= (unsigned char)compiledChannel.m_property;
+			m_channels.push_back(compiledChannel);
+		}
+
+		compiled.m_channelCount = (unsigned)m_channels.size() - compiled.m_firstChannel;
+	}
+
+	// Find the joints that the animations of the tree affect, and sort them depth first
+	void BlendProgram::collect_joints(IBlendNode* node, CompileContext& context)
+	{
+		BlendAnim* animNode = dynamic_cast<BlendAnim*>(node);
+		if (animNode && animNode->m_animSource)
+		{
+			for (const AnimationChannel& channel : animNode->m_animSource->m_channels)
+				context.m_jointLookup.emplace(channel.m_targetNodeIdx, 0);
+		}
+
+		for (IBlendNode* child : node->m_children)
+			collect_joints(child, context);
+	}
+
+	void BlendProgram::sort_joints(CompileContext& context)
+	{
+		const std::vector<GLTFNode>& modelNodes = context.m_model->m_nodes;
+
+		// Find the depth first order of the nodes of the model
+		std::vector<unsigned char> isChild(modelNodes.size(), 0);
+		for (const GLTFNode& modelNode : modelNodes)
+		{
+			for (int childIdx : modelNode.m_childrenIndices)
+				isChild[childIdx] = 1;
+		}
+
+		std::vector<unsigned> depthFirstOrder(modelNodes.size(), 0);
+		std::vector<int> nodesToVisit;
+		unsigned order = 0;
+		for (int i = 0; i < modelNodes.size(); ++i)
+		{
+			if (isChild[i])
+				continue;
+
+			nodesToVisit.push_back(i);
+			while (!nodesToVisit.empty())
+			{
+				int nodeIdx = nodesToVisit.back();
+				nodesToVisit.pop_back();
+				depthFirstOrder[nodeIdx] = order++;
+
+				const std::vector<int>& children = modelNodes[nodeIdx].m_childrenIndices;
+				nodesToVisit.insert(nodesToVisit.end(), children.rbegin(), children.rend());
+			}
+		}
+
+		// Sort the joints in that order, and store their rest transform
+		for (const auto& joint : context.m_jointLookup)
+			m_jointNodeIndices.push_back(joint.first);
+
+		std::sort(m_jointNodeIndices.begin(), m_jointNodeIndices.end(), [&depthFirstOrder](int lhs, int rhs) -> bool
+		{
+			return depthFirstOrder[lhs] < depthFirstOrder[rhs];
+		});
+
+		m_jointProperties.assign(m_jointNodeIndices.size(), 0);
+		m_restPose.resize(m_jointNodeIndices.size());
+		for (unsigned i = 0; i < m_jointNodeIndices.size(); ++i)
+		{
+			context.m_jointLookup[m_jointNodeIndices[i]] = i;
+			m_restPose[i].set_transform(modelNodes[m_jointNodeIndices[i]].m_localTransform);
+		}
+	}
+
+
+	// Compile the given mask restricted to the parent mask (null affects every joint of the parent).
+	// Returns the index of the compiled mask.
+	unsigned BlendProgram::compile_mask(const BlendMask* blendMask, unsigned parentMask)
+	{
+		unsigned jointCount = (unsigned)m_jointNodeIndices.size();
+		unsigned maskIdx = (unsigned)m_masks.size();
+		m_maskWeights.resize((maskIdx + 1) * jointCount, 0.0f);
+
+		// Compute the weight of every joint
+		for (unsigned i = 0; i < jointCount; ++i)
+		{
+			float weight = maskIdx == 0 ? 1.0f : m_maskWeights[parentMask * jointCount + i];
+			if (blendMask)
+			{
+				auto foundWeight = blendMask->find(m_jointNodeIndices[i]);
+				weight *= foundWeight != blendMask->end() ? foundWeight->second : 0.0f;
+			}
+
+			m_maskWeights[maskIdx * jointCount + i] = weight;
+		}
+
+		// Group the joints with some weight into ranges
+		BlendProgramMask mask;
+		mask.m_firstRange = (unsigned)m_maskRanges.size();
+		for (unsigned i = 0; i < jointCount; ++i)
+		{
+			if (m_maskWeights[maskIdx * jointCount + i] <= 0.0f)
+				continue;
+
+			if (mask.m_rangeCount > 0 && m_maskRanges.back().m_firstJoint + m_maskRanges.back().m_jointCount == i)
+				m_maskRanges.back().m_jointCount++;
+			else
+			{
+				m_maskRanges.push_back({ i, 1 });
+				mask.m_rangeCount++;
+			}
+		}
+
+		m_masks.push_back(mask);
+		return maskIdx;
+	}
+
+	// Get a slot that isn't being used
+	unsigned BlendProgram::allocate_slot(CompileContext& context)
+	{
+		if (context.m_freeSlots.empty())
+			return m_slotCount++;
+
+		unsigned slot = context.m_freeSlots.back();
+		context.m_freeSlots.pop_back();
+		return slot;
+	}
+
+
+	// Choose the children that each active blend node will blend this frame (root to leaves)
+	void BlendProgram::select_children(BlendProgramInstance& instance) const
+	{
+		std::fill(instance.m_active.begin(), instance.m_active.end(), 0);
+		if (m_nodes.empty())
+			return;
+
+		// Parents are always after their children, so iterating backwards visits the parents first
+		instance.m_active.back() = 1;
+		for (int i = (int)m_nodes.size() - 1; i >= 0; --i)
+		{
+			const BlendProgramNode& node = m_nodes[i];
+			if (!instance.m_active[i] || node.m_type == BlendNodeTypes::BLEND_ANIM || node.m_childCount == 0)
+				continue;
+
+			// Layer nodes always blend all of their children
+			if (node.m_type == BlendNodeTypes::BLEND_LAYER)
+			{
+				for (unsigned child = node.m_firstChild; child < node.m_firstChild + node.m_childCount; ++child)
+					instance.m_active[m_childIndices[child]] = 1;
+				continue;
+			}
+
+			if (node.m_type == BlendNodeTypes::BLEND_1D)
+				select_1d(i, instance);
+			else
+				select_2d(i, instance);
+
+			// Only the selected children need to be evaluated
+			const BlendSelection& selection = instance.m_selections[i];
+			instance.m_active[selection.m_nodes[0]] = 1;
+			instance.m_active[selection.m_nodes[1]] = 1;
+			instance.m_active[selection.m_nodes[2]] = 1;
+		}
+	}
+
+	void BlendProgram::select_1d(unsigned nodeIdx, BlendProgramInstance& instance) const
+	{
+		const BlendProgramNode& node = m_nodes[nodeIdx];
+		BlendSelection& selection = instance.m_selections[nodeIdx];
+		float param = instance.m_params[nodeIdx].x;
+		const unsigned* children = m_childIndices.data() + node.m_firstChild;
+
+		// If the blend parameter is out of the range, clamp to the first/last child
+		if (param <= node.m_minPos || param >= node.m_maxPos)
+		{
+			unsigned child = param <= node.m_minPos ? children[0] : children[node.m_childCount - 1];
+			selection.m_nodes[0] = selection.m_nodes[1] = selection.m_nodes[2] = child;
+			selection.m_weights[0] = selection.m_weights[2] = 0.0f;
+			selection.m_weights[1] = 1.0f;
+			return;
+		}
+
+		// Check the segment of the previous frame first, as well as its neighbours (the param won't
+		// change much from frame to frame), and only do a binary search if it has moved away from them
+		unsigned& segment = instance.m_lastSegments[nodeIdx];
+		if (!is_in_segment(node, segment, param))
+		{
+			if (is_in_segment(node, segment + 1, param))
+				++segment;
+			else if (segment > 0 && is_in_segment(node, segment - 1, param))
+				--segment;
+			else
+			{
+				// Find the first child to the right of the parameter
+				const unsigned* right = std::upper_bound(children, children + node.m_childCount, param, [this](float value, unsigned child) -> bool
+				{
+					return value < m_nodes[child].m_blendPos.x;
+				});
+				segment = (unsigned)(right - children) - 1;
+			}
+		}
+
+		// Normalize the blend parameter to the range [0, 1] (0=at from, 1=at to). The segment
+		// contains the parameter, so its length can't be 0 and the result doesn't need clamping.
+		unsigned from = children[segment];
+		unsigned to = children[segment + 1];
+		float fromPos = m_nodes[from].m_blendPos.x;
+		float normalizedBlendParam = (param - fromPos) / (m_nodes[to].m_blendPos.x - fromPos);
+
+		selection.m_nodes[0] = from;
+		selection.m_nodes[1] = selection.m_nodes[2] = to;
+		selection.m_weights[0] = 1.0f - normalizedBlendParam;
+		selection.m_weights[1] = normalizedBlendParam;
+		selection.m_weights[2] = 0.0f;
+	}
+
+	void BlendProgram::select_2d(unsigned nodeIdx, BlendProgramInstance& instance) const
+	{
+		const BlendProgramNode& node = m_nodes[nodeIdx];
+		BlendSelection& selection = instance.m_selections[nodeIdx];
+		const glm::vec2& param = instance.m_params[nodeIdx];
+
+		// Find the triangle that contains the parameter
+		for (unsigned i = node.m_firstTriangle; i < node.m_firstTriangle + node.m_triangleCount; ++i)
+		{
+			const auto& indices = m_triangles[i];
+			const glm::vec2& v0 = m_nodes[indices[0]].m_blendPos;
+			const glm::vec2& v1 = m_nodes[indices[1]].m_blendPos;
+			const glm::vec2& v2 = m_nodes[indices[2]].m_blendPos;
+
+			glm::vec2 p0 = v0 - param;
+			glm::vec2 p1 = v1 - param;
+			glm::vec2 p2 = v2 - param;
+
+			float area0 = p1.x * p2.y - p1.y * p2.x;
+			if (area0 > 0.0f)
+				continue;
+
+			float area1 = p2.x * p0.y - p2.y * p0.x;
+			if (area1 > 0.0f)
+				continue;
+
+			float area2 = p0.x * p1.y - p0.y * p1.x;
+			if (area2 > 0.0f)
+				continue;
+
+			glm::vec2 e0 = v1 - v0;
+			glm::vec2 e1 = v2 - v0;
+			float totalArea = e0.x * e1.y - e0.y * e1.x;
+
+			selection.m_nodes[0] = indices[0];
+			selection.m_nodes[1] = indices[1];
+			selection.m_nodes[2] = indices[2];
+			selection.m_weights[0] = area0 / totalArea;
+			selection.m_weights[1] = area1 / totalArea;
+			selection.m_weights[2] = area2 / totalArea;
+			return;
+		}
+
+		// The parameter is outside of the triangles, so use the closest child
+		unsigned closest = m_childIndices[node.m_firstChild];
+		float closestDistSq = FLT_MAX;
+		for (unsigned i = node.m_firstChild; i < node.m_firstChild + node.m_childCount; ++i)
+		{
+			unsigned child = m_childIndices[i];
+			glm::vec2 diff = m_nodes[child].m_blendPos - param;
+			float distSq = glm::dot(diff, diff);
+			if (distSq < closestDistSq)
+			{
+				closestDistSq = distSq;
+				closest = child;
+			}
+		}
+
+		selection.m_nodes[0] = selection.m_nodes[1] = selection.m_nodes[2] = closest;
+		selection.m_weights[0] = 1.0f;
+		selection.m_weights[1] = selection.m_weights[2] = 0.0f;
+	}
+
+
+	// Returns true if the parameter lies in the segment starting at the given child of a 1D node
+	bool BlendProgram::is_in_segment(const BlendProgramNode& node, unsigned segment, float param) const
+	{
+		if (segment + 1 >= node.m_childCount)
+			return false;
+
+		const unsigned* children = m_childIndices.data() + node.m_firstChild;
+		return m_nodes[children[segment]].m_blendPos.x <= param && param < m_nodes[children[segment + 1]].m_blendPos.x;
+	}
+
+
+	// Execute a single instruction for the given instance
+	void BlendProgram::run_instruction(const BlendInstruction& instruction, BlendProgramInstance& instance) const
+	{
+		if (!instance.m_active[instruction.m_node])
+			return;
+
+		const BlendProgramNode& node = m_nodes[instruction.m_node];
+		const BlendSelection& selection = instance.m_selections[instruction.m_node];
+		JointPose& pose = instance.m_slots[instruction.m_slot];
+
+		// Every instruction only touches the joints in the mask of its node
+		const BlendMaskRange* firstRange = m_maskRanges.data() + m_masks[node.m_mask].m_firstRange;
+		const BlendMaskRange* lastRange = firstRange + m_masks[node.m_mask].m_rangeCount;
+
+		// Sampling starts from the rest pose, and nodes without an animation or children just produce it
+		bool isEmpty = node.m_type == BlendNodeTypes::BLEND_ANIM ? node.m_animSource == nullptr : node.m_childCount == 0;
+		if (instruction.m_opCode != BlendOpCode::APPLY && (isEmpty || instruction.m_opCode == BlendOpCode::SAMPLE))
+		{
+			for (const BlendMaskRange* range = firstRange; range != lastRange; ++range)
+				std::copy_n(m_restPose.begin() + range->m_firstJoint, range->m_jointCount, pose.begin() + range->m_firstJoint);
+
+			if (isEmpty)
+				return;
+		}
+
+		switch (instruction.m_opCode)
+		{
+		case BlendOpCode::SAMPLE:
+		{
+			float time = glm::mod(instance.m_time, node.m_animSource->m_duration);
+			for (unsigned i = node.m_firstChannel; i < node.m_firstChannel + node.m_channelCount; ++i)
+			{
+				const BlendChannel& channel = m_channels[i];
+				JointTransform& joint = pose[channel.m_joint];
+
+				if (channel.m_property == TargetProperty::TRANSLATION)
+					joint.m_position = glm::vec4(node.m_animSource->sample_vec3(time, channel.m_channelIdx), 0.0f);
+				else if (channel.m_property == TargetProperty::SCALE)
+					joint.m_scale = glm::vec4(node.m_animSource->sample_vec3(time, channel.m_channelIdx), 0.0f);
+				else
+				{
+					glm::quat orientation = node.m_animSource->sample_quat(time, channel.m_channelIdx);
+					joint.m_orientation = glm::vec4(orientation.x, orientation.y, orientation.z, orientation.w);
+				}
+			}
+			break;
+		}
+
+		case BlendOpCode::LERP:
+		{
+			const JointPose& from = instance.m_slots[m_nodes[selection.m_nodes[0]].m_slot];
+			const JointPose& to = instance.m_slots[m_nodes[selection.m_nodes[1]].m_slot];
+			for (const BlendMaskRange* range = firstRange; range != lastRange; ++range)
+			{
+				unsigned first = range->m_firstJoint;
+				blend_joints_lerp(from.data() + first, to.data() + first, pose.data() + first, range->m_jointCount, selection.m_weights[1]);
+			}
+			break;
+		}
+
+		case BlendOpCode::BARYCENTRIC:
+		{
+			const JointPose& pose0 = instance.m_slots[m_nodes[selection.m_nodes[0]].m_slot];
+			const JointPose& pose1 = instance.m_slots[m_nodes[selection.m_nodes[1]].m_slot];
+			const JointPose& pose2 = instance.m_slots[m_nodes[selection.m_nodes[2]].m_slot];
+			for (const BlendMaskRange* range = firstRange; range != lastRange; ++range)
+			{
+				unsigned first = range->m_firstJoint;
+				blend_joints_barycentric(pose0.data() + first, pose1.data() + first, pose2.data() + first,
+										 selection.m_weights[0], selection.m_weights[1], selection.m_weights[2],
+										 pose.data() + first, range->m_jointCount);
+			}
+			break;
+		}
+
+		case BlendOpCode::LAYER:
+		{
+			// Start from the base pose
+			const JointPose& basePose = instance.m_slots[m_nodes[m_childIndices[node.m_firstChild]].m_slot];
+			for (const BlendMaskRange* range = firstRange; range != lastRange; ++range)
+				std::copy_n(basePose.begin() + range->m_firstJoint, range->m_jointCount, pose.begin() + range->m_firstJoint);
+
+			// Blend each layer on top, only in the joints of its mask
+			unsigned jointCount = (unsigned)m_jointNodeIndices.size();
+			for (unsigned i = node.m_firstChild + 1; i < node.m_firstChild + node.m_childCount; ++i)
+			{
+				const BlendProgramNode& layer = m_nodes[m_childIndices[i]];
+				const JointPose& layerPose = instance.m_slots[layer.m_slot];
+				const float* layerWeights = m_maskWeights.data() + layer.m_mask * jointCount;
+
+				const BlendProgramMask& layerMask = m_masks[layer.m_mask];
+				for (unsigned r = layerMask.m_firstRange; r < layerMask.m_firstRange + layerMask.m_rangeCount; ++r)
+				{
+					unsigned first = m_maskRanges[r].m_firstJoint;
+					blend_joints_lerp_masked(pose.data() + first, layerPose.data() + first, pose.data() + first, m_maskRanges[r].m_jointCount, layerWeights + first);
+				}
+			}
+			break;
+		}
+
+		case BlendOpCode::APPLY:
+			// Only write the properties that the animations of the tree affect
+			for (const BlendMaskRange* range = firstRange; range != lastRange; ++range)
+			{
+				for (unsigned i = range->m_firstJoint; i < range->m_firstJoint + range->m_jointCount; ++i)
+				{
+					SceneNode* jointNode = instance.m_jointNodes[i];
+					if (jointNode == nullptr)
+						continue;
+
+					unsigned char properties = m_jointProperties[i];
+					if (properties & (unsigned char)TargetProperty::TRANSLATION)
+						jointNode->set_local_position(pose[i].get_position());
+					if (properties & (unsigned char)TargetProperty::ROTATION)
+						jointNode->set_local_orientation(pose[i].get_orientation());
+					if (properties & (unsigned char)TargetProperty::SCALE)
+						jointNode->set_local_scale(pose[i].get_scale());
+				}
+			}
+			break;
+		}
+	}
+}
\ No newline at end of file
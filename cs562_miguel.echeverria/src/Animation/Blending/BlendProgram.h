@@ -0,0 +1,191 @@
+/**
+* @file BlendProgram.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Flat version of a blend tree. The tree is compiled into a list of
+*		 instructions that read and write pose slots, so that it can be evaluated
+*		 every frame without recursion or virtual calls.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "IBlendNode.h"
+#include "PoseKernels.h"
+
+
+namespace cs460
+{
+	struct Animation;
+	struct Model;
+	class SceneNode;
+
+
+	enum class BlendOpCode
+	{
+		SAMPLE,			// Sample the animation of a node into its slot
+		LERP,			// Blend the two selected children of a 1D node
+		BARYCENTRIC,	// Blend the three selected children of a 2D node
+		LAYER,			// Copy the base child of a layer node, and blend the other children on top using their masks
+		APPLY			// Apply the root slot to the skeleton
+	};
+
+
+	struct BlendInstruction
+	{
+		BlendOpCode m_opCode = BlendOpCode::SAMPLE;
+		unsigned m_node = 0;		// Compiled node evaluated by this instruction
+		unsigned m_slot = 0;		// Pose slot written by the instruction (read by APPLY)
+	};
+
+
+	// Animation channel sampled by an anim node, with the joint and property it writes to
+	struct BlendChannel
+	{
+		int m_channelIdx = 0;
+		unsigned m_joint = 0;			// Index of the joint in the poses of the program
+		TargetProperty m_property = TargetProperty::ROTATION;
+	};
+
+
+	// Consecutive joints of a mask
+	struct BlendMaskRange
+	{
+		unsigned m_firstJoint = 0;
+		unsigned m_jointCount = 0;
+	};
+
+	// Joints affected by a node, as ranges of the joints of the program
+	struct BlendProgramMask
+	{
+		unsigned m_firstRange = 0;
+		unsigned m_rangeCount = 0;
+	};
+
+
+	// Compiled data of one node of the blend tree
+	struct BlendProgramNode
+	{
+		BlendNodeTypes m_type = BlendNodeTypes::BLEND_ANIM;
+		Animation* m_animSource = nullptr;		// Only used by anim nodes
+		glm::vec2 m_blendPos{ 0.0f, 0.0f };
+		float m_minPos = 0.0f;					// Range of the blend space (only used by 1D nodes)
+		float m_maxPos = 0.0f;
+		unsigned m_slot = 0;
+		unsigned m_mask = 0;					// Only these joints are sampled and blended (0 is the whole skeleton)
+
+		// Ranges in the channels, child indices and triangles of the program
+		unsigned m_firstChannel = 0;
+		unsigned m_channelCount = 0;
+		unsigned m_firstChild = 0;
+		unsigned m_childCount = 0;
+		unsigned m_firstTriangle = 0;
+		unsigned m_triangleCount = 0;
+	};
+
+
+	// Children chosen by a blend node in the current frame, and their weights
+	struct BlendSelection
+	{
+		unsigned m_nodes[3] = { 0, 0, 0 };
+		float m_weights[3] = { 0.0f, 0.0f, 0.0f };
+	};
+
+
+	// Per character data needed to evaluate a blend program
+	struct BlendProgramInstance
+	{
+		AnimationReference* m_animComp = nullptr;
+		float m_time = 0.0f;
+		std::vector<glm::vec2> m_params;				// Blend parameter of each compiled node (only x for 1D)
+		std::vector<JointPose> m_slots;
+		std::vector<SceneNode*> m_jointNodes;			// Scene node of each joint of the poses
+		std::vector<BlendSelection> m_selections;
+		std::vector<unsigned> m_lastSegments;			// Segment chosen by each 1D node in the previous frame (search hint)
+		std::vector<unsigned char> m_active;			// Whether each node contributes to the final pose this frame
+	};
+
+
+	class BlendProgram
+	{
+	public:
+
+		// Walk the given tree and generate the instructions. If sourceNodes is given,
+		// it is filled with the tree node that corresponds to each compiled node.
+		void compile(IBlendNode* root, Model* model, std::vector<IBlendNode*>* sourceNodes = nullptr);
+		void clear();
+
+		// Allocate the slots and per node data that this program needs in the given instance,
+		// and find the scene nodes of the skeleton of the given component
+		void init_instance(BlendProgramInstance& instance, AnimationReference* animComp) const;
+
+		// Copy the blend parameters of the given tree nodes (obtained from compile) into the instance
+		void gather_params(const std::vector<IBlendNode*>& sourceNodes, BlendProgramInstance& instance) const;
+
+		// Evaluate the program and apply the resulting pose to the skeleton of the instance
+		void execute(BlendProgramInstance& instance) const;
+
+		bool is_empty() const;
+		unsigned get_slot_count() const;
+		unsigned get_instruction_count() const;
+		unsigned get_joint_count() const;
+
+	private:
+
+		// Temporary data used while compiling
+		struct CompileContext
+		{
+			Model* m_model = nullptr;
+			std::vector<IBlendNode*>* m_sourceNodes = nullptr;
+			std::vector<unsigned> m_freeSlots;
+			std::unordered_map<int, unsigned> m_jointLookup;		// Model node index to joint index
+		};
+
+		std::vector<BlendInstruction> m_instructions;
+		std::vector<BlendProgramNode> m_nodes;					// Children always come before their parent
+		std::vector<unsigned> m_childIndices;					// Sorted by blend position in 1D nodes
+		std::vector<std::array<unsigned, 3>> m_triangles;		// Indices of compiled nodes
+		std::vector<BlendChannel> m_channels;
+		unsigned m_slotCount = 0;
+
+		// Masks of the nodes. The joints are sorted depth first, so hierarchy masks are a single range.
+		std::vector<BlendProgramMask> m_masks;
+		std::vector<BlendMaskRange> m_maskRanges;
+		std::vector<float> m_maskWeights;						// Weight of every joint, for every mask
+
+		// Joints animated by any of the animations of the tree. The poses only contain these.
+		std::vector<int> m_jointNodeIndices;					// Model node index of each joint
+		std::vector<unsigned char> m_jointProperties;			// Properties animated in each joint (TargetProperty flags)
+		JointPose m_restPose;									// Local transform of each joint in the model
+
+
+		// Find the joints that the animations of the tree affect, and sort them depth first
+		void collect_joints(IBlendNode* node, CompileContext& context);
+		void sort_joints(CompileContext& context);
+
+		// Compile the given mask restricted to the parent mask (null affects every joint of the parent).
+		// Returns the index of the compiled mask.
+		unsigned compile_mask(const BlendMask* blendMask, unsigned parentMask);
+
+		// Compile the subtree of the given node, returns the index of the compiled node
+		unsigned compile_node(IBlendNode* node, unsigned mask, CompileContext& context);
+
+		// Generate the channels that the given anim node samples
+		void compile_channels(Animation* anim, BlendProgramNode& compiled, CompileContext& context);
+
+		// Get a slot that isn't being used
+		unsigned allocate_slot(CompileContext& context);
+
+		// Choose the children that each active blend node will blend this frame (root to leaves)
+		void select_children(BlendProgramInstance& instance) const;
+		void select_1d(unsigned nodeIdx, BlendProgramInstance& instance) const;
+		void select_2d(unsigned nodeIdx, BlendProgramInstance& instance) const;
+
+		// Returns true if the parameter lies in the segment starting at the given child of a 1D node
+		bool is_in_segment(const BlendProgramNode& node, unsigned segment, float param) const;
+
+		// Execute a single instruction for the given instance
+		void run_instruction(const BlendInstruction& instruction, BlendProgramInstance& instance) const;
+	};
+}
\ No newline at end of file
@@ -25,23 +25,6 @@ namespace cs460
 	}
 
 
-	void BlendTree::produce_pose(float time)
-	{
-		if (m_root == nullptr)
-			return;
-
-		m_root->produce_pose(time);
-	}
-
-	AnimPose& BlendTree::get_current_pose()
-	{
-		if (m_root == nullptr)
-			throw "ERROR: Calling get_current_pose on an empty tree\n";
-
-		return m_root->m_pose;
-	}
-
-
 	IBlendNode* BlendTree::get_root()
 	{
 		return m_root;
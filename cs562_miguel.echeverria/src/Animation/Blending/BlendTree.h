@@ -24,9 +24,6 @@ namespace cs460
 		BlendTree();
 		~BlendTree();
 
-		void produce_pose(float time);
-		AnimPose& get_current_pose();
-
 		IBlendNode* get_root();
 
 		// Returns true if the root is null
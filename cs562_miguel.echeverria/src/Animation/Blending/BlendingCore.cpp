@@ -16,6 +16,7 @@
 #include "Composition/Scene.h"
 #include "Composition/SceneNode.h"
 #include "Components/Models/ModelInstance.h"
+#include "Graphics/GLTF/Model.h"
 
 
 namespace cs460
@@ -55,7 +56,7 @@ namespace cs460
 
 	void blend_pose_lerp(const AnimPose& startPose, const AnimPose& endPose, AnimPose& resultPose, float blendParam, BlendMask* blendMask)
 	{
-		// We will ignore the blend mask for now
+		// The blend mask scales the blend parameter of each joint (joints not in the mask keep the start pose)
 		// Please note that blendParam should already be normalized in the range [0, 1]
 
 		// Generate all the keys given by the start pose
@@ -73,9 +74,16 @@ namespace cs460
 			const auto& foundStartJoint = startPose.find(resultJoint.first);
 			const auto& foundEndJoint = endPose.find(resultJoint.first);
 
-			float posParam = blendParam;
-			float rotParam = blendParam;
-			float scaleParam = blendParam;
+			float jointParam = blendParam;
+			if (blendMask)
+			{
+				auto foundWeight = blendMask->find(resultJoint.first);
+				jointParam = foundWeight != blendMask->end() ? blendParam * foundWeight->second : 0.0f;
+			}
+
+			float posParam = jointParam;
+			float rotParam = jointParam;
+			float scaleParam = jointParam;
 
 			// If the joint is not in the start pose
 			if (foundStartJoint == startPose.end())
@@ -140,7 +148,7 @@ namespace cs460
 
 	void blend_pose_barycentric(const AnimPose& pose0, const AnimPose& pose1, const AnimPose& pose2, float a0, float a1, float a2, AnimPose& resultPose, BlendMask* blendMask)
 	{
-		// We will ignore the blend mask for now
+		// The blend mask scales the influence of pose1 and pose2 on each joint (joints not in the mask keep pose0)
 
 		// Generate all the keys given by pose0
 		for (auto& jointPose0 : pose0)
@@ -162,9 +170,22 @@ namespace cs460
 			const auto& foundJoint1 = pose1.find(resultJoint.first);
 			const auto& foundJoint2 = pose2.find(resultJoint.first);
 
-			float posParams[3] = { a0, a1, a2 };
-			float rotParams[3] = { a0, a1, a2 };
-			float scaleParams[3] = { a0, a1, a2 };
+			// The influence taken from pose1 and pose2 by the mask goes back to pose0
+			float jointA0 = a0;
+			float jointA1 = a1;
+			float jointA2 = a2;
+			if (blendMask)
+			{
+				auto foundWeight = blendMask->find(resultJoint.first);
+				float weight = foundWeight != blendMask->end() ? foundWeight->second : 0.0f;
+				jointA0 = a0 + (a1 + a2) * (1.0f - weight);
+				jointA1 *= weight;
+				jointA2 *= weight;
+			}
+
+			float posParams[3] = { jointA0, jointA1, jointA2 };
+			float rotParams[3] = { jointA0, jointA1, jointA2 };
+			float scaleParams[3] = { jointA0, jointA1, jointA2 };
 
 			// If the joint is not in pose0
 			if (foundJoint0 == pose0.end())
@@ -288,18 +309,56 @@ namespace cs460
 			// If translation has been modified, apply it
 			if (joint.second.second & (unsigned char)TargetProperty::TRANSLATION)
 			{
-				jointNode->m_localTr.m_position = joint.second.first.m_position;
+				jointNode->set_local_position(joint.second.first.m_position);
 			}
 			// If orientation has been modified, apply it
 			if (joint.second.second & (unsigned char)TargetProperty::ROTATION)
 			{
-				jointNode->m_localTr.m_orientation = joint.second.first.m_orientation;
+				jointNode->set_local_orientation(joint.second.first.m_orientation);
 			}
 			// If scale has been modified, apply it
 			if (joint.second.second & (unsigned char)TargetProperty::SCALE)
 			{
-				jointNode->m_localTr.m_scale = joint.second.first.m_scale;
+				jointNode->set_local_scale(joint.second.first.m_scale);
 			}
 		}
 	}
+
+
+	// Create a mask with the given joint and all of its descendants (e.g. the spine for an upper body layer).
+	// The joint can be given by its model node index or by its name (returns an empty mask if not found).
+	BlendMask create_hierarchy_mask(const Model* model, int rootNodeIdx, float weight)
+	{
+		BlendMask mask;
+		if (model == nullptr || rootNodeIdx < 0 || rootNodeIdx >= model->m_nodes.size())
+			return mask;
+
+		std::vector<int> nodesToVisit{ rootNodeIdx };
+		while (!nodesToVisit.empty())
+		{
+			int nodeIdx = nodesToVisit.back();
+			nodesToVisit.pop_back();
+
+			mask[nodeIdx] = weight;
+			const std::vector<int>& children = model->m_nodes[nodeIdx].m_childrenIndices;
+			nodesToVisit.insert(nodesToVisit.end(), children.begin(), children.end());
+		}
+
+		return mask;
+	}
+
+	BlendMask create_hierarchy_mask(const Model* model, const std::string& rootJointName, float weight)
+	{
+		if (model == nullptr)
+			return BlendMask();
+
+		for (int i = 0; i < model->m_nodes.size(); ++i)
+		{
+			if (model->m_nodes[i].m_name == rootJointName)
+				return create_hierarchy_mask(model, i, weight);
+		}
+
+		std::cout << "WARNING: Joint " << rootJointName << " not found when creating a blend mask\n";
+		return BlendMask();
+	}
 }
\ No newline at end of file
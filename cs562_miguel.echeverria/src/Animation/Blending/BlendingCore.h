@@ -14,6 +14,7 @@
 namespace cs460
 {
 	struct Animation;
+	struct Model;
 	class AnimationReference;
 
 
@@ -32,4 +33,9 @@ namespace cs460
 
 	// Apply the given pose to the nodes of the skeleton of the given anim component.
 	void apply_pose_to_skeleton(const AnimPose& pose, AnimationReference* animComp);
+
+	// Create a mask with the given joint and all of its descendants (e.g. the spine for an upper body layer).
+	// The joint can be given by its model node index or by its name (returns an empty mask if not found).
+	BlendMask create_hierarchy_mask(const Model* model, int rootNodeIdx, float weight = 1.0f);
+	BlendMask create_hierarchy_mask(const Model* model, const std::string& rootJointName, float weight = 1.0f);
 }
\ No newline at end of file
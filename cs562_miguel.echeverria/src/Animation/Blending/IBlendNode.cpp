@@ -13,6 +13,8 @@
 #include "Blend1D.h"
 #include "Blend2D.h"
 #include "BlendAnim.h"
+#include "BlendLayer.h"
+#include "Components/Animation/AnimationReference.h"
 
 
 namespace cs460
@@ -24,11 +26,6 @@ namespace cs460
 	}
 
 
-	void IBlendNode::produce_pose(float time)
-	{
-	}
-
-
 	// Create and add a blend node child of the given type
 	IBlendNode* IBlendNode::add_child(BlendNodeTypes type)
 	{
@@ -40,9 +37,12 @@ namespace cs460
 			newNode = new Blend2D(m_animCompOwner);
 		else if (type == BlendNodeTypes::BLEND_ANIM)
 			newNode = new BlendAnim(m_animCompOwner);
+		else if (type == BlendNodeTypes::BLEND_LAYER)
+			newNode = new BlendLayer(m_animCompOwner);
 
 		newNode->m_parent = this;
 		m_children.push_back(newNode);
+		children_changed();
 		return newNode;
 	}
 
@@ -54,6 +54,7 @@ namespace cs460
 			if (child == *it)
 			{
 				it = m_children.erase(it);
+				children_changed();
 				break;
 			}
 		}
@@ -62,9 +63,43 @@ namespace cs460
 	}
 
 
-	// Blends the children's poses into this node's pose.
-	// Meant to be overriden by Blend1D and Blend2D.
-	void IBlendNode::blend_children(float time)
+	// Change the position of this node in its parent's blend space (lets the parent react to the change)
+	void IBlendNode::set_blend_pos(const glm::vec2& blendPos)
+	{
+		m_blendPos = blendPos;
+		notify_structure_changed();
+	}
+
+	// Change the joints that this node affects when it is a layer of a layer node
+	void IBlendNode::set_blend_mask(const BlendMask& blendMask)
+	{
+		m_blendMask = blendMask;
+		notify_structure_changed();
+	}
+
+	// Lets the parent node and the owner know that the structure of the tree has changed
+	// (the owner evaluates a compiled version of the tree, which needs to be regenerated)
+	void IBlendNode::notify_structure_changed()
 	{
+		if (m_parent)
+			m_parent->on_children_changed();
+
+		if (m_animCompOwner)
+			m_animCompOwner->invalidate_blend_program();
+	}
+
+
+	// Called whenever a child is added, removed, or moved in the blend space.
+	void IBlendNode::on_children_changed()
+	{
+	}
+
+	// Calls on_children_changed and notifies the owner
+	void IBlendNode::children_changed()
+	{
+		on_children_changed();
+
+		if (m_animCompOwner)
+			m_animCompOwner->invalidate_blend_program();
 	}
 }
\ No newline at end of file
@@ -19,7 +19,8 @@ namespace cs460
 	{
 		BLEND_1D,
 		BLEND_2D,
-		BLEND_ANIM
+		BLEND_ANIM,
+		BLEND_LAYER
 	};
 
 
@@ -28,8 +29,8 @@ namespace cs460
 		AnimationReference* m_animCompOwner = nullptr;
 		IBlendNode* m_parent = nullptr;
 		std::vector<IBlendNode*> m_children;
-		AnimPose m_pose;
 		glm::vec2 m_blendPos{0.0f, 0.0f};		// Only x is used in a 1D blend
+		BlendMask m_blendMask;					// Weight of each joint (model node index) this node affects when layered. Empty means all.
 
 
 		// Sets the animation component owner
@@ -41,12 +42,21 @@ namespace cs460
 		// Remove the given blend node from the vector of children
 		void remove_child(IBlendNode* child);
 
-		// Gets the blended(or not, depending on type of node) pose at time into m_pose
-		virtual void produce_pose(float time) = 0;
+		// Change the position of this node in its parent's blend space (lets the parent react to the change)
+		void set_blend_pos(const glm::vec2& blendPos);
+
+		// Change the joints that this node affects when it is a layer of a layer node
+		void set_blend_mask(const BlendMask& blendMask);
+
+		// Lets the parent node and the owner know that the structure of the tree has changed
+		// (the owner evaluates a compiled version of the tree, which needs to be regenerated)
+		void notify_structure_changed();
 
 	private:
-		// Blends the children's poses into this node's pose.
-		// Meant to be overriden by Blend1D and Blend2D.
-		virtual void blend_children(float time);
+		// Called whenever a child is added, removed, or moved in the blend space.
+		virtual void on_children_changed();
+
+		// Calls on_children_changed and notifies the owner
+		void children_changed();
 	};
 }
\ No newline at end of file
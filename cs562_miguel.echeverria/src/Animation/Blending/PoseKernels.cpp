@@ -0,0 +1,474 @@
+/**
+* @file PoseKernels.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Kernels that blend whole poses stored as flat arrays of joints. They use
+*		 AVX2 or SSE when the compiler targets them, and plain glm otherwise.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "PoseKernels.h"
+#include "BlendingCore.h"
+#include <random>
+#include <chrono>
+
+// Define POSE_KERNELS_SCALAR to force the glm version of the kernels.
+// SSE2 is always available in x64, AVX2 is used when compiling with /arch:AVX2 (-mavx2).
+#if !defined(POSE_KERNELS_SCALAR)
+	#if defined(__AVX2__)
+		#define POSE_KERNELS_AVX2
+		#define POSE_KERNELS_SSE
+	#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define POSE_KERNELS_SSE
+	#endif
+#endif
+
+#if defined(POSE_KERNELS_SSE)
+	#include <immintrin.h>
+#endif
+
+
+namespace cs460
+{
+	// Conversions from/to the transform data used by the scene nodes
+	void JointTransform::set_transform(const TransformData& transform)
+	{
+		m_position = glm::vec4(transform.m_position, 0.0f);
+		m_orientation = glm::vec4(transform.m_orientation.x, transform.m_orientation.y, transform.m_orientation.z, transform.m_orientation.w);
+		m_scale = glm::vec4(transform.m_scale, 0.0f);
+	}
+
+	glm::vec3 JointTransform::get_position() const
+	{
+		return glm::vec3(m_position);
+	}
+
+	glm::quat JointTransform::get_orientation() const
+	{
+		return glm::quat(m_orientation.w, m_orientation.x, m_orientation.y, m_orientation.z);
+	}
+
+	glm::vec3 JointTransform::get_scale() const
+	{
+		return glm::vec3(m_scale);
+	}
+
+
+	namespace
+	{
+#if defined(POSE_KERNELS_SSE)
+
+		// Dot product of two 4 float vectors, broadcast to all the components
+		// (two shuffles are cheaper than _mm_dp_ps in most cpus)
+		inline __m128 dot_4(__m128 a, __m128 b)
+		{
+			__m128 mul = _mm_mul_ps(a, b);
+			__m128 sum = _mm_add_ps(mul, _mm_shuffle_ps(mul, mul, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		}
+
+		// Negate q if it is in the opposite hemisphere of the reference quaternion
+		inline __m128 align_quat(__m128 q, __m128 reference)
+		{
+			__m128 sign = _mm_and_ps(dot_4(q, reference), _mm_set1_ps(-0.0f));
+			return _mm_xor_ps(q, sign);
+		}
+
+		inline __m128 normalize_quat(__m128 q)
+		{
+			return _mm_div_ps(q, _mm_sqrt_ps(dot_4(q, q)));
+		}
+
+		inline __m128 load(const glm::vec4& v)
+		{
+			return _mm_loadu_ps(&v.x);
+		}
+
+		inline void store(glm::vec4& v, __m128 value)
+		{
+			_mm_storeu_ps(&v.x, value);
+		}
+
+		inline __m128 lerp_4(__m128 a, __m128 b, __m128 t)
+		{
+			return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+		}
+
+
+		inline void lerp_joint(const JointTransform& joint0, const JointTransform& joint1, JointTransform& result, __m128 t)
+		{
+			__m128 r0 = load(joint0.m_orientation);
+			__m128 r1 = align_quat(load(joint1.m_orientation), r0);
+
+			__m128 position = lerp_4(load(joint0.m_position), load(joint1.m_position), t);
+			__m128 scale = lerp_4(load(joint0.m_scale), load(joint1.m_scale), t);
+			__m128 orientation = normalize_quat(lerp_4(r0, r1, t));
+
+			store(result.m_position, position);
+			store(result.m_orientation, orientation);
+			store(result.m_scale, scale);
+		}
+
+		inline void barycentric_joint(const JointTransform& joint0, const JointTransform& joint1, const JointTransform& joint2, JointTransform& result, __m128 a0, __m128 a1, __m128 a2)
+		{
+			__m128 r0 = load(joint0.m_orientation);
+			__m128 r1 = align_quat(load(joint1.m_orientation), r0);
+			__m128 r2 = align_quat(load(joint2.m_orientation), r0);
+
+			__m128 position = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, load(joint0.m_position)), _mm_mul_ps(a1, load(joint1.m_position))), _mm_mul_ps(a2, load(joint2.m_position)));
+			__m128 scale = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, load(joint0.m_scale)), _mm_mul_ps(a1, load(joint1.m_scale))), _mm_mul_ps(a2, load(joint2.m_scale)));
+			__m128 orientation = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, r0), _mm_mul_ps(a1, r1)), _mm_mul_ps(a2, r2));
+
+			store(result.m_position, position);
+			store(result.m_orientation, normalize_quat(orientation));
+			store(result.m_scale, scale);
+		}
+
+		inline void weighted_joint(const JointTransform* const* poses, const float* weights, unsigned poseCount, unsigned joint, JointTransform& result)
+		{
+			__m128 reference = load(poses[0][joint].m_orientation);
+			__m128 weight = _mm_set1_ps(weights[0]);
+
+			__m128 position = _mm_mul_ps(weight, load(poses[0][joint].m_position));
+			__m128 orientation = _mm_mul_ps(weight, reference);
+			__m128 scale = _mm_mul_ps(weight, load(poses[0][joint].m_scale));
+
+			for (unsigned i = 1; i < poseCount; ++i)
+			{
+				weight = _mm_set1_ps(weights[i]);
+				position = _mm_add_ps(position, _mm_mul_ps(weight, load(poses[i][joint].m_position)));
+				orientation = _mm_add_ps(orientation, _mm_mul_ps(weight, align_quat(load(poses[i][joint].m_orientation), reference)));
+				scale = _mm_add_ps(scale, _mm_mul_ps(weight, load(poses[i][joint].m_scale)));
+			}
+
+			store(result.m_position, position);
+			store(result.m_orientation, normalize_quat(orientation));
+			store(result.m_scale, scale);
+		}
+
+#else
+
+		// Negate q if it is in the opposite hemisphere of the reference quaternion
+		inline glm::vec4 align_quat(const glm::vec4& q, const glm::vec4& reference)
+		{
+			return glm::dot(q, reference) < 0.0f ? -q : q;
+		}
+
+		inline void lerp_joint(const JointTransform& joint0, const JointTransform& joint1, JointTransform& result, float t)
+		{
+			glm::vec4 r1 = align_quat(joint1.m_orientation, joint0.m_orientation);
+
+			result.m_position = glm::mix(joint0.m_position, joint1.m_position, t);
+			result.m_orientation = glm::normalize(glm::mix(joint0.m_orientation, r1, t));
+			result.m_scale = glm::mix(joint0.m_scale, joint1.m_scale, t);
+		}
+
+		inline void barycentric_joint(const JointTransform& joint0, const JointTransform& joint1, const JointTransform& joint2, JointTransform& result, float a0, float a1, float a2)
+		{
+			glm::vec4 r1 = align_quat(joint1.m_orientation, joint0.m_orientation);
+			glm::vec4 r2 = align_quat(joint2.m_orientation, joint0.m_orientation);
+
+			result.m_position = a0 * joint0.m_position + a1 * joint1.m_position + a2 * joint2.m_position;
+			result.m_orientation = glm::normalize(a0 * joint0.m_orientation + a1 * r1 + a2 * r2);
+			result.m_scale = a0 * joint0.m_scale + a1 * joint1.m_scale + a2 * joint2.m_scale;
+		}
+
+		inline void weighted_joint(const JointTransform* const* poses, const float* weights, unsigned poseCount, unsigned joint, JointTransform& result)
+		{
+			const glm::vec4& reference = poses[0][joint].m_orientation;
+
+			glm::vec4 position = weights[0] * poses[0][joint].m_position;
+			glm::vec4 orientation = weights[0] * reference;
+			glm::vec4 scale = weights[0] * poses[0][joint].m_scale;
+
+			for (unsigned i = 1; i < poseCount; ++i)
+			{
+				position += weights[i] * poses[i][joint].m_position;
+				orientation += weights[i] * align_quat(poses[i][joint].m_orientation, reference);
+				scale += weights[i] * poses[i][joint].m_scale;
+			}
+
+			result.m_position = position;
+			result.m_orientation = glm::normalize(orientation);
+			result.m_scale = scale;
+		}
+
+#endif
+
+
+#if defined(POSE_KERNELS_AVX2)
+
+		// Two consecutive joints are 24 floats, which are loaded into three registers:
+		// (position0, orientation0), (scale0, position1), (orientation1, scale1).
+		// Each 128 bit lane holds one property, so the quaternions are the high lane
+		// of the first register and the low lane of the third one.
+		struct JointPair
+		{
+			__m256 m_first;
+			__m256 m_middle;
+			__m256 m_last;
+		};
+
+		inline JointPair load_pair(const JointTransform* joints)
+		{
+			const float* data = &joints->m_position.x;
+			return { _mm256_loadu_ps(data), _mm256_loadu_ps(data + 8), _mm256_loadu_ps(data + 16) };
+		}
+
+		inline void store_pair(JointTransform* joints, const JointPair& pair)
+		{
+			float* data = &joints->m_position.x;
+			_mm256_storeu_ps(data, pair.m_first);
+			_mm256_storeu_ps(data + 8, pair.m_middle);
+			_mm256_storeu_ps(data + 16, pair.m_last);
+		}
+
+		// Dot product of each 128 bit lane, broadcast within the lane
+		inline __m256 dot_lanes(__m256 a, __m256 b)
+		{
+			__m256 mul = _mm256_mul_ps(a, b);
+			__m256 sum = _mm256_add_ps(mul, _mm256_permute_ps(mul, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm256_add_ps(sum, _mm256_permute_ps(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		}
+
+		// Negate the quaternions of the pair that are in the opposite hemisphere of the reference ones
+		inline JointPair align_pair(const JointPair& pair, const JointPair& reference)
+		{
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+			const __m256 highLane = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, 0, -1, -1, -1, -1));
+			const __m256 lowLane = _mm256_castsi256_ps(_mm256_setr_epi32(-1, -1, -1, -1, 0, 0, 0, 0));
+
+			__m256 firstSign = _mm256_and_ps(_mm256_and_ps(dot_lanes(pair.m_first, reference.m_first), signMask), highLane);
+			__m256 lastSign = _mm256_and_ps(_mm256_and_ps(dot_lanes(pair.m_last, reference.m_last), signMask), lowLane);
+
+			return { _mm256_xor_ps(pair.m_first, firstSign), pair.m_middle, _mm256_xor_ps(pair.m_last, lastSign) };
+		}
+
+		// Normalize the quaternions of the pair (the other lanes are set to one
+		// before computing the length, so that they never divide by zero)
+		inline JointPair normalize_pair(const JointPair& pair)
+		{
+			const __m256 ones = _mm256_set1_ps(1.0f);
+
+			__m256 first = _mm256_blend_ps(ones, pair.m_first, 0xF0);
+			__m256 last = _mm256_blend_ps(ones, pair.m_last, 0x0F);
+			first = _mm256_div_ps(first, _mm256_sqrt_ps(dot_lanes(first, first)));
+			last = _mm256_div_ps(last, _mm256_sqrt_ps(dot_lanes(last, last)));
+
+			return { _mm256_blend_ps(pair.m_first, first, 0xF0), pair.m_middle, _mm256_blend_ps(pair.m_last, last, 0x0F) };
+		}
+
+		// result + weight * pair
+		inline JointPair accumulate_pair(const JointPair& result, const JointPair& pair, __m256 weight)
+		{
+			return { _mm256_add_ps(result.m_first, _mm256_mul_ps(weight, pair.m_first)),
+					 _mm256_add_ps(result.m_middle, _mm256_mul_ps(weight, pair.m_middle)),
+					 _mm256_add_ps(result.m_last, _mm256_mul_ps(weight, pair.m_last)) };
+		}
+
+		inline JointPair scale_pair(const JointPair& pair, __m256 weight)
+		{
+			return { _mm256_mul_ps(weight, pair.m_first), _mm256_mul_ps(weight, pair.m_middle), _mm256_mul_ps(weight, pair.m_last) };
+		}
+
+
+		// t holds the parameter of each lane (it only differs between the joints when masking)
+		inline void lerp_pair(const JointTransform* pose0, const JointTransform* pose1, JointTransform* result, const JointPair& t)
+		{
+			JointPair pair0 = load_pair(pose0);
+			JointPair pair1 = align_pair(load_pair(pose1), pair0);
+
+			JointPair blended = { _mm256_add_ps(pair0.m_first, _mm256_mul_ps(t.m_first, _mm256_sub_ps(pair1.m_first, pair0.m_first))),
+								  _mm256_add_ps(pair0.m_middle, _mm256_mul_ps(t.m_middle, _mm256_sub_ps(pair1.m_middle, pair0.m_middle))),
+								  _mm256_add_ps(pair0.m_last, _mm256_mul_ps(t.m_last, _mm256_sub_ps(pair1.m_last, pair0.m_last))) };
+
+			store_pair(result, normalize_pair(blended));
+		}
+
+		inline void barycentric_pair(const JointTransform* pose0, const JointTransform* pose1, const JointTransform* pose2, JointTransform* result, __m256 a0, __m256 a1, __m256 a2)
+		{
+			JointPair pair0 = load_pair(pose0);
+			JointPair pair1 = align_pair(load_pair(pose1), pair0);
+			JointPair pair2 = align_pair(load_pair(pose2), pair0);
+
+			JointPair blended = scale_pair(pair0, a0);
+			blended = accumulate_pair(blended, pair1, a1);
+			blended = accumulate_pair(blended, pair2, a2);
+
+			store_pair(result, normalize_pair(blended));
+		}
+
+		inline void weighted_pair(const JointTransform* const* poses, const float* weights, unsigned poseCount, unsigned joint, JointTransform* result)
+		{
+			JointPair reference = load_pair(poses[0] + joint);
+			JointPair blended = scale_pair(reference, _mm256_set1_ps(weights[0]));
+
+			for (unsigned i = 1; i < poseCount; ++i)
+				blended = accumulate_pair(blended, align_pair(load_pair(poses[i] + joint), reference), _mm256_set1_ps(weights[i]));
+
+			store_pair(result, normalize_pair(blended));
+		}
+
+#endif
+	}
+
+
+	// Lerp positions and scales, and nlerp the rotations (taking the shortest path). t is in the range [0, 1]
+	void blend_joints_lerp(const JointTransform* pose0, const JointTransform* pose1, JointTransform* result, unsigned jointCount, float t)
+	{
+		unsigned joint = 0;
+
+#if defined(POSE_KERNELS_AVX2)
+		__m256 t8 = _mm256_set1_ps(t);
+		JointPair tPair = { t8, t8, t8 };
+		for (; joint + 1 < jointCount; joint += 2)
+			lerp_pair(pose0 + joint, pose1 + joint, result + joint, tPair);
+#endif
+
+#if defined(POSE_KERNELS_SSE)
+		__m128 param = _mm_set1_ps(t);
+#else
+		float param = t;
+#endif
+		for (; joint < jointCount; ++joint)
+			lerp_joint(pose0[joint], pose1[joint], result[joint], param);
+	}
+
+	// Same as blend_joints_lerp, but each joint has its own t (used to blend layers with per joint masks)
+	void blend_joints_lerp_masked(const JointTransform* pose0, const JointTransform* pose1, JointTransform* result, unsigned jointCount, const float* weights)
+	{
+		unsigned joint = 0;
+
+#if defined(POSE_KERNELS_AVX2)
+		for (; joint + 1 < jointCount; joint += 2)
+		{
+			__m256 t0 = _mm256_set1_ps(weights[joint]);
+			__m256 t1 = _mm256_set1_ps(weights[joint + 1]);
+			JointPair tPair = { t0, _mm256_blend_ps(t0, t1, 0xF0), t1 };
+			lerp_pair(pose0 + joint, pose1 + joint, result + joint, tPair);
+		}
+#endif
+
+		for (; joint < jointCount; ++joint)
+		{
+#if defined(POSE_KERNELS_SSE)
+			lerp_joint(pose0[joint], pose1[joint], result[joint], _mm_set1_ps(weights[joint]));
+#else
+			lerp_joint(pose0[joint], pose1[joint], result[joint], weights[joint]);
+#endif
+		}
+	}
+
+	// Weighted average of three poses using the given barycentric coordinates
+	void blend_joints_barycentric(const JointTransform* pose0, const JointTransform* pose1, const JointTransform* pose2,
+								  float a0, float a1, float a2, JointTransform* result, unsigned jointCount)
+	{
+		unsigned joint = 0;
+
+#if defined(POSE_KERNELS_AVX2)
+		__m256 a0x8 = _mm256_set1_ps(a0);
+		__m256 a1x8 = _mm256_set1_ps(a1);
+		__m256 a2x8 = _mm256_set1_ps(a2);
+		for (; joint + 1 < jointCount; joint += 2)
+			barycentric_pair(pose0 + joint, pose1 + joint, pose2 + joint, result + joint, a0x8, a1x8, a2x8);
+#endif
+
+#if defined(POSE_KERNELS_SSE)
+		__m128 w0 = _mm_set1_ps(a0);
+		__m128 w1 = _mm_set1_ps(a1);
+		__m128 w2 = _mm_set1_ps(a2);
+#else
+		float w0 = a0, w1 = a1, w2 = a2;
+#endif
+		for (; joint < jointCount; ++joint)
+			barycentric_joint(pose0[joint], pose1[joint], pose2[joint], result[joint], w0, w1, w2);
+	}
+
+	// Weighted average of any number of poses. The rotations are flipped to the hemisphere of the
+	// first pose before being accumulated, and normalized only once at the end.
+	void blend_joints_weighted(const JointTransform* const* poses, const float* weights, unsigned poseCount, JointTransform* result, unsigned jointCount)
+	{
+		if (poseCount == 0)
+			return;
+
+		unsigned joint = 0;
+
+#if defined(POSE_KERNELS_AVX2)
+		for (; joint + 1 < jointCount; joint += 2)
+			weighted_pair(poses, weights, poseCount, joint, result + joint);
+#endif
+
+		for (; joint < jointCount; ++joint)
+			weighted_joint(poses, weights, poseCount, joint, result[joint]);
+	}
+
+
+	// Name of the instruction set the kernels were compiled for
+	const char* get_pose_kernels_isa()
+	{
+#if defined(POSE_KERNELS_AVX2)
+		return "AVX2";
+#elif defined(POSE_KERNELS_SSE) && (defined(__SSE4_1__) || defined(__AVX__))
+		return "SSE4.1";
+#elif defined(POSE_KERNELS_SSE)
+		return "SSE2";
+#else
+		return "Scalar";
+#endif
+	}
+
+	// Time the kernels on random poses and print their throughput in joints per microsecond
+	void benchmark_pose_kernels(unsigned jointCount, unsigned iterations)
+	{
+		std::mt19937 generator(0);
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+		// Generate four random poses, both as flat arrays and as maps (for the previous blending functions)
+		const unsigned poseCount = 4;
+		std::vector<JointPose> poses(poseCount, JointPose(jointCount));
+		std::vector<AnimPose> mapPoses(poseCount);
+		for (unsigned i = 0; i < poseCount; ++i)
+		{
+			for (unsigned j = 0; j < jointCount; ++j)
+			{
+				TransformData transform;
+				transform.m_position = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+				transform.m_orientation = glm::normalize(glm::quat(distribution(generator), distribution(generator), distribution(generator), distribution(generator)));
+				transform.m_scale = glm::vec3(1.0f);
+				poses[i][j].set_transform(transform);
+				mapPoses[i][j] = std::make_pair(transform, (unsigned char)((int)TargetProperty::TRANSLATION | (int)TargetProperty::ROTATION | (int)TargetProperty::SCALE));
+			}
+		}
+
+		JointPose result(jointCount);
+		AnimPose mapResult;
+		const JointTransform* posePtrs[poseCount] = { poses[0].data(), poses[1].data(), poses[2].data(), poses[3].data() };
+		const float weights[poseCount] = { 0.4f, 0.3f, 0.2f, 0.1f };
+
+		// Returns the throughput of the given function in joints per microsecond
+		auto measure = [jointCount, iterations](const std::function<void(unsigned)>& kernel) -> double
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			for (unsigned i = 0; i < iterations; ++i)
+				kernel(i);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			double microseconds = std::chrono::duration<double, std::micro>(end - start).count();
+			return (double)jointCount * iterations / std::max(microseconds, 1e-3);
+		};
+
+		double lerp = measure([&](unsigned i) { blend_joints_lerp(posePtrs[0], posePtrs[1], result.data(), jointCount, (i % 100) * 0.01f); });
+		double barycentric = measure([&](unsigned) { blend_joints_barycentric(posePtrs[0], posePtrs[1], posePtrs[2], 0.5f, 0.3f, 0.2f, result.data(), jointCount); });
+		double weighted = measure([&](unsigned) { blend_joints_weighted(posePtrs, weights, poseCount, result.data(), jointCount); });
+		double mapLerp = measure([&](unsigned i) { blend_pose_lerp(mapPoses[0], mapPoses[1], mapResult, (i % 100) * 0.01f); });
+		double mapBarycentric = measure([&](unsigned) { blend_pose_barycentric(mapPoses[0], mapPoses[1], mapPoses[2], 0.5f, 0.3f, 0.2f, mapResult); });
+
+		std::cout << "Pose blend kernels (" << get_pose_kernels_isa() << ", " << jointCount << " joints, " << iterations << " iterations)\n";
+		std::cout << "  lerp/nlerp:          " << lerp << " joints/us (AnimPose version: " << mapLerp << ")\n";
+		std::cout << "  barycentric:         " << barycentric << " joints/us (AnimPose version: " << mapBarycentric << ")\n";
+		std::cout << "  weighted (4 poses):  " << weighted << " joints/us\n";
+		std::cout << "  checksum: " << result[0].m_orientation.x + mapResult[0].first.m_position.x << std::endl;
+	}
+}
\ No newline at end of file
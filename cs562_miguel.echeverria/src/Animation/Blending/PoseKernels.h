@@ -0,0 +1,54 @@
+/**
+* @file PoseKernels.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Kernels that blend whole poses stored as flat arrays of joints. They use
+*		 AVX2 or SSE when the compiler targets them, and plain glm otherwise.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+
+namespace cs460
+{
+	// Local transform of a joint, laid out so that each property is a single 16 byte load
+	struct alignas(16) JointTransform
+	{
+		glm::vec4 m_position{ 0.0f, 0.0f, 0.0f, 0.0f };
+		glm::vec4 m_orientation{ 0.0f, 0.0f, 0.0f, 1.0f };		// Quaternion stored as (x, y, z, w)
+		glm::vec4 m_scale{ 1.0f, 1.0f, 1.0f, 0.0f };
+
+		// Conversions from/to the transform data used by the scene nodes
+		void set_transform(const TransformData& transform);
+		glm::vec3 get_position() const;
+		glm::quat get_orientation() const;
+		glm::vec3 get_scale() const;
+	};
+
+	// A pose is just the transform of every joint, indexed by joint
+	using JointPose = std::vector<JointTransform>;
+
+
+	// Lerp positions and scales, and nlerp the rotations (taking the shortest path). t is in the range [0, 1]
+	void blend_joints_lerp(const JointTransform* pose0, const JointTransform* pose1, JointTransform* result, unsigned jointCount, float t);
+
+	// Same as blend_joints_lerp, but each joint has its own t (used to blend layers with per joint masks)
+	void blend_joints_lerp_masked(const JointTransform* pose0, const JointTransform* pose1, JointTransform* result, unsigned jointCount, const float* weights);
+
+	// Weighted average of three poses using the given barycentric coordinates
+	void blend_joints_barycentric(const JointTransform* pose0, const JointTransform* pose1, const JointTransform* pose2,
+								  float a0, float a1, float a2, JointTransform* result, unsigned jointCount);
+
+	// Weighted average of any number of poses. The rotations are flipped to the hemisphere of the
+	// first pose before being accumulated, and normalized only once at the end.
+	void blend_joints_weighted(const JointTransform* const* poses, const float* weights, unsigned poseCount, JointTransform* result, unsigned jointCount);
+
+
+	// Name of the instruction set the kernels were compiled for
+	const char* get_pose_kernels_isa();
+
+	// Time the kernels on random poses and print their throughput in joints per microsecond
+	void benchmark_pose_kernels(unsigned jointCount, unsigned iterations);
+}
\ No newline at end of file
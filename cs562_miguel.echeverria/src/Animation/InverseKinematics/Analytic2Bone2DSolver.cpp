@@ -39,8 +39,8 @@ namespace cs460
 			return m_status;
 		}
 
-		float endX = target->m_worldTr.m_position.x;
-		float endY = target->m_worldTr.m_position.y;
+		float endX = target->get_world_tr().m_position.x;
+		float endY = target->get_world_tr().m_position.y;
 		float d[2] = { 1.0f, 1.0f };
 
 		// Get the distances of the 2 bones (d array)
@@ -55,8 +55,8 @@ namespace cs460
 				return m_status;
 			}
 
-			const glm::vec3& pos = traverser->m_worldTr.m_position;
-			const glm::vec3& parentPos = traverser->get_parent()->m_worldTr.m_position;
+			const glm::vec3& pos = traverser->get_world_tr().m_position;
+			const glm::vec3& parentPos = traverser->get_parent()->get_world_tr().m_position;
 			const glm::vec2& boneVec = glm::vec2(pos) - glm::vec2(parentPos);
 
 			d[1 - i] = glm::length(boneVec);
@@ -108,8 +108,8 @@ namespace cs460
 		// Apply the computed local rotations
 		glm::quat localRot1(glm::vec3(0.0f, 0.0f, theta1));
 		glm::quat localRot2(glm::vec3(0.0f, 0.0f, theta2));
-		endEffector->get_parent()->m_localTr.m_orientation = localRot2;
-		chainRoot->m_localTr.m_orientation = localRot1;
+		endEffector->get_parent()->set_local_orientation(localRot2);
+		chainRoot->set_local_orientation(localRot1);
 
 		m_status = IKSolverStatus::SUCCESS;
 		return m_status;
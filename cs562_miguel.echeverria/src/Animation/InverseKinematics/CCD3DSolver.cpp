@@ -11,6 +11,7 @@
 #include "CCD3DSolver.h"
 #include "IKChain.h"
 #include "Composition/SceneNode.h"
+#include "Platform/FrameArena.h"
 #include "Graphics/Systems/DebugRenderer.h"
 #include "Math/Geometry/Geometry.h"
 #include <GL/glew.h>
@@ -44,7 +45,7 @@ namespace cs460
 
 
 		// Get the target world positions
-		const glm::vec3& targetWorldPos = target->m_worldTr.m_position;
+		const glm::vec3& targetWorldPos = target->get_world_tr().m_position;
 
 		// Process until a solution is found, or max iterations is reached
 		for (unsigned i = 0; i < m_maxIterations; ++i)
@@ -53,7 +54,7 @@ namespace cs460
 			SceneNode* traverser = endEffector->get_parent();
 			while (traverser != nullptr && traverser != chainRoot->get_parent())
 			{
-				const glm::vec3& endWorldPos = endEffector->m_worldTr.m_position;
+				const glm::vec3& endWorldPos = endEffector->get_world_tr().m_position;
 
 				// Do ccd and update the nodes' rotations
 				apply_local_rotation(traverser, endWorldPos, targetWorldPos);
@@ -63,7 +64,7 @@ namespace cs460
 			}
 
 			// Check if we found the solution, and if not repeat
-			if (check_solution(endEffector->m_worldTr.m_position, targetWorldPos))
+			if (check_solution(endEffector->get_world_tr().m_position, targetWorldPos))
 			{
 				m_status = IKSolverStatus::SUCCESS;
 				return m_status;
@@ -97,7 +98,7 @@ namespace cs460
 	{
 		// Get the vectors v1 = endEffector - curr; and v2 = target - curr
 		// (curr being the world position of the current joint)
-		const glm::vec3& currWorldPos = currNode->m_worldTr.m_position;
+		const glm::vec3& currWorldPos = currNode->get_world_tr().m_position;
 		const glm::vec3& v1 = endWorldPos - currWorldPos;
 		const glm::vec3& v2 = targetWorldPos - currWorldPos;
 
@@ -118,7 +119,7 @@ namespace cs460
 		// Build a quaternion from the axis angle rotation we just computed
 		// This rotation is applied to the joint's local orientation
 		glm::quat rot = glm::angleAxis(theta, axis);
-		currNode->m_localTr.m_orientation = rot * currNode->m_localTr.m_orientation;
+		currNode->set_local_orientation(rot * currNode->get_local_tr().m_orientation);
 	}
 
 
@@ -126,7 +127,7 @@ namespace cs460
 	void CCD3DSolver::update_world_transforms(SceneNode* start, SceneNode* endEffector)
 	{
 		// Store all the nodes that we need to update (do so from end effector until start)
-		std::list<SceneNode*> nodes;
+		FrameList<SceneNode*> nodes;
 
 		// Any siblings that are not part of the ik chain will be updated with the regular scene update
 
@@ -145,11 +146,11 @@ namespace cs460
 		for (SceneNode* currNode : nodes)
 		{
 			if (currNode->get_parent())
-				currNode->m_worldTr.concatenate(currNode->m_localTr, currNode->get_parent()->m_worldTr);
+				currNode->modify_world_tr().concatenate(currNode->get_local_tr(), currNode->get_parent()->get_world_tr());
 			else
-				currNode->m_worldTr = currNode->m_localTr;
+				currNode->modify_world_tr() = currNode->get_local_tr();
 
-			//currNode->m_updateWorldTr = false;
+			//currNode->skip_world_tr_update();
 		}
 	}
 
@@ -42,12 +42,12 @@ namespace cs460
 
 
 		// Get the target world position and the original chain root world position
-		const glm::vec3& targetWorldPos = target->m_worldTr.m_position;
-		glm::vec3 originalRootWorldPos = chainRoot->m_worldTr.m_position;
+		const glm::vec3& targetWorldPos = target->get_world_tr().m_position;
+		glm::vec3 originalRootWorldPos = chainRoot->get_world_tr().m_position;
 
 		// Store the all the bone lengths as well as the original joints world positions
-		std::vector<float> boneLengths;
-		std::vector<glm::vec3> worldPositions;
+		FrameVector<float> boneLengths;
+		FrameVector<glm::vec3> worldPositions;
 		store_bone_lengths(chainRoot, endEffector, boneLengths);
 		store_world_positions(chainRoot, endEffector, worldPositions);
 
@@ -86,25 +86,25 @@ namespace cs460
 	}
 
 
-	void FABRIK3DSolver::store_world_positions(SceneNode* chainRoot, SceneNode* endEffector, std::vector<glm::vec3>& jointsWorldPos)
+	void FABRIK3DSolver::store_world_positions(SceneNode* chainRoot, SceneNode* endEffector, FrameVector<glm::vec3>& jointsWorldPos)
 	{
 		// Add in reverser order, start-end of vector is: end effector until chain root
 		SceneNode* traverser = endEffector;
 		while (traverser != nullptr && traverser != chainRoot->get_parent())
 		{
-			jointsWorldPos.push_back(traverser->m_worldTr.m_position);
+			jointsWorldPos.push_back(traverser->get_world_tr().m_position);
 			traverser = traverser->get_parent();
 		}
 	}
 
-	void FABRIK3DSolver::store_bone_lengths(SceneNode* chainRoot, SceneNode* endEffector, std::vector<float>& boneLengths)
+	void FABRIK3DSolver::store_bone_lengths(SceneNode* chainRoot, SceneNode* endEffector, FrameVector<float>& boneLengths)
 	{
 		// Add in reverser order, start-end of vector is: end effector until chain root
 		SceneNode* traverser = endEffector;
 		while (traverser != nullptr && traverser != chainRoot)
 		{
 			SceneNode* parent = traverser->get_parent();
-			glm::vec3 boneVec = traverser->m_worldTr.m_position - parent->m_worldTr.m_position;
+			glm::vec3 boneVec = traverser->get_world_tr().m_position - parent->get_world_tr().m_position;
 			float boneLength = glm::length(boneVec);
 			boneLengths.push_back(boneLength);
 			traverser = traverser->get_parent();
@@ -112,7 +112,7 @@ namespace cs460
 	}
 
 
-	void FABRIK3DSolver::forward_step(std::vector<glm::vec3>& worldPositions, const glm::vec3& targetWorldPos, const std::vector<float>& boneLengths)
+	void FABRIK3DSolver::forward_step(FrameVector<glm::vec3>& worldPositions, const glm::vec3& targetWorldPos, const FrameVector<float>& boneLengths)
 	{
 		// Set the end effector to the target world position
 		worldPositions[0] = targetWorldPos;
@@ -135,7 +135,7 @@ namespace cs460
 	}
 
 
-	void FABRIK3DSolver::backward_step(std::vector<glm::vec3>& worldPositions, const std::vector<float>& boneLengths, const glm::vec3& originalRootWorldPos)
+	void FABRIK3DSolver::backward_step(FrameVector<glm::vec3>& worldPositions, const FrameVector<float>& boneLengths, const glm::vec3& originalRootWorldPos)
 	{
 		// Set the chain root to its original world position
 		worldPositions[worldPositions.size() - 1] = originalRootWorldPos;
@@ -157,7 +157,7 @@ namespace cs460
 
 
 	// Store the ik chain hierarchy of nodes in the given list
-	void FABRIK3DSolver::store_chain_nodes(SceneNode* start, SceneNode* end, std::list<SceneNode*>& nodes)
+	void FABRIK3DSolver::store_chain_nodes(SceneNode* start, SceneNode* end, FrameList<SceneNode*>& nodes)
 	{
 		// Get the chain of nodes in the natural order: From chain root to end effector
 		SceneNode* traverser = end;
@@ -181,10 +181,10 @@ namespace cs460
 	}
 
 
-	void FABRIK3DSolver::update_local_rotations(SceneNode* chainRoot, SceneNode* endEffector, const std::vector<glm::vec3>& solutionWorldPos)
+	void FABRIK3DSolver::update_local_rotations(SceneNode* chainRoot, SceneNode* endEffector, const FrameVector<glm::vec3>& solutionWorldPos)
 	{
 		// Get the chain of nodes in the natural order
-		std::list<SceneNode*> chainNodes;
+		FrameList<SceneNode*> chainNodes;
 		store_chain_nodes(chainRoot, endEffector, chainNodes);
 
 		// For each joint from the chain root until the end effector (not included)
@@ -194,8 +194,8 @@ namespace cs460
 		{
 			// Get the current joint and its children world positions
 			auto childIt = std::next(it);
-			const glm::vec3& worldPos = (*it)->m_worldTr.m_position;
-			const glm::vec3& worldChildPos = (*childIt)->m_worldTr.m_position;
+			const glm::vec3& worldPos = (*it)->get_world_tr().m_position;
+			const glm::vec3& worldChildPos = (*childIt)->get_world_tr().m_position;
 
 
 			// Get the axis angle rotation needed in world
@@ -211,7 +211,7 @@ namespace cs460
 
 			// Apply the rotation in world space
 			glm::quat rot = glm::angleAxis(angle, axis);
-			(*it)->m_worldTr.m_orientation = rot * (*it)->m_worldTr.m_orientation;
+			(*it)->modify_world_tr().m_orientation = rot * (*it)->get_world_tr().m_orientation;
 
 
 			// Update the world transforms of the original chain joints
@@ -221,11 +221,11 @@ namespace cs460
 			// Perform inverse concatenation of orientations to get the local orientation needed
 			if ((*it)->get_parent())
 			{
-				glm::quat invParentRot = glm::inverse((*it)->get_parent()->m_worldTr.m_orientation);
-				(*it)->m_localTr.m_orientation = invParentRot * (*it)->m_worldTr.m_orientation;
+				glm::quat invParentRot = glm::inverse((*it)->get_parent()->get_world_tr().m_orientation);
+				(*it)->set_local_orientation(invParentRot * (*it)->get_world_tr().m_orientation);
 			}
 			else
-				(*it)->m_localTr.m_orientation = (*it)->m_worldTr.m_orientation;
+				(*it)->set_local_orientation((*it)->get_world_tr().m_orientation);
 		}
 	}
 
@@ -233,11 +233,11 @@ namespace cs460
 	void FABRIK3DSolver::update_chain_world(SceneNode* start, SceneNode* endEffector)
 	{
 		// Store the nodes from start to endEffector (inclusive), in that order, in a list
-		std::list<SceneNode*> nodes;
+		FrameList<SceneNode*> nodes;
 		store_chain_nodes(start, endEffector, nodes);
 
 		// For each node in the hierarchy, update its world transform
 		for (SceneNode* currNode : nodes)
-			currNode->m_worldTr.concatenate(currNode->m_localTr, currNode->get_parent()->m_worldTr);
+			currNode->modify_world_tr().concatenate(currNode->get_local_tr(), currNode->get_parent()->get_world_tr());
 	}
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "IKSolver.h"
+#include "Platform/FrameArena.h"
 
 
 namespace cs460
@@ -34,19 +35,19 @@ namespace cs460
 
 	private:
 
-		void store_world_positions(SceneNode* chainRoot, SceneNode* endEffector, std::vector<glm::vec3>& jointsWorldPos);
-		void store_bone_lengths(SceneNode* chainRoot, SceneNode* endEffector, std::vector<float>& boneLengths);
+		void store_world_positions(SceneNode* chainRoot, SceneNode* endEffector, FrameVector<glm::vec3>& jointsWorldPos);
+		void store_bone_lengths(SceneNode* chainRoot, SceneNode* endEffector, FrameVector<float>& boneLengths);
 
-		void forward_step(std::vector<glm::vec3>& worldPositions, const glm::vec3& targetWorldPos, const std::vector<float>& boneLengths);
+		void forward_step(FrameVector<glm::vec3>& worldPositions, const glm::vec3& targetWorldPos, const FrameVector<float>& boneLengths);
 
-		void backward_step(std::vector<glm::vec3>& worldPositions, const std::vector<float>& boneLengths, const glm::vec3& originalRootWorldPos);
+		void backward_step(FrameVector<glm::vec3>& worldPositions, const FrameVector<float>& boneLengths, const glm::vec3& originalRootWorldPos);
 
 		// Store the ik chain hierarchy of nodes in the given list
-		void store_chain_nodes(SceneNode* start, SceneNode* end, std::list<SceneNode*>& nodes);
+		void store_chain_nodes(SceneNode* start, SceneNode* end, FrameList<SceneNode*>& nodes);
 
 		bool check_solution(const glm::vec3& endEffectorWorldPos, const glm::vec3& targetWorldPos);
 
-		void update_local_rotations(SceneNode* chainRoot, SceneNode* endEffector, const std::vector<glm::vec3>& solutionWorldPos);
+		void update_local_rotations(SceneNode* chainRoot, SceneNode* endEffector, const FrameVector<glm::vec3>& solutionWorldPos);
 
 		void update_chain_world(SceneNode* start, SceneNode* endEffector);
 	};
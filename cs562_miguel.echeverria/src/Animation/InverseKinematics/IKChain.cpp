@@ -58,7 +58,7 @@ namespace cs460
 	void IKChain::push_joint()
 	{
 		SceneNode* newEndEffector = m_endEffector->create_child("Pushed Joint");
-		newEndEffector->m_localTr.m_position = m_endEffector->m_localTr.m_position;
+		newEndEffector->set_local_position(m_endEffector->get_local_tr().m_position);
 		set_end_effector(newEndEffector);
 	}
 
@@ -10,6 +10,7 @@
 #include "pch.h"
 #include "ClothMgr.h"
 #include "Components/Particles/Cloth.h"
+#include "Graphics/Rendering/RenderView.h"
 
 
 namespace cs460
@@ -43,27 +44,38 @@ namespace cs460
 			cloth->debug_draw();
 	}
 
-	// Draws all the cloths with a texture
-	void ClothMgr::draw_textured()
+	// Copy the strips of all the cloths into the render view
+	void ClothMgr::extract_render_data(RenderView& view)
 	{
 		for (Cloth* cloth : m_cloths)
-			cloth->draw_textured();
+			cloth->extract_render_data(view);
+	}
+
+	// Records the commands that draw the cloths of the render view with a texture (skipping the ones deleted since it was extracted)
+	void ClothMgr::record_draw(RenderView& view)
+	{
+		if (view.m_cloths.empty())
+			return;
+
+		// Both sides of the cloths are visible
+		view.m_clothCommands.set_state(RenderState::CULL_FACE, false);
+		for (const RenderClothItem& item : view.m_cloths)
+		{
+			if (Cloth* cloth = m_cloths.get(item.m_cloth))
+				cloth->record_draw(view, item, view.m_clothCommands);
+		}
+		view.m_clothCommands.set_state(RenderState::CULL_FACE, true);
 	}
 
 
 	void ClothMgr::add_cloth(Cloth* cloth)
 	{
-		m_cloths.push_back(cloth);
+		cloth->set_registry_handle(m_cloths.add(cloth));
 	}
 
 	void ClothMgr::remove_cloth(Cloth* cloth)
 	{
-		auto foundIt = std::find(m_cloths.begin(), m_cloths.end(), cloth);
-
-		// Nothing to remove if not in the vector
-		if (foundIt == m_cloths.end())
-			return;
-
-		m_cloths.erase(foundIt);
+		m_cloths.remove(cloth->get_registry_handle());
+		cloth->set_registry_handle(RegistryHandle());
 	}
 }
\ No newline at end of file
@@ -9,10 +9,13 @@
 
 #pragma once
 
+#include "Composition/ComponentRegistry.h"
+
 
 namespace cs460
 {
 	class Cloth;
+	struct RenderView;
 
 
 	class ClothMgr
@@ -24,13 +27,15 @@ namespace cs460
 
 		void update();			// Updates all the cloth components in order
 		void debug_draw();		// Uses debug drawing to render each cloth
-		void draw_textured();	// Draws all the cloths with a texture
+
+		void extract_render_data(RenderView& view);		// Copy the strips of all the cloths into the render view
+		void record_draw(RenderView& view);				// Records the commands that draw the cloths of the render view with a texture
 
 		void add_cloth(Cloth* cloth);
 		void remove_cloth(Cloth* cloth);
 
 	private:
-		std::vector<Cloth*> m_cloths;
+		ComponentRegistry<Cloth> m_cloths;
 
 		ClothMgr();
 		ClothMgr(const ClothMgr&) = delete;
@@ -93,8 +93,8 @@ namespace cs460
 				// Assemble the bounding volume of the point
 				AABB pointBv;
 				float halfSize = 0.5f * DebugRenderer::s_curvePointSize;
-				pointBv.m_min = curvePoint->get_owner()->m_worldTr.m_position - glm::vec3(halfSize, halfSize, halfSize);
-				pointBv.m_max = curvePoint->get_owner()->m_worldTr.m_position + glm::vec3(halfSize, halfSize, halfSize);
+				pointBv.m_min = curvePoint->get_owner()->get_world_tr().m_position - glm::vec3(halfSize, halfSize, halfSize);
+				pointBv.m_max = curvePoint->get_owner()->get_world_tr().m_position + glm::vec3(halfSize, halfSize, halfSize);
 
 				// Check the ray against the bv of the current point
 				float pointTime = ray_vs_aabb(ray, pointBv);
@@ -119,8 +119,8 @@ namespace cs460
 						// Assemble the bounding volume of the tangent
 						AABB tangentBv;
 						float halfSize = 0.5f * DebugRenderer::s_tangentEndpointSize;
-						tangentBv.m_min = childNode2->m_worldTr.m_position - glm::vec3(halfSize, halfSize, halfSize);
-						tangentBv.m_max = childNode2->m_worldTr.m_position + glm::vec3(halfSize, halfSize, halfSize);
+						tangentBv.m_min = childNode2->get_world_tr().m_position - glm::vec3(halfSize, halfSize, halfSize);
+						tangentBv.m_max = childNode2->get_world_tr().m_position + glm::vec3(halfSize, halfSize, halfSize);
 
 						// Check the ray against the bv of the current tangent endpoint
 						float tangentTime = ray_vs_aabb(ray, tangentBv);
@@ -138,8 +138,8 @@ namespace cs460
 						// Assemble the bounding volume of the control point
 						AABB controlPointBv;
 						float halfSize = 0.5f * DebugRenderer::s_tangentEndpointSize;
-						controlPointBv.m_min = childNode2->m_worldTr.m_position - glm::vec3(halfSize, halfSize, halfSize);
-						controlPointBv.m_max = childNode2->m_worldTr.m_position + glm::vec3(halfSize, halfSize, halfSize);
+						controlPointBv.m_min = childNode2->get_world_tr().m_position - glm::vec3(halfSize, halfSize, halfSize);
+						controlPointBv.m_max = childNode2->get_world_tr().m_position + glm::vec3(halfSize, halfSize, halfSize);
 
 						// Check the ray against the bv of the current control point
 						float controlPointTime = ray_vs_aabb(ray, controlPointBv);
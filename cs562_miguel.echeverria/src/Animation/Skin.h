@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "Animation/Skinning/JointPalette.h"
+
 namespace tinygltf
 {
 	class Model;
@@ -24,7 +26,7 @@ namespace cs460
 
 
 		std::string m_name;
-		std::vector<glm::mat4> m_invBindMatrices;
+		std::vector<AffineTransform> m_invBindMatrices;
 		std::vector<int> m_joints;
 		int m_commonRootIdx = 0;
 
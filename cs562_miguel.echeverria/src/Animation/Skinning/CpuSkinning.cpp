@@ -0,0 +1,406 @@
+/**
+* @file CpuSkinning.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Linear blend skinning of whole primitives on the cpu. The vertices are split
+*		 in ranges processed by the job system, and each range uses AVX2 or SSE
+*		 when the compiler targets them, and plain glm otherwise.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "CpuSkinning.h"
+#include "Platform/JobSystem.h"
+#include <chrono>
+
+// Define CPU_SKINNING_SCALAR to force the glm version of the kernel.
+// SSE2 is always available in x64, AVX2 is used when compiling with /arch:AVX2 (-mavx2).
+#if !defined(CPU_SKINNING_SCALAR)
+	#if defined(__AVX2__)
+		#define CPU_SKINNING_AVX2
+		#define CPU_SKINNING_SSE
+	#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define CPU_SKINNING_SSE
+	#endif
+#endif
+
+#if defined(CPU_SKINNING_SSE)
+	#include <immintrin.h>
+#endif
+
+
+namespace cs460
+{
+	// Number of vertices processed by each job
+	static const unsigned s_verticesPerJob = 1024;
+
+
+	namespace
+	{
+		inline void store_vec3(glm::vec3& result, const float* data)
+		{
+			result.x = data[0];
+			result.y = data[1];
+			result.z = data[2];
+		}
+
+#if defined(CPU_SKINNING_SSE)
+
+		// Weighted sum of the rows of the joint matrices of a vertex (only the first ones if it has less influences)
+		template <int Influences>
+		inline void blend_rows_sse(const AffineTransform* palette, const glm::u16vec4& joints, const glm::vec4& weights, __m128 rows[3])
+		{
+			const AffineTransform& joint0 = palette[joints.x];
+			if (Influences == 1)
+			{
+				// The weight is always 1 after the preprocessing
+				for (int r = 0; r < 3; ++r)
+					rows[r] = _mm_load_ps(&joint0.m_rows[r].x);
+				return;
+			}
+
+			__m128 allWeights = _mm_loadu_ps(&weights.x);
+			__m128 w0 = _mm_shuffle_ps(allWeights, allWeights, _MM_SHUFFLE(0, 0, 0, 0));
+			__m128 w1 = _mm_shuffle_ps(allWeights, allWeights, _MM_SHUFFLE(1, 1, 1, 1));
+			const AffineTransform& joint1 = palette[joints.y];
+			if (Influences == 2)
+			{
+				for (int r = 0; r < 3; ++r)
+					rows[r] = _mm_add_ps(_mm_mul_ps(w0, _mm_load_ps(&joint0.m_rows[r].x)), _mm_mul_ps(w1, _mm_load_ps(&joint1.m_rows[r].x)));
+				return;
+			}
+
+			__m128 w2 = _mm_shuffle_ps(allWeights, allWeights, _MM_SHUFFLE(2, 2, 2, 2));
+			__m128 w3 = _mm_shuffle_ps(allWeights, allWeights, _MM_SHUFFLE(3, 3, 3, 3));
+			const AffineTransform& joint2 = palette[joints.z];
+			const AffineTransform& joint3 = palette[joints.w];
+
+			for (int r = 0; r < 3; ++r)
+			{
+				__m128 row = _mm_mul_ps(w0, _mm_load_ps(&joint0.m_rows[r].x));
+				row = _mm_add_ps(row, _mm_mul_ps(w1, _mm_load_ps(&joint1.m_rows[r].x)));
+				row = _mm_add_ps(row, _mm_mul_ps(w2, _mm_load_ps(&joint2.m_rows[r].x)));
+				rows[r] = _mm_add_ps(row, _mm_mul_ps(w3, _mm_load_ps(&joint3.m_rows[r].x)));
+			}
+		}
+
+		// Turn the three rows (plus the implicit 0, 0, 0, 1) into the four columns of the matrix
+		inline void rows_to_columns_sse(const __m128 rows[3], __m128 columns[4])
+		{
+			const __m128 lastRow = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+			__m128 t0 = _mm_unpacklo_ps(rows[0], rows[1]);		// r0x r1x r0y r1y
+			__m128 t1 = _mm_unpackhi_ps(rows[0], rows[1]);		// r0z r1z r0w r1w
+			__m128 t2 = _mm_unpacklo_ps(rows[2], lastRow);		// r2x 0 r2y 0
+			__m128 t3 = _mm_unpackhi_ps(rows[2], lastRow);		// r2z 0 r2w 1
+			columns[0] = _mm_movelh_ps(t0, t2);
+			columns[1] = _mm_movehl_ps(t2, t0);
+			columns[2] = _mm_movelh_ps(t1, t3);
+			columns[3] = _mm_movehl_ps(t3, t1);
+		}
+
+		// Normalize the xyz of the vector (w has to be 0)
+		inline __m128 normalize_sse(__m128 v)
+		{
+			__m128 squared = _mm_mul_ps(v, v);
+			__m128 sum = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 3, 0, 1)));
+			sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+			return _mm_div_ps(v, _mm_sqrt_ps(sum));
+		}
+
+		// The vertices are [begin, end) of order, or directly [begin, end) if there is no order
+		template <int Influences>
+		void skin_range_sse(const AffineTransform* palette, const SkinnedVertices& vertices, const unsigned* order, unsigned begin, unsigned end,
+							glm::vec3* positions, glm::vec3* normals)
+		{
+			alignas(16) float result[4];
+			__m128 rows[3];
+			__m128 columns[4];
+			for (unsigned v = begin; v < end; ++v)
+			{
+				unsigned i = order ? order[v] : v;
+				blend_rows_sse<Influences>(palette, vertices.m_joints[i], vertices.m_weights[i], rows);
+				rows_to_columns_sse(rows, columns);
+
+				const glm::vec3& pos = vertices.m_positions[i];
+				__m128 skinned = _mm_add_ps(_mm_mul_ps(columns[0], _mm_set1_ps(pos.x)), columns[3]);
+				skinned = _mm_add_ps(skinned, _mm_mul_ps(columns[1], _mm_set1_ps(pos.y)));
+				skinned = _mm_add_ps(skinned, _mm_mul_ps(columns[2], _mm_set1_ps(pos.z)));
+				_mm_store_ps(result, skinned);
+				store_vec3(positions[i], result);
+
+				if (normals)
+				{
+					const glm::vec3& normal = vertices.m_normals[i];
+					skinned = _mm_mul_ps(columns[0], _mm_set1_ps(normal.x));
+					skinned = _mm_add_ps(skinned, _mm_mul_ps(columns[1], _mm_set1_ps(normal.y)));
+					skinned = _mm_add_ps(skinned, _mm_mul_ps(columns[2], _mm_set1_ps(normal.z)));
+					_mm_store_ps(result, normalize_sse(skinned));
+					store_vec3(normals[i], result);
+				}
+			}
+		}
+
+#endif
+
+
+#if defined(CPU_SKINNING_AVX2)
+
+		// Two vertices at a time, one in each 128 bit lane. The shuffles and unpacks work
+		// within each lane, so the steps are the same as in the sse version.
+		inline __m256 broadcast_pair(float low, float high)
+		{
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(low)), _mm_set1_ps(high), 1);
+		}
+
+		inline __m256 load_pair(const glm::vec4& low, const glm::vec4& high)
+		{
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(&low.x)), _mm_load_ps(&high.x), 1);
+		}
+
+		inline __m256 multiply_add(__m256 a, __m256 b, __m256 c)
+		{
+#if defined(__FMA__)
+			return _mm256_fmadd_ps(a, b, c);
+#else
+			return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+		}
+
+		template <int Influences>
+		void skin_range_avx2(const AffineTransform* palette, const SkinnedVertices& vertices, const unsigned* order, unsigned begin, unsigned end,
+							 glm::vec3* positions, glm::vec3* normals)
+		{
+			const __m256 lastRow = _mm256_setr_ps(0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+			alignas(32) float result[8];
+
+			unsigned v = begin;
+			for (; v + 1 < end; v += 2)
+			{
+				unsigned i0 = order ? order[v] : v;
+				unsigned i1 = order ? order[v + 1] : v + 1;
+				const glm::u16vec4& joints0 = vertices.m_joints[i0];
+				const glm::u16vec4& joints1 = vertices.m_joints[i1];
+				const glm::vec4& weights0 = vertices.m_weights[i0];
+				const glm::vec4& weights1 = vertices.m_weights[i1];
+
+				// With a single influence the weight is always 1
+				__m256 rows[3];
+				for (int r = 0; r < 3; ++r)
+					rows[r] = load_pair(palette[joints0.x].m_rows[r], palette[joints1.x].m_rows[r]);
+				if (Influences > 1)
+				{
+					__m256 weight = broadcast_pair(weights0.x, weights1.x);
+					for (int r = 0; r < 3; ++r)
+						rows[r] = _mm256_mul_ps(weight, rows[r]);
+				}
+
+				for (int k = 1; k < Influences; ++k)
+				{
+					__m256 weight = broadcast_pair(weights0[k], weights1[k]);
+					const AffineTransform& joint0 = palette[joints0[k]];
+					const AffineTransform& joint1 = palette[joints1[k]];
+					for (int r = 0; r < 3; ++r)
+						rows[r] = multiply_add(weight, load_pair(joint0.m_rows[r], joint1.m_rows[r]), rows[r]);
+				}
+
+				__m256 t0 = _mm256_unpacklo_ps(rows[0], rows[1]);
+				__m256 t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+				__m256 t2 = _mm256_unpacklo_ps(rows[2], lastRow);
+				__m256 t3 = _mm256_unpackhi_ps(rows[2], lastRow);
+				__m256 column0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+				__m256 column1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+				__m256 column2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+				__m256 column3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+				const glm::vec3& pos0 = vertices.m_positions[i0];
+				const glm::vec3& pos1 = vertices.m_positions[i1];
+				__m256 skinned = multiply_add(column0, broadcast_pair(pos0.x, pos1.x), column3);
+				skinned = multiply_add(column1, broadcast_pair(pos0.y, pos1.y), skinned);
+				skinned = multiply_add(column2, broadcast_pair(pos0.z, pos1.z), skinned);
+				_mm256_store_ps(result, skinned);
+				store_vec3(positions[i0], result);
+				store_vec3(positions[i1], result + 4);
+
+				if (normals)
+				{
+					const glm::vec3& normal0 = vertices.m_normals[i0];
+					const glm::vec3& normal1 = vertices.m_normals[i1];
+					skinned = _mm256_mul_ps(column0, broadcast_pair(normal0.x, normal1.x));
+					skinned = multiply_add(column1, broadcast_pair(normal0.y, normal1.y), skinned);
+					skinned = multiply_add(column2, broadcast_pair(normal0.z, normal1.z), skinned);
+					skinned = _mm256_div_ps(skinned, _mm256_sqrt_ps(_mm256_dp_ps(skinned, skinned, 0x7F)));
+					_mm256_store_ps(result, skinned);
+					store_vec3(normals[i0], result);
+					store_vec3(normals[i1], result + 4);
+				}
+			}
+
+			// Odd vertex at the end
+			if (v < end)
+				skin_range_sse<Influences>(palette, vertices, order, v, end, positions, normals);
+		}
+
+#endif
+
+		template <int Influences>
+		void skin_range_scalar(const AffineTransform* palette, const SkinnedVertices& vertices, const unsigned* order, unsigned begin, unsigned end,
+							   glm::vec3* positions, glm::vec3* normals)
+		{
+			for (unsigned v = begin; v < end; ++v)
+			{
+				unsigned i = order ? order[v] : v;
+				const glm::u16vec4& joints = vertices.m_joints[i];
+				const glm::vec4& weights = vertices.m_weights[i];
+
+				glm::vec4 rows[3];
+				for (int r = 0; r < 3; ++r)
+				{
+					rows[r] = Influences == 1 ? palette[joints.x].m_rows[r] : palette[joints.x].m_rows[r] * weights.x;
+					for (int k = 1; k < Influences; ++k)
+						rows[r] += palette[joints[k]].m_rows[r] * weights[k];
+				}
+
+				glm::vec4 pos(vertices.m_positions[i], 1.0f);
+				positions[i] = glm::vec3(glm::dot(rows[0], pos), glm::dot(rows[1], pos), glm::dot(rows[2], pos));
+
+				if (normals)
+				{
+					glm::vec4 normal(vertices.m_normals[i], 0.0f);
+					normals[i] = glm::normalize(glm::vec3(glm::dot(rows[0], normal), glm::dot(rows[1], normal), glm::dot(rows[2], normal)));
+				}
+			}
+		}
+
+		template <int Influences>
+		void skin_range(const AffineTransform* palette, const SkinnedVertices& vertices, const unsigned* order, unsigned begin, unsigned end,
+						glm::vec3* positions, glm::vec3* normals)
+		{
+#if defined(CPU_SKINNING_AVX2)
+			skin_range_avx2<Influences>(palette, vertices, order, begin, end, positions, normals);
+#elif defined(CPU_SKINNING_SSE)
+			skin_range_sse<Influences>(palette, vertices, order, begin, end, positions, normals);
+#else
+			skin_range_scalar<Influences>(palette, vertices, order, begin, end, positions, normals);
+#endif
+		}
+	}
+
+
+	// Deform the vertices [begin, end) with the given palette. The normals are only written if the vertices have them.
+	void skin_vertices_range(const AffineTransform* palette, const SkinnedVertices& vertices, unsigned begin, unsigned end,
+							 glm::vec3* positions, glm::vec3* normals)
+	{
+		if (vertices.m_normals.empty())
+			normals = nullptr;
+
+		skin_range<4>(palette, vertices, nullptr, begin, end, positions, normals);
+	}
+
+	// Same, but for the vertices [begin, end) of the influence order, each group with the kernel for its influence count
+	void skin_vertices_grouped(const AffineTransform* palette, const SkinnedVertices& vertices, unsigned begin, unsigned end,
+							   glm::vec3* positions, glm::vec3* normals)
+	{
+		if (vertices.m_normals.empty())
+			normals = nullptr;
+
+		const unsigned* order = vertices.m_influenceOrder.data();
+		const unsigned* groupEnds = vertices.m_influenceGroupEnds;
+		if (begin < groupEnds[0])
+			skin_range<1>(palette, vertices, order, begin, glm::min(end, groupEnds[0]), positions, normals);
+		if (begin < groupEnds[1] && end > groupEnds[0])
+			skin_range<2>(palette, vertices, order, glm::max(begin, groupEnds[0]), glm::min(end, groupEnds[1]), positions, normals);
+		if (begin < groupEnds[2] && end > groupEnds[1])
+			skin_range<4>(palette, vertices, order, glm::max(begin, groupEnds[1]), glm::min(end, groupEnds[2]), positions, normals);
+	}
+
+	// Deform all the vertices (by influence count if the weights were prepared), split in ranges among the threads of the job system if parallel is set
+	void skin_vertices(const AffineTransform* palette, const SkinnedVertices& vertices, DeformedVertices& result, bool parallel)
+	{
+		unsigned count = vertices.get_vertex_count();
+		result.m_positions.resize(count);
+		result.m_normals.resize(count);
+
+		// Use the cheaper kernels if the vertices were grouped by influence count
+		bool grouped = !vertices.m_influenceOrder.empty();
+		auto skinRange = [&](unsigned begin, unsigned end)
+		{
+			if (grouped)
+				skin_vertices_grouped(palette, vertices, begin, end, result.m_positions.data(), result.m_normals.data());
+			else
+				skin_vertices_range(palette, vertices, begin, end, result.m_positions.data(), result.m_normals.data());
+		};
+
+		if (parallel)
+			JobSystem::get_instance().parallel_for(count, s_verticesPerJob, skinRange);
+		else
+			skinRange(0, count);
+	}
+
+
+	// Name of the instruction set the kernel was compiled for
+	const char* get_cpu_skinning_isa()
+	{
+#if defined(CPU_SKINNING_AVX2)
+		return "AVX2";
+#elif defined(CPU_SKINNING_SSE)
+		return "SSE";
+#else
+		return "Scalar";
+#endif
+	}
+
+
+	// Time the reference implementation, the kernel evaluating 4 influences, the kernels for each influence count and
+	// the threaded version on the given vertices, and print their throughput in vertices per microsecond
+	void benchmark_cpu_skinning(const AffineTransform* palette, const SkinnedVertices& vertices, unsigned iterations)
+	{
+		unsigned count = vertices.get_vertex_count();
+		iterations = glm::max(iterations, 1u);
+		if (count == 0)
+			return;
+
+		std::vector<glm::vec3> referencePositions(count);
+		std::vector<glm::vec3> referenceNormals(count);
+		DeformedVertices result;
+		result.m_positions.resize(count);
+		result.m_normals.resize(count);
+
+		// Returns the vertices per microsecond of the given function
+		auto measure = [count, iterations](const std::function<void()>& kernel) -> double
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			for (unsigned i = 0; i < iterations; ++i)
+				kernel();
+			auto end = std::chrono::high_resolution_clock::now();
+
+			return (double)count * iterations / std::chrono::duration<double, std::micro>(end - start).count();
+		};
+
+		glm::vec3* normals = vertices.m_normals.empty() ? nullptr : referenceNormals.data();
+		double scalarRate = measure([&]() { skin_range_scalar<4>(palette, vertices, nullptr, 0, count, referencePositions.data(), normals); });
+		double fourInfluencesRate = measure([&]() { skin_vertices_range(palette, vertices, 0, count, result.m_positions.data(), result.m_normals.data()); });
+		double kernelRate = measure([&]() { skin_vertices(palette, vertices, result, false); });
+		double parallelRate = measure([&]() { skin_vertices(palette, vertices, result, true); });
+
+		// The kernel has to give the same vertices as the reference
+		float maxError = 0.0f;
+		for (unsigned i = 0; i < count; ++i)
+		{
+			maxError = glm::max(maxError, glm::length(result.m_positions[i] - referencePositions[i]));
+			if (normals)
+				maxError = glm::max(maxError, glm::length(result.m_normals[i] - referenceNormals[i]));
+		}
+
+		std::cout << "  " << count << " vertices: scalar " << scalarRate << ", " << get_cpu_skinning_isa() << " 4 influences " << fourInfluencesRate
+			<< " (" << fourInfluencesRate / scalarRate << "x), by influence count " << kernelRate << " (" << kernelRate / scalarRate << "x), "
+			<< JobSystem::get_instance().get_thread_count() << " threads " << parallelRate << " (" << parallelRate / scalarRate
+			<< "x) vertices/us, max difference " << maxError << "\n";
+
+		if (!vertices.m_influenceOrder.empty())
+		{
+			const unsigned* groupEnds = vertices.m_influenceGroupEnds;
+			std::cout << "    vertices with 1/2/4 influences: " << groupEnds[0] << "/" << groupEnds[1] - groupEnds[0] << "/" << groupEnds[2] - groupEnds[1] << "\n";
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+/**
+* @file CpuSkinning.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Linear blend skinning of whole primitives on the cpu. The vertices are split
+*		 in ranges processed by the job system, and each range uses AVX2 or SSE
+*		 when the compiler targets them, and plain glm otherwise.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "SkinningCore.h"
+
+
+namespace cs460
+{
+	// Deformed vertices of a primitive (the normals have the same size as the positions)
+	struct DeformedVertices
+	{
+		std::vector<glm::vec3> m_positions;
+		std::vector<glm::vec3> m_normals;
+	};
+
+
+	// Deform the vertices [begin, end) with the given palette. The normals are only written if the vertices have them.
+	void skin_vertices_range(const AffineTransform* palette, const SkinnedVertices& vertices, unsigned begin, unsigned end,
+							 glm::vec3* positions, glm::vec3* normals);
+
+	// Same, but for the vertices [begin, end) of the influence order, each group with the kernel for its influence count
+	void skin_vertices_grouped(const AffineTransform* palette, const SkinnedVertices& vertices, unsigned begin, unsigned end,
+							   glm::vec3* positions, glm::vec3* normals);
+
+	// Deform all the vertices (by influence count if the weights were prepared), split in ranges among the threads of the job system if parallel is set
+	void skin_vertices(const AffineTransform* palette, const SkinnedVertices& vertices, DeformedVertices& result, bool parallel);
+
+
+	// Name of the instruction set the kernel was compiled for
+	const char* get_cpu_skinning_isa();
+
+	// Time the reference implementation, the kernel evaluating 4 influences, the kernels for each influence count and
+	// the threaded version on the given vertices, and print their throughput in vertices per microsecond
+	void benchmark_cpu_skinning(const AffineTransform* palette, const SkinnedVertices& vertices, unsigned iterations);
+}
\ No newline at end of file
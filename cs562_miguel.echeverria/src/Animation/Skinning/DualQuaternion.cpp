@@ -0,0 +1,81 @@
+/**
+* @file DualQuaternion.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Unit dual quaternions used for skinning. They represent a rotation and a
+*		 translation in 32 bytes, and blending them doesn't collapse the volume
+*		 around the joints like blending matrices does.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "DualQuaternion.h"
+
+
+namespace cs460
+{
+	static_assert(sizeof(DualQuaternion) == sizeof(glm::mat2x4), "A dual quaternion has to be seen as a mat2x4");
+
+
+	// Take the rotation and translation of the given transform (the scale and shear are lost)
+	void DualQuaternion::set_transform(const AffineTransform& transform)
+	{
+		// Remove the scale of the rotation axes before extracting the quaternion
+		glm::mat3 rotation;
+		for (int c = 0; c < 3; ++c)
+			rotation[c] = glm::normalize(glm::vec3(transform.m_rows[0][c], transform.m_rows[1][c], transform.m_rows[2][c]));
+
+		glm::quat q = glm::quat_cast(rotation);
+		glm::vec3 t(transform.m_rows[0].w, transform.m_rows[1].w, transform.m_rows[2].w);
+		glm::vec3 r(q.x, q.y, q.z);
+
+		// Dual part is 0.5 * t * q, with t as a pure quaternion
+		m_real = glm::vec4(r, q.w);
+		m_dual = 0.5f * glm::vec4(q.w * t + glm::cross(t, r), -glm::dot(t, r));
+	}
+
+	// Normalize and convert to an affine transform (used after blending)
+	AffineTransform DualQuaternion::get_transform() const
+	{
+		float invLength = 1.0f / glm::length(m_real);
+		glm::vec4 real = m_real * invLength;
+		glm::vec4 dual = m_dual * invLength;
+
+		glm::vec3 r(real);
+		glm::vec3 d(dual);
+		glm::vec3 t = 2.0f * (real.w * d - dual.w * r + glm::cross(r, d));
+
+		TransformData transform;
+		transform.m_orientation = glm::quat(real.w, real.x, real.y, real.z);
+		transform.m_position = t;
+
+		AffineTransform result;
+		result.set_transform(transform);
+		return result;
+	}
+
+	glm::vec3 DualQuaternion::transform_point(const glm::vec3& point) const
+	{
+		glm::vec3 r(m_real);
+		glm::vec3 d(m_dual);
+
+		// Rotate the point, and add the translation 2 * dual * conjugate(real)
+		glm::vec3 rotated = point + 2.0f * glm::cross(r, glm::cross(r, point) + m_real.w * point);
+		return rotated + 2.0f * (m_real.w * d - m_dual.w * r + glm::cross(r, d));
+	}
+
+	// The same memory seen as the glsl mat2x4 used by the shaders (real part in the first column)
+	const glm::mat2x4& DualQuaternion::as_mat2x4() const
+	{
+		return *reinterpret_cast<const glm::mat2x4*>(this);
+	}
+
+
+	// Convert a palette of joint matrices to dual quaternions
+	void convert_palette_to_dual_quats(const AffineTransform* palette, DualQuaternion* result, unsigned jointCount)
+	{
+		for (unsigned j = 0; j < jointCount; ++j)
+			result[j].set_transform(palette[j]);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+/**
+* @file DualQuaternion.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Unit dual quaternions used for skinning. They represent a rotation and a
+*		 translation in 32 bytes, and blending them doesn't collapse the volume
+*		 around the joints like blending matrices does.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "JointPalette.h"
+
+
+namespace cs460
+{
+	// The quaternions are stored as (x, y, z, w), like the glsl vec4 they are uploaded as
+	struct alignas(16) DualQuaternion
+	{
+		glm::vec4 m_real{ 0.0f, 0.0f, 0.0f, 1.0f };		// Rotation
+		glm::vec4 m_dual{ 0.0f, 0.0f, 0.0f, 0.0f };		// Half the translation times the rotation
+
+		// Take the rotation and translation of the given transform (the scale and shear are lost)
+		void set_transform(const AffineTransform& transform);
+
+		// Normalize and convert to an affine transform (used after blending)
+		AffineTransform get_transform() const;
+
+		glm::vec3 transform_point(const glm::vec3& point) const;
+
+		// The same memory seen as the glsl mat2x4 used by the shaders (real part in the first column)
+		const glm::mat2x4& as_mat2x4() const;
+	};
+
+	// Dual quaternions of the joints of a skin, indexed by joint
+	using DualQuatPalette = std::vector<DualQuaternion>;
+
+
+	// Convert a palette of joint matrices to dual quaternions
+	void convert_palette_to_dual_quats(const AffineTransform* palette, DualQuaternion* result, unsigned jointCount);
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+/**
+* @file JointBounds.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Bounding volumes of skinned meshes from a box per joint. The boxes are
+*		 computed once from the bind pose, and transformed by the joint palette
+*		 every frame, so the cost depends on the joints and not on the vertices.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "JointBounds.h"
+
+
+namespace cs460
+{
+	// Grow the box of each joint (indexed by skin joint) with the bind pose positions of the vertices it deforms.
+	// The boxes of the joints without vertices are left empty (min bigger than max).
+	void compute_joint_bounds(const SkinnedVertices& vertices, std::vector<AABB>& jointBounds)
+	{
+		for (unsigned i = 0; i < vertices.get_vertex_count(); ++i)
+		{
+			for (int k = 0; k < 4; ++k)
+			{
+				if (vertices.m_weights[i][k] <= 0.0f)
+					continue;
+
+				unsigned joint = vertices.m_joints[i][k];
+				if (joint >= jointBounds.size())
+					jointBounds.resize(joint + 1, { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) });
+
+				AABB& bounds = jointBounds[joint];
+				bounds.m_min = glm::min(bounds.m_min, vertices.m_positions[i]);
+				bounds.m_max = glm::max(bounds.m_max, vertices.m_positions[i]);
+			}
+		}
+	}
+
+	// Box around the joint boxes transformed by their joint matrices. With linear blend skinning each vertex ends up
+	// inside the hull of its joint transforms, so the result contains the deformed mesh. Returns false if all the boxes are empty.
+	bool compute_skinned_bounds(const AABB* jointBounds, const AffineTransform* palette, unsigned jointCount, AABB& result)
+	{
+		glm::vec3 finalMin(FLT_MAX);
+		glm::vec3 finalMax(-FLT_MAX);
+		for (unsigned j = 0; j < jointCount; ++j)
+		{
+			const AABB& bounds = jointBounds[j];
+			if (bounds.m_min.x > bounds.m_max.x)
+				continue;
+
+			// Transform the center, and project the half extents on each axis with the absolute value of the rotation
+			glm::vec3 center = (bounds.m_min + bounds.m_max) * 0.5f;
+			glm::vec3 halfExtents = (bounds.m_max - bounds.m_min) * 0.5f;
+			for (int r = 0; r < 3; ++r)
+			{
+				const glm::vec4& row = palette[j].m_rows[r];
+				float newCenter = glm::dot(glm::vec3(row), center) + row.w;
+				float newHalfExtent = glm::dot(glm::abs(glm::vec3(row)), halfExtents);
+				finalMin[r] = glm::min(finalMin[r], newCenter - newHalfExtent);
+				finalMax[r] = glm::max(finalMax[r], newCenter + newHalfExtent);
+			}
+		}
+
+		if (finalMin.x > finalMax.x)
+			return false;
+
+		result = { finalMin, finalMax };
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+/**
+* @file JointBounds.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Bounding volumes of skinned meshes from a box per joint. The boxes are
+*		 computed once from the bind pose, and transformed by the joint palette
+*		 every frame, so the cost depends on the joints and not on the vertices.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "SkinningCore.h"
+#include "Math/Geometry/Geometry.h"
+
+
+namespace cs460
+{
+	// Grow the box of each joint (indexed by skin joint) with the bind pose positions of the vertices it deforms.
+	// The boxes of the joints without vertices are left empty (min bigger than max).
+	void compute_joint_bounds(const SkinnedVertices& vertices, std::vector<AABB>& jointBounds);
+
+	// Box around the joint boxes transformed by their joint matrices. With linear blend skinning each vertex ends up
+	// inside the hull of its joint transforms, so the result contains the deformed mesh. Returns false if all the boxes are empty.
+	bool compute_skinned_bounds(const AABB* jointBounds, const AffineTransform* palette, unsigned jointCount, AABB& result);
+}
\ No newline at end of file
@@ -0,0 +1,238 @@
+/**
+* @file JointPalette.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Affine transforms stored as 3x4 matrices, and the kernel that computes the
+*		 joint matrices of a skin with them. It uses SSE when the compiler targets it,
+*		 and plain glm otherwise.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "JointPalette.h"
+#include <random>
+#include <chrono>
+
+// Define JOINT_PALETTE_SCALAR to force the glm version of the kernel (SSE2 is always available in x64)
+#if !defined(JOINT_PALETTE_SCALAR)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define JOINT_PALETTE_SSE
+	#endif
+#endif
+
+#if defined(JOINT_PALETTE_SSE)
+	#include <immintrin.h>
+#endif
+
+
+namespace cs460
+{
+	static_assert(sizeof(AffineTransform) == sizeof(glm::mat3x4), "An affine transform has to be seen as a mat3x4");
+
+
+	// Conversions from/to the other representations of a transform
+	void AffineTransform::set_matrix(const glm::mat4& matrix)
+	{
+		// glm matrices are indexed by column first
+		for (int r = 0; r < 3; ++r)
+			m_rows[r] = glm::vec4(matrix[0][r], matrix[1][r], matrix[2][r], matrix[3][r]);
+	}
+
+	// Built directly from the translation, rotation and scale
+	void AffineTransform::set_transform(const TransformData& transform)
+	{
+		const glm::quat& q = transform.m_orientation;
+		const glm::vec3& s = transform.m_scale;
+		const glm::vec3& t = transform.m_position;
+
+		float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+		// Rows of the rotation matrix, with each column scaled by the scale of its axis
+		m_rows[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy - wz) * s.y, 2.0f * (xz + wy) * s.z, t.x);
+		m_rows[1] = glm::vec4(2.0f * (xy + wz) * s.x, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz - wx) * s.z, t.y);
+		m_rows[2] = glm::vec4(2.0f * (xz - wy) * s.x, 2.0f * (yz + wx) * s.y, (1.0f - 2.0f * (xx + yy)) * s.z, t.z);
+	}
+
+	glm::mat4 AffineTransform::get_matrix() const
+	{
+		glm::mat4 matrix(1.0f);
+		for (int r = 0; r < 3; ++r)
+			for (int c = 0; c < 4; ++c)
+				matrix[c][r] = m_rows[r][c];
+		return matrix;
+	}
+
+	// The same memory seen as the glsl mat3x4 used by the shaders (each row is a column of it,
+	// so the shaders transform a point as vec4(p, 1.0) * m)
+	const glm::mat3x4& AffineTransform::as_mat3x4() const
+	{
+		return *reinterpret_cast<const glm::mat3x4*>(this);
+	}
+
+
+	namespace
+	{
+#if defined(JOINT_PALETTE_SSE)
+
+		// Each row of the result is a combination of the rows of b with the coefficients of the row of a.
+		// The implicit last row of b (0, 0, 0, 1) only adds the translation of a.
+		inline void affine_multiply_sse(const AffineTransform& a, const AffineTransform& b, AffineTransform& result)
+		{
+			const __m128 translationMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+			__m128 b0 = _mm_load_ps(&b.m_rows[0].x);
+			__m128 b1 = _mm_load_ps(&b.m_rows[1].x);
+			__m128 b2 = _mm_load_ps(&b.m_rows[2].x);
+
+			for (int r = 0; r < 3; ++r)
+			{
+				__m128 row = _mm_load_ps(&a.m_rows[r].x);
+				__m128 sum = _mm_and_ps(row, translationMask);
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(0, 0, 0, 0)), b0));
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+				_mm_store_ps(&result.m_rows[r].x, sum);
+			}
+		}
+
+#else
+
+		inline void affine_multiply_scalar(const AffineTransform& a, const AffineTransform& b, AffineTransform& result)
+		{
+			for (int r = 0; r < 3; ++r)
+			{
+				const glm::vec4& row = a.m_rows[r];
+				result.m_rows[r] = row.x * b.m_rows[0] + row.y * b.m_rows[1] + row.z * b.m_rows[2] + glm::vec4(0.0f, 0.0f, 0.0f, row.w);
+			}
+		}
+
+#endif
+	}
+
+
+	// result = a * b (result can't be a or b)
+	void affine_multiply(const AffineTransform& a, const AffineTransform& b, AffineTransform& result)
+	{
+#if defined(JOINT_PALETTE_SSE)
+		affine_multiply_sse(a, b, result);
+#else
+		affine_multiply_scalar(a, b, result);
+#endif
+	}
+
+	// Compute palette[j] = rootMtx * world(jointTransforms[j]) * invBindMatrices[j] for every joint. The world
+	// matrices are built from the transforms, so no 4x4 matrix is generated in the whole process.
+	void compute_joint_palette(const AffineTransform& rootMtx, const TransformData* const* jointTransforms,
+							   const AffineTransform* invBindMatrices, AffineTransform* palette, unsigned jointCount)
+	{
+		AffineTransform world;
+		AffineTransform worldInvBind;
+		for (unsigned j = 0; j < jointCount; ++j)
+		{
+			world.set_transform(*jointTransforms[j]);
+			affine_multiply(world, invBindMatrices[j], worldInvBind);
+			affine_multiply(rootMtx, worldInvBind, palette[j]);
+		}
+	}
+
+	// Same, but only for the given joints (the rest of the palette is left untouched)
+	void compute_joint_palette(const AffineTransform& rootMtx, const TransformData* const* jointTransforms, const AffineTransform* invBindMatrices,
+							   AffineTransform* palette, const unsigned short* joints, unsigned jointCount)
+	{
+		AffineTransform world;
+		AffineTransform worldInvBind;
+		for (unsigned i = 0; i < jointCount; ++i)
+		{
+			unsigned j = joints[i];
+			world.set_transform(*jointTransforms[j]);
+			affine_multiply(world, invBindMatrices[j], worldInvBind);
+			affine_multiply(rootMtx, worldInvBind, palette[j]);
+		}
+	}
+
+
+	// Name of the instruction set the kernel was compiled for
+	const char* get_joint_palette_isa()
+	{
+#if defined(JOINT_PALETTE_SSE)
+		return "SSE2";
+#else
+		return "Scalar";
+#endif
+	}
+
+	// Time the kernel against the previous mat4 version on random joints, and print the time per joint
+	void benchmark_joint_palette(unsigned jointCount, unsigned iterations)
+	{
+		std::mt19937 generator(0);
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+		// Random joints and inverse bind matrices, and a random root
+		std::vector<TransformData> transforms(jointCount);
+		std::vector<const TransformData*> transformPtrs(jointCount);
+		std::vector<glm::mat4> invBindMatrices(jointCount);
+		JointPalette invBindAffine(jointCount);
+		for (unsigned j = 0; j < jointCount; ++j)
+		{
+			TransformData& transform = transforms[j];
+			transform.m_position = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+			transform.m_orientation = glm::normalize(glm::quat(distribution(generator), distribution(generator), distribution(generator), distribution(generator)));
+			transform.m_scale = glm::vec3(1.0f + 0.5f * distribution(generator));
+			transformPtrs[j] = &transform;
+
+			TransformData bind;
+			bind.m_position = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+			bind.m_orientation = glm::normalize(glm::quat(distribution(generator), distribution(generator), distribution(generator), distribution(generator)));
+			invBindMatrices[j] = bind.get_inv_model_mtx();
+			invBindAffine[j].set_matrix(invBindMatrices[j]);
+		}
+
+		TransformData root;
+		root.m_position = glm::vec3(0.5f, 0.0f, -0.5f);
+		root.m_orientation = glm::angleAxis(0.3f, glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 rootMtx = root.get_model_mtx() * root.get_inv_model_mtx();
+		AffineTransform rootAffine;
+		rootAffine.set_matrix(rootMtx);
+
+		std::vector<glm::mat4> matrices(jointCount);
+		JointPalette palette(jointCount);
+
+		// Returns the nanoseconds per joint of the given function
+		auto measure = [jointCount, iterations](const std::function<void()>& kernel) -> double
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			for (unsigned i = 0; i < iterations; ++i)
+				kernel();
+			auto end = std::chrono::high_resolution_clock::now();
+
+			return std::chrono::duration<double, std::nano>(end - start).count() / ((double)jointCount * iterations);
+		};
+
+		double matrixNs = measure([&]()
+		{
+			for (unsigned j = 0; j < jointCount; ++j)
+				matrices[j] = rootMtx * transforms[j].get_model_mtx() * invBindMatrices[j];
+		});
+		double affineNs = measure([&]()
+		{
+			compute_joint_palette(rootAffine, transformPtrs.data(), invBindAffine.data(), palette.data(), jointCount);
+		});
+
+		// Both versions have to give the same matrices
+		float maxError = 0.0f;
+		for (unsigned j = 0; j < jointCount; ++j)
+		{
+			glm::mat4 affine = palette[j].get_matrix();
+			for (int c = 0; c < 4; ++c)
+				for (int r = 0; r < 4; ++r)
+					maxError = glm::max(maxError, glm::abs(affine[c][r] - matrices[j][c][r]));
+		}
+
+		std::cout << "Joint palette (" << get_joint_palette_isa() << ", " << jointCount << " joints, " << iterations << " iterations)\n";
+		std::cout << "  mat4 version:   " << matrixNs << " ns/joint\n";
+		std::cout << "  affine version: " << affineNs << " ns/joint (" << matrixNs / affineNs << "x)\n";
+		std::cout << "  max difference: " << maxError << std::endl;
+	}
+}
\ No newline at end of file
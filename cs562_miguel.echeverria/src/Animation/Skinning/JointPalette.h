@@ -0,0 +1,55 @@
+/**
+* @file JointPalette.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Affine transforms stored as 3x4 matrices, and the kernel that computes the
+*		 joint matrices of a skin with them. It uses SSE when the compiler targets it,
+*		 and plain glm otherwise.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+
+namespace cs460
+{
+	// Affine transform stored as the first three rows of its 4x4 matrix (the last one is always 0, 0, 0, 1).
+	// Each row is a single 16 byte load, and it takes 48 bytes instead of 64.
+	struct alignas(16) AffineTransform
+	{
+		glm::vec4 m_rows[3] = { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f } };
+
+		// Conversions from/to the other representations of a transform
+		void set_matrix(const glm::mat4& matrix);
+		void set_transform(const TransformData& transform);		// Built directly from the translation, rotation and scale
+		glm::mat4 get_matrix() const;
+
+		// The same memory seen as the glsl mat3x4 used by the shaders (each row is a column of it,
+		// so the shaders transform a point as vec4(p, 1.0) * m)
+		const glm::mat3x4& as_mat3x4() const;
+	};
+
+	// Joint matrices of a skin, indexed by joint
+	using JointPalette = std::vector<AffineTransform>;
+
+
+	// result = a * b (result can't be a or b)
+	void affine_multiply(const AffineTransform& a, const AffineTransform& b, AffineTransform& result);
+
+	// Compute palette[j] = rootMtx * world(jointTransforms[j]) * invBindMatrices[j] for every joint. The world
+	// matrices are built from the transforms, so no 4x4 matrix is generated in the whole process.
+	void compute_joint_palette(const AffineTransform& rootMtx, const TransformData* const* jointTransforms,
+							   const AffineTransform* invBindMatrices, AffineTransform* palette, unsigned jointCount);
+
+	// Same, but only for the given joints (the rest of the palette is left untouched)
+	void compute_joint_palette(const AffineTransform& rootMtx, const TransformData* const* jointTransforms, const AffineTransform* invBindMatrices,
+							   AffineTransform* palette, const unsigned short* joints, unsigned jointCount);
+
+
+	// Name of the instruction set the kernel was compiled for
+	const char* get_joint_palette_isa();
+
+	// Time the kernel against the previous mat4 version on random joints, and print the time per joint
+	void benchmark_joint_palette(unsigned jointCount, unsigned iterations);
+}
\ No newline at end of file
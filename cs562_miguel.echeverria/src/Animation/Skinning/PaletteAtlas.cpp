@@ -0,0 +1,545 @@
+/**
+* @file PaletteAtlas.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Joint palettes of every animation of a skin baked at a fixed rate.
+*		 Crowd characters only look up the two frames around their time and
+*		 blend them, instead of sampling the keyframes and the hierarchy.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "PaletteAtlas.h"
+#include "Graphics/GLTF/Model.h"
+#include "Math/Interpolation/InterpolationFunctions.h"
+#include <chrono>
+
+
+namespace cs460
+{
+	// Identifies the atlas files, and the version of their layout
+	static const char s_atlasFileMagic[4] = { 'P', 'A', 'T', 'L' };
+	static const unsigned s_atlasFileVersion = 1;
+
+
+	namespace
+	{
+		// Computes the palette of a skin for any time of an animation directly from the model data, the same way
+		// the animation and skin reference components do it on the nodes of a model instance
+		class SkinPaletteEvaluator
+		{
+		public:
+
+			SkinPaletteEvaluator(const Model& model, int skinIdx)
+				:	m_model(model),
+					m_skin(model.m_skins[skinIdx])
+			{
+				unsigned nodeCount = (unsigned)model.m_nodes.size();
+				std::vector<int> parents(nodeCount, -1);
+				for (unsigned i = 0; i < nodeCount; ++i)
+					for (int child : model.m_nodes[i].m_childrenIndices)
+						parents[child] = (int)i;
+
+				// Sort the nodes so that the parents come before their children
+				for (unsigned i = 0; i < nodeCount; ++i)
+					if (parents[i] < 0)
+						m_order.push_back(i);
+				for (unsigned i = 0; i < m_order.size(); ++i)
+					for (int child : model.m_nodes[m_order[i]].m_childrenIndices)
+						m_order.push_back(child);
+
+				m_parents = std::move(parents);
+				m_local.resize(nodeCount);
+				m_world.resize(nodeCount);
+				m_jointTransforms.resize(m_skin.m_joints.size());
+				for (unsigned j = 0; j < m_jointTransforms.size(); ++j)
+					m_jointTransforms[j] = &m_world[m_skin.m_joints[j]];
+			}
+
+			void evaluate(const Animation& anim, float time, AffineTransform* palette)
+			{
+				for (unsigned i = 0; i < m_local.size(); ++i)
+					m_local[i] = m_model.m_nodes[i].m_localTransform;
+
+				// Same interpolation that the animation reference uses for each property
+				for (const AnimationChannel& channel : anim.m_channels)
+				{
+					if (channel.m_targetNodeIdx < 0 || channel.m_targetNodeIdx >= (int)m_local.size())
+						continue;
+
+					const AnimationData& data = anim.m_animData[channel.m_animDataIdx];
+					TransformData& transform = m_local[channel.m_targetNodeIdx];
+					if (channel.m_targetProperty == "rotation")
+						transform.m_orientation = piecewise_slerp(data.m_keys, data.m_values, time);
+					else if (channel.m_targetProperty == "translation")
+						transform.m_position = sample_vec3(data, time);
+					else if (channel.m_targetProperty == "scale")
+						transform.m_scale = sample_vec3(data, time);
+				}
+
+				for (unsigned node : m_order)
+				{
+					if (m_parents[node] < 0)
+						m_world[node] = m_local[node];
+					else
+						m_world[node].concatenate(m_local[node], m_world[m_parents[node]]);
+				}
+
+				// The transform of the model instance cancels out, so the palettes are the same for every instance
+				AffineTransform rootMtx;
+				int root = m_skin.m_commonRootIdx;
+				rootMtx.set_matrix(m_local[root].get_model_mtx() * m_world[root].get_inv_model_mtx());
+				compute_joint_palette(rootMtx, m_jointTransforms.data(), m_skin.m_invBindMatrices.data(), palette, (unsigned)m_jointTransforms.size());
+			}
+
+		private:
+			const Model& m_model;
+			const Skin& m_skin;
+			std::vector<int> m_parents;
+			std::vector<unsigned> m_order;
+			std::vector<TransformData> m_local;
+			std::vector<TransformData> m_world;
+			std::vector<const TransformData*> m_jointTransforms;
+
+			static glm::vec3 sample_vec3(const AnimationData& data, float time)
+			{
+				if (data.m_interpolationMethod == "STEP")
+					return piecewise_step(data.m_keys, data.m_values, time);
+				if (data.m_interpolationMethod == "CUBICSPLINE")
+					return piecewise_hermite(data.m_keys, data.m_values, time);
+				return piecewise_lerp(data.m_keys, data.m_values, time);
+			}
+		};
+
+
+		// Biggest difference of the translations and of the rest of the elements between two palettes
+		void compare_palettes(const AffineTransform* a, const AffineTransform* b, unsigned jointCount, float& translationError, float& linearError)
+		{
+			for (unsigned j = 0; j < jointCount; ++j)
+			{
+				glm::vec3 translation;
+				for (int r = 0; r < 3; ++r)
+				{
+					glm::vec4 diff = glm::abs(a[j].m_rows[r] - b[j].m_rows[r]);
+					linearError = glm::max(linearError, glm::max(diff.x, glm::max(diff.y, diff.z)));
+					translation[r] = diff.w;
+				}
+				translationError = glm::max(translationError, glm::length(translation));
+			}
+		}
+
+
+		template <typename T>
+		void write_value(std::ofstream& file, const T& value)
+		{
+			file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		template <typename T>
+		void write_array(std::ofstream& file, const std::vector<T>& values)
+		{
+			file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+		}
+
+		template <typename T>
+		void read_value(std::ifstream& file, T& value)
+		{
+			file.read(reinterpret_cast<char*>(&value), sizeof(T));
+		}
+
+		template <typename T>
+		void read_array(std::ifstream& file, std::vector<T>& values, size_t count)
+		{
+			values.resize(count);
+			file.read(reinterpret_cast<char*>(values.data()), count * sizeof(T));
+		}
+	}
+
+
+	void PaletteAtlasStats::print(std::ostream& os) const
+	{
+		os << "Palette atlas: " << m_clipCount << " clips, " << m_frameCount << " frames of " << m_jointCount << " joints, "
+			<< m_byteSize / 1024.0f << " KB (" << m_floatByteSize / 1024.0f << " KB as floats)\n";
+		os << "  Baked in " << m_bakeMs << " ms. Per palette: " << m_evaluateUs << " us evaluated from the keyframes, "
+			<< m_sampleUs << " us sampled from the atlas\n";
+		os << "  Max error between frames: " << m_maxTranslationError << " translation, " << m_maxLinearError << " rotation/scale\n";
+		os << "  Max error on the frames (quantization): " << m_maxQuantizationTranslationError << " translation, "
+			<< m_maxQuantizationLinearError << " rotation/scale\n";
+	}
+
+
+	// Sample every animation of the model at the given rate (frames per second), computing the palette of the given
+	// skin for each frame the same way the skin references do. Only needs the nodes, skins and animations of the model.
+	bool PaletteAtlas::bake(const Model& model, int skinIdx, float sampleRate, PaletteAtlasFormat format, PaletteAtlasStats* stats)
+	{
+		clear();
+		if (skinIdx < 0 || skinIdx >= (int)model.m_skins.size() || sampleRate <= 0.0f)
+		{
+			std::cout << "ERROR: Invalid skin or sample rate to bake the palettes of " << model.m_fileName << std::endl;
+			return false;
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		SkinPaletteEvaluator evaluator(model, skinIdx);
+		m_format = format;
+		m_jointCount = (unsigned)model.m_skins[skinIdx].m_joints.size();
+
+		std::vector<AffineTransform> frames;
+		for (const Animation& anim : model.m_animations)
+		{
+			PaletteAtlasClip clip;
+			clip.m_name = anim.m_name;
+			clip.m_firstFrame = m_frameCount;
+			clip.m_duration = anim.m_duration;
+			clip.m_frameCount = anim.m_duration > 0.0f ? (unsigned)glm::ceil(anim.m_duration * sampleRate) + 1 : 1;
+			clip.m_frameTime = clip.m_frameCount > 1 ? anim.m_duration / (clip.m_frameCount - 1) : 0.0f;
+
+			frames.resize((size_t)(m_frameCount + clip.m_frameCount) * m_jointCount);
+			for (unsigned f = 0; f < clip.m_frameCount; ++f)
+				evaluator.evaluate(anim, f * clip.m_frameTime, &frames[(size_t)(clip.m_firstFrame + f) * m_jointCount]);
+
+			m_frameCount += clip.m_frameCount;
+			m_clips.push_back(clip);
+		}
+
+		if (format == PaletteAtlasFormat::UNORM16)
+			quantize(frames);
+		else
+			m_frames = std::move(frames);
+
+		auto end = std::chrono::high_resolution_clock::now();
+		if (stats == nullptr)
+			return true;
+
+		*stats = PaletteAtlasStats();
+		stats->m_clipCount = get_clip_count();
+		stats->m_frameCount = m_frameCount;
+		stats->m_jointCount = m_jointCount;
+		stats->m_byteSize = get_byte_size();
+		stats->m_floatByteSize = (size_t)m_frameCount * m_jointCount * sizeof(AffineTransform);
+		stats->m_bakeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+		// Compare the atlas with the keyframes on every frame and in the middle of every pair of frames
+		std::vector<AffineTransform> exact(m_jointCount);
+		std::vector<AffineTransform> sampled(m_jointCount);
+		double evaluateUs = 0.0;
+		double sampleUs = 0.0;
+		unsigned samples = 0;
+		for (unsigned c = 0; c < m_clips.size(); ++c)
+		{
+			const PaletteAtlasClip& clip = m_clips[c];
+			for (unsigned f = 0; f < clip.m_frameCount; ++f)
+			{
+				for (int half = 0; half < 2; ++half)
+				{
+					if (half == 1 && f + 1 == clip.m_frameCount)
+						break;
+
+					float time = (f + 0.5f * half) * clip.m_frameTime;
+					auto evaluateStart = std::chrono::high_resolution_clock::now();
+					evaluator.evaluate(model.m_animations[c], time, exact.data());
+					auto sampleStart = std::chrono::high_resolution_clock::now();
+					sample_palette(c, time, sampled.data());
+					auto sampleEnd = std::chrono::high_resolution_clock::now();
+
+					evaluateUs += std::chrono::duration<double, std::micro>(sampleStart - evaluateStart).count();
+					sampleUs += std::chrono::duration<double, std::micro>(sampleEnd - sampleStart).count();
+					++samples;
+
+					if (half == 0)
+						compare_palettes(exact.data(), sampled.data(), m_jointCount, stats->m_maxQuantizationTranslationError, stats->m_maxQuantizationLinearError);
+					else
+						compare_palettes(exact.data(), sampled.data(), m_jointCount, stats->m_maxTranslationError, stats->m_maxLinearError);
+				}
+			}
+		}
+
+		if (samples > 0)
+		{
+			stats->m_evaluateUs = evaluateUs / samples;
+			stats->m_sampleUs = sampleUs / samples;
+		}
+
+		// The frames of an animation with a single frame are only compared with themselves
+		stats->m_maxTranslationError = glm::max(stats->m_maxTranslationError, stats->m_maxQuantizationTranslationError);
+		stats->m_maxLinearError = glm::max(stats->m_maxLinearError, stats->m_maxQuantizationLinearError);
+		return true;
+	}
+
+	void PaletteAtlas::clear()
+	{
+		m_jointCount = 0;
+		m_frameCount = 0;
+		m_clips.clear();
+		m_frames.clear();
+		m_quantized.clear();
+		m_rangeMin.clear();
+		m_rangeScale.clear();
+	}
+
+
+	// Binary file with the clips, the ranges and the frames
+	bool PaletteAtlas::save(const std::string& filePath) const
+	{
+		std::ofstream file(filePath, std::ios::binary);
+		if (!file.is_open())
+		{
+			std::cout << "ERROR: Could not open " << filePath << " to save the palette atlas" << std::endl;
+			return false;
+		}
+
+		file.write(s_atlasFileMagic, sizeof(s_atlasFileMagic));
+		write_value(file, s_atlasFileVersion);
+		write_value(file, (unsigned)m_format);
+		write_value(file, m_jointCount);
+		write_value(file, m_frameCount);
+		write_value(file, get_clip_count());
+
+		for (const PaletteAtlasClip& clip : m_clips)
+		{
+			write_value(file, (unsigned)clip.m_name.size());
+			file.write(clip.m_name.data(), clip.m_name.size());
+			write_value(file, clip.m_firstFrame);
+			write_value(file, clip.m_frameCount);
+			write_value(file, clip.m_duration);
+			write_value(file, clip.m_frameTime);
+		}
+
+		if (m_format == PaletteAtlasFormat::UNORM16)
+		{
+			write_array(file, m_rangeMin);
+			write_array(file, m_rangeScale);
+			write_array(file, m_quantized);
+		}
+		else
+			write_array(file, m_frames);
+
+		return file.good();
+	}
+
+	bool PaletteAtlas::load(const std::string& filePath)
+	{
+		clear();
+		std::ifstream file(filePath, std::ios::binary);
+		if (!file.is_open())
+		{
+			std::cout << "ERROR: Could not open the palette atlas " << filePath << std::endl;
+			return false;
+		}
+
+		char magic[4];
+		unsigned version = 0;
+		unsigned format = 0;
+		unsigned clipCount = 0;
+		file.read(magic, sizeof(magic));
+		read_value(file, version);
+		if (!file || std::memcmp(magic, s_atlasFileMagic, sizeof(magic)) != 0 || version != s_atlasFileVersion)
+		{
+			std::cout << "ERROR: " << filePath << " is not a palette atlas of the current version" << std::endl;
+			return false;
+		}
+
+		read_value(file, format);
+		read_value(file, m_jointCount);
+		read_value(file, m_frameCount);
+		read_value(file, clipCount);
+		m_format = (PaletteAtlasFormat)format;
+
+		m_clips.resize(clipCount);
+		for (PaletteAtlasClip& clip : m_clips)
+		{
+			unsigned nameLength = 0;
+			read_value(file, nameLength);
+			clip.m_name.resize(nameLength);
+			file.read(&clip.m_name[0], nameLength);
+			read_value(file, clip.m_firstFrame);
+			read_value(file, clip.m_frameCount);
+			read_value(file, clip.m_duration);
+			read_value(file, clip.m_frameTime);
+		}
+
+		size_t jointFrames = (size_t)m_frameCount * m_jointCount;
+		if (m_format == PaletteAtlasFormat::UNORM16)
+		{
+			read_array(file, m_rangeMin, m_jointCount);
+			read_array(file, m_rangeScale, m_jointCount);
+			read_array(file, m_quantized, jointFrames * 12);
+		}
+		else
+			read_array(file, m_frames, jointFrames);
+
+		if (!file)
+		{
+			std::cout << "ERROR: The palette atlas " << filePath << " is truncated" << std::endl;
+			clear();
+			return false;
+		}
+		return true;
+	}
+
+
+	// Blend the two frames of the given clip around the given time (clamped to the clip) into palette
+	void PaletteAtlas::sample_palette(unsigned clip, float time, AffineTransform* palette) const
+	{
+		const PaletteAtlasClip& atlasClip = m_clips[clip];
+		if (atlasClip.m_frameCount < 2)
+		{
+			decode_frame(atlasClip.m_firstFrame, palette);
+			return;
+		}
+
+		float frame = glm::clamp(time / atlasClip.m_frameTime, 0.0f, (float)(atlasClip.m_frameCount - 1));
+		unsigned frame0 = glm::min((unsigned)frame, atlasClip.m_frameCount - 2);
+		float t = frame - frame0;
+		size_t first = (size_t)(atlasClip.m_firstFrame + frame0) * m_jointCount;
+
+		if (m_format == PaletteAtlasFormat::FLOAT32)
+		{
+			const AffineTransform* a = &m_frames[first];
+			const AffineTransform* b = a + m_jointCount;
+			for (unsigned j = 0; j < m_jointCount; ++j)
+				for (int r = 0; r < 3; ++r)
+					palette[j].m_rows[r] = glm::mix(a[j].m_rows[r], b[j].m_rows[r], t);
+			return;
+		}
+
+		const unsigned short* a = &m_quantized[first * 12];
+		const unsigned short* b = a + m_jointCount * 12;
+		for (unsigned j = 0; j < m_jointCount; ++j)
+		{
+			for (int r = 0; r < 3; ++r, a += 4, b += 4)
+			{
+				glm::vec4 blended = glm::mix(glm::vec4(a[0], a[1], a[2], a[3]), glm::vec4(b[0], b[1], b[2], b[3]), t);
+				palette[j].m_rows[r] = m_rangeMin[j].m_rows[r] + blended * m_rangeScale[j].m_rows[r];
+			}
+		}
+	}
+
+	// Copy a single frame of the atlas into palette
+	void PaletteAtlas::decode_frame(unsigned frame, AffineTransform* palette) const
+	{
+		size_t first = (size_t)frame * m_jointCount;
+		if (m_format == PaletteAtlasFormat::FLOAT32)
+		{
+			std::copy(m_frames.begin() + first, m_frames.begin() + first + m_jointCount, palette);
+			return;
+		}
+
+		const unsigned short* q = &m_quantized[first * 12];
+		for (unsigned j = 0; j < m_jointCount; ++j)
+			for (int r = 0; r < 3; ++r, q += 4)
+				palette[j].m_rows[r] = m_rangeMin[j].m_rows[r] + glm::vec4(q[0], q[1], q[2], q[3]) * m_rangeScale[j].m_rows[r];
+	}
+
+
+	bool PaletteAtlas::is_empty() const
+	{
+		return m_frameCount == 0;
+	}
+
+	PaletteAtlasFormat PaletteAtlas::get_format() const
+	{
+		return m_format;
+	}
+
+	unsigned PaletteAtlas::get_joint_count() const
+	{
+		return m_jointCount;
+	}
+
+	unsigned PaletteAtlas::get_frame_count() const
+	{
+		return m_frameCount;
+	}
+
+	unsigned PaletteAtlas::get_clip_count() const
+	{
+		return (unsigned)m_clips.size();
+	}
+
+	const PaletteAtlasClip& PaletteAtlas::get_clip(unsigned clip) const
+	{
+		return m_clips[clip];
+	}
+
+	// Size of the frames and ranges
+	size_t PaletteAtlas::get_byte_size() const
+	{
+		return m_frames.size() * sizeof(AffineTransform) + m_quantized.size() * sizeof(unsigned short) +
+			(m_rangeMin.size() + m_rangeScale.size()) * sizeof(AffineTransform);
+	}
+
+
+	// Store each element relative to the range it takes in all the frames of its joint
+	void PaletteAtlas::quantize(const std::vector<AffineTransform>& frames)
+	{
+		m_rangeMin.assign(m_jointCount, AffineTransform());
+		m_rangeScale.assign(m_jointCount, AffineTransform());
+		m_quantized.resize(frames.size() * 12);
+
+		for (unsigned j = 0; j < m_jointCount; ++j)
+		{
+			for (int r = 0; r < 3; ++r)
+			{
+				glm::vec4 minValue(FLT_MAX);
+				glm::vec4 maxValue(-FLT_MAX);
+				for (unsigned f = 0; f < m_frameCount; ++f)
+				{
+					minValue = glm::min(minValue, frames[(size_t)f * m_jointCount + j].m_rows[r]);
+					maxValue = glm::max(maxValue, frames[(size_t)f * m_jointCount + j].m_rows[r]);
+				}
+				m_rangeMin[j].m_rows[r] = minValue;
+				m_rangeScale[j].m_rows[r] = (maxValue - minValue) / 65535.0f;
+			}
+		}
+
+		for (size_t i = 0; i < frames.size(); ++i)
+		{
+			unsigned j = (unsigned)(i % m_jointCount);
+			for (int r = 0; r < 3; ++r)
+			{
+				const glm::vec4& scale = m_rangeScale[j].m_rows[r];
+				glm::vec4 normalized = frames[i].m_rows[r] - m_rangeMin[j].m_rows[r];
+				for (int k = 0; k < 4; ++k)
+					m_quantized[i * 12 + r * 4 + k] = scale[k] > 0.0f ? (unsigned short)glm::clamp(glm::round(normalized[k] / scale[k]), 0.0f, 65535.0f) : 0;
+			}
+		}
+	}
+
+
+	// Load the model without its meshes (no graphics context needed), bake the palettes of each of its skins and save
+	// them in outputPath (with the skin index appended to the name if there are several). Prints the report of each one.
+	bool bake_palette_atlas_files(const std::string& modelPath, const std::string& outputPath, float sampleRate, PaletteAtlasFormat format)
+	{
+		Model model;
+		model.load_gltf_file(modelPath, false);
+		if (model.m_skins.empty())
+		{
+			std::cout << "ERROR: " << modelPath << " has no skins to bake" << std::endl;
+			return false;
+		}
+
+		bool success = true;
+		for (int i = 0; i < (int)model.m_skins.size(); ++i)
+		{
+			fs::path path(outputPath);
+			if (model.m_skins.size() > 1)
+				path.replace_filename(path.stem().generic_string() + "_skin" + std::to_string(i) + path.extension().generic_string());
+
+			PaletteAtlas atlas;
+			PaletteAtlasStats stats;
+			if (!atlas.bake(model, i, sampleRate, format, &stats) || !atlas.save(path.generic_string()))
+			{
+				success = false;
+				continue;
+			}
+
+			std::cout << "Skin " << i << " (" << model.m_skins[i].m_name << ") of " << modelPath << " -> " << path.generic_string() << "\n";
+			stats.print(std::cout);
+		}
+
+		return success;
+	}
+}
\ No newline at end of file
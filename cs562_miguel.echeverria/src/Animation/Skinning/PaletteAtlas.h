@@ -0,0 +1,110 @@
+/**
+* @file PaletteAtlas.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Joint palettes of every animation of a skin baked at a fixed rate.
+*		 Crowd characters only look up the two frames around their time and
+*		 blend them, instead of sampling the keyframes and the hierarchy.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "JointPalette.h"
+
+
+namespace cs460
+{
+	struct Model;
+
+
+	// How the matrices of the atlas are stored
+	enum class PaletteAtlasFormat
+	{
+		FLOAT32,		// 48 bytes per joint and frame
+		UNORM16			// 24 bytes per joint and frame, each element relative to the range of its joint in the whole atlas
+	};
+
+
+	// Frames of one animation in the atlas
+	struct PaletteAtlasClip
+	{
+		std::string m_name;
+		unsigned m_firstFrame = 0;
+		unsigned m_frameCount = 0;
+		float m_duration = 0.0f;
+		float m_frameTime = 0.0f;		// Time between frames (the rate is adjusted so that the last frame falls on the duration)
+	};
+
+
+	// Report of a bake. The errors are the biggest difference between an element of the palettes sampled from the
+	// atlas and the ones evaluated from the keyframes, in the middle of each pair of frames (interpolation) and on the
+	// frames themselves (quantization). Translation errors are in the units of the model, and linear ones unitless.
+	struct PaletteAtlasStats
+	{
+		unsigned m_clipCount = 0;
+		unsigned m_frameCount = 0;
+		unsigned m_jointCount = 0;
+		size_t m_byteSize = 0;
+		size_t m_floatByteSize = 0;					// Size the same frames would take as floats
+		float m_maxTranslationError = 0.0f;
+		float m_maxLinearError = 0.0f;
+		float m_maxQuantizationTranslationError = 0.0f;
+		float m_maxQuantizationLinearError = 0.0f;
+		double m_bakeMs = 0.0;
+		double m_evaluateUs = 0.0;					// Average time to evaluate a palette from the keyframes
+		double m_sampleUs = 0.0;					// Average time to sample a palette from the atlas
+
+		void print(std::ostream& os) const;
+	};
+
+
+	class PaletteAtlas
+	{
+	public:
+
+		// Frames per second used when no other rate is given
+		static constexpr float DEFAULT_SAMPLE_RATE = 30.0f;
+
+		// Sample every animation of the model at the given rate (frames per second), computing the palette of the given
+		// skin for each frame the same way the skin references do. Only needs the nodes, skins and animations of the model.
+		bool bake(const Model& model, int skinIdx, float sampleRate, PaletteAtlasFormat format, PaletteAtlasStats* stats = nullptr);
+		void clear();
+
+		// Binary file with the clips, the ranges and the frames
+		bool save(const std::string& filePath) const;
+		bool load(const std::string& filePath);
+
+		// Blend the two frames of the given clip around the given time (clamped to the clip) into palette
+		void sample_palette(unsigned clip, float time, AffineTransform* palette) const;
+
+		// Copy a single frame of the atlas into palette
+		void decode_frame(unsigned frame, AffineTransform* palette) const;
+
+		bool is_empty() const;
+		PaletteAtlasFormat get_format() const;
+		unsigned get_joint_count() const;
+		unsigned get_frame_count() const;
+		unsigned get_clip_count() const;
+		const PaletteAtlasClip& get_clip(unsigned clip) const;
+		size_t get_byte_size() const;		// Size of the frames and ranges
+
+	private:
+		PaletteAtlasFormat m_format = PaletteAtlasFormat::FLOAT32;
+		unsigned m_jointCount = 0;
+		unsigned m_frameCount = 0;
+		std::vector<PaletteAtlasClip> m_clips;
+		std::vector<AffineTransform> m_frames;			// Float frames, one palette after another
+		std::vector<unsigned short> m_quantized;		// Quantized frames, 12 elements per joint
+		std::vector<AffineTransform> m_rangeMin;		// Range of every element of each joint (only quantized)
+		std::vector<AffineTransform> m_rangeScale;
+
+		void quantize(const std::vector<AffineTransform>& frames);
+	};
+
+
+	// Load the model without its meshes (no graphics context needed), bake the palettes of each of its skins and save
+	// them in outputPath (with the skin index appended to the name if there are several). Prints the report of each one.
+	bool bake_palette_atlas_files(const std::string& modelPath, const std::string& outputPath, float sampleRate, PaletteAtlasFormat format);
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+/**
+* @file SkinPartition.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Load time compaction of the joints used by a skinned primitive. The
+*		 triangles are grouped in partitions that reference at most MAX_JOINTS
+*		 joints, and each partition is drawn with its own small palette.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "SkinPartition.h"
+#include <algorithm>
+
+
+namespace cs460
+{
+	// Groups with less triangles are drawn with the next influence count, as it isn't worth an extra draw
+	static const unsigned s_minTrianglesPerInfluenceGroup = 64;
+
+
+	namespace
+	{
+		// Add the joints with weight of the given vertex that aren't in the partition yet (marked in localIdx) to newJoints
+		void gather_new_joints(const SkinnedVertices& vertices, unsigned vertex, const std::vector<int>& localIdx, std::vector<unsigned short>& newJoints)
+		{
+			for (int k = 0; k < 4; ++k)
+			{
+				unsigned short joint = vertices.m_joints[vertex][k];
+				if (vertices.m_weights[vertex][k] > 0.0f && localIdx[joint] < 0 && std::find(newJoints.begin(), newJoints.end(), joint) == newJoints.end())
+					newJoints.push_back(joint);
+			}
+		}
+
+		// Sort the joints of the partition and remap the joints of its vertices to them (all of them if indices is null)
+		void build_local_joints(const SkinnedVertices& vertices, const unsigned* indices, std::vector<int>& localIdx, SkinPartition& partition)
+		{
+			std::sort(partition.m_joints.begin(), partition.m_joints.end());
+			for (unsigned i = 0; i < partition.m_joints.size(); ++i)
+				localIdx[partition.m_joints[i]] = (int)i;
+
+			// The joints without weight aren't in the palette, so they point to any entry
+			partition.m_localJoints.assign(vertices.get_vertex_count(), glm::u8vec4(0));
+			unsigned count = indices ? partition.m_indexCount : vertices.get_vertex_count();
+			for (unsigned i = 0; i < count; ++i)
+			{
+				unsigned vertex = indices ? indices[partition.m_firstIndex + i] : i;
+				for (int k = 0; k < 4; ++k)
+				{
+					int local = localIdx[vertices.m_joints[vertex][k]];
+					if (vertices.m_weights[vertex][k] > 0.0f && local >= 0)
+						partition.m_localJoints[vertex][k] = (unsigned char)glm::min(local, 255);
+				}
+			}
+
+			for (unsigned short joint : partition.m_joints)
+				localIdx[joint] = -1;
+		}
+
+		// Reorder the triangles of the partition by the influences of their vertices (the most of the three)
+		void group_by_influences(const SkinnedVertices& vertices, std::vector<unsigned>& indices, SkinPartition& partition)
+		{
+			if (vertices.m_influenceOrder.empty())
+			{
+				partition.m_influenceIndexCounts[2] = partition.m_indexCount;
+				return;
+			}
+
+			std::vector<unsigned> groups[3];
+			for (unsigned t = partition.m_firstIndex; t + 2 < partition.m_firstIndex + partition.m_indexCount; t += 3)
+			{
+				unsigned influences = 1;
+				for (int v = 0; v < 3; ++v)
+					influences = glm::max(influences, get_influence_count(vertices.m_weights[indices[t + v]]));
+
+				std::vector<unsigned>& group = groups[influences == 1 ? 0 : influences == 2 ? 1 : 2];
+				group.insert(group.end(), indices.begin() + t, indices.begin() + t + 3);
+			}
+
+			for (int g = 0; g < 2; ++g)
+			{
+				if (groups[g].size() / 3 < s_minTrianglesPerInfluenceGroup)
+				{
+					groups[g + 1].insert(groups[g + 1].end(), groups[g].begin(), groups[g].end());
+					groups[g].clear();
+				}
+			}
+
+			unsigned index = partition.m_firstIndex;
+			for (int g = 0; g < 3; ++g)
+			{
+				std::copy(groups[g].begin(), groups[g].end(), indices.begin() + index);
+				index += (unsigned)groups[g].size();
+				partition.m_influenceIndexCounts[g] = (unsigned)groups[g].size();
+			}
+		}
+	}
+
+
+	// Split the given triangles (3 indices each) in partitions that use at most maxJoints joints, counting only the joints
+	// with weight. The indices are reordered so that the triangles of each partition are contiguous, and grouped by the
+	// influences their vertices need if the weights were prepared. Returns false if a partition had to exceed maxJoints.
+	bool partition_skin(const SkinnedVertices& vertices, std::vector<unsigned>& indices, unsigned maxJoints, std::vector<SkinPartition>& partitions)
+	{
+		partitions.clear();
+		if (vertices.is_empty())
+			return true;
+
+		unsigned short maxJoint = 0;
+		for (const glm::u16vec4& joints : vertices.m_joints)
+			maxJoint = glm::max(maxJoint, glm::max(glm::max(joints.x, joints.y), glm::max(joints.z, joints.w)));
+		std::vector<int> localIdx(maxJoint + 1, -1);
+
+		// Common case, the whole primitive only needs one palette
+		SkinPartition whole;
+		std::vector<unsigned short> newJoints;
+		for (unsigned i = 0; i < vertices.get_vertex_count(); ++i)
+		{
+			newJoints.clear();
+			gather_new_joints(vertices, i, localIdx, newJoints);
+			for (unsigned short joint : newJoints)
+			{
+				localIdx[joint] = (int)whole.m_joints.size();
+				whole.m_joints.push_back(joint);
+			}
+		}
+		for (unsigned short joint : whole.m_joints)
+			localIdx[joint] = -1;
+
+		if (whole.m_joints.size() <= maxJoints || indices.size() < 3)
+		{
+			whole.m_indexCount = (unsigned)indices.size();
+			build_local_joints(vertices, nullptr, localIdx, whole);
+			group_by_influences(vertices, indices, whole);
+			partitions.push_back(std::move(whole));
+			return partitions.back().m_joints.size() <= maxJoints;
+		}
+
+		// Otherwise, add the triangles in their original order (usually coherent in space) to the current partition
+		// until the joints of the next one don't fit, and then start a new partition
+		bool fits = true;
+		std::vector<std::vector<unsigned>> partitionTriangles(1);
+		partitions.emplace_back();
+		for (size_t t = 0; t + 2 < indices.size(); t += 3)
+		{
+			newJoints.clear();
+			for (int v = 0; v < 3; ++v)
+				gather_new_joints(vertices, indices[t + v], localIdx, newJoints);
+
+			SkinPartition* current = &partitions.back();
+			if (current->m_joints.size() + newJoints.size() > maxJoints && !current->m_joints.empty())
+			{
+				for (unsigned short joint : current->m_joints)
+					localIdx[joint] = -1;
+				partitions.emplace_back();
+				partitionTriangles.emplace_back();
+				current = &partitions.back();
+
+				newJoints.clear();
+				for (int v = 0; v < 3; ++v)
+					gather_new_joints(vertices, indices[t + v], localIdx, newJoints);
+			}
+
+			for (unsigned short joint : newJoints)
+			{
+				localIdx[joint] = (int)current->m_joints.size();
+				current->m_joints.push_back(joint);
+			}
+			fits = fits && current->m_joints.size() <= maxJoints;
+			partitionTriangles.back().insert(partitionTriangles.back().end(), indices.begin() + t, indices.begin() + t + 3);
+		}
+		for (unsigned short joint : partitions.back().m_joints)
+			localIdx[joint] = -1;
+
+		// Write the triangles back grouped by partition
+		indices.clear();
+		for (unsigned p = 0; p < partitions.size(); ++p)
+		{
+			partitions[p].m_firstIndex = (unsigned)indices.size();
+			partitions[p].m_indexCount = (unsigned)partitionTriangles[p].size();
+			indices.insert(indices.end(), partitionTriangles[p].begin(), partitionTriangles[p].end());
+		}
+
+		for (SkinPartition& partition : partitions)
+		{
+			build_local_joints(vertices, indices.data(), localIdx, partition);
+			group_by_influences(vertices, indices, partition);
+		}
+
+		return fits;
+	}
+}
\ No newline at end of file
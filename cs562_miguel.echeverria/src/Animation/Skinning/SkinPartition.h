@@ -0,0 +1,37 @@
+/**
+* @file SkinPartition.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Load time compaction of the joints used by a skinned primitive. The
+*		 triangles are grouped in partitions that reference at most MAX_JOINTS
+*		 joints, and each partition is drawn with its own small palette.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "SkinWeights.h"
+
+
+namespace cs460
+{
+	// Group of triangles of a skinned primitive that is drawn with its own compact palette
+	struct SkinPartition
+	{
+		// Maximum size of a palette (has to match MAX_JOINTS in the shaders)
+		static const unsigned MAX_JOINTS = 128;
+
+		std::vector<unsigned short> m_joints;			// Skin joint of each entry of the local palette (sorted)
+		std::vector<glm::u8vec4> m_localJoints;			// Joints of every vertex as indices into m_joints (only valid for the vertices of this partition)
+		unsigned m_firstIndex = 0;						// Range of the partition in the reordered indices
+		unsigned m_indexCount = 0;
+		unsigned m_influenceIndexCounts[3] = { 0, 0, 0 };	// Indices of the triangles evaluated with 1, 2 and 4 influences, in this order from m_firstIndex
+	};
+
+
+	// Split the given triangles (3 indices each) in partitions that use at most maxJoints joints, counting only the joints
+	// with weight. The indices are reordered so that the triangles of each partition are contiguous, and grouped by the
+	// influences their vertices need if the weights were prepared. Returns false if a partition had to exceed maxJoints.
+	bool partition_skin(const SkinnedVertices& vertices, std::vector<unsigned>& indices, unsigned maxJoints, std::vector<SkinPartition>& partitions);
+}
\ No newline at end of file
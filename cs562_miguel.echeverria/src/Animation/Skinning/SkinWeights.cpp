@@ -0,0 +1,123 @@
+/**
+* @file SkinWeights.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Load time preprocessing of the skin weights. The influences of each
+*		 vertex are sorted, pruned, renormalized and quantized, and the vertices
+*		 are grouped by the number of influences the kernels have to evaluate.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "SkinWeights.h"
+#include <algorithm>
+
+
+namespace cs460
+{
+	namespace
+	{
+		// Quantize the weights (that add up to 1) so that the integers add up exactly to maxValue. The rounding
+		// error of the smaller weights goes to the first one, which is the biggest after sorting.
+		template <typename T>
+		void quantize_weights(glm::vec4& weights, float maxValue, T* result)
+		{
+			float remaining = maxValue;
+			for (int k = 3; k > 0; --k)
+			{
+				result[k] = (T)glm::round(weights[k] * maxValue);
+				remaining -= result[k];
+			}
+			result[0] = (T)remaining;
+
+			// Keep the exact values the gpu will see
+			for (int k = 0; k < 4; ++k)
+				weights[k] = result[k] / maxValue;
+		}
+	}
+
+
+	// Bytes taken by the four weights of a vertex in the given format
+	unsigned get_skin_weight_size(SkinWeightFormat format)
+	{
+		return format == SkinWeightFormat::UNORM8 ? 4 : 8;
+	}
+
+	// Number of influences the kernels evaluate for the given sorted weights (1, 2 or 4)
+	unsigned get_influence_count(const glm::vec4& weights)
+	{
+		if (weights.y == 0.0f)
+			return 1;
+		if (weights.z == 0.0f)
+			return 2;
+		return 4;
+	}
+
+
+	// Sort the influences of every vertex by weight, remove the ones below threshold and renormalize the rest. Then
+	// quantize the weights to the given format (quantized gets the data to upload, and m_weights the same values as
+	// floats, so the cpu and the gpu skin with the same weights) and group the vertices by influence count.
+	void prepare_skin_weights(SkinnedVertices& vertices, float threshold, SkinWeightFormat format, std::vector<unsigned char>& quantized)
+	{
+		unsigned count = vertices.get_vertex_count();
+		quantized.resize(count * get_skin_weight_size(format));
+
+		for (unsigned i = 0; i < count; ++i)
+		{
+			glm::u16vec4& joints = vertices.m_joints[i];
+			glm::vec4& weights = vertices.m_weights[i];
+
+			// Sort the influences from the biggest weight to the smallest
+			int order[4] = { 0, 1, 2, 3 };
+			std::sort(order, order + 4, [&weights](int a, int b) { return weights[a] > weights[b]; });
+			glm::u16vec4 sortedJoints(joints[order[0]], joints[order[1]], joints[order[2]], joints[order[3]]);
+			glm::vec4 sortedWeights(weights[order[0]], weights[order[1]], weights[order[2]], weights[order[3]]);
+
+			// Prune the small ones (always keeping the biggest) and renormalize. The removed influences point
+			// to the first joint, so that they don't add more joints to the palette of the primitive.
+			float sum = 0.0f;
+			for (int k = 0; k < 4; ++k)
+			{
+				if (k > 0 && sortedWeights[k] < threshold)
+				{
+					sortedWeights[k] = 0.0f;
+					sortedJoints[k] = sortedJoints[0];
+				}
+				sum += sortedWeights[k];
+			}
+			sortedWeights = sum > 0.0f ? sortedWeights / sum : glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+
+			if (format == SkinWeightFormat::UNORM8)
+				quantize_weights(sortedWeights, 255.0f, quantized.data() + i * 4);
+			else
+				quantize_weights(sortedWeights, 65535.0f, reinterpret_cast<unsigned short*>(quantized.data()) + i * 4);
+
+			// The weights that became 0 after quantizing are also removed
+			for (int k = 1; k < 4; ++k)
+				if (sortedWeights[k] == 0.0f)
+					sortedJoints[k] = sortedJoints[0];
+
+			joints = sortedJoints;
+			weights = sortedWeights;
+		}
+
+		// Group the vertices by influence count, keeping their order within each group
+		vertices.m_influenceOrder.resize(count);
+		for (unsigned i = 0; i < count; ++i)
+			vertices.m_influenceOrder[i] = i;
+		std::stable_sort(vertices.m_influenceOrder.begin(), vertices.m_influenceOrder.end(), [&vertices](unsigned a, unsigned b)
+		{
+			return get_influence_count(vertices.m_weights[a]) < get_influence_count(vertices.m_weights[b]);
+		});
+
+		unsigned groupEnd = 0;
+		const unsigned groupInfluences[3] = { 1, 2, 4 };
+		for (int g = 0; g < 3; ++g)
+		{
+			while (groupEnd < count && get_influence_count(vertices.m_weights[vertices.m_influenceOrder[groupEnd]]) == groupInfluences[g])
+				++groupEnd;
+			vertices.m_influenceGroupEnds[g] = groupEnd;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+/**
+* @file SkinWeights.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Load time preprocessing of the skin weights. The influences of each
+*		 vertex are sorted, pruned, renormalized and quantized, and the vertices
+*		 are grouped by the number of influences the kernels have to evaluate.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "SkinningCore.h"
+
+
+namespace cs460
+{
+	// Precision of the weights uploaded to the gpu (normalized integers)
+	enum class SkinWeightFormat
+	{
+		UNORM8,
+		UNORM16
+	};
+
+	// Bytes taken by the four weights of a vertex in the given format
+	unsigned get_skin_weight_size(SkinWeightFormat format);
+
+	// Number of influences the kernels evaluate for the given sorted weights (1, 2 or 4)
+	unsigned get_influence_count(const glm::vec4& weights);
+
+	// Sort the influences of every vertex by weight, remove the ones below threshold and renormalize the rest. Then
+	// quantize the weights to the given format (quantized gets the data to upload, and m_weights the same values as
+	// floats, so the cpu and the gpu skin with the same weights) and group the vertices by influence count.
+	void prepare_skin_weights(SkinnedVertices& vertices, float threshold, SkinWeightFormat format, std::vector<unsigned char>& quantized);
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+/**
+* @file SkinningCore.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief CPU implementation of the skinning done by the vertex shaders, for both
+*		 linear blend skinning and dual quaternion skinning. Used as a reference
+*		 to validate and compare the two modes.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "SkinningCore.h"
+
+
+namespace cs460
+{
+	const char* get_skinning_mode_name(SkinningMode mode)
+	{
+		switch (mode)
+		{
+		case SkinningMode::LINEAR:
+			return "Linear Blend";
+		case SkinningMode::DUAL_QUATERNION:
+			return "Dual Quaternion";
+		}
+		return "Unknown";
+	}
+
+
+	unsigned SkinnedVertices::get_vertex_count() const
+	{
+		return (unsigned)m_positions.size();
+	}
+
+	bool SkinnedVertices::is_empty() const
+	{
+		return m_positions.empty();
+	}
+
+
+	// Deform the positions of the given vertices like the shaders do in each mode
+	void skin_vertices_linear(const AffineTransform* palette, const SkinnedVertices& vertices, glm::vec3* result)
+	{
+		unsigned count = vertices.get_vertex_count();
+		for (unsigned i = 0; i < count; ++i)
+		{
+			const glm::u16vec4& joints = vertices.m_joints[i];
+			const glm::vec4& weights = vertices.m_weights[i];
+
+			// Blend the rows of the joint matrices
+			glm::vec4 rows[3];
+			for (int r = 0; r < 3; ++r)
+			{
+				rows[r] = palette[joints.x].m_rows[r] * weights.x + palette[joints.y].m_rows[r] * weights.y +
+						  palette[joints.z].m_rows[r] * weights.z + palette[joints.w].m_rows[r] * weights.w;
+			}
+
+			glm::vec4 pos(vertices.m_positions[i], 1.0f);
+			result[i] = glm::vec3(glm::dot(rows[0], pos), glm::dot(rows[1], pos), glm::dot(rows[2], pos));
+		}
+	}
+
+	void skin_vertices_dual_quat(const DualQuaternion* dualQuats, const SkinnedVertices& vertices, glm::vec3* result)
+	{
+		unsigned count = vertices.get_vertex_count();
+		for (unsigned i = 0; i < count; ++i)
+		{
+			const glm::u16vec4& joints = vertices.m_joints[i];
+			const glm::vec4& weights = vertices.m_weights[i];
+			const DualQuaternion& first = dualQuats[joints.x];
+
+			// Blend the dual quaternions, flipping them to the hemisphere of the first one
+			DualQuaternion blended;
+			blended.m_real = first.m_real * weights.x;
+			blended.m_dual = first.m_dual * weights.x;
+			for (int k = 1; k < 4; ++k)
+			{
+				const DualQuaternion& dq = dualQuats[joints[k]];
+				float w = glm::dot(first.m_real, dq.m_real) < 0.0f ? -weights[k] : weights[k];
+				blended.m_real += dq.m_real * w;
+				blended.m_dual += dq.m_dual * w;
+			}
+
+			// Normalize by the length of the real part
+			float invLength = 1.0f / glm::length(blended.m_real);
+			blended.m_real *= invLength;
+			blended.m_dual *= invLength;
+
+			result[i] = blended.transform_point(vertices.m_positions[i]);
+		}
+	}
+}
\ No newline at end of file
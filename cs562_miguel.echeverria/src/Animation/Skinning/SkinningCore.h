@@ -0,0 +1,50 @@
+/**
+* @file SkinningCore.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief CPU implementation of the skinning done by the vertex shaders, for both
+*		 linear blend skinning and dual quaternion skinning. Used as a reference
+*		 to validate and compare the two modes.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "DualQuaternion.h"
+
+
+namespace cs460
+{
+	// How the vertices of a skinned model are deformed by its joints
+	enum class SkinningMode
+	{
+		LINEAR,				// Blend the joint matrices (palette of affine transforms)
+		DUAL_QUATERNION		// Blend the joint dual quaternions (no scale, but preserves volume)
+	};
+
+	const char* get_skinning_mode_name(SkinningMode mode);
+
+
+	// Bind pose data of the vertices of a skinned primitive, kept on the cpu
+	struct SkinnedVertices
+	{
+		std::vector<glm::vec3> m_positions;
+		std::vector<glm::vec3> m_normals;			// Can be empty if the primitive has no normals
+		std::vector<glm::u16vec4> m_joints;
+		std::vector<glm::vec4> m_weights;
+
+		// Vertices sorted by influence count, and the end of the groups with 1, 2 and 4 influences
+		// in it (empty if the weights weren't prepared, then every vertex uses 4 influences)
+		std::vector<unsigned> m_influenceOrder;
+		unsigned m_influenceGroupEnds[3] = { 0, 0, 0 };
+
+		unsigned get_vertex_count() const;
+		bool is_empty() const;
+	};
+
+
+	// Deform the positions of the given vertices like the shaders do in each mode
+	void skin_vertices_linear(const AffineTransform* palette, const SkinnedVertices& vertices, glm::vec3* result);
+	void skin_vertices_dual_quat(const DualQuaternion* dualQuats, const SkinnedVertices& vertices, glm::vec3* result);
+}
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include "Gameplay/Systems/ScriptMgr.h"
 #include "Cameras/ICamera.h"
 #include "Animation/ParticleSimulations/ClothMgr.h"
+#include "Platform/JobSystem.h"
 
 
 namespace cs460
@@ -39,6 +40,11 @@ namespace cs460
 		if (!inputMgr.initialize())
 			return false;
 
+		// Start the job system (one thread per hardware thread)
+		JobSystem& jobSystem = JobSystem::get_instance();
+		if (!jobSystem.initialize())
+			return false;
+
 		// Initialize the animation system
 		Animator& animator = Animator::get_instance();
 		if (!animator.initialize())
@@ -70,6 +76,27 @@ namespace cs460
 
 	// Update of the engine and all its necessary systems
 	void Engine::update()
+	{
+		Renderer& renderer = Renderer::get_instance();
+
+		build_frame_graph();
+		
+		// Loop until the user closes the window (the stages change with the frame latency of the renderer)
+		while (!renderer.get_window().get_window_should_close())
+		{
+			if (renderer.get_frame_latency() != m_frameGraphLatency)
+				build_frame_graph();
+
+			m_frameGraph.execute();
+		}
+	}
+
+
+	// The stages are declared in the order they used to run in. Only the ones that don't touch
+	// the same data can overlap (like the cloths with the scripts, curves and animations).
+	// With one frame of latency, the meshes extracted in the previous frame are drawn while
+	// the simulation of the current one runs in the workers.
+	void Engine::build_frame_graph()
 	{
 		Renderer& renderer = Renderer::get_instance();
 		Animator& animator = Animator::get_instance();
@@ -81,51 +108,86 @@ namespace cs460
 		ScriptMgr& scriptMgr = ScriptMgr::get_instance();
 		ClothMgr& clothMgr = ClothMgr::get_instance();
 
-		
-		// Loop until the user closes the window
-		while (!renderer.get_window().get_window_should_close())
-		{
-			// Update all the model to local and model to world matrices
-			scene.update();
-
-			// Update the editor camera (the way the camera is organized will change)
-			scene.get_active_camera()->update();
-
-			// Do all the gui logic as well as the gizmos
-			editor.update();
-
-			// Update all the scripts
-			scriptMgr.update();
-
-			// Update all the piecewise curves
-			curveMgr.update();
-
-			// Update all the cloths
-			clothMgr.update();
-
-			// Update the animations and joint matrices
-			animator.update();
-
-			// Render the scene
-			renderer.render();
-
-			// Render the gui
-			editor.render();
-
-			// Update the input system (needs to be called just before polling for events)
-			inputMgr.update();
-
-			// Swap buffers, clear the back buffer and poll for events
-			renderer.get_window().update();
-
-			// Clear the frame buffer for the next frame
-			renderer.clear_fb();
-
-			MainMenuBarGUI::get_main_menu_bar_gui().load_scene();
-
-			// End the measurement and store a new dt
-			frc.end_frame();
-		}
+		using Res = FrameResource;
+		m_frameGraph.clear();
+		m_frameGraphLatency = renderer.get_frame_latency();
+
+		// Update all the model to local and model to world matrices (ctrl + r clears the scene). Also
+		// compacts the transform arrays after nodes are deleted, which moves the local transforms.
+		m_frameGraph.add_task("Scene", [&scene]() { scene.update(); },
+			Res::INPUT | Res::NODE_TRANSFORMS | Res::JOINT_TRANSFORMS, Res::SCENE_GRAPH | Res::NODE_TRANSFORMS | Res::WORLD_TRANSFORMS | Res::JOINT_TRANSFORMS);
+
+		// Update the editor camera (the way the camera is organized will change)
+		m_frameGraph.add_task("Camera", [&scene]() { scene.get_active_camera()->update(); },
+			Res::INPUT | Res::TIME | Res::GUI | Res::WORLD_TRANSFORMS, Res::CAMERA, true);
+
+		// Do all the gui logic as well as the gizmos (it can modify anything)
+		m_frameGraph.add_task("Editor", [&editor]() { editor.update(); },
+			Res::ALL, Res::ALL & ~(Res::INPUT | Res::TIME | Res::FRAMEBUFFER), true);
+
+		// Update all the scripts
+		m_frameGraph.add_task("Scripts", [&scriptMgr]() { scriptMgr.update(); },
+			Res::INPUT | Res::TIME | Res::CAMERA | Res::WORLD_TRANSFORMS, Res::NODE_TRANSFORMS | Res::ANIMATION_STATE);
+
+		// Update all the piecewise curves (they move their followers and sync their animations)
+		m_frameGraph.add_task("Curves", [&curveMgr]() { curveMgr.update(); },
+			Res::TIME | Res::NODE_TRANSFORMS, Res::CURVES | Res::NODE_TRANSFORMS | Res::ANIMATION_STATE);
+
+		// Update all the cloths (they collide with the world transform of their spheres)
+		m_frameGraph.add_task("Cloth", [&clothMgr]() { clothMgr.update(); },
+			Res::TIME | Res::WORLD_TRANSFORMS, Res::CLOTH);
+
+		// Update the animations, the ik chains and the joint matrices
+		m_frameGraph.add_task("Animations", [&animator]() { animator.update_animations(); },
+			Res::TIME | Res::ANIMATION_STATE, Res::ANIMATION_STATE | Res::JOINT_TRANSFORMS);
+		m_frameGraph.add_task("IK Chains", [&animator]() { animator.update_ik_chains(); },
+			Res::WORLD_TRANSFORMS | Res::JOINT_TRANSFORMS, Res::JOINT_TRANSFORMS);
+		m_frameGraph.add_task("Skins", [&animator]() { animator.update_skins(); },
+			Res::WORLD_TRANSFORMS | Res::JOINT_TRANSFORMS, Res::SKIN_MATRICES);
+
+		// Copy what the renderer needs from the scene
+		m_frameGraph.add_task("Extract Render View", [&renderer]() { renderer.extract_render_view(); },
+			Res::INPUT | Res::SCENE_GRAPH | Res::WORLD_TRANSFORMS | Res::JOINT_TRANSFORMS | Res::SKIN_MATRICES | Res::CLOTH | Res::CAMERA,
+			Res::RENDER_EXTRACT);
+
+		// Render the meshes and cloths of the view just extracted, or of the previous one (which doesn't wait for the simulation)
+		m_frameGraph.add_task("Render", [&renderer]() { renderer.render(); },
+			m_frameGraphLatency == 0 ? Res::RENDER_EXTRACT : Res::RENDER_VIEW, Res::FRAMEBUFFER, true);
+
+		// Render the skybox and the debug drawing
+		m_frameGraph.add_task("Render Overlays", [&renderer]() { renderer.render_overlays(); },
+			Res::ALL & ~(Res::FRAMEBUFFER | Res::RENDER_EXTRACT | Res::RENDER_VIEW), Res::FRAMEBUFFER, true);
+
+		// Render the gui
+		m_frameGraph.add_task("Editor Render", [&editor]() { editor.render(); },
+			Res::GUI, Res::GUI | Res::FRAMEBUFFER, true);
+
+		// Update the input system (needs to be called just before polling for events)
+		m_frameGraph.add_task("Input", [&inputMgr]() { inputMgr.update(); },
+			Res::NONE, Res::INPUT, true);
+
+		// Swap buffers, clear the back buffer and poll for events
+		m_frameGraph.add_task("Window", [&renderer]() { renderer.get_window().update(); },
+			Res::NONE, Res::INPUT | Res::FRAMEBUFFER, true);
+
+		// Clear the frame buffer for the next frame
+		m_frameGraph.add_task("Clear", [&renderer]() { renderer.clear_fb(); },
+			Res::NONE, Res::FRAMEBUFFER, true);
+
+		// The view just extracted will be drawn in the next frame
+		m_frameGraph.add_task("Swap Render Views", [&renderer]() { renderer.swap_render_views(); },
+			Res::NONE, Res::RENDER_EXTRACT | Res::RENDER_VIEW);
+
+		// Create and destroy the nodes and components requested during the frame (no system is iterating them now)
+		m_frameGraph.add_task("Scene Commands", [&scene]() { scene.apply_commands(); },
+			Res::NONE, Res::ALL & ~(Res::INPUT | Res::TIME), true);
+
+		m_frameGraph.add_task("Load Scene", []() { MainMenuBarGUI::get_main_menu_bar_gui().load_scene(); },
+			Res::NONE, Res::ALL & ~(Res::INPUT | Res::TIME), true);
+
+		// End the measurement and store a new dt. It resets the frame arenas, so it goes after everything else.
+		m_frameGraph.add_task("End Frame", [&frc]() { frc.end_frame(); },
+			Res::ALL, Res::TIME, true);
 	}
 
 
@@ -135,6 +197,7 @@ namespace cs460
 		Scene::get_instance().close();					// Release the memory of all the scene nodes
 		Editor::get_instance().close();					// Terminate imgui
 		Animator::get_instance().close();				// Terminate the animation system
+		JobSystem::get_instance().close();				// Join the worker threads
 		InputMgr::get_instance().close();
 		Renderer::get_instance().close();
 		Renderer::get_instance().get_window().close();	// Terminate glfw
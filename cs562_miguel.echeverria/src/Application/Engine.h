@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "FrameTaskGraph.h"
+
 
 namespace cs460
 {
@@ -21,6 +23,11 @@ namespace cs460
 		void close();		// Close the engine by releasing any resources in use
 
 	private:
-		
+
+		// Stages of every frame, and the data each one reads and writes
+		FrameTaskGraph m_frameGraph;
+		unsigned m_frameGraphLatency = 0;		// Frame latency of the renderer when the graph was built
+
+		void build_frame_graph();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,339 @@
+/**
+* @file FrameTaskGraph.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Graph of the stages executed every frame. Each stage declares the data it
+*		 reads and writes, the dependencies are found from that, and the stages
+*		 that don't depend on each other run at the same time in the job system.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "FrameTaskGraph.h"
+
+
+namespace cs460
+{
+	bool FrameTaskGraph::s_dumpNextFrame = false;
+
+
+	// Add a stage at the end of the frame. It will run after every previous stage that writes something it
+	// reads or writes, and after every previous stage that reads something it writes. Main thread stages
+	// (like the ones using OpenGL or imgui) never run in the workers. Returns the index of the task.
+	unsigned FrameTaskGraph::add_task(const std::string& name, TaskFunction func, FrameResource reads, FrameResource writes, bool mainThread)
+	{
+		unsigned taskIdx = (unsigned)m_tasks.size();
+
+		Task task;
+		task.m_name = name;
+		task.m_func = func;
+		task.m_reads = (unsigned)reads;
+		task.m_writes = (unsigned)writes;
+		task.m_mainThread = mainThread;
+
+		// The resources whose last writer/readers still need to be found
+		unsigned readsLeft = task.m_reads;
+		unsigned writesLeft = task.m_writes;
+
+		for (int i = (int)taskIdx - 1; i >= 0 && (readsLeft | writesLeft) != 0; --i)
+		{
+			Task& prev = m_tasks[i];
+
+			// Read after write, write after write, and write after read
+			unsigned hazards = (prev.m_writes & (readsLeft | writesLeft)) | (prev.m_reads & writesLeft);
+			if (hazards == 0)
+				continue;
+
+			task.m_dependencies.push_back(i);
+			prev.m_successors.push_back(taskIdx);
+
+			// Anything before the last writer of a resource is already ordered through it
+			readsLeft &= ~prev.m_writes;
+			writesLeft &= ~prev.m_writes;
+		}
+
+		m_tasks.push_back(task);
+		return taskIdx;
+	}
+
+	void FrameTaskGraph::clear()
+	{
+		m_tasks.clear();
+		m_criticalPath.clear();
+	}
+
+
+	// Run all the stages of one frame. Must be called from the main thread.
+	void FrameTaskGraph::execute()
+	{
+		JobSystem& jobSystem = JobSystem::get_instance();
+
+		if (m_pendingDeps.size() != m_tasks.size())
+			m_pendingDeps = std::vector<std::atomic<int>>(m_tasks.size());
+
+		for (unsigned i = 0; i < m_tasks.size(); ++i)
+			m_pendingDeps[i] = (int)m_tasks[i].m_dependencies.size();
+
+		m_frameStart = std::chrono::high_resolution_clock::now();
+		m_tasksLeft = (int)m_tasks.size();
+
+		for (unsigned i = 0; i < m_tasks.size(); ++i)
+			if (m_tasks[i].m_dependencies.empty())
+				schedule(i);
+
+		// Run the main thread stages as they become ready, and help the workers in the meantime
+		while (m_tasksLeft > 0)
+		{
+			int taskIdx = -1;
+			{
+				std::lock_guard<std::mutex> lock(m_mainQueueMutex);
+				if (!m_mainQueue.empty())
+				{
+					taskIdx = m_mainQueue.front();
+					m_mainQueue.erase(m_mainQueue.begin());
+				}
+			}
+
+			if (taskIdx >= 0)
+				run_task(taskIdx);
+			else if (!jobSystem.run_pending_job())
+				std::this_thread::yield();
+		}
+
+		m_frameMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_frameStart).count();
+		compute_critical_path();
+		compute_overlaps();
+
+		if (s_dumpNextFrame)
+		{
+			s_dumpNextFrame = false;
+			dump(std::cout);
+			if (write_dot("frame_graph.dot"))
+				std::cout << "Frame task graph written to frame_graph.dot\n";
+		}
+	}
+
+
+	// Print the stages, their dependencies, the timings of the last frame and the critical path. Also
+	// prints how long each stage ran in parallel with others on average, and resets those averages.
+	void FrameTaskGraph::dump(std::ostream& os)
+	{
+		os << "Frame task graph: " << m_tasks.size() << " stages, " << JobSystem::get_instance().get_thread_count() << " threads\n";
+
+		for (unsigned i = 0; i < m_tasks.size(); ++i)
+		{
+			const Task& task = m_tasks[i];
+
+			os << "  [" << i << "] " << task.m_name << (task.m_mainThread ? " (main thread)" : "") << "\n";
+			os << "      reads: " << resources_to_string(task.m_reads) << "\n";
+			os << "      writes: " << resources_to_string(task.m_writes) << "\n";
+			os << "      after:";
+			for (unsigned dep : task.m_dependencies)
+				os << " " << m_tasks[dep].m_name;
+			os << "\n";
+			os << "      last frame: " << task.m_startMs << " - " << task.m_endMs << " ms on thread " << task.m_threadIdx << "\n";
+			if (m_measuredFrames > 0)
+			{
+				os << "      average of " << m_measuredFrames << " frames: " << task.m_totalMs / m_measuredFrames << " ms, "
+					<< task.m_totalParallelMs / m_measuredFrames << " ms of it in parallel with other stages\n";
+			}
+		}
+
+		os << "Frame: " << m_frameMs << " ms, critical path: " << m_criticalPathMs << " ms\n  ";
+		for (unsigned i = 0; i < m_criticalPath.size(); ++i)
+			os << (i > 0 ? " -> " : "") << m_tasks[m_criticalPath[i]].m_name;
+		os << "\n";
+
+		for (Task& task : m_tasks)
+		{
+			task.m_totalMs = 0.0;
+			task.m_totalParallelMs = 0.0;
+		}
+		m_measuredFrames = 0;
+	}
+
+	// Write the graph in graphviz format, with the critical path highlighted
+	bool FrameTaskGraph::write_dot(const std::string& filename) const
+	{
+		std::ofstream file(filename);
+		if (!file.is_open())
+		{
+			std::cout << "ERROR: Could not open " << filename << " to write the frame task graph\n";
+			return false;
+		}
+
+		// Task that comes before each task in the critical path (-1 if not in it)
+		std::vector<bool> inCriticalPath(m_tasks.size(), false);
+		std::vector<int> criticalPrevious(m_tasks.size(), -1);
+		for (unsigned i = 0; i < m_criticalPath.size(); ++i)
+		{
+			inCriticalPath[m_criticalPath[i]] = true;
+			if (i > 0)
+				criticalPrevious[m_criticalPath[i]] = m_criticalPath[i - 1];
+		}
+
+		file << "digraph FrameTaskGraph {\n";
+		file << "  node [shape=box];\n";
+		for (unsigned i = 0; i < m_tasks.size(); ++i)
+		{
+			const Task& task = m_tasks[i];
+			file << "  t" << i << " [label=\"" << task.m_name << "\\n" << task.m_endMs - task.m_startMs << " ms\"";
+			if (task.m_mainThread)
+				file << " style=filled fillcolor=lightgrey";
+			if (inCriticalPath[i])
+				file << " color=red penwidth=2";
+			file << "];\n";
+		}
+
+		for (unsigned i = 0; i < m_tasks.size(); ++i)
+		{
+			for (unsigned dep : m_tasks[i].m_dependencies)
+			{
+				file << "  t" << dep << " -> t" << i;
+				if (criticalPrevious[i] == (int)dep)
+					file << " [color=red penwidth=2]";
+				file << ";\n";
+			}
+		}
+		file << "}\n";
+
+		return true;
+	}
+
+
+	// Duration of the last frame, and of the longest chain of dependent stages in it
+	double FrameTaskGraph::get_frame_ms() const
+	{
+		return m_frameMs;
+	}
+
+	double FrameTaskGraph::get_critical_path_ms() const
+	{
+		return m_criticalPathMs;
+	}
+
+
+	// Queue a task whose dependencies are done
+	void FrameTaskGraph::schedule(unsigned taskIdx)
+	{
+		if (m_tasks[taskIdx].m_mainThread)
+		{
+			std::lock_guard<std::mutex> lock(m_mainQueueMutex);
+			m_mainQueue.push_back(taskIdx);
+		}
+		else
+			JobSystem::get_instance().submit([this, taskIdx]() { run_task(taskIdx); });
+	}
+
+	// Run a task and schedule the successors that become ready
+	void FrameTaskGraph::run_task(unsigned taskIdx)
+	{
+		Task& task = m_tasks[taskIdx];
+
+		auto start = std::chrono::high_resolution_clock::now();
+		task.m_func();
+		auto end = std::chrono::high_resolution_clock::now();
+
+		task.m_startMs = std::chrono::duration<double, std::milli>(start - m_frameStart).count();
+		task.m_endMs = std::chrono::duration<double, std::milli>(end - m_frameStart).count();
+		task.m_threadIdx = JobSystem::get_instance().get_thread_index();
+
+		for (unsigned successor : task.m_successors)
+			if (--m_pendingDeps[successor] == 0)
+				schedule(successor);
+
+		--m_tasksLeft;
+	}
+
+
+	// Find the longest chain of dependent stages using the timings of the last frame
+	void FrameTaskGraph::compute_critical_path()
+	{
+		m_criticalPath.clear();
+		m_criticalPathMs = 0.0;
+		if (m_tasks.empty())
+			return;
+
+		// Longest chain ending at each task (the tasks are already in topological order)
+		std::vector<double> chainMs(m_tasks.size(), 0.0);
+		std::vector<int> previous(m_tasks.size(), -1);
+		unsigned lastTask = 0;
+
+		for (unsigned i = 0; i < m_tasks.size(); ++i)
+		{
+			for (unsigned dep : m_tasks[i].m_dependencies)
+			{
+				if (chainMs[dep] > chainMs[i])
+				{
+					chainMs[i] = chainMs[dep];
+					previous[i] = dep;
+				}
+			}
+
+			chainMs[i] += m_tasks[i].m_endMs - m_tasks[i].m_startMs;
+			if (chainMs[i] > chainMs[lastTask])
+				lastTask = i;
+		}
+
+		m_criticalPathMs = chainMs[lastTask];
+		for (int taskIdx = lastTask; taskIdx >= 0; taskIdx = previous[taskIdx])
+			m_criticalPath.push_back(taskIdx);
+		std::reverse(m_criticalPath.begin(), m_criticalPath.end());
+	}
+
+	// Add the time each stage ran at the same time as any other in the last frame to its sums
+	void FrameTaskGraph::compute_overlaps()
+	{
+		for (unsigned i = 0; i < m_tasks.size(); ++i)
+		{
+			Task& task = m_tasks[i];
+
+			// Parts of the other stages that happened while this one was running
+			m_intervals.clear();
+			for (unsigned j = 0; j < m_tasks.size(); ++j)
+			{
+				double start = std::max(m_tasks[j].m_startMs, task.m_startMs);
+				double end = std::min(m_tasks[j].m_endMs, task.m_endMs);
+				if (j != i && start < end)
+					m_intervals.push_back({ start, end });
+			}
+
+			// Length of their union
+			std::sort(m_intervals.begin(), m_intervals.end());
+			double parallelMs = 0.0;
+			double coveredUntil = task.m_startMs;
+			for (const std::pair<double, double>& interval : m_intervals)
+			{
+				double start = std::max(interval.first, coveredUntil);
+				if (interval.second > start)
+				{
+					parallelMs += interval.second - start;
+					coveredUntil = interval.second;
+				}
+			}
+
+			task.m_totalMs += task.m_endMs - task.m_startMs;
+			task.m_totalParallelMs += parallelMs;
+		}
+
+		++m_measuredFrames;
+	}
+
+	// Names of the resources in the given flags
+	std::string FrameTaskGraph::resources_to_string(unsigned resources)
+	{
+		static const char* names[] = { "INPUT", "TIME", "SCENE_GRAPH", "NODE_TRANSFORMS", "WORLD_TRANSFORMS", "JOINT_TRANSFORMS",
+									   "ANIMATION_STATE", "SKIN_MATRICES", "CURVES", "CLOTH", "CAMERA", "GUI", "FRAMEBUFFER",
+									   "RENDER_EXTRACT", "RENDER_VIEW" };
+
+		std::string result;
+		for (unsigned i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+		{
+			if (resources & (1u << i))
+				result += (result.empty() ? "" : " ") + std::string(names[i]);
+		}
+
+		return result.empty() ? "-" : result;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+/**
+* @file FrameTaskGraph.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Graph of the stages executed every frame. Each stage declares the data it
+*		 reads and writes, the dependencies are found from that, and the stages
+*		 that don't depend on each other run at the same time in the job system.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "Platform/JobSystem.h"
+#include <chrono>
+
+
+namespace cs460
+{
+	// Data shared between the stages of a frame (used as flags)
+	enum class FrameResource : unsigned
+	{
+		NONE = 0,
+		INPUT = 1,
+		TIME = 2,
+		SCENE_GRAPH = 4,			// Creation and destruction of nodes and components
+		NODE_TRANSFORMS = 8,		// Local transforms of the nodes that aren't joints
+		WORLD_TRANSFORMS = 16,		// World transforms of the nodes that aren't joints
+		JOINT_TRANSFORMS = 32,		// Local and world transforms of the joints of the skeletons
+		ANIMATION_STATE = 64,		// Timers, time scales and blend parameters of the animations
+		SKIN_MATRICES = 128,
+		CURVES = 256,
+		CLOTH = 512,
+		CAMERA = 1024,
+		GUI = 2048,
+		FRAMEBUFFER = 4096,
+		RENDER_EXTRACT = 8192,		// Render view being filled from the scene
+		RENDER_VIEW = 16384,		// Render view being drawn
+
+		ALL = 32767
+	};
+
+	inline FrameResource operator|(FrameResource lhs, FrameResource rhs) { return FrameResource((unsigned)lhs | (unsigned)rhs); }
+	inline FrameResource operator&(FrameResource lhs, FrameResource rhs) { return FrameResource((unsigned)lhs & (unsigned)rhs); }
+	inline FrameResource operator~(FrameResource res) { return FrameResource(~(unsigned)res & (unsigned)FrameResource::ALL); }
+
+
+	class FrameTaskGraph
+	{
+	public:
+
+		using TaskFunction = std::function<void()>;
+
+		// Add a stage at the end of the frame. It will run after every previous stage that writes something it
+		// reads or writes, and after every previous stage that reads something it writes. Main thread stages
+		// (like the ones using OpenGL or imgui) never run in the workers. Returns the index of the task.
+		unsigned add_task(const std::string& name, TaskFunction func, FrameResource reads, FrameResource writes, bool mainThread = false);
+		void clear();
+
+		// Run all the stages of one frame. Must be called from the main thread.
+		void execute();
+
+		// Print the stages, their dependencies, the timings of the last frame and the critical path. Also
+		// prints how long each stage ran in parallel with others on average, and resets those averages.
+		void dump(std::ostream& os);
+
+		// Write the graph in graphviz format, with the critical path highlighted
+		bool write_dot(const std::string& filename) const;
+
+		// Duration of the last frame, and of the longest chain of dependent stages in it
+		double get_frame_ms() const;
+		double get_critical_path_ms() const;
+
+		// If set, the graph is dumped to the console and to frame_graph.dot after the next frame
+		static bool s_dumpNextFrame;
+
+	private:
+
+		struct Task
+		{
+			std::string m_name;
+			TaskFunction m_func;
+			unsigned m_reads = 0;
+			unsigned m_writes = 0;
+			bool m_mainThread = false;
+			std::vector<unsigned> m_dependencies;
+			std::vector<unsigned> m_successors;
+
+			// Timings of the last frame (milliseconds since the start of the frame)
+			double m_startMs = 0.0;
+			double m_endMs = 0.0;
+			unsigned m_threadIdx = 0;
+
+			// Sums since the last dump of the duration of the stage and of the time other stages were running with it
+			double m_totalMs = 0.0;
+			double m_totalParallelMs = 0.0;
+		};
+
+		std::vector<Task> m_tasks;							// In topological order, as dependencies always go backwards
+		std::vector<std::atomic<int>> m_pendingDeps;		// Dependencies left for each task in the current frame
+		std::atomic<int> m_tasksLeft{ 0 };
+
+		// Main thread stages ready to run
+		std::mutex m_mainQueueMutex;
+		std::vector<unsigned> m_mainQueue;
+
+		std::chrono::high_resolution_clock::time_point m_frameStart;
+		double m_frameMs = 0.0;
+		double m_criticalPathMs = 0.0;
+		std::vector<unsigned> m_criticalPath;
+		unsigned m_measuredFrames = 0;						// Frames added to the sums of the stages
+		std::vector<std::pair<double, double>> m_intervals;	// Temporary storage of compute_overlaps
+
+		// Queue a task whose dependencies are done
+		void schedule(unsigned taskIdx);
+
+		// Run a task and schedule the successors that become ready
+		void run_task(unsigned taskIdx);
+
+		// Find the longest chain of dependent stages using the timings of the last frame
+		void compute_critical_path();
+
+		// Add the time each stage ran at the same time as any other in the last frame to its sums
+		void compute_overlaps();
+
+		// Names of the resources in the given flags
+		static std::string resources_to_string(unsigned resources);
+	};
+}
\ No newline at end of file
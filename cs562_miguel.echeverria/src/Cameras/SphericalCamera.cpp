@@ -184,7 +184,7 @@ namespace cs460
 	{
 		glm::vec3 realFocalPoint;
 		if (m_focalNode)
-			realFocalPoint = m_focalNode->m_worldTr.m_position;
+			realFocalPoint = m_focalNode->get_world_tr().m_position;
 		else
 			realFocalPoint = m_focalPoint;
 		return realFocalPoint + m_focalOffset;
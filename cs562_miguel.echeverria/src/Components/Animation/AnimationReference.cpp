@@ -22,7 +22,9 @@
 #include "Animation/Blending/Blend1D.h"
 #include "Animation/Blending/Blend2D.h"
 #include "Animation/Blending/BlendAnim.h"
+#include "Animation/Blending/BlendLayer.h"
 #include "Math/Geometry/IntersectionTests.h"
+#include "Resources/ResourceManager.h"
 
 
 namespace cs460
@@ -58,9 +60,10 @@ namespace cs460
 				return;
 			if (m_blendTreeType == 2 && m_2dBlendTree == nullptr)
 				return;
+			if (m_blendTreeType == 3 && m_layerBlendTree == nullptr)
+				return;
 
-			get_blend_tree()->produce_pose(m_animTimer);
-			apply_pose_to_skeleton(get_blend_tree()->m_pose, this);
+			update_blend_program();
 		}
 		else
 		{
@@ -68,8 +71,9 @@ namespace cs460
 			if (m_animIdx < 0 || m_paused)
 				return;
 
-			// Update the properties of the animation
-			update_properties();
+			// Update the properties of the animation (the skins look up the baked palettes with the timer instead)
+			if (!m_bakedPalettes)
+				update_properties();
 		}
 		
 		// Update the timer of the animation
@@ -84,6 +88,21 @@ namespace cs460
 			m_animTimer = 0.0f;
 	}
 
+	// Evaluate the compiled blend tree (compiling it first if it has changed)
+	void AnimationReference::update_blend_program()
+	{
+		if (m_blendProgramDirty)
+		{
+			m_blendProgram.compile(get_blend_tree(), get_owner()->get_model(), &m_blendProgramNodes);
+			m_blendProgram.init_instance(m_blendInstance, this);
+			m_blendProgramDirty = false;
+		}
+
+		m_blendProgram.gather_params(m_blendProgramNodes, m_blendInstance);
+		m_blendInstance.m_time = m_animTimer;
+		m_blendProgram.execute(m_blendInstance);
+	}
+
 	void AnimationReference::update_properties()
 	{
 		Model* model = get_owner()->get_model();
@@ -91,7 +110,7 @@ namespace cs460
 		for (int i = 0; i < m_animProperties.size(); ++i)
 		{
 			// Go to the next if there is no property to update
-			if (m_animProperties[i].m_property == nullptr)
+			if (m_animProperties[i].m_targetNode == nullptr)
 				continue;
 
 			// Get the animation data and number of components in this property
@@ -101,26 +120,28 @@ namespace cs460
 			int componentCount = data.m_componentCount;
 			
 
+			float* property = m_animProperties[i].get_property();
+
 			// Interpolate the current property based on the animation timer and the interpolation method
 			if (m_animProperties[i].m_interpolationMode == INTERPOLATION_MODE::LERP)
 			{
 				const glm::vec3& interpolatedVal = piecewise_lerp(data.m_keys, data.m_values, m_animTimer);
-				std::memcpy(m_animProperties[i].m_property, glm::value_ptr(interpolatedVal), 3 * sizeof(float));
+				std::memcpy(property, glm::value_ptr(interpolatedVal), 3 * sizeof(float));
 			}
 			else if (m_animProperties[i].m_interpolationMode == INTERPOLATION_MODE::SLERP)
 			{
 				const glm::quat& interpolatedVal = piecewise_slerp(data.m_keys, data.m_values, m_animTimer);
-				std::memcpy(m_animProperties[i].m_property, glm::value_ptr(interpolatedVal), 4 * sizeof(float));
+				std::memcpy(property, glm::value_ptr(interpolatedVal), 4 * sizeof(float));
 			}
 			if (m_animProperties[i].m_interpolationMode == INTERPOLATION_MODE::STEP)
 			{
 				const glm::vec3& interpolatedVal = piecewise_step(data.m_keys, data.m_values, m_animTimer);
-				std::memcpy(m_animProperties[i].m_property, glm::value_ptr(interpolatedVal), 3 * sizeof(float));
+				std::memcpy(property, glm::value_ptr(interpolatedVal), 3 * sizeof(float));
 			}
 			if (m_animProperties[i].m_interpolationMode == INTERPOLATION_MODE::CUBIC_SPLINE)
 			{
 				const glm::vec3& interpolatedVal = piecewise_hermite(data.m_keys, data.m_values, m_animTimer);
-				std::memcpy(m_animProperties[i].m_property, glm::value_ptr(interpolatedVal), 3 * sizeof(float));
+				std::memcpy(property, glm::value_ptr(interpolatedVal), 3 * sizeof(float));
 			}
 		}
 	}
@@ -145,6 +166,9 @@ namespace cs460
 		ImGui::SameLine();
 		if (ImGui::RadioButton("2D Blend", &m_blendTreeType, 2))
 			set_blend_tree_type(2);
+		ImGui::SameLine();
+		if (ImGui::RadioButton("Layered", &m_blendTreeType, 3))
+			set_blend_tree_type(3);
 
 		if (ImGui::Button("Add Anim Node"))
 		{
@@ -168,6 +192,11 @@ namespace cs460
 			blend_2d_editor();
 			blend_node_gui(m_pickedNode);
 		}
+		else if (m_blendTreeType == 3)
+		{
+			ImGui::Text("The first node is the base pose, the rest are layered on top");
+			blend_layer_editor();
+		}
 
 		if (m_blendTreeType > 0)
 			return;
@@ -190,6 +219,9 @@ namespace cs460
 
 		ImGui::Checkbox("Loop", &m_looping);
 		ImGui::Checkbox("Paused", &m_paused);
+		bool bakedPalettes = m_bakedPalettes;
+		if (ImGui::Checkbox("Baked Palettes", &bakedPalettes))
+			set_baked_palettes(bakedPalettes);
 		ImGui::SliderFloat("Time Scale", &m_timeScale, 0.01f, 5.0f, "%.2f");
 	}
 
@@ -215,14 +247,13 @@ namespace cs460
 		drawList->AddRectFilled(editorMin, editorMax, IM_COL32(BACKGROUND_COLOR.r, BACKGROUND_COLOR.g, BACKGROUND_COLOR.b, BACKGROUND_COLOR.a), 5.0f);
 
 		
-		// Sort the blend nodes first, to know the length of the blendspace
+		// The blend nodes are kept sorted, so the first and last give the length of the blendspace
 		Blend1D* blendTree = dynamic_cast<Blend1D*>(get_blend_tree());
 		if (blendTree->m_children.empty())
 		{
 			drawList->PopClipRect();
 			return;
 		}
-		blendTree->sort_children();
 
 		IBlendNode* first = blendTree->m_children.front();
 		IBlendNode* last = blendTree->m_children.back();
@@ -393,6 +424,54 @@ namespace cs460
 	}
 
 
+	void AnimationReference::blend_layer_editor()
+	{
+		BlendLayer* blendTree = dynamic_cast<BlendLayer*>(get_blend_tree());
+		Model* model = get_owner()->get_model();
+
+		for (int i = 0; i < blendTree->m_children.size(); ++i)
+		{
+			IBlendNode* layer = blendTree->m_children[i];
+			ImGui::PushID(i);
+			ImGui::Separator();
+
+			if (i == 0)
+				ImGui::Text("Base");
+			else
+				ImGui::Text("Layer %d (%d joints in mask, 0=all)", i, (int)layer->m_blendMask.size());
+
+			BlendAnim* animNode = dynamic_cast<BlendAnim*>(layer);
+			if (animNode)
+				display_blend_animations_gui(animNode);
+
+			// The layers can be restricted to a joint and its descendants
+			if (i > 0 && ImGui::BeginCombo("Mask Root Joint", "Select"))
+			{
+				if (ImGui::Selectable("None (whole skeleton)"))
+					layer->set_blend_mask(BlendMask());
+
+				for (int j = 0; j < model->m_nodes.size(); j++)
+				{
+					if (ImGui::Selectable(model->m_nodes[j].m_name.c_str()))
+						layer->set_blend_mask(create_hierarchy_mask(model, j));
+				}
+
+				ImGui::EndCombo();
+			}
+
+			// Always keep the base and at least one layer
+			if (i > 0 && blendTree->m_children.size() > 2 && ImGui::Button("Delete Layer"))
+			{
+				blendTree->remove_child(layer);
+				ImGui::PopID();
+				break;
+			}
+
+			ImGui::PopID();
+		}
+	}
+
+
 	void AnimationReference::blend_param_picking(const glm::vec2& windowCoordsStart, const glm::vec2& windowCoordsEnd, const ImVec2& rectMin, const ImVec2& rectMax, const glm::vec2& blendSpaceMin, const glm::vec2& blendSpaceMax, IBlendNode* blendTree)
 	{
 		static bool draggingBlendParam = false;
@@ -455,7 +534,6 @@ namespace cs460
 
 		if (tree1d)
 		{
-			tree1d->sort_children();
 			minPos = tree1d->m_children.front()->m_blendPos;
 			maxPos = tree1d->m_children.back()->m_blendPos;
 		}
@@ -505,13 +583,18 @@ namespace cs460
 		if ((blend1d && m_blendTreeType != 1) || (blend2d && m_blendTreeType != 2))
 			return;
 
-		ImGui::SliderFloat("X##0", &node->m_blendPos.x, -4.0f, 4.0f, "%.3f");
+		// Go through set_blend_pos so that the parent can react to the change (i.e. 1D blend nodes re-sort their children)
+		glm::vec2 blendPos = node->m_blendPos;
+		bool blendPosChanged = ImGui::SliderFloat("X##0", &blendPos.x, -4.0f, 4.0f, "%.3f");
 
 		if (blend2d)
 		{
-			ImGui::SliderFloat("Y##1", &node->m_blendPos.y, -4.0f, 4.0f, "%.3f");
+			blendPosChanged |= ImGui::SliderFloat("Y##1", &blendPos.y, -4.0f, 4.0f, "%.3f");
 		}
 
+		if (blendPosChanged)
+			node->set_blend_pos(blendPos);
+
 		// Allow choosing of animation if it is a blend anim node
 		BlendAnim* animNode = dynamic_cast<BlendAnim*>(node);
 		if (animNode)
@@ -546,7 +629,7 @@ namespace cs460
 			{
 				if (ImGui::Selectable(model->m_animations[i].m_name.c_str()))
 				{
-					animNode->m_animSource = &model->m_animations[i];
+					animNode->set_anim_source(&model->m_animations[i]);
 				}
 			}
 
@@ -594,12 +677,13 @@ namespace cs460
 			
 			// Get the target node, and set the property to the appropriate data
 			SceneNode* targetNode = modelNodes[anim.m_channels[i].m_targetNodeIdx];
+			m_animProperties[i].m_targetNode = targetNode;
 			if (anim.m_channels[i].m_targetProperty == "translation")
-				m_animProperties[i].m_property = glm::value_ptr(targetNode->m_localTr.m_position);
+				m_animProperties[i].m_propertyOffset = offsetof(TransformData, m_position) / sizeof(float);
 			else if (anim.m_channels[i].m_targetProperty == "rotation")
-				m_animProperties[i].m_property = glm::value_ptr(targetNode->m_localTr.m_orientation);
+				m_animProperties[i].m_propertyOffset = offsetof(TransformData, m_orientation) / sizeof(float);
 			else if (anim.m_channels[i].m_targetProperty == "scale")
-				m_animProperties[i].m_property = glm::value_ptr(targetNode->m_localTr.m_scale);
+				m_animProperties[i].m_propertyOffset = offsetof(TransformData, m_scale) / sizeof(float);
 
 
 			// Set the interpolation function
@@ -651,6 +735,10 @@ namespace cs460
 		return m_paused;
 	}
 
+	void AnimationReference::set_anim_timer(float newTime)
+	{
+		m_animTimer = newTime;
+	}
 	void AnimationReference::set_anim_time_scale(float newTimeScale)
 	{
 		m_timeScale = newTimeScale;
@@ -665,6 +753,32 @@ namespace cs460
 	}
 
 
+	// Whether the skins of this character sample the palettes baked for its current animation instead of
+	// animating the nodes (for big crowds). The nodes of the skeleton keep their pose while they are used.
+	void AnimationReference::set_baked_palettes(bool bakedPalettes)
+	{
+		m_bakedPalettes = bakedPalettes;
+		if (!m_bakedPalettes)
+			return;
+
+		// Bake them now, as the skins are updated from the worker threads
+		Model* model = get_owner()->get_model();
+		for (int i = 0; i < (int)model->m_skins.size(); ++i)
+			ResourceManager::get_instance().get_palette_atlas(model, i);
+	}
+
+	bool AnimationReference::get_baked_palettes() const
+	{
+		return m_bakedPalettes;
+	}
+
+	// Only with an animation selected and without blend trees
+	bool AnimationReference::is_using_baked_palettes() const
+	{
+		return m_bakedPalettes && m_animIdx >= 0 && m_blendTreeType == 0;
+	}
+
+
 	// Getter and setter for the type of blend tree to use (0=None, 1=1D, 2=2D)
 	int AnimationReference::get_blend_tree_type() const
 	{
@@ -679,6 +793,10 @@ namespace cs460
 			m_1dBlendTree = new Blend1D(this);
 		else if (type == 2 && m_2dBlendTree == nullptr)
 			m_2dBlendTree = new Blend2D(this);
+		else if (type == 3 && m_layerBlendTree == nullptr)
+			m_layerBlendTree = new BlendLayer(this);
+
+		invalidate_blend_program();
 	}
 
 	// Get the current blend tree (null, blend1d, or blend2d)
@@ -688,10 +806,18 @@ namespace cs460
 			return m_1dBlendTree;
 		else if (m_blendTreeType == 2)
 			return m_2dBlendTree;
+		else if (m_blendTreeType == 3)
+			return m_layerBlendTree;
 
 		return nullptr;
 	}
 
+	// Mark the compiled blend tree as outdated (it will be recompiled in the next update)
+	void AnimationReference::invalidate_blend_program()
+	{
+		m_blendProgramDirty = true;
+	}
+
 
 	// TODO: Remove these in the future. This is just to be able to harcode the demos
 	//void AnimationReference::set_1d_blend_tree(Blend1D* blendTree)
@@ -12,6 +12,7 @@
 
 #include "Components/IComponent.h"
 #include "Animation/Animation.h"
+#include "Animation/Blending/BlendProgram.h"
 
 
 namespace cs460
@@ -20,6 +21,7 @@ namespace cs460
 	struct Blend1D;
 	struct Blend2D;
 	struct BlendAnim;
+	struct BlendLayer;
 
 
 	class AnimationReference : public IComponent
@@ -32,6 +34,7 @@ namespace cs460
 		// Update the animation
 		void update();
 		void update_properties();
+		void update_blend_program();
 
 		void change_animation(int idx, const std::string& animName);
 
@@ -46,17 +49,27 @@ namespace cs460
 		bool get_anim_looping() const;
 		bool get_anim_paused() const;
 
+		void set_anim_timer(float newTime);
 		void set_anim_time_scale(float newTimeScale);
 		void set_anim_looping(bool isLooping);
 		void set_anim_paused(bool isPaused);
 
-		// Getter and setter for the type of blend tree to use (0=None, 1=1D, 2=2D)
+		// Whether the skins of this character sample the palettes baked for its current animation instead of
+		// animating the nodes (for big crowds). The nodes of the skeleton keep their pose while they are used.
+		void set_baked_palettes(bool bakedPalettes);
+		bool get_baked_palettes() const;
+		bool is_using_baked_palettes() const;		// Only with an animation selected and without blend trees
+
+		// Getter and setter for the type of blend tree to use (0=None, 1=1D, 2=2D, 3=Layered)
 		int get_blend_tree_type() const;
 		void set_blend_tree_type(int type);
 
-		// Get the current blend tree (null, blend1d, or blend2d)
+		// Get the current blend tree (null, blend1d, blend2d, or blend layer)
 		IBlendNode* get_blend_tree();
 
+		// Mark the compiled blend tree as outdated (it will be recompiled in the next update)
+		void invalidate_blend_program();
+
 		// TODO: Remove these in the future. This is just to be able to harcode the demos
 		//void set_1d_blend_tree(Blend1D* blendTree);
 		//void set_2d_blend_tree(Blend2D* blendTree);
@@ -74,12 +87,20 @@ namespace cs460
 		float m_timeScale = 1.0f;
 		bool m_looping = true;
 		bool m_paused = false;
+		bool m_bakedPalettes = false;
 
-		// The 1d and 2d blending trees
+		// The 1d, 2d and layered blending trees
 		Blend1D* m_1dBlendTree = nullptr;
 		Blend2D* m_2dBlendTree = nullptr;
+		BlendLayer* m_layerBlendTree = nullptr;
 		int m_blendTreeType = 0;
 
+		// Compiled version of the current blend tree, which is what gets evaluated every frame
+		BlendProgram m_blendProgram;
+		BlendProgramInstance m_blendInstance;
+		std::vector<IBlendNode*> m_blendProgramNodes;
+		bool m_blendProgramDirty = true;
+
 		// Blend tree gui params
 		IBlendNode* m_pickedNode = nullptr;
 
@@ -87,6 +108,7 @@ namespace cs460
 		void on_gui() override;
 		void blend_1d_editor();
 		void blend_2d_editor();
+		void blend_layer_editor();
 		void blend_param_picking(const glm::vec2& windowCoordsStart, const glm::vec2& windowCoordsEnd, const ImVec2& rectMin, const ImVec2& rectMax, const glm::vec2& blendSpaceMin, const glm::vec2& blendSpaceMax, IBlendNode* blendTree);
 		void pick_blend_node(const glm::vec2& windowCoordsStart, const glm::vec2& windowCoordsEnd, IBlendNode* blendTree, const ImVec2& mousePos);
 		void blend_node_gui(IBlendNode* node);
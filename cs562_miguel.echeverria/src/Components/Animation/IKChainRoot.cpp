@@ -54,7 +54,7 @@ namespace cs460
 		
 		// Don't solve if we have finished processing and the target hasn't moved
 		SceneNode* target = m_chain->get_target();
-		const glm::vec3& currentTargetPos = target->m_worldTr.m_position;
+		const glm::vec3& currentTargetPos = target->get_world_tr().m_position;
 		if (m_solver->get_status() != IKSolverStatus::PROCESSING && glm::all(glm::epsilonEqual(currentTargetPos, m_lastTargetPos, FLT_EPSILON)))
 		{
 			m_lastSolverStatus = m_solver->get_status();//IKSolverStatus::IDLE;
@@ -63,7 +63,7 @@ namespace cs460
 		
 		// Update the last target position if the previous frame's solve was successful
 		if (m_solver->get_status() != IKSolverStatus::PROCESSING)
-			m_lastTargetPos = target->m_worldTr.m_position;
+			m_lastTargetPos = target->get_world_tr().m_position;
 
 		// Solve using the internal solver
 		m_lastSolverStatus = m_solver->solve();
@@ -9,9 +9,16 @@
 
 #include "pch.h"
 #include "SkinReference.h"
+#include "Animation/Skinning/JointBounds.h"
 #include "Animation/Animator.h"
 #include "Graphics/GLTF/Model.h"
 #include "Composition/SceneNode.h"
+#include "Composition/Scene.h"
+#include "Components/Models/ModelInstance.h"
+#include "Components/Models/MeshRenderable.h"
+#include "Components/Animation/AnimationReference.h"
+#include "Animation/Skinning/PaletteAtlas.h"
+#include "Resources/ResourceManager.h"
 
 
 namespace cs460
@@ -25,6 +32,9 @@ namespace cs460
 	{
 		//std::cout << "SKIN REF DESTRUCTOR CALLED\n";
 		Animator::get_instance().remove_skin_ref(this);
+
+		if (m_meshComp)
+			m_meshComp->set_skin(nullptr);
 	}
 
 
@@ -32,10 +42,13 @@ namespace cs460
 	void SkinReference::set_skin_idx(int idx)
 	{
 		m_skinIdx = idx;
+		m_skeletonRoot = nullptr;
+		m_missingJoints = false;
 
 		// Resize the joint matrices vector so that it has enough space for a matrix per joint
 		Model* modelResource = get_owner()->get_model();
 		m_jointMatrices.resize(modelResource->m_skins[idx].m_joints.size());
+		m_jointDualQuats.resize(m_jointMatrices.size());
 	}
 
 	int SkinReference::get_skin_idx() const
@@ -43,16 +56,250 @@ namespace cs460
 		return m_skinIdx;
 	}
 
-	std::vector<glm::mat4>& SkinReference::get_joint_matrices()
+	JointPalette& SkinReference::get_joint_matrices()
 	{
 		return m_jointMatrices;
 	}
 
+	DualQuatPalette& SkinReference::get_joint_dual_quats()
+	{
+		return m_jointDualQuats;
+	}
+
+	SkinningMode SkinReference::get_skinning_mode() const
+	{
+		return m_modelInstance ? m_modelInstance->get_skinning_mode() : SkinningMode::LINEAR;
+	}
+
 	bool SkinReference::get_draw_skeleton() const
 	{
 		return m_drawSkeleton;
 	}
 
+	// Bounding volume of the deformed mesh in the space of the node, from the boxes of the joints and the current
+	// joint matrices (only valid if has_skinned_bounding_volume, since the mesh might not have vertices with joints)
+	bool SkinReference::has_skinned_bounding_volume() const
+	{
+		return m_hasSkinnedBv;
+	}
+
+	const AABB& SkinReference::get_skinned_bounding_volume() const
+	{
+		return m_skinnedBv;
+	}
+
+
+	// Update the joint matrices (and dual quaternions if used) from the world transforms of the joints, or from the
+	// baked palettes if the character uses them. Only reads the scene, so different skins can be updated from different threads.
+	// Returns false if none of the joints moved since the last update, in which case the matrices are kept.
+	bool SkinReference::update_joint_matrices()
+	{
+		// Skins without their whole skeleton keep their matrices
+		if (m_skeletonRoot == nullptr && (m_missingJoints || !find_joint_nodes()))
+			return false;
+
+		Model* model = get_owner()->get_model();
+		const Skin& skin = model->m_skins[m_skinIdx];
+		bool dualQuats = m_modelInstance->get_skinning_mode() == SkinningMode::DUAL_QUATERNION;
+
+		// Crowd characters with baked palettes only blend two frames of the atlas (the palettes
+		// are relative to the skeleton root, so they are the same for every instance of the model)
+		const PaletteAtlas* atlas = nullptr;
+		if (m_animComp && m_animComp->is_using_baked_palettes())
+			atlas = ResourceManager::get_instance().find_palette_atlas(model, m_skinIdx);
+
+		if (atlas && m_animComp->get_anim_idx() < (int)atlas->get_clip_count() && atlas->get_joint_count() == m_jointMatrices.size())
+		{
+			atlas->sample_palette(m_animComp->get_anim_idx(), m_animComp->get_anim_timer(), m_jointMatrices.data());
+			if (dualQuats)
+				convert_palette_to_dual_quats(m_jointMatrices.data(), m_jointDualQuats.data(), (unsigned)m_jointDualQuats.size());
+
+			// Computed again from the joints when the baked palettes are disabled
+			m_paletteDirty = true;
+		}
+		else
+		{
+			// Nothing to do if no joint (or the skeleton root) has moved since the palette was computed. The
+			// versions of the world transforms only grow, so comparing the biggest one is enough.
+			unsigned jointsVersion = m_skeletonRoot->get_world_tr_version();
+			for (SceneNode* jointNode : m_jointNodes)
+				jointsVersion = glm::max(jointsVersion, jointNode->get_world_tr_version());
+
+			if (!m_paletteDirty && jointsVersion == m_jointsVersion && dualQuats == m_paletteDualQuats)
+				return false;
+
+			m_paletteDirty = false;
+			m_jointsVersion = jointsVersion;
+			m_paletteDualQuats = dualQuats;
+
+			// The skeleton root factors are the same for every joint
+			AffineTransform rootMtx;
+			rootMtx.set_matrix(m_skeletonRoot->get_local_tr().get_model_mtx() * m_skeletonRoot->get_world_tr().get_inv_model_mtx());
+
+			for (unsigned j = 0; j < m_jointNodes.size(); ++j)
+				m_jointTransforms[j] = &m_jointNodes[j]->get_world_tr();
+
+			// Only the joints that deform some vertex are computed (the rest keep the identity)
+			if (m_usedJoints.empty())
+			{
+				compute_joint_palette(rootMtx, m_jointTransforms.data(), skin.m_invBindMatrices.data(), m_jointMatrices.data(), (unsigned)m_jointMatrices.size());
+
+				// The dual quaternions are taken from the final matrices, so that the scale of the
+				// nodes above the skeleton cancels out with the one in the inverse bind matrices
+				if (dualQuats)
+					convert_palette_to_dual_quats(m_jointMatrices.data(), m_jointDualQuats.data(), (unsigned)m_jointDualQuats.size());
+			}
+			else
+			{
+				compute_joint_palette(rootMtx, m_jointTransforms.data(), skin.m_invBindMatrices.data(), m_jointMatrices.data(), m_usedJoints.data(), (unsigned)m_usedJoints.size());
+				if (dualQuats)
+					for (unsigned short j : m_usedJoints)
+						m_jointDualQuats[j].set_transform(m_jointMatrices[j]);
+			}
+		}
+
+		// The boxes are transformed with the matrices also in dual quaternion mode, which gives a close approximation
+		m_hasSkinnedBv = false;
+		if (m_mesh)
+		{
+			unsigned jointCount = (unsigned)glm::min(m_mesh->m_jointBounds.size(), m_jointMatrices.size());
+			m_hasSkinnedBv = compute_skinned_bounds(m_mesh->m_jointBounds.data(), m_jointMatrices.data(), jointCount, m_skinnedBv);
+		}
+
+		return true;
+	}
+
+
+	// Whether the vertices of the mesh are deformed on the cpu (only in linear mode) and drawn without gpu skinning
+	void SkinReference::set_cpu_skinning(bool cpuSkinning)
+	{
+		// The vertices have to be deformed again even if the joints don't move
+		m_paletteDirty = m_paletteDirty || (cpuSkinning && !m_cpuSkinning);
+		m_cpuSkinning = cpuSkinning;
+	}
+
+	bool SkinReference::get_cpu_skinning() const
+	{
+		return m_cpuSkinning;
+	}
+
+	bool SkinReference::is_cpu_skinned() const
+	{
+		return m_cpuSkinning && get_skinning_mode() == SkinningMode::LINEAR;
+	}
+
+
+	// Deform the primitives of the mesh with the current joint matrices (each one split among threads if parallel)
+	void SkinReference::update_deformed_vertices(bool parallel)
+	{
+		if (m_mesh == nullptr)
+			return;
+
+		const std::vector<Primitive>& primitives = m_mesh->m_primitives;
+		m_deformedPrimitives.resize(primitives.size());
+		for (int i = 0; i < primitives.size(); ++i)
+			skin_vertices(m_jointMatrices.data(), primitives[i].get_skinned_vertices(), m_deformedPrimitives[i], parallel);
+	}
+
+	// Deformed vertices of each primitive of the mesh (empty for the primitives that aren't skinned)
+	const std::vector<DeformedVertices>& SkinReference::get_deformed_primitives() const
+	{
+		return m_deformedPrimitives;
+	}
+
+	// Mesh component of the node, found with the joints (cleared when one of the two is deleted)
+	void SkinReference::set_mesh_renderable(MeshRenderable* meshComp)
+	{
+		if (m_meshComp == meshComp)
+			return;
+
+		if (m_meshComp)
+			m_meshComp->set_skin(nullptr);
+		m_meshComp = meshComp;
+		if (m_meshComp)
+			m_meshComp->set_skin(this);
+	}
+
+	MeshRenderable* SkinReference::get_mesh_renderable() const
+	{
+		return m_meshComp;
+	}
+
+
+	// Find the nodes of the skeleton in the nodes of the model instance. Done in the first update if the
+	// model instance didn't call it when it created its nodes (the animation component has to exist already).
+	// Returns false if some of them aren't in the instance (like joints outside of its scene), and then the skin isn't updated.
+	bool SkinReference::find_joint_nodes()
+	{
+		ModelInstance* rootModelInst = get_owner()->get_model_root_node()->get_component<ModelInstance>();
+		int modelInstanceId = rootModelInst->get_instance_id();
+		m_modelInstance = rootModelInst;
+		m_animComp = get_owner()->get_model_root_node()->get_component<AnimationReference>();
+
+		Model* model = get_owner()->get_model();
+		const Skin& skin = model->m_skins[m_skinIdx];
+		const std::vector<SceneNode*>& modelInstanceNodes = Scene::get_instance().get_model_inst_nodes(modelInstanceId);
+
+		// The table has a slot per node of the model, but the nodes outside of the scene of the instance are null
+		auto findNode = [&modelInstanceNodes](int nodeIdx) -> SceneNode*
+		{
+			return nodeIdx >= 0 && nodeIdx < (int)modelInstanceNodes.size() ? modelInstanceNodes[nodeIdx] : nullptr;
+		};
+
+		SceneNode* skeletonRoot = findNode(skin.m_commonRootIdx);
+		bool foundAll = skeletonRoot != nullptr;
+		m_jointNodes.resize(m_jointMatrices.size());
+		m_jointTransforms.resize(m_jointMatrices.size());
+		for (int j = 0; j < m_jointNodes.size(); ++j)
+		{
+			m_jointNodes[j] = findNode(skin.m_joints[j]);
+			foundAll = foundAll && m_jointNodes[j] != nullptr;
+		}
+
+		if (!foundAll)
+		{
+			std::cout << "ERROR: Skin " << m_skinIdx << " of " << model->m_fileName << " has joints outside of the model instance, it won't be animated\n";
+			m_missingJoints = true;
+			return false;
+		}
+
+		m_skeletonRoot = skeletonRoot;
+		m_paletteDirty = true;
+		find_used_joints();
+		return true;
+	}
+
+	// Find the mesh, and gather the joints used by the partitions of all its primitives
+	void SkinReference::find_used_joints()
+	{
+		m_usedJoints.clear();
+		m_mesh = nullptr;
+		set_mesh_renderable(get_owner()->get_component<MeshRenderable>());
+		if (m_meshComp == nullptr || m_meshComp->get_mesh_idx() < 0)
+			return;
+
+		m_mesh = &get_owner()->get_model()->m_meshes[m_meshComp->get_mesh_idx()];
+		std::vector<bool> used(m_jointMatrices.size(), false);
+		for (const Primitive& primitive : m_mesh->m_primitives)
+		{
+			// A skinned primitive without partitions could use any joint
+			if (primitive.get_skin_partitions().empty() && !primitive.get_skinned_vertices().is_empty())
+				return;
+
+			for (const SkinPartition& partition : primitive.get_skin_partitions())
+				for (unsigned short joint : partition.m_joints)
+					if (joint < used.size())
+						used[joint] = true;
+		}
+
+		for (unsigned j = 0; j < used.size(); ++j)
+			if (used[j])
+				m_usedJoints.push_back((unsigned short)j);
+
+		if (m_usedJoints.size() == used.size())
+			m_usedJoints.clear();
+	}
+
 
 	void SkinReference::on_gui()
 	{
@@ -65,6 +312,9 @@ namespace cs460
 			ImGui::Text("Joint count: %i", skin.m_joints.size());
 
 			ImGui::Checkbox("Draw Skeleton", &m_drawSkeleton);
+			bool cpuSkinning = m_cpuSkinning;
+			if (ImGui::Checkbox("CPU Skinning", &cpuSkinning))
+				set_cpu_skinning(cpuSkinning);
 		}
 	}
 }
\ No newline at end of file
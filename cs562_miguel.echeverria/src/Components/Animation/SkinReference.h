@@ -10,10 +10,18 @@
 #pragma once
 
 #include "Components/IComponent.h"
+#include "Animation/Skinning/CpuSkinning.h"
+#include "Math/Geometry/Geometry.h"
 
 
 namespace cs460
 {
+	class ModelInstance;
+	class AnimationReference;
+	class MeshRenderable;
+	struct Mesh;
+
+
 	class SkinReference : public IComponent
 	{
 	public:
@@ -25,13 +33,66 @@ namespace cs460
 		void set_skin_idx(int idx);
 		int get_skin_idx() const;
 
-		std::vector<glm::mat4>& get_joint_matrices();
+		JointPalette& get_joint_matrices();
+		DualQuatPalette& get_joint_dual_quats();		// Only updated in dual quaternion mode
+		SkinningMode get_skinning_mode() const;			// Mode of the model instance this skin belongs to
 		bool get_draw_skeleton() const;
 
+		// Bounding volume of the deformed mesh in the space of the node, from the boxes of the joints and the current
+		// joint matrices (only valid if has_skinned_bounding_volume, since the mesh might not have vertices with joints)
+		bool has_skinned_bounding_volume() const;
+		const AABB& get_skinned_bounding_volume() const;
+
+		// Update the joint matrices (and dual quaternions if used) from the world transforms of the joints, or from the
+		// baked palettes if the character uses them. Only reads the scene, so different skins can be updated from different threads.
+		// Returns false if none of the joints moved since the last update, in which case the matrices are kept.
+		bool update_joint_matrices();
+
+		// Whether the vertices of the mesh are deformed on the cpu (only in linear mode) and drawn without gpu skinning
+		void set_cpu_skinning(bool cpuSkinning);
+		bool get_cpu_skinning() const;
+		bool is_cpu_skinned() const;
+
+		// Deform the primitives of the mesh with the current joint matrices (each one split among threads if parallel)
+		void update_deformed_vertices(bool parallel);
+
+		// Deformed vertices of each primitive of the mesh (empty for the primitives that aren't skinned)
+		const std::vector<DeformedVertices>& get_deformed_primitives() const;
+
+		// Mesh component of the node, found with the joints (cleared when one of the two is deleted)
+		void set_mesh_renderable(MeshRenderable* meshComp);
+		MeshRenderable* get_mesh_renderable() const;
+
+		// Find the nodes of the skeleton in the nodes of the model instance. Done in the first update if the
+		// model instance didn't call it when it created its nodes (the animation component has to exist already).
+		// Returns false if some of them aren't in the instance (like joints outside of its scene), and then the skin isn't updated.
+		bool find_joint_nodes();
+
 	private:
 		int m_skinIdx = -1;
-		std::vector<glm::mat4> m_jointMatrices;
+		JointPalette m_jointMatrices;
+		DualQuatPalette m_jointDualQuats;
 		bool m_drawSkeleton = true;
+		bool m_cpuSkinning = false;
+		std::vector<DeformedVertices> m_deformedPrimitives;
+		AABB m_skinnedBv;
+		bool m_hasSkinnedBv = false;
+
+		// Nodes of the skeleton, looked up in the model instance nodes the first time they are needed
+		SceneNode* m_skeletonRoot = nullptr;
+		ModelInstance* m_modelInstance = nullptr;
+		AnimationReference* m_animComp = nullptr;					// Animation of the character, to sample the baked palettes
+		std::vector<SceneNode*> m_jointNodes;
+		std::vector<const TransformData*> m_jointTransforms;		// World transform of each joint (looked up every update, they move when the scene changes)
+		std::vector<unsigned short> m_usedJoints;					// Joints referenced by the partitions of the mesh (empty if all of them are)
+		unsigned m_jointsVersion = 0;								// Biggest world transform version of the joints when the palette was computed
+		bool m_paletteDualQuats = false;
+		bool m_paletteDirty = true;									// Compute the palette even if the joints haven't moved
+		bool m_missingJoints = false;								// Some node of the skeleton isn't in the model instance (reported once)
+		const Mesh* m_mesh = nullptr;
+		MeshRenderable* m_meshComp = nullptr;
+
+		void find_used_joints();
 
 		void on_gui() override;
 	};
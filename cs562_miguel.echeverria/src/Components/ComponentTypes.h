@@ -0,0 +1,62 @@
+/**
+* @file ComponentTypes.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Every type of component, each one with a compile time id. The scene
+*		 nodes keep their components indexed by this id, so finding the
+*		 component of a type doesn't need to check each one with rtti.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+
+namespace cs460
+{
+	class IComponent;
+	class ModelInstance;
+	class MeshRenderable;
+	class AnimationReference;
+	class SkinReference;
+	class SkeletonRoot;
+	class Joint;
+	class IKChainRoot;
+	class PiecewiseCurve;
+	class CurvePoint;
+	class CurveTangent;
+	class CurveControlPoint;
+	class Rigidbody;
+	class Cloth;
+	class ScriptComponent;
+	class PlayerController;
+
+
+	// New component types have to be added here
+	using ComponentTypes = TypeList<ModelInstance, MeshRenderable, AnimationReference, SkinReference, SkeletonRoot, Joint, IKChainRoot,
+		PiecewiseCurve, CurvePoint, CurveTangent, CurveControlPoint, Rigidbody, Cloth, ScriptComponent, PlayerController>;
+
+	static const unsigned COMPONENT_TYPE_COUNT = ComponentTypes::size;
+
+
+	// Id of the component type T (its position in ComponentTypes)
+	template<typename T>
+	constexpr unsigned get_component_type_id()
+	{
+		return TypeIndex<T, ComponentTypes>::value;
+	}
+
+
+	// Component type T inherits from (other than IComponent), so that asking for the base type finds the derived components
+	template<typename T>
+	struct ComponentBase
+	{
+		using type = IComponent;
+	};
+
+	template<>
+	struct ComponentBase<PlayerController>
+	{
+		using type = ScriptComponent;
+	};
+}
\ No newline at end of file
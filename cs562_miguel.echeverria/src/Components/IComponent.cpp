@@ -11,6 +11,7 @@
 #include "IComponent.h"
 #include "Composition/SceneNode.h"
 #include "Utilities/Rtti.h"
+#include "Platform/ObjectPool.h"
 
 
 namespace cs460
@@ -20,6 +21,19 @@ namespace cs460
 		//std::cout << "ICOMP DESTRUCTOR\n";
 	}
 
+
+	// Components come from the shared object pool of their size, so the ones of the same type are together in memory
+	// and adding/removing them reuses the memory of the removed ones (the virtual destructor gives the size of the type)
+	void* IComponent::operator new(size_t size)
+	{
+		return ObjectPool::allocate_object(size);
+	}
+
+	void IComponent::operator delete(void* ptr, size_t size)
+	{
+		ObjectPool::deallocate_object(ptr, size);
+	}
+
 	// Calls a private virtual ongui so that the ongui of the actual component gets called
 	void IComponent::show_gui()
 	{
@@ -59,6 +73,15 @@ namespace cs460
 		return m_active;
 	}
 
+	void IComponent::set_registry_handle(RegistryHandle handle)
+	{
+		m_registryHandle = handle;
+	}
+	RegistryHandle IComponent::get_registry_handle() const
+	{
+		return m_registryHandle;
+	}
+
 	// To be overriden by specific components
 	void IComponent::on_gui()
 	{
@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "Composition/ComponentRegistry.h"
+
 
 namespace cs460
 {
@@ -21,6 +23,11 @@ namespace cs460
 
 		virtual ~IComponent();
 
+		// Components come from the shared object pool of their size, so the ones of the same type are together in memory
+		// and adding/removing them reuses the memory of the removed ones (the virtual destructor gives the size of the type)
+		static void* operator new(size_t size);
+		static void operator delete(void* ptr, size_t size);
+
 		void show_gui();	// Calls a private virtual ongui so that the ongui of the actual component gets called
 
 		// Getter and setter for the scene node that owns this component
@@ -31,10 +38,15 @@ namespace cs460
 		void set_active(bool newActive);
 		bool get_active() const;
 
+		// Getter and setter for the handle of this component in the registry of its system
+		void set_registry_handle(RegistryHandle handle);
+		RegistryHandle get_registry_handle() const;
+
 	private:
 
 		SceneNode* m_owner = nullptr;
 		bool m_active = true;
+		RegistryHandle m_registryHandle;
 
 		virtual void on_gui();	// To be overriden by specific components
 	};
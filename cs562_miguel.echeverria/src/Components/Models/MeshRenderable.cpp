@@ -17,12 +17,37 @@
 #include "Composition/SceneNode.h"
 #include "Composition/Scene.h"
 #include "Components/Animation/SkinReference.h"
-#include "Platform/InputMgr.h"
 #include "Cameras/ICamera.h"
+#include "Graphics/Rendering/RenderView.h"
+#include "Graphics/Rendering/RenderCommandBuffer.h"
+#include "Resources/ResourceManager.h"
 
 
 namespace cs460
 {
+	// Upload the joints of the given partition of a primitive, taken from the whole palette of the item
+	static void record_partition_palette(const RenderView& view, const RenderMeshItem& item, const SkinPartition& partition, RenderCommandBuffer& commands)
+	{
+		unsigned jointCount = glm::min((unsigned)partition.m_joints.size(), SkinPartition::MAX_JOINTS);
+		if (item.m_dualQuaternions)
+		{
+			DualQuaternion dualQuats[SkinPartition::MAX_JOINTS];
+			for (unsigned i = 0; i < jointCount; ++i)
+				if (partition.m_joints[i] < item.m_jointCount)
+					dualQuats[i] = view.m_jointDualQuats[item.m_firstJointMatrix + partition.m_joints[i]];
+			commands.set_uniform_array("jointDualQuats", &dualQuats[0].as_mat2x4(), jointCount);
+		}
+		else
+		{
+			AffineTransform matrices[SkinPartition::MAX_JOINTS];
+			for (unsigned i = 0; i < jointCount; ++i)
+				if (partition.m_joints[i] < item.m_jointCount)
+					matrices[i] = view.m_jointMatrices[item.m_firstJointMatrix + partition.m_joints[i]];
+			commands.set_uniform_array("jointMatrices", &matrices[0].as_mat3x4(), jointCount);
+		}
+	}
+
+
 	MeshRenderable::MeshRenderable()
 	{
 		Renderer::get_instance().add_mesh_renderable(this);
@@ -32,86 +57,140 @@ namespace cs460
 	{
 		//std::cout << "MESH RENDERABLE DESTRUCTOR\n";
 		Renderer::get_instance().remove_mesh_renderable(this);
+
+		if (m_skin)
+			m_skin->set_mesh_renderable(nullptr);
 	}
 
-	// Render the primitives of the mesh this component references, with the transform of the node it belongs to.
-	void MeshRenderable::render_primitives() const
+	// Copy the mesh, the transform of the node it belongs to and its joint matrices into the render view
+	void MeshRenderable::extract_render_data(RenderView& view) const
 	{
 		Model* modelResource = get_owner()->get_model();
 
 		if (modelResource == nullptr)
 			return;
 
-		Scene& scene = Scene::get_instance();
-		InputMgr& inputMgr = InputMgr::get_instance();
+		RenderMeshItem item;
+		item.m_model = modelResource;
+		item.m_meshIdx = m_meshIdx;
+		item.m_modelToWorld = get_model_to_world();
+
+		// Copy the joint matrices, dual quaternions or cpu skinned vertices (if the mesh has a skin)
+		SkinReference* skin = m_skin;
+		if (skin && skin->is_cpu_skinned())
+		{
+			// Copy the vertices deformed on the cpu instead
+			item.m_cpuSkinned = true;
+			item.m_firstDeformedVertex = (unsigned)view.m_deformedPositions.size();
+			for (const DeformedVertices& deformed : skin->get_deformed_primitives())
+			{
+				view.m_deformedPositions.insert(view.m_deformedPositions.end(), deformed.m_positions.begin(), deformed.m_positions.end());
+				view.m_deformedNormals.insert(view.m_deformedNormals.end(), deformed.m_normals.begin(), deformed.m_normals.end());
+			}
+		}
+		else if (skin)
+		{
+			item.m_skinned = true;
+			if (skin->get_skinning_mode() == SkinningMode::DUAL_QUATERNION)
+			{
+				const DualQuatPalette& dualQuats = skin->get_joint_dual_quats();
+				item.m_dualQuaternions = true;
+				item.m_firstJointMatrix = (unsigned)view.m_jointDualQuats.size();
+				item.m_jointCount = (unsigned)dualQuats.size();
+				view.m_jointDualQuats.insert(view.m_jointDualQuats.end(), dualQuats.begin(), dualQuats.end());
+			}
+			else
+			{
+				const JointPalette& jointMatrices = skin->get_joint_matrices();
+				item.m_firstJointMatrix = (unsigned)view.m_jointMatrices.size();
+				item.m_jointCount = (unsigned)jointMatrices.size();
+				view.m_jointMatrices.insert(view.m_jointMatrices.end(), jointMatrices.begin(), jointMatrices.end());
+			}
+		}
+
+		view.m_meshes.push_back(item);
+	}
+
+	// Record the commands that render the primitives of an extracted mesh, with the camera and lights of the render view.
+	// Doesn't modify the model, so different meshes can be recorded from different threads.
+	void MeshRenderable::record_primitives(const RenderView& view, const RenderMeshItem& item, RenderCommandBuffer& commands)
+	{
+		ResourceManager& resourceMgr = ResourceManager::get_instance();
 
 		// Get all the primitives of the mesh this component is referencing
-		Mesh& mesh = modelResource->m_meshes[m_meshIdx];
+		Mesh& mesh = item.m_model->m_meshes[item.m_meshIdx];
 		std::vector<Primitive>& primitives = mesh.m_primitives;
+		unsigned deformedVertex = item.m_firstDeformedVertex;
 		for (int i = 0; i < primitives.size(); ++i)
 		{
-			// Should this go here?
-			bool useNormalMap = true;
-			if (inputMgr.is_key_down(KEYS::key_n))
-				useNormalMap = !useNormalMap;
-
+			bool useNormalMap = view.m_useNormalMap;
 
-			const glm::mat4& modelToWorld = get_owner()->m_worldTr.get_model_mtx();
-			const glm::mat4& worldToView = scene.get_active_camera()->get_view_mtx();
-			const glm::mat4& perspectiveProjection = scene.get_active_camera()->get_projection_mtx();
+			const glm::mat4& modelToWorld = item.m_modelToWorld;
+			const glm::mat4& worldToView = view.m_worldToView;
+			const glm::mat4& perspectiveProjection = view.m_perspectiveProj;
 
 			// Decide between phong color, phong texture, and phong normal map
-			Shader* shader = primitives[i].get_shader();
+			Shader* shader = nullptr;
 			const Material& material = primitives[i].get_material();
 			if (material.m_usesNormalTexture && useNormalMap)
-				shader = primitives[i].set_shader("phong_normal_map");
+				shader = resourceMgr.get_shader("phong_normal_map");
 			else if (material.m_usesBaseTexture)
-				shader = primitives[i].set_shader("phong_texture");
+				shader = resourceMgr.get_shader("phong_texture");
 			else
-				shader = primitives[i].set_shader("phong_color");
+				shader = resourceMgr.get_shader("phong_color");
 
 			// Shader and uniform setup
-			shader->use();
-			shader->set_uniform("modelToWorld", modelToWorld);				// Set model to world
-			shader->set_uniform("worldToView", worldToView);				// Set the view mtx
-			shader->set_uniform("perspectiveProj", perspectiveProjection);	// Set the perspective projection matrix
-			shader->set_uniform("normalViewMtx", glm::transpose(glm::inverse(glm::mat3(worldToView * modelToWorld))));
-
-			// Set the joint matrices (if the mesh has a skin)
-			if (SkinReference* skin = get_owner()->get_component<SkinReference>())
-			{
-				shader->set_uniform("useSkinning", true);
-
-				const std::vector<glm::mat4>& jointMatrices = skin->get_joint_matrices();
-				for (int j = 0; j < jointMatrices.size(); ++j)
-					shader->set_uniform("jointMatrices[" + std::to_string(j) + "]", jointMatrices[j]);
-			}
-			else
-				shader->set_uniform("useSkinning", false);
+			commands.use_shader(shader);
+			commands.set_uniform("modelToWorld", modelToWorld);				// Set model to world
+			commands.set_uniform("worldToView", worldToView);				// Set the view mtx
+			commands.set_uniform("perspectiveProj", perspectiveProjection);	// Set the perspective projection matrix
+			commands.set_uniform("normalViewMtx", glm::transpose(glm::inverse(glm::mat3(worldToView * modelToWorld))));
+
+			// The joint matrices are set with each partition of the primitive (if the mesh has a skin)
+			const std::vector<SkinPartition>& partitions = primitives[i].get_skin_partitions();
+			bool skinned = item.m_skinned && !partitions.empty();
+			commands.set_uniform("useSkinning", skinned);
+			if (skinned)
+				commands.set_uniform("useDualQuaternions", item.m_dualQuaternions);
 
 			// Set the light properties
-			shader->set_uniform("light.m_direction", scene.m_lightProperties.m_direction);
-			shader->set_uniform("light.m_ambient", scene.m_lightProperties.m_ambient);
-			shader->set_uniform("light.m_diffuse", scene.m_lightProperties.m_diffuse);
-			shader->set_uniform("light.m_specular", scene.m_lightProperties.m_specular);
+			commands.set_uniform("light.m_direction", view.m_light.m_direction);
+			commands.set_uniform("light.m_ambient", view.m_light.m_ambient);
+			commands.set_uniform("light.m_diffuse", view.m_light.m_diffuse);
+			commands.set_uniform("light.m_specular", view.m_light.m_specular);
 
 			// Set the material properties
 			if (material.m_usesBaseTexture)
-				shader->set_uniform("mat.m_diffuse", material.m_baseColorTex.get_texture_unit());
+				commands.set_uniform("mat.m_diffuse", material.m_baseColorTex.get_texture_unit());
 			else
-				shader->set_uniform("mat.m_diffuse", glm::vec3(material.m_baseColor));
+				commands.set_uniform("mat.m_diffuse", glm::vec3(material.m_baseColor));
 
 			if (material.m_usesNormalTexture && useNormalMap)
 			{
-				shader->set_uniform("camPosWorldSpace", scene.get_active_camera()->get_position());
-				shader->set_uniform("mat.m_normalMap", material.m_normalMapTex.get_texture_unit());
-				shader->set_uniform("normalColorScale", material.m_normalMapScale);
+				commands.set_uniform("camPosWorldSpace", view.m_camPosition);
+				commands.set_uniform("mat.m_normalMap", material.m_normalMapTex.get_texture_unit());
+				commands.set_uniform("normalColorScale", material.m_normalMapScale);
 			}
 
-			shader->set_uniform("mat.m_shininess", 32.0f);
+			commands.set_uniform("mat.m_shininess", 32.0f);
 			
-			// Call render on each primitive
-			primitives[i].render();
+			// Record the draw of each primitive, or of each of its partitions with only the joints it uses
+			if (skinned)
+			{
+				for (unsigned p = 0; p < partitions.size(); ++p)
+				{
+					record_partition_palette(view, item, partitions[p], commands);
+					primitives[i].record_partition(commands, p);
+				}
+				continue;
+			}
+
+			unsigned deformedCount = item.m_cpuSkinned ? primitives[i].get_skinned_vertices().get_vertex_count() : 0;
+			if (deformedCount > 0 && deformedVertex + deformedCount <= view.m_deformedPositions.size())
+				primitives[i].record_deformed(commands, &view.m_deformedPositions[deformedVertex], &view.m_deformedNormals[deformedVertex]);
+			else
+				primitives[i].record(commands);
+			deformedVertex += deformedCount;
 		}
 	}
 
@@ -140,24 +219,53 @@ namespace cs460
 		return m_localBv;
 	}
 
+	// Model to world matrix of the node, only computed again when its world transform changes
+	const glm::mat4& MeshRenderable::get_model_to_world() const
+	{
+		unsigned version = get_owner()->get_world_tr_version();
+		if (version != m_modelToWorldVersion)
+		{
+			m_modelToWorld = get_owner()->get_world_tr().get_model_mtx();
+			m_modelToWorldVersion = version;
+		}
+		return m_modelToWorld;
+	}
+
+	// Skin that deforms this mesh, set by the skin reference of the node when it finds its mesh
+	void MeshRenderable::set_skin(SkinReference* skin)
+	{
+		m_skin = skin;
+	}
+
+	SkinReference* MeshRenderable::get_skin() const
+	{
+		return m_skin;
+	}
+
 	// Get the world bounding volume of this mesh as an aabb
 	AABB MeshRenderable::get_world_bounding_volume() const
 	{
+		// Skinned meshes use the bounding volume of their current pose instead of the bind pose one
+		const AABB* localBv = &m_localBv;
+		SkinReference* skin = m_skin;
+		if (skin && skin->has_skinned_bounding_volume())
+			localBv = &skin->get_skinned_bounding_volume();
+
 		// Compute all the corners of the aabb in local space
-		const glm::vec3& localDiagonal = m_localBv.m_max - m_localBv.m_min;
+		const glm::vec3& localDiagonal = localBv->m_max - localBv->m_min;
 		glm::vec3 localBvCorners[8];
-		localBvCorners[0] = m_localBv.m_min;
-		localBvCorners[1] = m_localBv.m_min + glm::vec3(localDiagonal.x, 0.0f, 0.0f);
-		localBvCorners[2] = m_localBv.m_min + glm::vec3(0.0f, localDiagonal.y, 0.0f);
-		localBvCorners[3] = m_localBv.m_min + glm::vec3(localDiagonal.x, localDiagonal.y, 0.0f);
-		localBvCorners[4] = m_localBv.m_min + glm::vec3(0.0f, 0.0f, localDiagonal.z);
-		localBvCorners[5] = m_localBv.m_min + glm::vec3(localDiagonal.x, 0.0f, localDiagonal.z);
-		localBvCorners[6] = m_localBv.m_min + glm::vec3(0.0f, localDiagonal.y, localDiagonal.z);
-		localBvCorners[7] = m_localBv.m_max;
+		localBvCorners[0] = localBv->m_min;
+		localBvCorners[1] = localBv->m_min + glm::vec3(localDiagonal.x, 0.0f, 0.0f);
+		localBvCorners[2] = localBv->m_min + glm::vec3(0.0f, localDiagonal.y, 0.0f);
+		localBvCorners[3] = localBv->m_min + glm::vec3(localDiagonal.x, localDiagonal.y, 0.0f);
+		localBvCorners[4] = localBv->m_min + glm::vec3(0.0f, 0.0f, localDiagonal.z);
+		localBvCorners[5] = localBv->m_min + glm::vec3(localDiagonal.x, 0.0f, localDiagonal.z);
+		localBvCorners[6] = localBv->m_min + glm::vec3(0.0f, localDiagonal.y, localDiagonal.z);
+		localBvCorners[7] = localBv->m_max;
 
 
 		// Get all the corners of the aabb in world space
-		const glm::mat4& modelMtx = get_owner()->m_worldTr.get_model_mtx();
+		const glm::mat4& modelMtx = get_model_to_world();
 		glm::vec3 worldBvCorners[8];
 		for (int i = 0; i < 8; ++i)
 			worldBvCorners[i] = glm::vec3(modelMtx * glm::vec4(localBvCorners[i], 1.0f));
@@ -170,17 +278,17 @@ namespace cs460
 		{
 			if (worldBvCorners[i].x < finalMin.x)
 				finalMin.x = worldBvCorners[i].x;
-			else if (worldBvCorners[i].x > finalMax.x)
+			if (worldBvCorners[i].x > finalMax.x)
 				finalMax.x = worldBvCorners[i].x;
 		
 			if (worldBvCorners[i].y < finalMin.y)
 				finalMin.y = worldBvCorners[i].y;
-			else if (worldBvCorners[i].y > finalMax.y)
+			if (worldBvCorners[i].y > finalMax.y)
 				finalMax.y = worldBvCorners[i].y;
 		
 			if (worldBvCorners[i].z < finalMin.z)
 				finalMin.z = worldBvCorners[i].z;
-			else if (worldBvCorners[i].z > finalMax.z)
+			if (worldBvCorners[i].z > finalMax.z)
 				finalMax.z = worldBvCorners[i].z;
 		}
 
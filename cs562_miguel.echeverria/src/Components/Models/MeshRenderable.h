@@ -18,6 +18,10 @@ namespace cs460
 {
 	struct Model;
 	class SceneNode;
+	class SkinReference;
+	struct RenderView;
+	struct RenderMeshItem;
+	class RenderCommandBuffer;
 
 
 	class MeshRenderable : public IComponent
@@ -27,8 +31,12 @@ namespace cs460
 		MeshRenderable();
 		virtual ~MeshRenderable();
 
-		// Render the primitives of the mesh this component references, with the transform of the node it belongs to.
-		void render_primitives() const;
+		// Copy the mesh, the transform of the node it belongs to and its joint matrices into the render view
+		void extract_render_data(RenderView& view) const;
+
+		// Record the commands that render the primitives of an extracted mesh, with the camera and lights of the render view.
+		// Doesn't modify the model, so different meshes can be recorded from different threads.
+		static void record_primitives(const RenderView& view, const RenderMeshItem& item, RenderCommandBuffer& commands);
 
 		void set_mesh_idx(int meshIdx);							// Set the index of the referenced mesh inside the model's vector of meshes
 		int get_mesh_idx() const;								// Get the index of the referenced mesh inside the model's vector of meshes
@@ -38,6 +46,13 @@ namespace cs460
 
 		AABB get_world_bounding_volume() const;					// Get the world bounding volume of this mesh as an aabb
 
+		// Model to world matrix of the node, only computed again when its world transform changes
+		const glm::mat4& get_model_to_world() const;
+
+		// Skin that deforms this mesh, set by the skin reference of the node when it finds its mesh
+		void set_skin(SkinReference* skin);
+		SkinReference* get_skin() const;
+
 		bool get_draw_bounding_volume() const;					// Get wether the bounding volume of this mesh is being rendered
 
 	private:
@@ -45,6 +60,9 @@ namespace cs460
 		int m_meshIdx = -1;
 		AABB m_localBv;
 		bool m_drawBv = true;
+		mutable glm::mat4 m_modelToWorld;
+		mutable unsigned m_modelToWorldVersion = 0xFFFFFFFF;		// World transform version it was computed from
+		SkinReference* m_skin = nullptr;
 
 		void on_gui() override;
 	};
@@ -14,6 +14,7 @@
 #include "Resources/ResourceManager.h"
 #include "Composition/SceneNode.h"
 #include "Composition/Scene.h"
+#include "Composition/ModelPrefab.h"
 #include "Components/Animation/AnimationReference.h"
 #include <gltf/tiny_gltf.h>
 
@@ -22,90 +23,53 @@ namespace cs460
 {
 	ModelInstance::ModelInstance()
 	{
-		Scene& scene = Scene::get_instance();
-		auto& allModelNodes = scene.get_all_model_nodes();
-		m_instanceId = (unsigned)allModelNodes.size();
-		allModelNodes.push_back({});
+		m_instanceId = Scene::get_instance().allocate_model_instance_id();
 	}
 
 	ModelInstance::~ModelInstance()
 	{
 		//std::cout << "MODEL INSTANCE DESTRUCTOR\n";
+		Scene::get_instance().free_model_instance_id(m_instanceId);
 	}
 
 
 	void ModelInstance::change_model(const fs::path& filePath)
 	{
+		// Get the model from the resource manager (load if it is not already there)
+		change_model(ResourceManager::get_instance().get_model(filePath.generic_string()));
 		m_previewName = filePath.filename().generic_string();
-		Scene& scene = Scene::get_instance();
+	}
+
+	// Delete the nodes of the previous model, and create the ones of the given model from its prefab
+	void ModelInstance::change_model(Model* model)
+	{
 		get_owner()->delete_all_children();
 		get_owner()->delete_component<AnimationReference>();
 
-		// Get the model from the resource manager (load if it is not already there), and generate the nodes
-		Model* model = ResourceManager::get_instance().get_model(filePath.generic_string());
-		if (model != nullptr)
-		{
-			m_model = model;
-			get_owner()->set_model_source(m_model);
-			get_owner()->set_model_root_node(get_owner());
-
+		if (model == nullptr)
+			return;
 
-			generate_nodes();
-			generate_components();
-		}
+		m_model = model;
+		m_previewName = model->m_fileName;
+		model->get_prefab().instantiate(this);
 	}
 
 
-	// Create all the nodes/components from the internal Model resource
-	void ModelInstance::generate_nodes()
+	unsigned ModelInstance::get_instance_id() const
 	{
-		if (m_model == nullptr)
-			return;
-
-		// Reset the dictionary of nodes
-		Scene& scene = Scene::get_instance();
-		auto& instanceNodes = scene.get_model_inst_nodes(m_instanceId);
-		instanceNodes.clear();
-
-
-		// Create the immediate children, which will create their own childrens
-		GLTFScene& gltfScene = m_model->m_scenes[m_model->m_defaultScene];
-		std::vector<int>& nodesIndices = gltfScene.m_nodeIndices;
-
-		for (int i = 0; i < nodesIndices.size(); ++i)
-		{
-			int childIdx = nodesIndices[i];
-			SceneNode* child = get_owner()->create_child(m_model->m_nodes[childIdx].m_name);
-			child->from_node_resource(m_model, childIdx, this);
-		}
+		return m_instanceId;
 	}
 
-	void ModelInstance::generate_components()
-	{
-		if (m_model == nullptr)
-			return;
-
-		Scene& scene = Scene::get_instance();
-		auto& modelNodes = scene.get_model_inst_nodes(m_instanceId);
-
-		add_anim_comp();		
 
-		// Create the immediate children's components, which will create their own childrens' components
-		GLTFScene& gltfScene = m_model->m_scenes[m_model->m_defaultScene];
-		std::vector<int>& nodesIndices = gltfScene.m_nodeIndices;
-
-		for (int i = 0; i < nodesIndices.size(); ++i)
-		{
-			int childIdx = nodesIndices[i];
-			SceneNode* childNode = modelNodes[childIdx];
-			childNode->generate_components(childIdx);
-		}
+	// How the skins of this model instance deform its meshes
+	void ModelInstance::set_skinning_mode(SkinningMode mode)
+	{
+		m_skinningMode = mode;
 	}
 
-
-	unsigned ModelInstance::get_instance_id() const
+	SkinningMode ModelInstance::get_skinning_mode() const
 	{
-		return m_instanceId;
+		return m_skinningMode;
 	}
 
 
@@ -144,12 +108,17 @@ namespace cs460
 
 			ImGui::EndCombo();
 		}
-	}
 
+		if (ImGui::BeginCombo("Skinning", get_skinning_mode_name(m_skinningMode)))
+		{
+			SkinningMode modes[] = { SkinningMode::LINEAR, SkinningMode::DUAL_QUATERNION };
+			for (SkinningMode mode : modes)
+			{
+				if (ImGui::Selectable(get_skinning_mode_name(mode), mode == m_skinningMode))
+					m_skinningMode = mode;
+			}
 
-	void ModelInstance::add_anim_comp()
-	{
-		// Add the animation reference component to the node with the model instance component
-		AnimationReference* anim = get_owner()->add_component<AnimationReference>();
+			ImGui::EndCombo();
+		}
 	}
 }
\ No newline at end of file
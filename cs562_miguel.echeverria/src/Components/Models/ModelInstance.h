@@ -10,6 +10,7 @@
 #pragma once
 
 #include "Components/IComponent.h"
+#include "Animation/Skinning/SkinningCore.h"
 
 namespace tinygltf
 {
@@ -31,20 +32,23 @@ namespace cs460
 
 		void change_model(const fs::path& filePath);
 
-		// Create all the nodes/components from the internal Model resources
-		void generate_nodes();
-		void generate_components();
+		// Delete the nodes of the previous model, and create the ones of the given model from its prefab
+		void change_model(Model* model);
 
 		unsigned get_instance_id() const;
 
+		// How the skins of this model instance deform its meshes
+		void set_skinning_mode(SkinningMode mode);
+		SkinningMode get_skinning_mode() const;
+
 	private:
 
 		Model* m_model = nullptr;
 		std::string m_previewName = "Empty";
 		unsigned m_instanceId = 0;				// For accessing the Index->SceneNode dictionaries in Scenes
+		SkinningMode m_skinningMode = SkinningMode::LINEAR;
 
 		
 		void on_gui() override;
-		void add_anim_comp();
 	};
 }
\ No newline at end of file
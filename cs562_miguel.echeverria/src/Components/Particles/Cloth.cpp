@@ -18,6 +18,8 @@
 #include "Composition/Scene.h"
 #include "Cameras/ICamera.h"
 #include "Utilities/ImageProcessing.h"
+#include "Graphics/Rendering/RenderView.h"
+#include "Graphics/Systems/Renderer.h"
 #include <GL/glew.h>
 
 
@@ -113,20 +115,17 @@ namespace cs460
 		}
 	}
 
-	// Draw with a texture (currently hardcoded)
-	void Cloth::draw_textured()
+	// Copy the triangle strips of the cloth (positions, normals and tangents) into the given render view
+	void Cloth::extract_render_data(RenderView& view)
 	{
-		setup_uniforms();
+		RenderClothItem item;
+		item.m_cloth = get_registry_handle();
+		item.m_firstVertex = (unsigned)view.m_clothPositions.size();
+		item.m_stripCount = m_height - 1;
+		item.m_stripVertexCount = m_width * 2;
 
-		std::vector<glm::vec3> pos;
-		std::vector<glm::vec3> normals;
-		std::vector<glm::vec3> tangents;
-
-		// Update the render data (positions and normals)
 		for (unsigned r = 0; r < m_height - 1; ++r)
 		{
-			glBindVertexArray(m_vaos[r]);
-
 			for (unsigned c = 0; c < m_width; ++c)
 			{
 				unsigned currIdx = idx(r, c);
@@ -136,38 +135,43 @@ namespace cs460
 				VerletParticle& nextPart = m_system.m_particles[nextIdx];
 
 				// Gather the position data from the particles
-				pos.push_back(currPart.m_pos);
-				pos.push_back(nextPart.m_pos);
+				view.m_clothPositions.push_back(currPart.m_pos);
+				view.m_clothPositions.push_back(nextPart.m_pos);
 
 				// Gather the averaged normals from the particles
-				normals.push_back(currPart.m_normal);//get_averaged_normal(r, c));
-				normals.push_back(nextPart.m_normal);//get_averaged_normal(r + 1, c));
+				view.m_clothNormals.push_back(currPart.m_normal);//get_averaged_normal(r, c));
+				view.m_clothNormals.push_back(nextPart.m_normal);//get_averaged_normal(r + 1, c));
 
 				// Gather the averaged tangents from the particles
-				tangents.push_back(get_averaged_tangent(r, c));
-				tangents.push_back(get_averaged_tangent(r + 1, c));
+				view.m_clothTangents.push_back(get_averaged_tangent(r, c));
+				view.m_clothTangents.push_back(get_averaged_tangent(r + 1, c));
 			}
+		}
 
-			// Update the position data
-			glBindBuffer(GL_ARRAY_BUFFER, m_posVbos[r]);
-			glBufferSubData(GL_ARRAY_BUFFER, 0, pos.size() * sizeof(glm::vec3), pos.data());
+		view.m_cloths.push_back(item);
+	}
 
-			// Update the normals data
-			glBindBuffer(GL_ARRAY_BUFFER, m_normalVbos[r]);
-			glBufferSubData(GL_ARRAY_BUFFER, 0, normals.size() * sizeof(glm::vec3), normals.data());
+	// Record the commands that draw with a texture (currently hardcoded) the strips extracted in the given render view
+	void Cloth::record_draw(const RenderView& view, const RenderClothItem& item, RenderCommandBuffer& commands) const
+	{
+		// Skip it if it was initialized again since the extraction
+		if (item.m_stripCount != m_vaos.size() || item.m_stripVertexCount != m_width * 2)
+			return;
 
-			// Update the tangents data
-			glBindBuffer(GL_ARRAY_BUFFER, m_tangentVbos[r]);
-			glBufferSubData(GL_ARRAY_BUFFER, 0, tangents.size() * sizeof(glm::vec3), tangents.data());
+		record_uniforms(view, commands);
 
-			// Draw the current triangle strip
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, pos.size());
+		for (unsigned r = 0; r < item.m_stripCount; ++r)
+		{
+			unsigned first = item.m_firstVertex + r * item.m_stripVertexCount;
+			unsigned byteCount = item.m_stripVertexCount * sizeof(glm::vec3);
 
-			pos.clear();
-			normals.clear();
-			tangents.clear();
+			// Update the positions, normals and tangents
+			commands.update_buffer(m_posVbos[r], &view.m_clothPositions[first], byteCount);
+			commands.update_buffer(m_normalVbos[r], &view.m_clothNormals[first], byteCount);
+			commands.update_buffer(m_tangentVbos[r], &view.m_clothTangents[first], byteCount);
 
-			glBindVertexArray(0);
+			// Draw the current triangle strip
+			commands.draw(m_vaos[r], GL_TRIANGLE_STRIP, item.m_stripVertexCount);
 		}
 	}
 
@@ -519,41 +523,47 @@ namespace cs460
 	}
 
 
-	void Cloth::setup_uniforms()
+	void Cloth::record_uniforms(const RenderView& view, RenderCommandBuffer& commands) const
 	{
 		ResourceManager& resourceMgr = ResourceManager::get_instance();
 
-		// Shader and uniform setup
-		Shader* shader = resourceMgr.get_shader("phong_normal_map");
-		shader->use();
-		shader->set_uniform("mat.m_diffuse", m_diffuse.get_texture_unit());
-		shader->set_uniform("mat.m_normalMap", m_normalMap.get_texture_unit());
-		shader->set_uniform("mat.m_shininess", 8.0f);
-		shader->set_uniform("normalColorScale", 1.0f);
-		shader->set_uniform("useSkinning", false);
+		// Shader, textures and uniform setup
+		commands.use_shader(resourceMgr.get_shader("phong_normal_map"));
+		commands.bind_texture(TextureTarget::TEXTURE_2D, m_diffuse.get_id(), m_diffuse.get_texture_unit());
+		commands.bind_texture(TextureTarget::TEXTURE_2D, m_normalMap.get_id(), m_normalMap.get_texture_unit());
+		commands.set_uniform("mat.m_diffuse", m_diffuse.get_texture_unit());
+		commands.set_uniform("mat.m_normalMap", m_normalMap.get_texture_unit());
+		commands.set_uniform("mat.m_shininess", 8.0f);
+		commands.set_uniform("normalColorScale", 1.0f);
+		commands.set_uniform("useSkinning", false);
 		
-		Scene& scene = Scene::get_instance();
-		ICamera* cam = scene.get_active_camera();
-		shader->set_uniform("camPosWorldSpace", cam->get_position());
-		shader->set_uniform("worldToView", cam->get_view_mtx());
-		shader->set_uniform("perspectiveProj", cam->get_projection_mtx());
-		shader->set_uniform("modelToWorld", glm::mat4(1.0f));
-		shader->set_uniform("normalViewMtx", glm::transpose(glm::inverse(glm::mat3(cam->get_view_mtx() * glm::mat4(1.0f)))));
+		// Camera of the render view
+		commands.set_uniform("camPosWorldSpace", view.m_camPosition);
+		commands.set_uniform("worldToView", view.m_worldToView);
+		commands.set_uniform("perspectiveProj", view.m_perspectiveProj);
+		commands.set_uniform("modelToWorld", glm::mat4(1.0f));
+		commands.set_uniform("normalViewMtx", glm::transpose(glm::inverse(glm::mat3(view.m_worldToView * glm::mat4(1.0f)))));
 		
 		// Set the light properties
-		shader->set_uniform("light.m_direction", scene.m_lightProperties.m_direction);
-		shader->set_uniform("light.m_ambient", scene.m_lightProperties.m_ambient);
-		shader->set_uniform("light.m_diffuse", scene.m_lightProperties.m_diffuse);
-		shader->set_uniform("light.m_specular", scene.m_lightProperties.m_specular);
+		commands.set_uniform("light.m_direction", view.m_light.m_direction);
+		commands.set_uniform("light.m_ambient", view.m_light.m_ambient);
+		commands.set_uniform("light.m_diffuse", view.m_light.m_diffuse);
+		commands.set_uniform("light.m_specular", view.m_light.m_specular);
 	}
 
 
+	// The buffers and textures may still be used by recorded commands, so they are freed by the renderer after them
 	void Cloth::delete_gl_buffers()
 	{
-		glDeleteVertexArrays(m_vaos.size(), m_vaos.data());
-		glDeleteBuffers(m_posVbos.size(), m_posVbos.data());
-		glDeleteBuffers(m_normalVbos.size(), m_normalVbos.data());
-		glDeleteBuffers(m_texCoordsVbos.size(), m_texCoordsVbos.data());
+		RenderCommandBuffer& releaseCommands = Renderer::get_instance().get_release_commands();
+		releaseCommands.delete_handles(HandleType::VERTEX_ARRAY, m_vaos.data(), (unsigned)m_vaos.size());
+		releaseCommands.delete_handles(HandleType::BUFFER, m_posVbos.data(), (unsigned)m_posVbos.size());
+		releaseCommands.delete_handles(HandleType::BUFFER, m_normalVbos.data(), (unsigned)m_normalVbos.size());
+		releaseCommands.delete_handles(HandleType::BUFFER, m_texCoordsVbos.data(), (unsigned)m_texCoordsVbos.size());
+		releaseCommands.delete_handles(HandleType::BUFFER, m_tangentVbos.data(), (unsigned)m_tangentVbos.size());
+
+		unsigned textures[2] = { m_diffuse.release(), m_normalMap.release() };
+		releaseCommands.delete_handles(HandleType::TEXTURE, textures, 2);
 	}
 
 
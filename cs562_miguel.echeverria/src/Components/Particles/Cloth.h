@@ -16,6 +16,11 @@
 
 namespace cs460
 {
+	struct RenderView;
+	struct RenderClothItem;
+	class RenderCommandBuffer;
+
+
 	class Cloth : public IComponent
 	{
 	public:
@@ -26,7 +31,10 @@ namespace cs460
 		void initialize(SceneNode* sphere = nullptr);		// Initialize the particles as well as the constraints
 		void update();										// Update the particle system (verlet integration, constraints satisfaction etc)
 		void debug_draw();									// Debug draws this cloth
-		void draw_textured();								// Draw with a texture (currently hardcoded)
+
+		// Copy the triangle strips into the render view, and record the commands that draw them with a texture (currently hardcoded)
+		void extract_render_data(RenderView& view);
+		void record_draw(const RenderView& view, const RenderClothItem& item, RenderCommandBuffer& commands) const;
 
 		// Getters for number of particles in width and height
 		unsigned get_width() const;
@@ -64,8 +72,9 @@ namespace cs460
 		glm::vec3 get_averaged_normal(int row, int col);
 		glm::vec3 get_averaged_tangent(int row, int col);
 
-		void setup_uniforms();
+		void record_uniforms(const RenderView& view, RenderCommandBuffer& commands) const;
 
+		// The buffers and textures may still be used by recorded commands, so they are freed by the renderer after them
 		void delete_gl_buffers();
 
 		void on_gui() override;
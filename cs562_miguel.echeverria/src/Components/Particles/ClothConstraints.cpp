@@ -52,13 +52,13 @@ namespace cs460
 
 		// Get the true radius of the spere
 		float epsilon = 0.05f;
-		float sphereRadius = m_sphere->m_worldTr.m_scale.x + epsilon;
+		float sphereRadius = m_sphere->get_world_tr().m_scale.x + epsilon;
 
 		VerletParticle& particle = system->m_particles[m_part];
 
 		// "Clamp" the particle against the sphere
-		glm::vec3 dir = particle.m_pos - m_sphere->m_worldTr.m_position;
+		glm::vec3 dir = particle.m_pos - m_sphere->get_world_tr().m_position;
 		if (glm::length2(dir) <= sphereRadius * sphereRadius)
-			particle.m_pos = m_sphere->m_worldTr.m_position + glm::normalize(dir) * sphereRadius;
+			particle.m_pos = m_sphere->get_world_tr().m_position + glm::normalize(dir) * sphereRadius;
 	}
 }
\ No newline at end of file
@@ -46,7 +46,7 @@ namespace cs460
 		m_nodeToMove = rootNode->create_child("CurveCesiumMan");
 		ModelInstance* modelInst = m_nodeToMove->add_component<ModelInstance>();
 		modelInst->change_model("data/Models/rigged figure/CesiumMan.gltf");
-		m_nodeToMove->m_localTr.m_scale = glm::vec3(0.5f, 0.5f, 0.5f);
+		m_nodeToMove->set_local_scale(glm::vec3(0.5f, 0.5f, 0.5f));
 		AnimationReference* animComp = m_nodeToMove->get_component<AnimationReference>();
 		animComp->change_animation(0, "");
 	}
@@ -498,7 +498,7 @@ namespace cs460
 			}
 
 			// Get the position value
-			float* pos = glm::value_ptr(child->m_worldTr.m_position);
+			const float* pos = glm::value_ptr(child->get_world_tr().m_position);
 			values.push_back(pos[0]);
 			values.push_back(pos[1]);
 			values.push_back(pos[2]);
@@ -551,9 +551,9 @@ namespace cs460
 			if (tangentComp)
 			{
 				if (tangentComp->get_is_in_tangent())
-					inTangent = /*glm::normalize(*/child->m_worldTr.m_position - pointNode->m_worldTr.m_position/*)*/;
+					inTangent = /*glm::normalize(*/child->get_world_tr().m_position - pointNode->get_world_tr().m_position/*)*/;
 				else
-					outTangent = /*glm::normalize(*/child->m_worldTr.m_position - pointNode->m_worldTr.m_position/*)*/;
+					outTangent = /*glm::normalize(*/child->get_world_tr().m_position - pointNode->get_world_tr().m_position/*)*/;
 			}
 		}
 	}
@@ -566,9 +566,9 @@ namespace cs460
 			if (tangentComp)
 			{
 				if (tangentComp->get_is_left_control_point())
-					leftControlPoint = child->m_worldTr.m_position;
+					leftControlPoint = child->get_world_tr().m_position;
 				else
-					rightControlPoint = child->m_worldTr.m_position;
+					rightControlPoint = child->get_world_tr().m_position;
 			}
 		}
 	}
@@ -657,7 +657,7 @@ namespace cs460
 			if (pointComp == nullptr)
 				continue;
 
-			const glm::vec3& currPos = child->m_worldTr.m_position;
+			const glm::vec3& currPos = child->get_world_tr().m_position;
 
 			// Draw the point as an aabb
 			DebugRenderer::draw_curve_node(currPos, DebugRenderer::s_curvePointColor, DebugRenderer::s_curvePointSize);
@@ -696,7 +696,7 @@ namespace cs460
 
 			// Draw the point as an aabb
 			if (DebugRenderer::s_enableCurveDrawing)
-				DebugRenderer::draw_curve_node(child->m_worldTr.m_position, DebugRenderer::s_curvePointColor, DebugRenderer::s_curvePointSize);
+				DebugRenderer::draw_curve_node(child->get_world_tr().m_position, DebugRenderer::s_curvePointColor, DebugRenderer::s_curvePointSize);
 
 			// Debug draw the tangents/control_points of the current point
 			if (DebugRenderer::s_enableTangentDrawing && (type == CURVE_TYPE::HERMITE || type == CURVE_TYPE::BEZIER))
@@ -752,13 +752,13 @@ namespace cs460
 				continue;
 
 			// Draw the tangent endpoint
-			DebugRenderer::draw_curve_node(child->m_worldTr.m_position, DebugRenderer::s_tangentEndpointColor, DebugRenderer::s_tangentEndpointSize);
+			DebugRenderer::draw_curve_node(child->get_world_tr().m_position, DebugRenderer::s_tangentEndpointColor, DebugRenderer::s_tangentEndpointSize);
 
 
 			// Draw the line from the point to the tangent endpoint
 			Segment seg;
-			seg.m_start = pointNode->m_worldTr.m_position;
-			seg.m_end = child->m_worldTr.m_position;
+			seg.m_start = pointNode->get_world_tr().m_position;
+			seg.m_end = child->get_world_tr().m_position;
 			DebugRenderer::draw_segment(seg, DebugRenderer::s_tangentLineColor);
 		}
 	}
@@ -1032,7 +1032,7 @@ namespace cs460
 			m_currentTime += dt * /*m_timeScale **/ m_direction;
 		}
 
-		m_nodeToMove->m_localTr.m_position = m_currentPos;
+		m_nodeToMove->set_local_position(m_currentPos);
 	}
 
 	// Orient the character using a basic frenet frame
@@ -1102,6 +1102,6 @@ namespace cs460
 			resultOrientation = glm::quatLookAtLH(tangent, normal);
 		else
 			resultOrientation = glm::quatLookAtLH(tangent, globalUp);
-		m_nodeToMove->m_localTr.m_orientation = resultOrientation;
+		m_nodeToMove->set_local_orientation(resultOrientation);
 	}
 }
\ No newline at end of file
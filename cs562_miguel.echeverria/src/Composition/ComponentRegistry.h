@@ -0,0 +1,168 @@
+/**
+* @file ComponentRegistry.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Container used by the systems to keep track of their components. The
+*		 components are stored contiguously for iteration, and are added and
+*		 removed in constant time through generational handles.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+
+namespace cs460
+{
+	// Handle to an element of a registry. The generation changes every time the slot is
+	// reused, so a handle to an element that was removed never gives a different one.
+	struct RegistryHandle
+	{
+		static const unsigned INVALID_SLOT = 0xFFFFFFFF;
+
+		unsigned m_slot = INVALID_SLOT;
+		unsigned m_generation = 0;
+
+		bool is_valid() const { return m_slot != INVALID_SLOT; }
+	};
+
+
+	template<typename T>
+	class ComponentRegistry
+	{
+	public:
+
+		// Add an element and get the handle needed to remove it
+		RegistryHandle add(T* item);
+
+		// Remove the element of the handle (if it still exists). The last element is moved to its
+		// place, so removing while iterating skips the element that was moved.
+		void remove(RegistryHandle handle);
+
+		// Get the element of the handle (null if it was removed)
+		T* get(RegistryHandle handle) const;
+
+		void reserve(unsigned count);
+		void clear();
+
+		// Iteration over the elements (in no particular order)
+		unsigned size() const { return (unsigned)m_items.size(); }
+		bool empty() const { return m_items.empty(); }
+		T* operator[](unsigned idx) const { return m_items[idx]; }
+		typename std::vector<T*>::const_iterator begin() const { return m_items.begin(); }
+		typename std::vector<T*>::const_iterator end() const { return m_items.end(); }
+
+	private:
+
+		struct Slot
+		{
+			unsigned m_itemIdx = 0;			// Index in m_items while the slot is in use
+			unsigned m_generation = 0;
+		};
+
+		std::vector<T*> m_items;
+		std::vector<unsigned> m_itemSlots;		// Slot of each element of m_items
+		std::vector<Slot> m_slots;
+		std::vector<unsigned> m_freeSlots;
+
+		// Whether the handle refers to an element that is still in the registry
+		bool is_alive(RegistryHandle handle) const;
+	};
+
+
+	// Add an element and get the handle needed to remove it
+	template<typename T>
+	RegistryHandle ComponentRegistry<T>::add(T* item)
+	{
+		unsigned slotIdx = 0;
+		if (!m_freeSlots.empty())
+		{
+			slotIdx = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else
+		{
+			slotIdx = (unsigned)m_slots.size();
+			m_slots.push_back(Slot());
+		}
+
+		Slot& slot = m_slots[slotIdx];
+		slot.m_itemIdx = (unsigned)m_items.size();
+		m_items.push_back(item);
+		m_itemSlots.push_back(slotIdx);
+
+		RegistryHandle handle;
+		handle.m_slot = slotIdx;
+		handle.m_generation = slot.m_generation;
+		return handle;
+	}
+
+	// Remove the element of the handle (if it still exists). The last element is moved to its
+	// place, so removing while iterating skips the element that was moved.
+	template<typename T>
+	void ComponentRegistry<T>::remove(RegistryHandle handle)
+	{
+		if (!is_alive(handle))
+			return;
+
+		Slot& slot = m_slots[handle.m_slot];
+		unsigned itemIdx = slot.m_itemIdx;
+		unsigned lastIdx = (unsigned)m_items.size() - 1;
+
+		// Move the last element to the hole
+		m_items[itemIdx] = m_items[lastIdx];
+		m_itemSlots[itemIdx] = m_itemSlots[lastIdx];
+		m_slots[m_itemSlots[itemIdx]].m_itemIdx = itemIdx;
+		m_items.pop_back();
+		m_itemSlots.pop_back();
+
+		// Invalidate any handle to the slot and allow reusing it
+		++slot.m_generation;
+		m_freeSlots.push_back(handle.m_slot);
+	}
+
+	// Get the element of the handle (null if it was removed)
+	template<typename T>
+	T* ComponentRegistry<T>::get(RegistryHandle handle) const
+	{
+		if (!is_alive(handle))
+			return nullptr;
+
+		return m_items[m_slots[handle.m_slot].m_itemIdx];
+	}
+
+
+	template<typename T>
+	void ComponentRegistry<T>::reserve(unsigned count)
+	{
+		m_items.reserve(count);
+		m_itemSlots.reserve(count);
+		m_slots.reserve(count);
+	}
+
+	template<typename T>
+	void ComponentRegistry<T>::clear()
+	{
+		// Every slot gets a new generation, so the old handles stop working
+		for (unsigned slotIdx : m_itemSlots)
+		{
+			++m_slots[slotIdx].m_generation;
+			m_freeSlots.push_back(slotIdx);
+		}
+
+		m_items.clear();
+		m_itemSlots.clear();
+	}
+
+
+	// Whether the handle refers to an element that is still in the registry
+	template<typename T>
+	bool ComponentRegistry<T>::is_alive(RegistryHandle handle) const
+	{
+		if (handle.m_slot >= m_slots.size())
+			return false;
+
+		const Slot& slot = m_slots[handle.m_slot];
+		return slot.m_generation == handle.m_generation;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+/**
+* @file ModelPrefab.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Nodes and components of an instance of a model, gathered once from
+*		 its gltf hierarchy, so that every instance only copies the lists.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "ModelPrefab.h"
+#include "SceneNode.h"
+#include "Scene.h"
+#include "GLTFNode.h"
+#include "Graphics/GLTF/Model.h"
+#include "Components/Models/ModelInstance.h"
+#include "Components/Models/MeshRenderable.h"
+#include "Components/Animation/AnimationReference.h"
+#include "Components/Animation/SkinReference.h"
+#include "Components/Animation/SkeletonRoot.h"
+#include "Components/Animation/Joint.h"
+
+
+namespace cs460
+{
+	// Gather the nodes of the default scene of the model in the order they are created (every parent before its
+	// children), and the components added to them in the same order generating them node by node would
+	void ModelPrefab::build(Model* model)
+	{
+		m_model = model;
+		m_nodes.clear();
+		m_components.clear();
+
+		if (model->m_scenes.empty())
+			return;
+
+		const std::vector<int>& rootIndices = model->m_scenes[model->m_defaultScene].m_nodeIndices;
+		for (int rootIdx : rootIndices)
+			add_nodes(rootIdx, -1);
+
+		// Component of each type of each node (to add every component once, with the last skin that sets it)
+		std::vector<int> componentIndices(model->m_nodes.size() * 4, -1);
+		for (int rootIdx : rootIndices)
+			add_components(rootIdx, componentIndices);
+
+		// To reserve the children and components of each node
+		std::vector<int> prefabIndices(model->m_nodes.size(), -1);
+		for (unsigned i = 0; i < m_nodes.size(); ++i)
+		{
+			prefabIndices[m_nodes[i].m_nodeIdx] = (int)i;
+			m_nodes[i].m_childCount = (unsigned)model->m_nodes[m_nodes[i].m_nodeIdx].m_childrenIndices.size();
+		}
+		for (const PrefabComponent& prefabComp : m_components)
+			if (prefabIndices[prefabComp.m_nodeIdx] >= 0)
+				++m_nodes[prefabIndices[prefabComp.m_nodeIdx]].m_componentCount;
+	}
+
+
+	// Create the nodes and components of the model under the node of the model instance (which has no children yet),
+	// and find the joints of the skins. Also adds the animation component to the node of the model instance.
+	void ModelPrefab::instantiate(ModelInstance* modelInst) const
+	{
+		SceneNode* rootNode = modelInst->get_owner();
+		rootNode->set_model_source(m_model);
+		rootNode->set_model_root_node(rootNode);
+
+		Scene& scene = Scene::get_instance();
+		std::vector<SceneNode*>& instanceNodes = scene.get_model_inst_nodes(modelInst->get_instance_id());
+		instanceNodes.assign(m_model->m_nodes.size(), nullptr);
+
+		for (const PrefabNode& prefabNode : m_nodes)
+		{
+			const GLTFNode& gltfNode = m_model->m_nodes[prefabNode.m_nodeIdx];
+			SceneNode* parent = prefabNode.m_parentIdx < 0 ? rootNode : instanceNodes[prefabNode.m_parentIdx];
+			SceneNode* node = parent->create_child(gltfNode.m_name);
+			node->set_model_source(m_model);
+			node->set_model_root_node(rootNode);
+			node->set_local_tr(gltfNode.m_localTransform);
+			node->m_children.reserve(prefabNode.m_childCount);
+			node->m_components.reserve(prefabNode.m_componentCount);
+			instanceNodes[prefabNode.m_nodeIdx] = node;
+		}
+
+		// Before the skins, that keep it
+		rootNode->add_component<AnimationReference>();
+
+		for (const PrefabComponent& prefabComp : m_components)
+		{
+			// The joints of a skin might not be in the default scene
+			SceneNode* node = instanceNodes[prefabComp.m_nodeIdx];
+			if (node == nullptr)
+				continue;
+
+			switch (prefabComp.m_type)
+			{
+			case ComponentType::MESH_RENDERABLE:
+			{
+				MeshRenderable* comp = node->add_component<MeshRenderable>();
+				comp->set_mesh_idx(prefabComp.m_resourceIdx);
+				comp->set_local_bounding_volume(m_model->m_meshes[prefabComp.m_resourceIdx].m_boundingVolume);
+				break;
+			}
+			case ComponentType::SKIN_REFERENCE:
+				node->add_component<SkinReference>()->set_skin_idx(prefabComp.m_resourceIdx);
+				break;
+			case ComponentType::SKELETON_ROOT:
+				node->add_component<SkeletonRoot>()->set_skin_idx(prefabComp.m_resourceIdx);
+				break;
+			case ComponentType::JOINT:
+				node->add_component<Joint>()->set_skin_idx(prefabComp.m_resourceIdx);
+				break;
+			}
+		}
+
+		// Now that every node has its components, instead of in the first update of each skin
+		for (const PrefabComponent& prefabComp : m_components)
+			if (prefabComp.m_type == ComponentType::SKIN_REFERENCE && instanceNodes[prefabComp.m_nodeIdx] != nullptr)
+				instanceNodes[prefabComp.m_nodeIdx]->get_component<SkinReference>()->find_joint_nodes();
+	}
+
+
+	unsigned ModelPrefab::get_node_count() const
+	{
+		return (unsigned)m_nodes.size();
+	}
+
+	unsigned ModelPrefab::get_component_count() const
+	{
+		return (unsigned)m_components.size();
+	}
+
+
+	void ModelPrefab::add_nodes(int nodeIdx, int parentIdx)
+	{
+		PrefabNode prefabNode;
+		prefabNode.m_nodeIdx = nodeIdx;
+		prefabNode.m_parentIdx = parentIdx;
+		m_nodes.push_back(prefabNode);
+
+		for (int childIdx : m_model->m_nodes[nodeIdx].m_childrenIndices)
+			add_nodes(childIdx, nodeIdx);
+	}
+
+	// Same order as generating the mesh and skin components of each node, and then the ones of its children
+	void ModelPrefab::add_components(int nodeIdx, std::vector<int>& componentIndices)
+	{
+		const GLTFNode& node = m_model->m_nodes[nodeIdx];
+
+		if (node.m_meshIdx >= 0 && node.m_meshIdx < m_model->m_meshes.size())
+			add_component(ComponentType::MESH_RENDERABLE, nodeIdx, node.m_meshIdx, componentIndices);
+
+		if (node.m_skinIdx >= 0 && node.m_skinIdx < m_model->m_skins.size())
+		{
+			add_component(ComponentType::SKIN_REFERENCE, nodeIdx, node.m_skinIdx, componentIndices);
+
+			const Skin& skin = m_model->m_skins[node.m_skinIdx];
+			add_component(ComponentType::SKELETON_ROOT, skin.m_commonRootIdx, node.m_skinIdx, componentIndices);
+			for (int jointIdx : skin.m_joints)
+				add_component(ComponentType::JOINT, jointIdx, node.m_skinIdx, componentIndices);
+		}
+
+		for (int childIdx : node.m_childrenIndices)
+			add_components(childIdx, componentIndices);
+	}
+
+	// A node can't have the same component twice, so adding it again only changes its skin (like set_skin_idx would)
+	void ModelPrefab::add_component(ComponentType type, int nodeIdx, int resourceIdx, std::vector<int>& componentIndices)
+	{
+		int& componentIdx = componentIndices[nodeIdx * 4 + (int)type];
+		if (componentIdx >= 0)
+		{
+			m_components[componentIdx].m_resourceIdx = resourceIdx;
+			return;
+		}
+
+		componentIdx = (int)m_components.size();
+		PrefabComponent prefabComp;
+		prefabComp.m_type = type;
+		prefabComp.m_nodeIdx = nodeIdx;
+		prefabComp.m_resourceIdx = resourceIdx;
+		m_components.push_back(prefabComp);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+/**
+* @file ModelPrefab.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Nodes and components of an instance of a model, gathered once from
+*		 its gltf hierarchy, so that every instance only copies the lists.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+
+namespace cs460
+{
+	struct Model;
+	class ModelInstance;
+
+
+	class ModelPrefab
+	{
+	public:
+
+		// Gather the nodes of the default scene of the model in the order they are created (every parent before its
+		// children), and the components added to them in the same order generating them node by node would
+		void build(Model* model);
+
+		// Create the nodes and components of the model under the node of the model instance (which has no children yet),
+		// and find the joints of the skins. Also adds the animation component to the node of the model instance.
+		void instantiate(ModelInstance* modelInst) const;
+
+		unsigned get_node_count() const;
+		unsigned get_component_count() const;
+
+	private:
+
+		enum class ComponentType
+		{
+			MESH_RENDERABLE,
+			SKIN_REFERENCE,
+			SKELETON_ROOT,
+			JOINT
+		};
+
+		struct PrefabNode
+		{
+			int m_nodeIdx = -1;			// Index of the gltf node
+			int m_parentIdx = -1;		// Index of the gltf node of the parent (-1 for the children of the model instance)
+			unsigned m_childCount = 0;
+			unsigned m_componentCount = 0;
+		};
+
+		struct PrefabComponent
+		{
+			ComponentType m_type = ComponentType::MESH_RENDERABLE;
+			int m_nodeIdx = -1;			// Index of the gltf node it is added to
+			int m_resourceIdx = -1;		// Index of the mesh or skin in the model
+		};
+
+		Model* m_model = nullptr;
+		std::vector<PrefabNode> m_nodes;
+		std::vector<PrefabComponent> m_components;
+
+		void add_nodes(int nodeIdx, int parentIdx);
+		void add_components(int nodeIdx, std::vector<int>& componentIndices);
+		void add_component(ComponentType type, int nodeIdx, int resourceIdx, std::vector<int>& componentIndices);
+	};
+}
\ No newline at end of file
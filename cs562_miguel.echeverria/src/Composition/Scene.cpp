@@ -10,10 +10,14 @@
 #include "pch.h"
 #include "Scene.h"
 #include "SceneNode.h"
+#include "SceneCommandQueue.h"
 #include "GUI/EditorState.h"
 #include "Platform/InputMgr.h"
 #include "Cameras/EditorCamera.h"
 #include "Cameras/SphericalCamera.h"
+#include "ModelPrefab.h"
+#include "Graphics/GLTF/Model.h"
+#include "Components/Models/ModelInstance.h"
 //#include "Components/Animation/IKChainRoot.h"
 
 
@@ -57,13 +61,10 @@ namespace cs460
 			return;
 		}
 
-		// Special case, set the root's world transform as the local transform
-		m_root->m_worldTr = m_root->m_localTr;
-
-		// Update its childs
-		const std::vector<SceneNode*>& children = m_root->get_children();
-		for (int i = 0; i < children.size(); ++i)
-			update_node(children[i]);
+		// Remove the transforms of the nodes deleted since the last update, and update the world transforms
+		// of the nodes whose local transform changed, and their subtrees (static nodes cost nothing)
+		m_transforms.compact();
+		m_transforms.update_world_transforms();
 	}
 
 	void Scene::close()
@@ -78,6 +79,7 @@ namespace cs460
 
 		delete m_camera;
 		m_camera = nullptr;
+		m_transforms.clear();
 	}
 
 	
@@ -93,6 +95,9 @@ namespace cs460
 		if (m_root == nullptr)
 			return;
 
+		// The pending requests may reference the deleted nodes
+		get_command_queue().discard();
+
 		// Delete all the children
 		std::vector<SceneNode*>& children = m_root->m_children;
 		for (int i = 0; i < children.size(); ++i)
@@ -106,6 +111,12 @@ namespace cs460
 		return m_root;
 	}
 
+	// Transforms of every node, in the order they are updated
+	TransformHierarchy& Scene::get_transforms()
+	{
+		return m_transforms;
+	}
+
 	ICamera* Scene::get_active_camera()
 	{
 		return m_camera;
@@ -125,38 +136,38 @@ namespace cs460
 			m_camera = new SphericalCamera;
 	}
 
-	std::vector<std::unordered_map<int, SceneNode*>>& Scene::get_all_model_nodes()
+	// Nodes of each model instance, indexed by the index of their node in the gltf model (null if not instanced)
+	std::vector<std::vector<SceneNode*>>& Scene::get_all_model_nodes()
 	{
 		return m_modelNodes;
 	}
 
-	std::unordered_map<int, SceneNode*>& Scene::get_model_inst_nodes(int instanceId)
+	std::vector<SceneNode*>& Scene::get_model_inst_nodes(int instanceId)
 	{
 		return m_modelNodes[instanceId];
 	}
 
-	// Recursive function to update the transform of the provided node
-	void Scene::update_node(SceneNode* node)
+	// Get a free index in the model nodes dictionaries (reusing the ones of deleted instances)
+	unsigned Scene::allocate_model_instance_id()
 	{
-		if (node == nullptr)
-			return;
-
-		//if (node->get_component<IKChainRoot>())
-		//	return;
-
-		if (node->m_updateWorldTr)
+		if (!m_freeModelInstanceIds.empty())
 		{
-			// Update the world transform of the current node (it's parent world tr is already updated)
-			if (SceneNode* parent = node->get_parent())
-				node->m_worldTr.concatenate(node->m_localTr, parent->m_worldTr);
+			unsigned instanceId = m_freeModelInstanceIds.back();
+			m_freeModelInstanceIds.pop_back();
+			return instanceId;
 		}
 
-		node->m_updateWorldTr = true;
+		m_modelNodes.push_back({});
+		return (unsigned)m_modelNodes.size() - 1;
+	}
 
-		// Update all its childs
-		const std::vector<SceneNode*>& children = node->get_children();
-		for (int i = 0; i < children.size(); ++i)
-			update_node(children[i]);
+	void Scene::free_model_instance_id(unsigned instanceId)
+	{
+		if (instanceId >= m_modelNodes.size())
+			return;
+
+		m_modelNodes[instanceId].clear();
+		m_freeModelInstanceIds.push_back(instanceId);
 	}
 
 	// Recursive function to free the memory of all the nodes
@@ -169,18 +180,71 @@ namespace cs460
 			parent->m_children.clear();
 	}
 
+	// Remove the node from its parent's children, and delete its tree
+	void Scene::destroy_node(SceneNode* node)
+	{
+		if (node == nullptr || node == m_root)
+			return;
+
+		if (SceneNode* parent = node->get_parent())
+		{
+			std::vector<SceneNode*>& siblings = parent->m_children;
+			siblings.erase(std::remove(siblings.begin(), siblings.end(), node), siblings.end());
+		}
+
+		delete_tree_internal(node);
+	}
+
+	// Create count nodes with an instance of the model as children of parent (the root if null), named after the model
+	// and their index. Every instance is cloned from the prefab of the model, with space reserved for all of them first.
+	std::vector<SceneNode*> Scene::instantiate(Model* model, unsigned count, SceneNode* parent)
+	{
+		std::vector<SceneNode*> instances;
+		if (parent == nullptr)
+			parent = m_root;
+		if (model == nullptr || parent == nullptr || count == 0)
+			return instances;
+
+		const ModelPrefab& prefab = model->get_prefab();
+		m_transforms.reserve(m_transforms.get_size() + count * (prefab.get_node_count() + 1));
+		m_modelNodes.reserve(m_modelNodes.size() + count);
+		parent->m_children.reserve(parent->m_children.size() + count);
+		instances.reserve(count);
+
+		std::string name = fs::path(model->m_fileName).stem().generic_string() + " ";
+		for (unsigned i = 0; i < count; ++i)
+		{
+			SceneNode* node = parent->create_child(name + std::to_string(i));
+			node->add_component<ModelInstance>()->change_model(model);
+			instances.push_back(node);
+		}
+
+		return instances;
+	}
+
+	// Requests to create/destroy nodes and components from any thread. They are applied by apply_commands.
+	SceneCommandQueue& Scene::get_command_queue()
+	{
+		static SceneCommandQueue queue;
+		return queue;
+	}
+
+	// Apply the requests of the command queue. Called once per frame by the main thread, when no system is iterating.
+	void Scene::apply_commands()
+	{
+		get_command_queue().apply();
+	}
+
 	void Scene::delete_tree_internal(SceneNode* node)
 	{
 		if (node == nullptr)
 			return;
 
+		// Delete all the children first and clear the vector once (erasing one by one is quadratic)
 		std::vector<SceneNode*>& children = node->m_children;
-		for (auto it = children.begin(); it != children.end();)
-		{
-			//std::cout << "DELETE TREE\n";
-			delete_tree_internal(*it);
-			it = children.erase(it);
-		}
+		for (int i = 0; i < children.size(); ++i)
+			delete_tree_internal(children[i]);
+		children.clear();
 
 		delete node;
 	}
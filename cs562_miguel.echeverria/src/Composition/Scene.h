@@ -9,11 +9,15 @@
 
 #pragma once
 
+#include "TransformHierarchy.h"
+
 
 namespace cs460
 {
 	class SceneNode;
 	class ICamera;
+	class SceneCommandQueue;
+	struct Model;
 
 	// Should this go on a separate file and inside a different class?
 	struct LightProperties
@@ -39,26 +43,44 @@ namespace cs460
 
 		void clear();							// Delete all the nodes in the scene graph except the root
 		void delete_tree(SceneNode* node, bool clearParentChildren = false);//, bool clearParentChildren = true);		// Recursive function to free the memory of all the nodes in the given tree
+		void destroy_node(SceneNode* node);		// Remove the node from its parent's children, and delete its tree
+
+		// Create count nodes with an instance of the model as children of parent (the root if null), named after the model
+		// and their index. Every instance is cloned from the prefab of the model, with space reserved for all of them first.
+		std::vector<SceneNode*> instantiate(Model* model, unsigned count, SceneNode* parent = nullptr);
+
+		// Requests to create/destroy nodes and components from any thread. They are applied by apply_commands.
+		SceneCommandQueue& get_command_queue();
+		void apply_commands();
 
 		SceneNode* get_root() const;
+
+		// Transforms of every node, in the order they are updated
+		TransformHierarchy& get_transforms();
 	
 		// The whole camera api will change
 		ICamera* get_active_camera();
 		void change_camera(bool isEditorCam);	// TODO: Change this to a better system
 
-		std::vector<std::unordered_map<int, SceneNode*>>& get_all_model_nodes();
-		std::unordered_map<int, SceneNode*>& get_model_inst_nodes(int instanceId);
+		// Nodes of each model instance, indexed by the index of their node in the gltf model (null if not instanced)
+		std::vector<std::vector<SceneNode*>>& get_all_model_nodes();
+		std::vector<SceneNode*>& get_model_inst_nodes(int instanceId);
+
+		// Get a free index in the model nodes dictionaries (reusing the ones of deleted instances)
+		unsigned allocate_model_instance_id();
+		void free_model_instance_id(unsigned instanceId);
 
 		LightProperties m_lightProperties;
 
 	private:
 	
 		SceneNode* m_root;
-		std::vector<std::unordered_map<int, SceneNode*>> m_modelNodes;		// One "dictionary" per model instance in the scene
+		TransformHierarchy m_transforms;
+		std::vector<std::vector<SceneNode*>> m_modelNodes;					// One "dictionary" per model instance in the scene
+		std::vector<unsigned> m_freeModelInstanceIds;						// Dictionaries of deleted instances, ready to be reused
 		ICamera* m_camera;
 		bool m_isEditorCamera;
 		
-		void update_node(SceneNode* node);		// Recursive function to update the transform of the provided node
 		void delete_tree_internal(SceneNode* node);
 
 		// For singleton pattern
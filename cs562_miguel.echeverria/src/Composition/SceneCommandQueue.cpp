@@ -0,0 +1,180 @@
+/**
+* @file SceneCommandQueue.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Queue of requests to create and destroy scene nodes and components. Any thread
+*		 can push requests without locking, and they are applied by the main thread at
+*		 a fixed point of the frame, when no system is iterating its components.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "SceneCommandQueue.h"
+#include <unordered_set>
+
+
+namespace cs460
+{
+	SceneCommandQueue::~SceneCommandQueue()
+	{
+		discard();
+	}
+
+
+	// Request the creation of a child of the given parent. The callback (optional) is called with the new node.
+	void SceneCommandQueue::create_node(SceneNode* parent, const std::string& name, NodeCallback onCreated)
+	{
+		SceneCommand* command = new SceneCommand;
+		command->m_type = SceneCommandType::CREATE_NODE;
+		command->m_node = parent;
+		command->m_name = name;
+		command->m_function = std::move(onCreated);
+		push(command);
+	}
+
+	void SceneCommandQueue::create_node_with_model(SceneNode* parent, const std::string& name, const fs::path& modelPath, NodeCallback onCreated)
+	{
+		SceneCommand* command = new SceneCommand;
+		command->m_type = SceneCommandType::CREATE_NODE_WITH_MODEL;
+		command->m_node = parent;
+		command->m_name = name;
+		command->m_modelPath = modelPath;
+		command->m_function = std::move(onCreated);
+		push(command);
+	}
+
+	// Request the deletion of the given node and all its children
+	void SceneCommandQueue::destroy_node(SceneNode* node)
+	{
+		SceneCommand* command = new SceneCommand;
+		command->m_type = SceneCommandType::DESTROY_NODE;
+		command->m_node = node;
+		push(command);
+	}
+
+
+	// Apply all the requests pushed until now, in the order they were pushed by each thread. The creations
+	// and component changes go first, and then the destructions, so that a request never uses a deleted node
+	// (even if another request deleted one of its ancestors). Only called from the main thread.
+	void SceneCommandQueue::apply()
+	{
+		m_lastAppliedCount = 0;
+		SceneCommand* command = pop_all();
+		if (command == nullptr)
+			return;
+
+		std::vector<SceneNode*> nodesToDestroy;
+		while (command != nullptr)
+		{
+			switch (command->m_type)
+			{
+			case SceneCommandType::CREATE_NODE:
+			case SceneCommandType::CREATE_NODE_WITH_MODEL:
+			{
+				SceneNode* parent = command->m_node != nullptr ? command->m_node : Scene::get_instance().get_root();
+				SceneNode* node = nullptr;
+				if (command->m_type == SceneCommandType::CREATE_NODE)
+					node = parent->create_child(command->m_name);
+				else
+					node = parent->create_child_with_model(command->m_name, command->m_modelPath);
+
+				if (command->m_function)
+					command->m_function(node);
+				break;
+			}
+			case SceneCommandType::DESTROY_NODE:
+				if (command->m_node != nullptr && command->m_node != Scene::get_instance().get_root())
+					nodesToDestroy.push_back(command->m_node);
+				break;
+
+			case SceneCommandType::EDIT_NODE:
+				if (command->m_node != nullptr)
+					command->m_function(command->m_node);
+				break;
+			}
+
+			SceneCommand* next = command->m_next;
+			delete command;
+			command = next;
+			++m_lastAppliedCount;
+		}
+
+		// Skip the nodes that will already be deleted with one of their ancestors (or twice)
+		std::unordered_set<SceneNode*> destroySet(nodesToDestroy.begin(), nodesToDestroy.end());
+		for (SceneNode* node : nodesToDestroy)
+		{
+			if (destroySet.find(node) == destroySet.end())
+				continue;
+
+			bool ancestorDestroyed = false;
+			for (SceneNode* ancestor = node->get_parent(); ancestor != nullptr && !ancestorDestroyed; ancestor = ancestor->get_parent())
+				ancestorDestroyed = destroySet.find(ancestor) != destroySet.end();
+
+			if (ancestorDestroyed)
+				destroySet.erase(node);
+		}
+
+		// Delete the rest in the order they were requested
+		Scene& scene = Scene::get_instance();
+		for (SceneNode* node : nodesToDestroy)
+		{
+			if (destroySet.erase(node) != 0)
+				scene.destroy_node(node);
+		}
+	}
+
+	// Delete the requests without applying them (used when the nodes they reference are deleted)
+	void SceneCommandQueue::discard()
+	{
+		SceneCommand* command = m_head.exchange(nullptr, std::memory_order_acquire);
+		while (command != nullptr)
+		{
+			SceneCommand* next = command->m_next;
+			delete command;
+			command = next;
+		}
+	}
+
+	// Number of requests applied by the last call to apply
+	unsigned SceneCommandQueue::get_last_applied_count() const
+	{
+		return m_lastAppliedCount;
+	}
+
+
+	// Add a request to the queue (can be called from any thread)
+	void SceneCommandQueue::push(SceneCommand* command)
+	{
+		// Link it in front of the current head, and retry if another thread pushed in between
+		command->m_next = m_head.load(std::memory_order_relaxed);
+		while (!m_head.compare_exchange_weak(command->m_next, command, std::memory_order_release, std::memory_order_relaxed))
+			;
+	}
+
+	// Take all the pushed requests, in the order they were pushed
+	SceneCommand* SceneCommandQueue::pop_all()
+	{
+		SceneCommand* newest = m_head.exchange(nullptr, std::memory_order_acquire);
+
+		// Reverse the list, so that it goes from oldest to newest
+		SceneCommand* oldest = nullptr;
+		while (newest != nullptr)
+		{
+			SceneCommand* next = newest->m_next;
+			newest->m_next = oldest;
+			oldest = newest;
+			newest = next;
+		}
+		return oldest;
+	}
+
+	void SceneCommandQueue::edit_node(SceneNode* node, NodeCallback function)
+	{
+		SceneCommand* command = new SceneCommand;
+		command->m_type = SceneCommandType::EDIT_NODE;
+		command->m_node = node;
+		command->m_function = std::move(function);
+		push(command);
+	}
+}
\ No newline at end of file
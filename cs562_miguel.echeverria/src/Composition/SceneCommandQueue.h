@@ -0,0 +1,113 @@
+/**
+* @file SceneCommandQueue.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Queue of requests to create and destroy scene nodes and components. Any thread
+*		 can push requests without locking, and they are applied by the main thread at
+*		 a fixed point of the frame, when no system is iterating its components.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "SceneNode.h"
+#include <atomic>
+
+
+namespace cs460
+{
+
+	enum class SceneCommandType
+	{
+		CREATE_NODE,			// Create a child of m_node
+		CREATE_NODE_WITH_MODEL,	// Create a child of m_node with a model instance of m_modelPath
+		DESTROY_NODE,			// Delete m_node and its subtree
+		EDIT_NODE				// Call m_function on m_node (used to add and delete components)
+	};
+
+
+	struct SceneCommand
+	{
+		SceneCommandType m_type = SceneCommandType::CREATE_NODE;
+		SceneNode* m_node = nullptr;
+		std::string m_name;
+		fs::path m_modelPath;
+
+		// Called with the created node, or with m_node when editing it
+		std::function<void(SceneNode*)> m_function;
+
+		SceneCommand* m_next = nullptr;			// Intrusive link of the queue
+	};
+
+
+	class SceneCommandQueue
+	{
+	public:
+
+		using NodeCallback = std::function<void(SceneNode*)>;
+
+		~SceneCommandQueue();
+
+		// Request the creation of a child of the given parent. The callback (optional) is called with the new node.
+		void create_node(SceneNode* parent, const std::string& name, NodeCallback onCreated = nullptr);
+		void create_node_with_model(SceneNode* parent, const std::string& name, const fs::path& modelPath, NodeCallback onCreated = nullptr);
+
+		// Request the deletion of the given node and all its children
+		void destroy_node(SceneNode* node);
+
+		// Request adding/deleting a component of type T to/from the given node. The
+		// callback (optional) is called with the component once it has been added.
+		template<typename T>
+		void add_component(SceneNode* node, std::function<void(T*)> onAdded = nullptr);
+
+		template<typename T>
+		void delete_component(SceneNode* node);
+
+		// Apply all the requests pushed until now, in the order they were pushed by each thread. The creations
+		// and component changes go first, and then the destructions, so that a request never uses a deleted node
+		// (even if another request deleted one of its ancestors). Only called from the main thread.
+		void apply();
+
+		// Delete the requests without applying them (used when the nodes they reference are deleted)
+		void discard();
+
+		// Number of requests applied by the last call to apply
+		unsigned get_last_applied_count() const;
+
+	private:
+
+		std::atomic<SceneCommand*> m_head{ nullptr };		// Last pushed request (the list goes from newest to oldest)
+		unsigned m_lastAppliedCount = 0;
+
+		// Add a request to the queue (can be called from any thread)
+		void push(SceneCommand* command);
+
+		// Take all the pushed requests, in the order they were pushed
+		SceneCommand* pop_all();
+
+		void edit_node(SceneNode* node, NodeCallback function);
+	};
+
+
+
+	// Request adding a component of type T to the given node. The callback (optional)
+	// is called with the component once it has been added.
+	template<typename T>
+	void SceneCommandQueue::add_component(SceneNode* node, std::function<void(T*)> onAdded)
+	{
+		edit_node(node, [onAdded](SceneNode* target)
+		{
+			T* comp = target->add_component<T>();
+			if (onAdded)
+				onAdded(comp);
+		});
+	}
+
+	// Request deleting the component of type T of the given node
+	template<typename T>
+	void SceneCommandQueue::delete_component(SceneNode* node)
+	{
+		edit_node(node, [](SceneNode* target) { target->delete_component<T>(); });
+	}
+}
\ No newline at end of file
@@ -21,6 +21,7 @@
 #include "Components/Animation/Joint.h"
 #include "Components/PiecewiseCurves/PiecewiseCurve.h"
 #include "Components/Animation/IKChainRoot.h"
+#include "Platform/ObjectPool.h"
 #include <gltf/tiny_gltf.h>
 
 
@@ -29,12 +30,24 @@ namespace cs460
 	unsigned SceneNode::s_UIDGenerator = 0;
 
 
+	namespace
+	{
+		// Never destroyed, the scene deletes its nodes at exit
+		ObjectPool& get_node_pool()
+		{
+			static ObjectPool* pool = new ObjectPool(sizeof(SceneNode), "SceneNode");
+			return *pool;
+		}
+	}
+
+
 	SceneNode::SceneNode(const std::string& name)
 		:	m_parent(nullptr),
 			m_modelRootNode(nullptr),
 			m_sourceModel(nullptr)
 	{
 		m_UID = s_UIDGenerator++;
+		m_transformIdx = Scene::get_instance().get_transforms().add(TransformHierarchy::INVALID_INDEX, this);
 		change_name(name);
 	}
 
@@ -42,17 +55,38 @@ namespace cs460
 	{
 		// Clear in case there are still components
 		delete_all_components();
+		Scene::get_instance().get_transforms().remove(m_transformIdx);
 	}
 
 
-	// Free all the children of this node
-	void SceneNode::delete_all_children()
+	// The nodes come from their own object pool, so creating and deleting model instances reuses the memory of the deleted nodes
+	// (anything of a different size, like a derived type, goes to the shared pool of its size instead)
+	void* SceneNode::operator new(size_t size)
+	{
+		if (size != sizeof(SceneNode))
+			return ObjectPool::allocate_object(size);
+
+		return get_node_pool().allocate();
+	}
+
+	void SceneNode::operator delete(void* ptr, size_t size)
 	{
-		for (auto it = m_children.begin(); it != m_children.end();)
+		if (size != sizeof(SceneNode))
 		{
-			Scene::get_instance().delete_tree(*it);//, false);
-			it = m_children.erase(it);
+			ObjectPool::deallocate_object(ptr, size);
+			return;
 		}
+
+		get_node_pool().deallocate(ptr);
+	}
+
+
+	// Free all the children of this node
+	void SceneNode::delete_all_children()
+	{
+		for (int i = 0; i < m_children.size(); ++i)
+			Scene::get_instance().delete_tree(m_children[i]);//, false);
+		m_children.clear();
 	}
 
 	// Free all the components of this node
@@ -60,6 +94,7 @@ namespace cs460
 	{
 		for (int i = 0; i < m_components.size(); ++i)
 		{
+			remove_component_by_type(m_components[i]);
 			delete m_components[i];
 			m_components[i] = nullptr;
 		}
@@ -71,6 +106,7 @@ namespace cs460
 	{
 		SceneNode* newNode = new SceneNode(name);
 		newNode->m_parent = this;
+		Scene::get_instance().get_transforms().set_parent(newNode->m_transformIdx, m_transformIdx);
 		m_children.push_back(newNode);
 		return newNode;
 	}
@@ -86,57 +122,6 @@ namespace cs460
 	}
 
 
-	// Generates all the data for this scenenode from a Model resource (except the necessary components)
-	void SceneNode::from_node_resource(Model* sourceModel, int nodeIdx, ModelInstance* rootModelInst)
-	{
-		// Save the model resource and the scene node with the model instance
-		m_sourceModel = sourceModel;
-		m_modelRootNode = rootModelInst->get_owner();
-
-
-		// Store the node in the "dictionary"
-		auto& modelInstNodes = Scene::get_instance().get_model_inst_nodes(rootModelInst->get_instance_id());
-		modelInstNodes[nodeIdx] = this;
-
-
-		// Save the transform info
-		GLTFNode& node = sourceModel->m_nodes[nodeIdx];
-		m_localTr.m_position = node.m_localTransform.m_position;
-		m_localTr.m_orientation = node.m_localTransform.m_orientation;
-		m_localTr.m_scale = node.m_localTransform.m_scale;
-
-
-		// Create the children nodes
-		for (int i = 0; i < node.m_childrenIndices.size(); ++i)
-		{
-			int childIdx = node.m_childrenIndices[i];
-			SceneNode* child = create_child(sourceModel->m_nodes[childIdx].m_name);
-			child->from_node_resource(sourceModel, childIdx, rootModelInst);
-		}
-	}
-
-	// Generate the components necessary for this node (from the gltf node info), and its children
-	void SceneNode::generate_components(int nodeIdx)
-	{
-		GLTFNode& node = m_sourceModel->m_nodes[nodeIdx];
-		Scene& scene = Scene::get_instance();
-		auto& modelNodes = scene.get_model_inst_nodes(m_modelRootNode->get_component<ModelInstance>()->get_instance_id());
-
-		// Generate a mesh and skin comp if necessary
-		generate_mesh_comp(node);
-		generate_skin_comps(node, modelNodes);
-
-
-		// Iterate over the children and call generate_components on them
-		for (int i = 0; i < node.m_childrenIndices.size(); ++i)
-		{
-			int childIdx = node.m_childrenIndices[i];
-			SceneNode* childNode = modelNodes[childIdx];
-			childNode->generate_components(childIdx);
-		}
-	}
-
-
 	// Show the components gui
 	void SceneNode::on_gui()
 	{
@@ -225,6 +210,74 @@ namespace cs460
 		return m_UID;
 	}
 
+
+	// Local (with respect to parent) and world (with respect world origin) transforms, stored in the transform
+	// hierarchy of the scene. They move when nodes are deleted, so pointers to them can't be kept between frames.
+	const TransformData& SceneNode::get_local_tr() const
+	{
+		return Scene::get_instance().get_transforms().get_local(m_transformIdx);
+	}
+
+	const TransformData& SceneNode::get_world_tr() const
+	{
+		return Scene::get_instance().get_transforms().get_world(m_transformIdx);
+	}
+
+	unsigned SceneNode::get_transform_idx() const
+	{
+		return m_transformIdx;
+	}
+
+	// Writes to the local transform mark the node dirty, so that its subtree is updated in the next scene update
+	void SceneNode::set_local_tr(const TransformData& localTr)
+	{
+		modify_local_tr() = localTr;
+	}
+
+	void SceneNode::set_local_position(const glm::vec3& position)
+	{
+		modify_local_tr().m_position = position;
+	}
+
+	void SceneNode::set_local_orientation(const glm::quat& orientation)
+	{
+		modify_local_tr().m_orientation = orientation;
+	}
+
+	void SceneNode::set_local_scale(const glm::vec3& scale)
+	{
+		modify_local_tr().m_scale = scale;
+	}
+
+	// Marks the node dirty, and returns the local transform to change it in place
+	TransformData& SceneNode::modify_local_tr()
+	{
+		TransformHierarchy& transforms = Scene::get_instance().get_transforms();
+		transforms.mark_dirty(m_transformIdx);
+		return transforms.get_local(m_transformIdx);
+	}
+
+	// For the ik solvers, that move the joints before the scene update. The world transform is
+	// computed again from the local one in the next update, so the local one has to match it.
+	TransformData& SceneNode::modify_world_tr()
+	{
+		TransformHierarchy& transforms = Scene::get_instance().get_transforms();
+		transforms.mark_world_written(m_transformIdx);
+		return transforms.get_world(m_transformIdx);
+	}
+
+	// Changes every time the world transform changes, to know if anything computed from it is outdated
+	unsigned SceneNode::get_world_tr_version() const
+	{
+		return Scene::get_instance().get_transforms().get_world_version(m_transformIdx);
+	}
+
+	// Don't update this node's world transform in the next scene update (needs to be called each frame)
+	void SceneNode::skip_world_tr_update()
+	{
+		Scene::get_instance().get_transforms().skip_world_update(m_transformIdx);
+	}
+
 	// Setter and getter for the name
 	void SceneNode::change_name(const std::string& newName)
 	{
@@ -239,63 +292,37 @@ namespace cs460
 	}
 
 
+	// Clear every type the component is indexed by
+	void SceneNode::remove_component_by_type(IComponent* comp)
+	{
+		for (unsigned i = 0; i < COMPONENT_TYPE_COUNT; ++i)
+			if (m_componentsByType[i] == comp)
+				m_componentsByType[i] = nullptr;
+	}
+
+
 	void SceneNode::show_transforms_gui()
 	{
 		if (ImGui::CollapsingHeader("Transform"))
 		{
+			// Only marked dirty when edited
+			TransformData localTr = get_local_tr();
+			bool changed = false;
 			ImGui::Text("Local");
-			ImGui::DragFloat3("Position##0", glm::value_ptr(m_localTr.m_position));
-			ImGui::DragFloat4("Rotation##0", glm::value_ptr(m_localTr.m_orientation));
-			ImGui::DragFloat3("Scale##0", glm::value_ptr(m_localTr.m_scale));
+			changed |= ImGui::DragFloat3("Position##0", glm::value_ptr(localTr.m_position));
+			changed |= ImGui::DragFloat4("Rotation##0", glm::value_ptr(localTr.m_orientation));
+			changed |= ImGui::DragFloat3("Scale##0", glm::value_ptr(localTr.m_scale));
+			if (changed)
+				set_local_tr(localTr);
 
 			//ImGui::NewLine();
 			//ImGui::Separator();
 			//ImGui::NewLine();
 
 			//ImGui::Text("World");
-			//ImGui::DragFloat3("Position##1", glm::value_ptr(m_worldTr.m_position));
-			//ImGui::DragFloat3("Rotation##1", glm::value_ptr(m_worldTr.m_orientation));
-			//ImGui::DragFloat3("Scale##1", glm::value_ptr(m_worldTr.m_scale));
-		}
-	}
-
-
-	// Helper functions for creating and adding the meshrenderable and skin components to this SceneNode if necessary.
-	void SceneNode::generate_mesh_comp(const GLTFNode& node)
-	{
-		// If this node uses a mesh, generate a mesh renderable component
-		// for drawing (save its index into the model's vector of meshes)
-		if (node.m_meshIdx >= 0 && node.m_meshIdx < m_sourceModel->m_meshes.size())
-		{
-			MeshRenderable* comp = add_component<MeshRenderable>();
-			comp->set_mesh_idx(node.m_meshIdx);
-			comp->set_local_bounding_volume(m_sourceModel->m_meshes[node.m_meshIdx].m_boundingVolume);
-		}
-	}
-
-	void SceneNode::generate_skin_comps(const GLTFNode& node, std::unordered_map<int, SceneNode*>& modelInstNodes)
-	{
-		// If this node uses a skin, generate a skin reference component
-		// to keep track and update the matrices for each joint
-		if (node.m_skinIdx >= 0 && node.m_skinIdx < m_sourceModel->m_skins.size())
-		{
-			SkinReference* comp = add_component<SkinReference>();
-			comp->set_skin_idx(node.m_skinIdx);
-
-			// Generate the skeleton root component
-			Skin& skin = m_sourceModel->m_skins[node.m_skinIdx];
-			SceneNode* skeletonRootNode = modelInstNodes[skin.m_commonRootIdx];
-			SkeletonRoot* rootComp = skeletonRootNode->add_component<SkeletonRoot>();
-			rootComp->set_skin_idx(node.m_skinIdx);
-
-			// Generate the joint components
-			for (int i = 0; i < skin.m_joints.size(); ++i)
-			{
-				int jointIdx = skin.m_joints[i];
-				SceneNode* jointNode = modelInstNodes[jointIdx];
-				Joint* comp = jointNode->add_component<Joint>();
-				comp->set_skin_idx(node.m_skinIdx);
-			}
+			//ImGui::DragFloat3("Position##1", glm::value_ptr(get_world_tr().m_position));
+			//ImGui::DragFloat3("Rotation##1", glm::value_ptr(get_world_tr().m_orientation));
+			//ImGui::DragFloat3("Scale##1", glm::value_ptr(get_world_tr().m_scale));
 		}
 	}
 }
\ No newline at end of file
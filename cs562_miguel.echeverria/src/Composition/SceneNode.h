@@ -12,6 +12,7 @@
 
 #include "TransformData.h"
 #include "Scene.h"
+#include "Components/ComponentTypes.h"
 
 namespace tinygltf
 {
@@ -33,12 +34,39 @@ namespace cs460
 	public:
 		
 		friend class Scene;								// Scene can access private members of SceneNode
+		friend class TransformHierarchy;				// Updates the transform index when the transforms are moved
+		friend class ModelPrefab;						// Reserves the children and components of the nodes it creates
 
 		SceneNode(const std::string& name = "Unnamed");
 		~SceneNode();
 
-		TransformData m_localTr;	// Local transform (with respect to parent)
-		TransformData m_worldTr;	// World transform (with respect world origin)
+		// The nodes come from their own object pool, so creating and deleting model instances reuses the memory of the deleted nodes
+		// (anything of a different size, like a derived type, goes to the shared pool of its size instead)
+		static void* operator new(size_t size);
+		static void operator delete(void* ptr, size_t size);
+
+		// Local (with respect to parent) and world (with respect world origin) transforms, stored in the transform
+		// hierarchy of the scene. They move when nodes are deleted, so pointers to them can't be kept between frames.
+		const TransformData& get_local_tr() const;
+		const TransformData& get_world_tr() const;
+		unsigned get_transform_idx() const;
+
+		// Writes to the local transform mark the node dirty, so that its subtree is updated in the next scene update
+		void set_local_tr(const TransformData& localTr);
+		void set_local_position(const glm::vec3& position);
+		void set_local_orientation(const glm::quat& orientation);
+		void set_local_scale(const glm::vec3& scale);
+		TransformData& modify_local_tr();		// Marks the node dirty, and returns the local transform to change it in place
+
+		// For the ik solvers, that move the joints before the scene update. The world transform is
+		// computed again from the local one in the next update, so the local one has to match it.
+		TransformData& modify_world_tr();
+
+		// Changes every time the world transform changes, to know if anything computed from it is outdated
+		unsigned get_world_tr_version() const;
+
+		// Don't update this node's world transform in the next scene update (needs to be called each frame)
+		void skip_world_tr_update();
 
 		void delete_all_children();			// Free all the children of this node
 		void delete_all_components();		// Free all the components of this node
@@ -54,18 +82,12 @@ namespace cs460
 		// The model instance component will load/get the model at the given path.
 		SceneNode* create_child_with_model(const std::string& name, const fs::path& modelPath);
 
-		// Generates all the data for this scenenode from a Model resource (except the necessary components)
-		void from_node_resource(Model* sourceModel, int nodeIdx, ModelInstance* rootModelInst);
-
-		// Generate the components necessary for this node (from the gltf node info), and its children
-		void generate_components(int nodeIdx);
-
 		// -------------------------- Component management functions --------------------------
 		template<typename T>
 		T* add_component();
 
 		template<typename T>
-		T* get_component() const;
+		T* get_component() const;		// Constant time, with the id of the type
 
 		template<typename T>
 		void delete_component();
@@ -94,27 +116,26 @@ namespace cs460
 		void change_name(const std::string& newName);
 		std::string get_name() const;
 
-
-		// Needs to be set to false each frame that we don't want to update this node's world transform
-		bool m_updateWorldTr = true;
-
 	private:
 		std::string m_name;						// "Gameobject" name
 		SceneNode* m_parent;
 		std::vector<SceneNode*> m_children;
 		std::vector<IComponent*> m_components;
+		IComponent* m_componentsByType[COMPONENT_TYPE_COUNT] = {};		// Components indexed by the id of their type (and of their base types)
 		SceneNode* m_modelRootNode;				// The root node of the model's hierarchy (null if it doesn't belong to a model)
 		Model* m_sourceModel;					// The gltf model resource this node belongs to (null if doesn't belong to any model)
 		unsigned m_UID;
+		unsigned m_transformIdx;				// Index of the transforms in the transform hierarchy of the scene
 
 		static unsigned s_UIDGenerator;
 
 
 		void show_transforms_gui();
 
-		// Helper functions for creating and adding the meshrenderable and skin components to this SceneNode if necessary.
-		void generate_mesh_comp(const GLTFNode& node);
-		void generate_skin_comps(const GLTFNode& node, std::unordered_map<int, SceneNode*>& modelInstNodes);
+		// Index the component by the id of T and of the types T inherits from
+		template<typename T>
+		void set_component_by_type(IComponent* comp);
+		void remove_component_by_type(IComponent* comp);
 	};
 
 
@@ -156,6 +177,7 @@ namespace cs460
 
 		comp = new T;
 		m_components.push_back(comp);
+		set_component_by_type<T>(comp);
 		comp->set_owner(this);
 		return comp;
 	}
@@ -163,12 +185,7 @@ namespace cs460
 	template<typename T>
 	T* SceneNode::get_component() const
 	{
-		for (int i = 0; i < m_components.size(); ++i)
-			if (T* comp = dynamic_cast<T*>(m_components[i]))
-				return comp;
-
-		// Not found, return nullptr
-		return nullptr;
+		return static_cast<T*>(m_componentsByType[get_component_type_id<T>()]);
 	}
 
 	template<typename T>
@@ -188,7 +205,19 @@ namespace cs460
 		if (foundIt != m_components.end())
 		{
 			m_components.erase(foundIt);
+			remove_component_by_type(compToDelete);
 			delete compToDelete;
 		}
 	}
+
+	// Index the component by the id of T and of the types T inherits from
+	template<typename T>
+	void SceneNode::set_component_by_type(IComponent* comp)
+	{
+		m_componentsByType[get_component_type_id<T>()] = comp;
+
+		using Base = typename ComponentBase<T>::type;
+		if constexpr (!std::is_same<Base, IComponent>::value)
+			set_component_by_type<Base>(comp);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,605 @@
+/**
+* @file TransformHierarchy.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Local and world transforms of the scene nodes, stored in contiguous
+*		 arrays sorted so that every parent comes before its children. The
+*		 world transforms are updated with a single loop over the arrays.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "TransformHierarchy.h"
+#include "SceneNode.h"
+#include "Platform/JobSystem.h"
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <thread>
+
+
+namespace cs460
+{
+	// Smaller updates aren't worth splitting among the threads
+	static const unsigned s_minParallelTransforms = 8192;
+	static const unsigned s_transformsPerJob = 1024;
+
+
+	namespace
+	{
+		// Node of a pointer tree laid out like the scene nodes used to be, with the transforms inline
+		// next to the rest of the data. Only used to compare against in the benchmark.
+		struct PointerTreeNode
+		{
+			std::string m_name;
+			TransformData m_localTr;
+			TransformData m_worldTr;
+			PointerTreeNode* m_parent = nullptr;
+			std::vector<PointerTreeNode*> m_children;
+			std::vector<void*> m_components;
+			bool m_updateWorldTr = true;
+		};
+
+		void update_pointer_tree(PointerTreeNode* node)
+		{
+			if (node->m_updateWorldTr && node->m_parent)
+				node->m_worldTr.concatenate(node->m_localTr, node->m_parent->m_worldTr);
+			node->m_updateWorldTr = true;
+
+			for (PointerTreeNode* child : node->m_children)
+				update_pointer_tree(child);
+		}
+	}
+
+
+	// Add a transform at the end of the arrays (so its parent is always before it), returns its index.
+	// The owner gets its new index when the arrays are compacted (it can be null).
+	unsigned TransformHierarchy::add(unsigned parent, SceneNode* owner)
+	{
+		m_local.emplace_back();
+		m_world.emplace_back();
+		m_parents.push_back(parent);
+		m_flags.push_back(0);
+		m_worldVersions.push_back(0);
+		m_owners.push_back(owner);
+
+		unsigned index = (unsigned)m_local.size() - 1;
+		m_scheduleDirty = true;
+		mark_dirty(index);
+		return index;
+	}
+
+	// The parent has to be before the transform
+	void TransformHierarchy::set_parent(unsigned index, unsigned parent)
+	{
+		if (parent != INVALID_INDEX && parent >= index)
+		{
+			std::cout << "ERROR: The parent of a transform has to come before it in the hierarchy\n";
+			return;
+		}
+
+		m_parents[index] = parent;
+		m_scheduleDirty = true;
+		mark_dirty(index);
+	}
+
+	// Space for count transforms in total (before adding many)
+	void TransformHierarchy::reserve(unsigned count)
+	{
+		m_local.reserve(count);
+		m_world.reserve(count);
+		m_parents.reserve(count);
+		m_flags.reserve(count);
+		m_worldVersions.reserve(count);
+		m_owners.reserve(count);
+	}
+
+	// Mark the transform as free. Its children have to be removed too, and the
+	// arrays keep their size until they are compacted.
+	void TransformHierarchy::remove(unsigned index)
+	{
+		if (index >= m_flags.size() || (m_flags[index] & FREE))
+			return;
+
+		m_flags[index] = FREE;
+		m_owners[index] = nullptr;
+		m_scheduleDirty = true;
+		++m_freeCount;
+	}
+
+	// Remove the free transforms keeping the order of the rest, and update the indices of their owners.
+	// Moves the transforms in memory, so no system can be holding pointers to them.
+	void TransformHierarchy::compact()
+	{
+		if (m_freeCount == 0)
+			return;
+
+		// The parents are always moved before their children, so their new index is already known
+		std::vector<unsigned> newIndices(m_local.size(), INVALID_INDEX);
+		unsigned count = 0;
+		unsigned firstDirty = INVALID_INDEX;
+		for (unsigned i = 0; i < m_local.size(); ++i)
+		{
+			if (m_flags[i] & FREE)
+				continue;
+
+			newIndices[i] = count;
+			m_local[count] = m_local[i];
+			m_world[count] = m_world[i];
+			m_parents[count] = m_parents[i] == INVALID_INDEX ? INVALID_INDEX : newIndices[m_parents[i]];
+			m_flags[count] = m_flags[i];
+			m_worldVersions[count] = m_worldVersions[i];
+			m_owners[count] = m_owners[i];
+			if ((m_flags[count] & LOCAL_DIRTY) && firstDirty == INVALID_INDEX)
+				firstDirty = count;
+			if (m_owners[count])
+				m_owners[count]->m_transformIdx = count;
+			++count;
+		}
+
+		m_local.resize(count);
+		m_world.resize(count);
+		m_parents.resize(count);
+		m_flags.resize(count);
+		m_worldVersions.resize(count);
+		m_owners.resize(count);
+		m_freeCount = 0;
+		m_firstDirty = firstDirty;
+		m_scheduleDirty = true;
+	}
+
+	void TransformHierarchy::clear()
+	{
+		m_local.clear();
+		m_world.clear();
+		m_parents.clear();
+		m_flags.clear();
+		m_worldVersions.clear();
+		m_owners.clear();
+		m_freeCount = 0;
+		m_firstDirty = INVALID_INDEX;
+		m_scheduleDirty = true;
+	}
+
+
+	// Concatenate the local transforms marked dirty (and the ones below them) with the world transform of their
+	// parent, in order. Starts at the first dirty transform, and does nothing if none of them changed. Big updates
+	// are split among the threads of the job system (with the same results as the serial one).
+	void TransformHierarchy::update_world_transforms()
+	{
+		++m_updateIdx;
+		m_lastUpdateCount = 0;
+
+		// Nothing before the first dirty transform can change, since the parents come before their children
+		unsigned first = m_firstDirty.exchange(INVALID_INDEX, std::memory_order_relaxed);
+		unsigned count = (unsigned)m_local.size();
+		unsigned version = m_updateIdx * 2;
+		if (first >= count)
+			return;
+
+		if (m_parallelUpdate && count - first >= s_minParallelTransforms && JobSystem::get_instance().get_thread_count() > 1)
+		{
+			update_world_transforms_parallel(version);
+			return;
+		}
+
+		for (unsigned i = first; i < count; ++i)
+			if (update_world_transform(i, version))
+				++m_lastUpdateCount;
+	}
+
+	// Whether big updates use the job system. The independent subtrees under the roots are distributed among the
+	// threads, or the levels of the hierarchy are updated one after another if a single subtree has most of the nodes.
+	void TransformHierarchy::set_parallel_update(bool parallel)
+	{
+		m_parallelUpdate = parallel;
+	}
+
+	bool TransformHierarchy::get_parallel_update() const
+	{
+		return m_parallelUpdate;
+	}
+
+	// The local transform has changed, so the world transforms of it and its subtree are updated in the next
+	// update. Can be called from different threads for different transforms.
+	void TransformHierarchy::mark_dirty(unsigned index)
+	{
+		m_flags[index] |= LOCAL_DIRTY;
+		lower_first_dirty(index);
+	}
+
+	// The world transform was written directly (by the ik solvers). It's computed again from the local one in the next
+	// update, but what depends on it has to know it changed before that.
+	void TransformHierarchy::mark_world_written(unsigned index)
+	{
+		m_worldVersions[index] = m_updateIdx * 2 + 1;
+		mark_dirty(index);
+	}
+
+
+	TransformData& TransformHierarchy::get_local(unsigned index)
+	{
+		return m_local[index];
+	}
+
+	const TransformData& TransformHierarchy::get_local(unsigned index) const
+	{
+		return m_local[index];
+	}
+
+	TransformData& TransformHierarchy::get_world(unsigned index)
+	{
+		return m_world[index];
+	}
+
+	const TransformData& TransformHierarchy::get_world(unsigned index) const
+	{
+		return m_world[index];
+	}
+
+	unsigned TransformHierarchy::get_parent(unsigned index) const
+	{
+		return m_parents[index];
+	}
+
+	// Changes every time the world transform changes, to know if anything computed from it is outdated
+	unsigned TransformHierarchy::get_world_version(unsigned index) const
+	{
+		return m_worldVersions[index];
+	}
+
+	// Skip the update of the world transform of the given node in the next update (only that one)
+	void TransformHierarchy::skip_world_update(unsigned index)
+	{
+		m_flags[index] |= SKIP_WORLD_UPDATE;
+		lower_first_dirty(index);
+	}
+
+	unsigned TransformHierarchy::get_size() const
+	{
+		return (unsigned)m_local.size();
+	}
+
+	unsigned TransformHierarchy::get_free_count() const
+	{
+		return m_freeCount;
+	}
+
+	// World transforms computed in the last update
+	unsigned TransformHierarchy::get_last_update_count() const
+	{
+		return m_lastUpdateCount;
+	}
+
+	// Update the world transform of a single one if it or its parent changed, returns whether it was computed
+	bool TransformHierarchy::update_world_transform(unsigned index, unsigned version)
+	{
+		unsigned char flags = m_flags[index];
+		if (flags & FREE)
+			return false;
+
+		// Dirty if its local transform changed or if its parent's world transform changed in this update
+		unsigned parent = m_parents[index];
+		if (!(flags & LOCAL_DIRTY) && (parent == INVALID_INDEX || m_worldVersions[parent] != version))
+		{
+			m_flags[index] = flags & ~SKIP_WORLD_UPDATE;
+			return false;
+		}
+
+		m_flags[index] = flags & ~(LOCAL_DIRTY | SKIP_WORLD_UPDATE);
+		m_worldVersions[index] = version;
+
+		// The ones that skip this update keep the world transform that was written to them
+		if (flags & SKIP_WORLD_UPDATE)
+			return false;
+
+		if (parent == INVALID_INDEX)
+			m_world[index] = m_local[index];
+		else
+			m_world[index].concatenate(m_local[index], m_world[parent]);
+		return true;
+	}
+
+	// Group the transforms by the subtree under a root they belong to, and by their depth
+	void TransformHierarchy::build_schedule()
+	{
+		unsigned count = (unsigned)m_local.size();
+		std::vector<unsigned> depths(count, 0);
+		std::vector<unsigned> subtrees(count, INVALID_INDEX);
+		std::vector<unsigned> subtreeSizes;
+		std::vector<unsigned> levelSizes;
+
+		m_rootIndices.clear();
+		for (unsigned i = 0; i < count; ++i)
+		{
+			if (m_flags[i] & FREE)
+				continue;
+
+			// The children of the roots start a new subtree, and the rest belong to the one of their parent
+			unsigned parent = m_parents[i];
+			if (parent == INVALID_INDEX)
+			{
+				m_rootIndices.push_back(i);
+				continue;
+			}
+
+			depths[i] = depths[parent] + 1;
+			if (depths[i] == 1)
+			{
+				subtrees[i] = (unsigned)subtreeSizes.size();
+				subtreeSizes.push_back(0);
+			}
+			else
+				subtrees[i] = subtrees[parent];
+
+			if (levelSizes.size() < depths[i])
+				levelSizes.resize(depths[i], 0);
+			++subtreeSizes[subtrees[i]];
+			++levelSizes[depths[i] - 1];
+		}
+
+		// Counting sort, which keeps the order of the arrays inside each group
+		m_subtreeStarts.assign(subtreeSizes.size() + 1, 0);
+		m_biggestSubtree = 0;
+		for (unsigned t = 0; t < subtreeSizes.size(); ++t)
+		{
+			m_subtreeStarts[t + 1] = m_subtreeStarts[t] + subtreeSizes[t];
+			m_biggestSubtree = glm::max(m_biggestSubtree, subtreeSizes[t]);
+		}
+		m_levelStarts.assign(levelSizes.size() + 1, 0);
+		for (unsigned l = 0; l < levelSizes.size(); ++l)
+			m_levelStarts[l + 1] = m_levelStarts[l] + levelSizes[l];
+
+		m_subtreeIndices.resize(m_subtreeStarts.back());
+		m_levelIndices.resize(m_levelStarts.back());
+		std::vector<unsigned> subtreeEnds(m_subtreeStarts.begin(), m_subtreeStarts.end() - 1);
+		std::vector<unsigned> levelEnds(m_levelStarts.begin(), m_levelStarts.end() - 1);
+		for (unsigned i = 0; i < count; ++i)
+		{
+			if (subtrees[i] == INVALID_INDEX)
+				continue;
+
+			m_subtreeIndices[subtreeEnds[subtrees[i]]++] = i;
+			m_levelIndices[levelEnds[depths[i] - 1]++] = i;
+		}
+
+		m_scheduleDirty = false;
+	}
+
+	// The subtrees under the roots don't depend on each other, so they are distributed among the threads if none of them
+	// is too big. Otherwise, the nodes of each level only depend on the previous one, so the levels are split instead.
+	void TransformHierarchy::update_world_transforms_parallel(unsigned version)
+	{
+		if (m_scheduleDirty)
+			build_schedule();
+
+		unsigned updated = 0;
+		for (unsigned root : m_rootIndices)
+			if (update_world_transform(root, version))
+				++updated;
+
+		JobSystem& jobSystem = JobSystem::get_instance();
+		unsigned threadCount = jobSystem.get_thread_count();
+		unsigned nodeCount = (unsigned)m_subtreeIndices.size();
+		std::atomic<unsigned> parallelUpdated{ 0 };
+
+		if (m_biggestSubtree <= nodeCount / threadCount)
+		{
+			// Chunks of subtrees with about s_transformsPerJob nodes
+			unsigned subtreeCount = (unsigned)m_subtreeStarts.size() - 1;
+			unsigned grainSize = (unsigned)glm::max(1ull, (unsigned long long)subtreeCount * s_transformsPerJob / glm::max(nodeCount, 1u));
+			jobSystem.parallel_for(subtreeCount, grainSize, [this, version, &parallelUpdated](unsigned begin, unsigned end)
+			{
+				unsigned jobUpdated = 0;
+				for (unsigned i = m_subtreeStarts[begin]; i < m_subtreeStarts[end]; ++i)
+					if (update_world_transform(m_subtreeIndices[i], version))
+						++jobUpdated;
+				parallelUpdated += jobUpdated;
+			});
+		}
+		else
+		{
+			for (unsigned l = 0; l + 1 < m_levelStarts.size(); ++l)
+			{
+				const unsigned* level = m_levelIndices.data() + m_levelStarts[l];
+				jobSystem.parallel_for(m_levelStarts[l + 1] - m_levelStarts[l], s_transformsPerJob, [this, level, version, &parallelUpdated](unsigned begin, unsigned end)
+				{
+					unsigned jobUpdated = 0;
+					for (unsigned i = begin; i < end; ++i)
+						if (update_world_transform(level[i], version))
+							++jobUpdated;
+					parallelUpdated += jobUpdated;
+				});
+			}
+		}
+
+		m_lastUpdateCount = updated + parallelUpdated;
+	}
+
+	// Make the next update start at the given transform if it's before the current first one
+	void TransformHierarchy::lower_first_dirty(unsigned index)
+	{
+		unsigned first = m_firstDirty.load(std::memory_order_relaxed);
+		while (index < first && !m_firstDirty.compare_exchange_weak(first, index, std::memory_order_relaxed))
+			;
+	}
+
+
+	// Time the update of synthetic hierarchies of the given number of nodes (one deep chain of nodes with few
+	// children, and one wide tree of a root with many leaves) against a tree of heap allocated nodes updated recursively,
+	// and the update of a mostly static hierarchy where only a few nodes are dirty against updating all of them
+	void benchmark_transform_hierarchy(unsigned nodeCount, unsigned iterations)
+	{
+		std::mt19937 generator(0);
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+		// Deep: chains of 1000 nodes under the root. Wide: every node is a child of the root.
+		const unsigned chainLength = 1000;
+		auto deepParent = [chainLength](unsigned i) { return (i - 1) % chainLength == 0 ? 0 : i - 1; };
+		auto wideParent = [](unsigned) { return 0u; };
+
+		auto measure = [&](const char* shape, const std::function<unsigned(unsigned)>& getParent)
+		{
+			// The pointer tree nodes are allocated in a random order, as if the scene had been edited over time
+			std::vector<PointerTreeNode*> treeNodes(nodeCount);
+			for (unsigned i = 0; i < nodeCount; ++i)
+				treeNodes[i] = new PointerTreeNode;
+			std::shuffle(treeNodes.begin() + 1, treeNodes.end(), generator);
+
+			TransformHierarchy hierarchy;
+			for (unsigned i = 0; i < nodeCount; ++i)
+			{
+				TransformData local;
+				local.m_position = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+				local.m_orientation = glm::angleAxis(distribution(generator), glm::normalize(glm::vec3(distribution(generator), 1.0f, distribution(generator))));
+
+				unsigned parent = i == 0 ? TransformHierarchy::INVALID_INDEX : getParent(i);
+				hierarchy.get_local(hierarchy.add(parent, nullptr)) = local;
+
+				treeNodes[i]->m_name = "Node " + std::to_string(i);
+				treeNodes[i]->m_localTr = local;
+				if (i > 0)
+				{
+					treeNodes[i]->m_parent = treeNodes[parent];
+					treeNodes[parent]->m_children.push_back(treeNodes[i]);
+				}
+			}
+			treeNodes[0]->m_worldTr = treeNodes[0]->m_localTr;
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (unsigned it = 0; it < iterations; ++it)
+				update_pointer_tree(treeNodes[0]);
+			auto treeEnd = std::chrono::high_resolution_clock::now();
+			for (unsigned it = 0; it < iterations; ++it)
+			{
+				hierarchy.mark_dirty(0);
+				hierarchy.update_world_transforms();
+			}
+			auto end = std::chrono::high_resolution_clock::now();
+
+			// Both have to produce the same transforms
+			float maxError = 0.0f;
+			for (unsigned i = 0; i < nodeCount; ++i)
+				maxError = glm::max(maxError, glm::length(treeNodes[i]->m_worldTr.m_position - hierarchy.get_world(i).m_position));
+
+			double treeMs = std::chrono::duration<double, std::milli>(treeEnd - start).count() / iterations;
+			double flatMs = std::chrono::duration<double, std::milli>(end - treeEnd).count() / iterations;
+			std::cout << "  " << shape << ": pointer tree " << treeMs << " ms, flat arrays " << flatMs << " ms (x"
+				<< treeMs / flatMs << "), max position difference " << maxError << "\n";
+
+			for (PointerTreeNode* node : treeNodes)
+				delete node;
+		};
+
+		std::cout << "Transform hierarchy update of " << nodeCount << " nodes:\n";
+		measure("Deep (chains of 1000)", deepParent);
+		measure("Wide (one level)", wideParent);
+
+		// Mostly static: a level of nodes that never move, and 1% of animated nodes in chains of 50 (loaded after it,
+		// like characters) whose local transforms change every update. Compared against updating everything.
+		TransformHierarchy hierarchy;
+		unsigned animatedCount = nodeCount / 100;
+		unsigned staticCount = nodeCount - animatedCount;
+		hierarchy.add(TransformHierarchy::INVALID_INDEX, nullptr);
+		for (unsigned i = 1; i < nodeCount; ++i)
+		{
+			unsigned parent = i < staticCount ? deepParent(i) : ((i - staticCount) % 50 == 0 ? 0 : i - 1);
+			hierarchy.get_local(hierarchy.add(parent, nullptr)).m_position = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+		}
+		hierarchy.update_world_transforms();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (unsigned it = 0; it < iterations; ++it)
+		{
+			hierarchy.mark_dirty(0);
+			hierarchy.update_world_transforms();
+		}
+		auto fullEnd = std::chrono::high_resolution_clock::now();
+		unsigned updated = 0;
+		for (unsigned it = 0; it < iterations; ++it)
+		{
+			for (unsigned i = staticCount; i < nodeCount; ++i)
+				hierarchy.mark_dirty(i);
+			hierarchy.update_world_transforms();
+			updated = hierarchy.get_last_update_count();
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double fullMs = std::chrono::duration<double, std::milli>(fullEnd - start).count() / iterations;
+		double dirtyMs = std::chrono::duration<double, std::milli>(end - fullEnd).count() / iterations;
+		std::cout << "  Mostly static (" << animatedCount << " animated): everything " << fullMs << " ms, dirty only " << dirtyMs
+			<< " ms (x" << fullMs / dirtyMs << ", " << updated << " world transforms computed)\n";
+	}
+
+
+	// Time the full update of synthetic hierarchies of the given number of nodes (a crowd of small subtrees, deep chains
+	// and one wide subtree) with 1 to maxThreads threads (0 is one per hardware thread), checking the results are the same
+	void benchmark_transform_hierarchy_scaling(unsigned nodeCount, unsigned iterations, unsigned maxThreads)
+	{
+		JobSystem& jobSystem = JobSystem::get_instance();
+		unsigned previousThreadCount = jobSystem.get_thread_count();
+		if (maxThreads == 0)
+			maxThreads = glm::max(std::thread::hardware_concurrency(), 1u);
+		iterations = glm::max(iterations, 1u);
+
+		std::mt19937 generator(0);
+		std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+		// Crowd: characters of 100 nodes under the root (each node hangs from a random previous one of its character).
+		// Deep: chains of 1000 nodes under the root. Wide: one node under the root with all the rest as its children.
+		auto crowdParent = [&generator](unsigned i) { unsigned first = (i - 1) / 100 * 100 + 1; return i == first ? 0 : first + generator() % (i - first); };
+		auto deepParent = [](unsigned i) { return (i - 1) % 1000 == 0 ? 0 : i - 1; };
+		auto wideParent = [](unsigned i) { return i == 1 ? 0 : 1; };
+
+		auto measure = [&](const char* shape, const std::function<unsigned(unsigned)>& getParent)
+		{
+			TransformHierarchy hierarchy;
+			hierarchy.add(TransformHierarchy::INVALID_INDEX, nullptr);
+			for (unsigned i = 1; i < nodeCount; ++i)
+			{
+				TransformData& local = hierarchy.get_local(hierarchy.add(getParent(i), nullptr));
+				local.m_position = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+				local.m_orientation = glm::angleAxis(distribution(generator), glm::normalize(glm::vec3(distribution(generator), 1.0f, distribution(generator))));
+			}
+
+			std::cout << "  " << shape << ":\n";
+			std::vector<TransformData> serialWorld(nodeCount);
+			double serialMs = 0.0;
+			for (unsigned threadCount = 1; threadCount <= maxThreads; ++threadCount)
+			{
+				jobSystem.set_thread_count(threadCount);
+
+				auto start = std::chrono::high_resolution_clock::now();
+				for (unsigned it = 0; it < iterations; ++it)
+				{
+					hierarchy.mark_dirty(0);
+					hierarchy.update_world_transforms();
+				}
+				auto end = std::chrono::high_resolution_clock::now();
+				double ms = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+
+				bool identical = true;
+				for (unsigned i = 0; i < nodeCount; ++i)
+				{
+					if (threadCount == 1)
+						serialWorld[i] = hierarchy.get_world(i);
+					else
+						identical = identical && std::memcmp(&serialWorld[i], &hierarchy.get_world(i), sizeof(TransformData)) == 0;
+				}
+				if (threadCount == 1)
+					serialMs = ms;
+
+				std::cout << "    " << threadCount << " threads: " << ms << " ms, speedup " << serialMs / ms
+					<< (identical ? "" : "  (WARNING: results differ from the serial update)") << "\n";
+			}
+		};
+
+		std::cout << "Transform hierarchy thread scaling, " << nodeCount << " nodes, " << iterations << " iterations:\n";
+		measure("Crowd (subtrees of 100)", crowdParent);
+		measure("Deep (chains of 1000)", deepParent);
+		measure("Wide (one subtree, split by levels)", wideParent);
+
+		jobSystem.set_thread_count(previousThreadCount);
+	}
+}
\ No newline at end of file
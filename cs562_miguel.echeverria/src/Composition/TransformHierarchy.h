@@ -0,0 +1,128 @@
+/**
+* @file TransformHierarchy.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Local and world transforms of the scene nodes, stored in contiguous
+*		 arrays sorted so that every parent comes before its children. The
+*		 world transforms are updated with a single loop over the arrays.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "TransformData.h"
+#include <atomic>
+
+
+namespace cs460
+{
+	class SceneNode;
+
+
+	class TransformHierarchy
+	{
+	public:
+
+		static const unsigned INVALID_INDEX = 0xFFFFFFFF;
+
+		// Add a transform at the end of the arrays (so its parent is always before it), returns its index.
+		// The owner gets its new index when the arrays are compacted (it can be null).
+		unsigned add(unsigned parent, SceneNode* owner);
+		void set_parent(unsigned index, unsigned parent);		// The parent has to be before the transform
+		void reserve(unsigned count);							// Space for count transforms in total (before adding many)
+
+		// Mark the transform as free. Its children have to be removed too, and the
+		// arrays keep their size until they are compacted.
+		void remove(unsigned index);
+
+		// Remove the free transforms keeping the order of the rest, and update the indices of their owners.
+		// Moves the transforms in memory, so no system can be holding pointers to them.
+		void compact();
+		void clear();
+
+		// Concatenate the local transforms marked dirty (and the ones below them) with the world transform of their
+		// parent, in order. Starts at the first dirty transform, and does nothing if none of them changed. Big updates
+		// are split among the threads of the job system (with the same results as the serial one).
+		void update_world_transforms();
+
+		// Whether big updates use the job system. The independent subtrees under the roots are distributed among the
+		// threads, or the levels of the hierarchy are updated one after another if a single subtree has most of the nodes.
+		void set_parallel_update(bool parallel);
+		bool get_parallel_update() const;
+
+		// The local transform has changed, so the world transforms of it and its subtree are updated in the next
+		// update. Can be called from different threads for different transforms.
+		void mark_dirty(unsigned index);
+
+		// The world transform was written directly (by the ik solvers). It's computed again from the local one in the next
+		// update, but what depends on it has to know it changed before that.
+		void mark_world_written(unsigned index);
+
+		// get_local doesn't mark the transform dirty, writes have to call mark_dirty
+		TransformData& get_local(unsigned index);
+		const TransformData& get_local(unsigned index) const;
+		TransformData& get_world(unsigned index);
+		const TransformData& get_world(unsigned index) const;
+		unsigned get_parent(unsigned index) const;
+
+		// Changes every time the world transform changes, to know if anything computed from it is outdated
+		unsigned get_world_version(unsigned index) const;
+
+		// Skip the update of the world transform of the given node in the next update (only that one)
+		void skip_world_update(unsigned index);
+
+		unsigned get_size() const;
+		unsigned get_free_count() const;
+		unsigned get_last_update_count() const;		// World transforms computed in the last update
+
+	private:
+
+		enum TransformFlags : unsigned char
+		{
+			FREE = 1,
+			SKIP_WORLD_UPDATE = 2,
+			LOCAL_DIRTY = 4
+		};
+
+		std::vector<TransformData> m_local;
+		std::vector<TransformData> m_world;
+		std::vector<unsigned> m_parents;			// INVALID_INDEX for the roots
+		std::vector<unsigned char> m_flags;
+		std::vector<unsigned> m_worldVersions;		// Twice the update in which the world transform changed (plus one if written directly)
+		std::vector<SceneNode*> m_owners;
+		unsigned m_freeCount = 0;
+		unsigned m_updateIdx = 0;
+		unsigned m_lastUpdateCount = 0;
+		std::atomic<unsigned> m_firstDirty{ INVALID_INDEX };
+
+		// Order of the parallel update, built again when the hierarchy changes. The roots go first, then the nodes of
+		// each subtree under them (or of each level), each group in the order of the arrays.
+		bool m_parallelUpdate = true;
+		bool m_scheduleDirty = true;
+		std::vector<unsigned> m_rootIndices;
+		std::vector<unsigned> m_subtreeIndices;
+		std::vector<unsigned> m_subtreeStarts;		// Where each subtree begins in m_subtreeIndices (plus the end)
+		std::vector<unsigned> m_levelIndices;
+		std::vector<unsigned> m_levelStarts;		// Where each level begins in m_levelIndices (plus the end)
+		unsigned m_biggestSubtree = 0;
+
+		void lower_first_dirty(unsigned index);		// Make the next update start at the given transform if it's before the current first one
+
+		// Update the world transform of a single one if it or its parent changed, returns whether it was computed
+		bool update_world_transform(unsigned index, unsigned version);
+
+		void build_schedule();
+		void update_world_transforms_parallel(unsigned version);
+	};
+
+
+	// Time the update of synthetic hierarchies of the given number of nodes (one deep chain of nodes with few
+	// children, and one wide tree of a root with many leaves) against a tree of heap allocated nodes updated recursively,
+	// and the update of a mostly static hierarchy where only a few nodes are dirty against updating all of them
+	void benchmark_transform_hierarchy(unsigned nodeCount, unsigned iterations);
+
+	// Time the full update of synthetic hierarchies of the given number of nodes (a crowd of small subtrees, deep chains
+	// and one wide subtree) with 1 to maxThreads threads (0 is one per hardware thread), checking the results are the same
+	void benchmark_transform_hierarchy_scaling(unsigned nodeCount, unsigned iterations, unsigned maxThreads);
+}
\ No newline at end of file
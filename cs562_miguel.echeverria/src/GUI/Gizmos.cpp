@@ -68,7 +68,7 @@ namespace cs460
 
         if (state.m_selectedNode)
         {
-            modelMtx = state.m_selectedNode->m_worldTr.get_model_mtx();
+            modelMtx = state.m_selectedNode->get_world_tr().get_model_mtx();
 
             // Set perspective projection
             ImGuizmo::SetOrthographic(false);
@@ -95,9 +95,9 @@ namespace cs460
                 // If there is no parent, the world transform is the local transform
                 if (parent == nullptr)
                 {
-                    state.m_selectedNode->m_localTr.m_position = childWorldPos;
-                    state.m_selectedNode->m_localTr.m_scale = childWorldScale;
-                    state.m_selectedNode->m_localTr.m_orientation = childWorldOrientation;
+                    state.m_selectedNode->set_local_position(childWorldPos);
+                    state.m_selectedNode->set_local_scale(childWorldScale);
+                    state.m_selectedNode->set_local_orientation(childWorldOrientation);
                 }
                 // Otherwise, do inverse concatenation to obtain the local transform of the selected object from its world transform
                 else
@@ -107,7 +107,7 @@ namespace cs460
                     childWorld.m_orientation = childWorldOrientation;
                     childWorld.m_scale = childWorldScale;
 
-                    state.m_selectedNode->m_localTr.inverse_concatenate(childWorld, parent->m_worldTr);
+                    state.m_selectedNode->modify_local_tr().inverse_concatenate(childWorld, parent->get_world_tr());
                 }
             }
         }
@@ -23,6 +23,8 @@
 #include "Animation/Blending/Blend1D.h"
 #include "Animation/Blending/Blend2D.h"
 #include "Animation/Blending/BlendAnim.h"
+#include "Animation/Blending/BlendLayer.h"
+#include "Animation/Blending/BlendingCore.h"
 #include "Resources/ResourceManager.h"
 #include "Graphics/GLTF/Model.h"
 #include "Gameplay/Components/PlayerController.h"
@@ -33,6 +35,14 @@
 #include "Components/Animation/IKChainRoot.h"
 #include "Graphics/Rendering/Skybox.h"
 #include "Components/Particles/Cloth.h"
+#include "Animation/Blending/PoseKernels.h"
+#include "Animation/Skinning/JointPalette.h"
+#include "Animation/Animator.h"
+#include "Application/FrameTaskGraph.h"
+#include "Platform/FrameArena.h"
+#include "Platform/ObjectPool.h"
+#include "Graphics/Rendering/GLCallCounter.h"
+#include <chrono>
 
 
 
@@ -74,6 +84,10 @@ namespace cs460
 				{
 					m_sceneToLoad = SCENE_TO_LOAD::SKINNED_ANIMATION;
 				}
+				if (ImGui::MenuItem("Animation Crowd"))
+				{
+					m_sceneToLoad = SCENE_TO_LOAD::ANIMATION_CROWD;
+				}
 				if (ImGui::MenuItem("NESTED MODELS"))
 				{
 					m_sceneToLoad = SCENE_TO_LOAD::NESTED_MODELS;
@@ -98,6 +112,10 @@ namespace cs460
 				{
 					m_sceneToLoad = SCENE_TO_LOAD::BLEND_EDITOR_2D;
 				}
+				if (ImGui::MenuItem("Blend layers"))
+				{
+					m_sceneToLoad = SCENE_TO_LOAD::BLEND_LAYERS;
+				}
 				if (ImGui::MenuItem("IK Analytic 2D"))
 				{
 					m_sceneToLoad = SCENE_TO_LOAD::IK_ANALYTICAL_2D;
@@ -227,6 +245,97 @@ namespace cs460
 				ImGui::EndMenu();
 			}
 
+			if (ImGui::BeginMenu("Rendering"))
+			{
+				// Draw the meshes of the previous frame while the current one is simulated
+				Renderer& renderer = Renderer::get_instance();
+				bool pipelined = renderer.get_frame_latency() == 1;
+				if (ImGui::Checkbox("One Frame Latency", &pipelined))
+					renderer.set_frame_latency(pipelined ? 1 : 0);
+
+				ImGui::EndMenu();
+			}
+
+			// The results are printed to the console
+			if (ImGui::BeginMenu("Benchmarks"))
+			{
+				if (ImGui::MenuItem("Pose Blend Kernels"))
+					benchmark_pose_kernels(67, 20000);
+
+				if (ImGui::MenuItem("Joint Palette"))
+					benchmark_joint_palette(100, 20000);
+
+				// Synthetic deep and wide hierarchies, not the current scene
+				if (ImGui::MenuItem("Transform Hierarchy 100k"))
+					benchmark_transform_hierarchy(100000, 20);
+
+				if (ImGui::MenuItem("Transform Hierarchy Thread Scaling"))
+					benchmark_transform_hierarchy_scaling(100000, 50, 0);
+
+				// Uses the characters of the current scene (load the animation crowd first)
+				if (ImGui::MenuItem("Animator Thread Scaling"))
+					Animator::get_instance().benchmark_thread_scaling(0, 100);
+
+				// Compares the meshes of the current scene in their current pose
+				if (ImGui::MenuItem("Compare Skinning Modes"))
+					Animator::get_instance().compare_skinning_modes();
+
+				if (ImGui::MenuItem("CPU Skinning"))
+					Animator::get_instance().benchmark_cpu_skinning(100);
+
+				if (ImGui::MenuItem("Skin Palette Sizes"))
+					Animator::get_instance().print_skin_palette_sizes();
+
+				if (ImGui::MenuItem("Skin Weight Stats"))
+					Animator::get_instance().print_skin_weight_stats();
+
+				if (ImGui::MenuItem("Palette Atlas Stats"))
+					Animator::get_instance().print_palette_atlas_stats();
+
+				// Switches every character of the current scene between its animation and the baked palettes
+				bool bakedPalettes = Animator::get_instance().get_baked_palettes();
+				if (ImGui::MenuItem("Baked Crowd Palettes", nullptr, &bakedPalettes))
+					Animator::get_instance().set_baked_palettes(bakedPalettes);
+
+				// Also writes frame_graph.dot, with the critical path in red, and prints how long each stage
+				// overlapped with others on average since the last dump (like the render with the simulation)
+				if (ImGui::MenuItem("Dump Frame Task Graph"))
+					FrameTaskGraph::s_dumpNextFrame = true;
+
+				// Counted in the opengl backend and the shaders, so they also work with a software context
+				if (ImGui::MenuItem("GL Call Stats"))
+					GLCallCounter::print_last_frame(std::cout);
+
+				if (ImGui::MenuItem("Frame Arena Stats"))
+				{
+					FrameArena::FrameStats stats = FrameArena::get_last_frame_stats();
+					std::cout << "Frame arenas (last frame): " << stats.m_allocations << " allocations, " << stats.m_heapAllocations
+						<< " new blocks from the heap, " << stats.m_bytesUsed << " bytes used out of " << stats.m_bytesReserved << "\n";
+				}
+
+				if (ImGui::MenuItem("Object Pool Stats"))
+					ObjectPool::print_stats(std::cout);
+
+				// Replace the current scene with an empty one
+				if (ImGui::MenuItem("Spawn/Despawn 1k Fox"))
+					benchmark_spawn_despawn("data/Models/Fox/Fox.gltf", 1000, 3);
+
+				if (ImGui::MenuItem("Spawn/Despawn 10k Fox"))
+					benchmark_spawn_despawn("data/Models/Fox/Fox.gltf", 10000, 3);
+
+				if (ImGui::MenuItem("Spawn/Despawn 10 Sponza"))
+					benchmark_spawn_despawn("data/Models/sponza/Sponza.gltf", 10, 3);
+
+				if (ImGui::MenuItem("Spawn/Despawn 1k BrainStem"))
+					benchmark_spawn_despawn("data/Models/BrainStem/BrainStem.gltf", 1000, 3);
+
+				// Uses the view extracted in the last frame
+				if (ImGui::MenuItem("Render Command Recording"))
+					Renderer::get_instance().benchmark_command_recording(100);
+
+				ImGui::EndMenu();
+			}
+
 			ImGui::EndMainMenuBar();
 		}
 	}
@@ -255,6 +364,8 @@ namespace cs460
 			load_bezier_curve_scene();
 		else if (m_sceneToLoad == SCENE_TO_LOAD::SKINNED_ANIMATION)
 			load_skinned_animation_scene();
+		else if (m_sceneToLoad == SCENE_TO_LOAD::ANIMATION_CROWD)
+			load_animation_crowd_scene();
 		else if (m_sceneToLoad == SCENE_TO_LOAD::NESTED_MODELS)
 			load_nested_models_scene();
 		else if (m_sceneToLoad == SCENE_TO_LOAD::PATH_FOLLOWING)
@@ -267,6 +378,8 @@ namespace cs460
 			load_blend_editor_1d_scene();
 		else if (m_sceneToLoad == SCENE_TO_LOAD::BLEND_EDITOR_2D)
 			load_blend_editor_2d_scene();
+		else if (m_sceneToLoad == SCENE_TO_LOAD::BLEND_LAYERS)
+			load_blend_layers_scene();
 		else if (m_sceneToLoad == SCENE_TO_LOAD::IK_ANALYTICAL_2D)
 			load_ik_analytical_2d_scene();
 		else if (m_sceneToLoad == SCENE_TO_LOAD::IK_CCD_3D)
@@ -325,11 +438,11 @@ namespace cs460
 		curvePoint4->add_component<CurvePoint>()->set_time(8.0f);
 
 		// Set their positions
-		curvePoint0->m_localTr.m_position = glm::vec3(0.0f, 0.0f, 0.0f);
-		curvePoint1->m_localTr.m_position = glm::vec3(1.69f, 0.0f, 0.0f);
-		curvePoint2->m_localTr.m_position = glm::vec3(-0.124f, -0.881f, 0.0f);
-		curvePoint3->m_localTr.m_position = glm::vec3(1.705f, -0.898f, 0.0f);
-		curvePoint4->m_localTr.m_position = glm::vec3(0.355f, -1.801f, 0.0f);
+		curvePoint0->set_local_position(glm::vec3(0.0f, 0.0f, 0.0f));
+		curvePoint1->set_local_position(glm::vec3(1.69f, 0.0f, 0.0f));
+		curvePoint2->set_local_position(glm::vec3(-0.124f, -0.881f, 0.0f));
+		curvePoint3->set_local_position(glm::vec3(1.705f, -0.898f, 0.0f));
+		curvePoint4->set_local_position(glm::vec3(0.355f, -1.801f, 0.0f));
 
 		// Place the camera
 		ICamera* cam = scene.get_active_camera();
@@ -375,48 +488,48 @@ namespace cs460
 		// Add the tangents for point 0
 		SceneNode* leftTangent0 = curvePoint0->create_child("Left Tangent 0");
 		leftTangent0->add_component<CurveTangent>()->set_is_in_tangent(true);
-		leftTangent0->m_localTr.m_position = glm::vec3(-0.916f, 0.0f, -0.818f);
+		leftTangent0->set_local_position(glm::vec3(-0.916f, 0.0f, -0.818f));
 
 		SceneNode* rightTangent0 = curvePoint0->create_child("Right Tangent 0");
 		rightTangent0->add_component<CurveTangent>()->set_is_in_tangent(false);
-		rightTangent0->m_localTr.m_position = glm::vec3(-0.644f, 1.991f, -1.932f);
+		rightTangent0->set_local_position(glm::vec3(-0.644f, 1.991f, -1.932f));
 
 
 		// Add the tangents for point 1
 		SceneNode* leftTangent1 = curvePoint1->create_child("Left Tangent 1");
 		leftTangent1->add_component<CurveTangent>()->set_is_in_tangent(true);
-		leftTangent1->m_localTr.m_position = glm::vec3(-0.590f, -0.661f, 0.782f);
+		leftTangent1->set_local_position(glm::vec3(-0.590f, -0.661f, 0.782f));
 
 		SceneNode* rightTangent1 = curvePoint1->create_child("Right Tangent 1");
 		rightTangent1->add_component<CurveTangent>()->set_is_in_tangent(false);
-		rightTangent1->m_localTr.m_position = glm::vec3(0.845f, 1.224f, -0.917f);
+		rightTangent1->set_local_position(glm::vec3(0.845f, 1.224f, -0.917f));
 
 
 		// Add the tangents for point 2
 		SceneNode* leftTangent2 = curvePoint2->create_child("Left Tangent 2");
 		leftTangent2->add_component<CurveTangent>()->set_is_in_tangent(true);
-		leftTangent2->m_localTr.m_position = glm::vec3(0.258f, -2.156f, -1.447f);
+		leftTangent2->set_local_position(glm::vec3(0.258f, -2.156f, -1.447f));
 
 		SceneNode* rightTangent2 = curvePoint2->create_child("Right Tangent 2");
 		rightTangent2->add_component<CurveTangent>()->set_is_in_tangent(false);
-		rightTangent2->m_localTr.m_position = glm::vec3(0.258f, -2.156f, -1.447f);
+		rightTangent2->set_local_position(glm::vec3(0.258f, -2.156f, -1.447f));
 
 
 		// Add the tangents for point 3
 		SceneNode* leftTangent3 = curvePoint3->create_child("Left Tangent 3");
 		leftTangent3->add_component<CurveTangent>()->set_is_in_tangent(true);
-		leftTangent3->m_localTr.m_position = glm::vec3(-0.355f, 8.891f, -0.313f);
+		leftTangent3->set_local_position(glm::vec3(-0.355f, 8.891f, -0.313f));
 
 		SceneNode* rightTangent3 = curvePoint3->create_child("Right Tangent 3");
 		rightTangent3->add_component<CurveTangent>()->set_is_in_tangent(false);
-		rightTangent3->m_localTr.m_position = glm::vec3(-0.594f, 0.0f, 0.266f);
+		rightTangent3->set_local_position(glm::vec3(-0.594f, 0.0f, 0.266f));
 
 
 		// Set the curve points' positions
-		curvePoint0->m_localTr.m_position = glm::vec3(0.0f, 0.0f, 0.0f);
-		curvePoint1->m_localTr.m_position = glm::vec3(2.801f, 0.0f, 0.0f);
-		curvePoint2->m_localTr.m_position = glm::vec3(2.685f, 0.0f, 2.803f);
-		curvePoint3->m_localTr.m_position = glm::vec3(-0.651f, 2.230f, 2.704f);
+		curvePoint0->set_local_position(glm::vec3(0.0f, 0.0f, 0.0f));
+		curvePoint1->set_local_position(glm::vec3(2.801f, 0.0f, 0.0f));
+		curvePoint2->set_local_position(glm::vec3(2.685f, 0.0f, 2.803f));
+		curvePoint3->set_local_position(glm::vec3(-0.651f, 2.230f, 2.704f));
 
 
 
@@ -461,10 +574,10 @@ namespace cs460
 		curvePoint3->add_component<CurvePoint>()->set_time(6.0f);
 
 		// Set their positions
-		curvePoint0->m_localTr.m_position = glm::vec3(-1.041f, 1.624f, -2.537f);
-		curvePoint1->m_localTr.m_position = glm::vec3(2.167f, -0.639f, -0.562f);
-		curvePoint2->m_localTr.m_position = glm::vec3(2.141f, -0.289f, 1.609f);
-		curvePoint3->m_localTr.m_position = glm::vec3(-2.011f, 0.472f, 0.558f);
+		curvePoint0->set_local_position(glm::vec3(-1.041f, 1.624f, -2.537f));
+		curvePoint1->set_local_position(glm::vec3(2.167f, -0.639f, -0.562f));
+		curvePoint2->set_local_position(glm::vec3(2.141f, -0.289f, 1.609f));
+		curvePoint3->set_local_position(glm::vec3(-2.011f, 0.472f, 0.558f));
 
 		// Place the camera
 		ICamera* cam = scene.get_active_camera();
@@ -508,37 +621,37 @@ namespace cs460
 		// Add the control points for point 0
 		SceneNode* leftTangent0 = curvePoint0->create_child("Left Control Point 0");
 		leftTangent0->add_component<CurveControlPoint>()->set_is_left_control_point(true);
-		leftTangent0->m_localTr.m_position = glm::vec3(-0.666f, 0.0f, 0.504f);
+		leftTangent0->set_local_position(glm::vec3(-0.666f, 0.0f, 0.504f));
 
 		SceneNode* rightTangent0 = curvePoint0->create_child("Right Control Point 0");
 		rightTangent0->add_component<CurveControlPoint>()->set_is_left_control_point(false);
-		rightTangent0->m_localTr.m_position = glm::vec3(0.555f, 0.755f, -2.044f);
+		rightTangent0->set_local_position(glm::vec3(0.555f, 0.755f, -2.044f));
 
 
 		// Add the control points for point 1
 		SceneNode* leftTangent1 = curvePoint1->create_child("Left Control Point 1");
 		leftTangent1->add_component<CurveControlPoint>()->set_is_left_control_point(true);
-		leftTangent1->m_localTr.m_position = glm::vec3(0.020f, 0.0f, 0.914f);
+		leftTangent1->set_local_position(glm::vec3(0.020f, 0.0f, 0.914f));
 
 		SceneNode* rightTangent1 = curvePoint1->create_child("Right Control Point 1");
 		rightTangent1->add_component<CurveControlPoint>()->set_is_left_control_point(false);
-		rightTangent1->m_localTr.m_position = glm::vec3(-0.281f, 0.0f, -1.368f);
+		rightTangent1->set_local_position(glm::vec3(-0.281f, 0.0f, -1.368f));
 
 
 		// Add the control points for point 2
 		SceneNode* leftTangent2 = curvePoint2->create_child("Left Control Point 2");
 		leftTangent2->add_component<CurveControlPoint>()->set_is_left_control_point(true);
-		leftTangent2->m_localTr.m_position = glm::vec3(-2.104f, -1.546f, -0.447f);
+		leftTangent2->set_local_position(glm::vec3(-2.104f, -1.546f, -0.447f));
 
 		SceneNode* rightTangent2 = curvePoint2->create_child("Right Control Point 2");
 		rightTangent2->add_component<CurveControlPoint>()->set_is_left_control_point(false);
-		rightTangent2->m_localTr.m_position = glm::vec3(0.226, 0.0f, -1.104f);
+		rightTangent2->set_local_position(glm::vec3(0.226, 0.0f, -1.104f));
 
 
 		// Set the curve points' positions
-		curvePoint0->m_localTr.m_position = glm::vec3(0.0f, 0.0f, 0.0f);
-		curvePoint1->m_localTr.m_position = glm::vec3(2.325f, 0.0f, 0.736f);
-		curvePoint2->m_localTr.m_position = glm::vec3(6.313f, 0.0f, -5.033f);
+		curvePoint0->set_local_position(glm::vec3(0.0f, 0.0f, 0.0f));
+		curvePoint1->set_local_position(glm::vec3(2.325f, 0.0f, 0.736f));
+		curvePoint2->set_local_position(glm::vec3(6.313f, 0.0f, -5.033f));
 
 
 		// Place the camera
@@ -609,13 +722,13 @@ namespace cs460
 
 
 		// Set their local transforms
-		brainStem->m_localTr.m_position = glm::vec3(0.0f, 0.0f, 0.0f);
-		cesiumMan->m_localTr.m_position = glm::vec3(2.206f, 0.0f, 0.0f);
-		fox->m_localTr.m_position = glm::vec3(4.312f, 0.0f, 0.0f);
-		fox->m_localTr.m_scale = glm::vec3(0.022f, 0.022f, 0.022f);
-		box->m_localTr.m_position = glm::vec3(0.0f, 0.0f, -8.094f);
-		cube->m_localTr.m_position = glm::vec3(4.11f, 0.0f, -8.631f);
-		cube->m_localTr.m_scale = glm::vec3(0.64f, 0.64f, 0.64f);
+		brainStem->set_local_position(glm::vec3(0.0f, 0.0f, 0.0f));
+		cesiumMan->set_local_position(glm::vec3(2.206f, 0.0f, 0.0f));
+		fox->set_local_position(glm::vec3(4.312f, 0.0f, 0.0f));
+		fox->set_local_scale(glm::vec3(0.022f, 0.022f, 0.022f));
+		box->set_local_position(glm::vec3(0.0f, 0.0f, -8.094f));
+		cube->set_local_position(glm::vec3(4.11f, 0.0f, -8.631f));
+		cube->set_local_scale(glm::vec3(0.64f, 0.64f, 0.64f));
 
 
 		// Place the camera
@@ -631,6 +744,63 @@ namespace cs460
 			std::cout << "ERROR: Editor camera not being used on skinned animations demo\n";
 	}
 
+	void MainMenuBarGUI::load_animation_crowd_scene()
+	{
+		load_empty_scene();
+
+		Scene& scene = Scene::get_instance();
+		SceneNode* root = scene.get_root();
+
+		// Grid of foxes and xbots, alternating, each one starting its animation at a different time
+		const int rows = 10;
+		const int columns = 20;
+		const float spacing = 2.0f;
+
+		for (int row = 0; row < rows; ++row)
+		{
+			for (int col = 0; col < columns; ++col)
+			{
+				int index = row * columns + col;
+				bool isFox = index % 2 == 0;
+
+				SceneNode* character = root->create_child((isFox ? "FOX " : "XBOT ") + std::to_string(index));
+				character->set_local_position(glm::vec3((col - columns / 2) * spacing, 0.0f, -row * spacing));
+
+				ModelInstance* modelInst = character->add_component<ModelInstance>();
+				AnimationReference* anim = nullptr;
+				if (isFox)
+				{
+					modelInst->change_model("data/Models/Fox/Fox.gltf");
+					character->set_local_scale(glm::vec3(0.022f, 0.022f, 0.022f));
+					anim = character->get_component<AnimationReference>();
+					anim->change_animation(2, "Run");
+					anim->set_anim_time_scale(2.25f);
+				}
+				else
+				{
+					modelInst->change_model("data/Models/xbot/xbot.gltf");
+					anim = character->get_component<AnimationReference>();
+					anim->change_animation(22, "WALK");
+				}
+
+				anim->set_anim_timer(std::fmod(index * 0.137f, anim->get_anim_duration()));
+			}
+		}
+
+
+		// Place the camera
+		ICamera* cam = scene.get_active_camera();
+		cam->set_is_active(true);
+		EditorCamera* editorCam = dynamic_cast<EditorCamera*>(cam);
+		if (editorCam)
+		{
+			editorCam->set_position(glm::vec3(0.0f, 8.0f, 12.0f));
+			editorCam->set_target(editorCam->get_position() + glm::vec3(0.0f, -0.4f, -1.0f) * 25.0f);
+		}
+		else
+			std::cout << "ERROR: Editor camera not being used on animation crowd demo\n";
+	}
+
 	void MainMenuBarGUI::load_nested_models_scene()
 	{
 		load_empty_scene();
@@ -659,9 +829,9 @@ namespace cs460
 
 
 		// Set the local transform of the axe
-		axe->m_localTr.m_position = glm::vec3(-27.708f, -3.855f, 58.506f);
-		axe->m_localTr.m_orientation = glm::quat(-0.483f, 0.318f, 0.666f, 0.471f);
-		axe->m_localTr.m_scale = glm::vec3(0.34f, 0.34f, 0.34f);
+		axe->set_local_position(glm::vec3(-27.708f, -3.855f, 58.506f));
+		axe->set_local_orientation(glm::quat(-0.483f, 0.318f, 0.666f, 0.471f));
+		axe->set_local_scale(glm::vec3(0.34f, 0.34f, 0.34f));
 
 
 		// Set the animation
@@ -713,37 +883,37 @@ namespace cs460
 		// Add the control points for point 0
 		SceneNode* leftTangent0 = curvePoint0->create_child("Left Control Point 0");
 		leftTangent0->add_component<CurveControlPoint>()->set_is_left_control_point(true);
-		leftTangent0->m_localTr.m_position = glm::vec3(-0.666f, 0.0f, 0.504f);
+		leftTangent0->set_local_position(glm::vec3(-0.666f, 0.0f, 0.504f));
 
 		SceneNode* rightTangent0 = curvePoint0->create_child("Right Control Point 0");
 		rightTangent0->add_component<CurveControlPoint>()->set_is_left_control_point(false);
-		rightTangent0->m_localTr.m_position = glm::vec3(1.541f, 0.0f, -1.616f);
+		rightTangent0->set_local_position(glm::vec3(1.541f, 0.0f, -1.616f));
 
 
 		// Add the control points for point 1
 		SceneNode* leftTangent1 = curvePoint1->create_child("Left Control Point 1");
 		leftTangent1->add_component<CurveControlPoint>()->set_is_left_control_point(true);
-		leftTangent1->m_localTr.m_position = glm::vec3(-1.362f, 0.0f, 1.7f);
+		leftTangent1->set_local_position(glm::vec3(-1.362f, 0.0f, 1.7f));
 
 		SceneNode* rightTangent1 = curvePoint1->create_child("Right Control Point 1");
 		rightTangent1->add_component<CurveControlPoint>()->set_is_left_control_point(false);
-		rightTangent1->m_localTr.m_position = glm::vec3(1.509f, 0.0f, -1.892f);
+		rightTangent1->set_local_position(glm::vec3(1.509f, 0.0f, -1.892f));
 
 
 		// Add the control points for point 2
 		SceneNode* leftTangent2 = curvePoint2->create_child("Left Control Point 2");
 		leftTangent2->add_component<CurveControlPoint>()->set_is_left_control_point(true);
-		leftTangent2->m_localTr.m_position = glm::vec3(0.317f, 0.0f, -1.421f);
+		leftTangent2->set_local_position(glm::vec3(0.317f, 0.0f, -1.421f));
 
 		SceneNode* rightTangent2 = curvePoint2->create_child("Right Control Point 2");
 		rightTangent2->add_component<CurveControlPoint>()->set_is_left_control_point(false);
-		rightTangent2->m_localTr.m_position = glm::vec3(0.551f, 0.0f, 0.769f);
+		rightTangent2->set_local_position(glm::vec3(0.551f, 0.0f, 0.769f));
 
 
 		// Set the curve points' positions
-		curvePoint0->m_localTr.m_position = glm::vec3(-3.253f, 0.0f, 17.762f);
-		curvePoint1->m_localTr.m_position = glm::vec3(-0.137f, 0.0f, 18.872f);
-		curvePoint2->m_localTr.m_position = glm::vec3(3.0f, 0.0f, 18.0f);
+		curvePoint0->set_local_position(glm::vec3(-3.253f, 0.0f, 17.762f));
+		curvePoint1->set_local_position(glm::vec3(-0.137f, 0.0f, 18.872f));
+		curvePoint2->set_local_position(glm::vec3(3.0f, 0.0f, 18.0f));
 
 
 		// Place the camera
@@ -799,11 +969,11 @@ namespace cs460
 		BlendAnim* blendAnim4 = static_cast<BlendAnim*>(xBotAnim->get_blend_tree()->add_child(BlendNodeTypes::BLEND_ANIM));
 		BlendAnim* blendAnim5 = static_cast<BlendAnim*>(xBotAnim->get_blend_tree()->add_child(BlendNodeTypes::BLEND_ANIM));
 
-		blendAnim1->m_blendPos.x = 0.0f;
-		blendAnim2->m_blendPos.x = 0.5f;
-		blendAnim3->m_blendPos.x = 1.0f;
-		blendAnim4->m_blendPos.x = 1.5f;
-		blendAnim5->m_blendPos.x = 2.0f;
+		blendAnim1->set_blend_pos(glm::vec2(0.0f, 0.0f));
+		blendAnim2->set_blend_pos(glm::vec2(0.5f, 0.0f));
+		blendAnim3->set_blend_pos(glm::vec2(1.0f, 0.0f));
+		blendAnim4->set_blend_pos(glm::vec2(1.5f, 0.0f));
+		blendAnim5->set_blend_pos(glm::vec2(2.0f, 0.0f));
 
 		// 14(RUMBA-DANCING), 5(IDLE), 22(WALK), 6(JOG), 15(RUN), 3(FAST RUN)
 		blendAnim1->m_animSource = &(xBotInstance->get_owner()->get_model()->m_animations[4]);
@@ -834,7 +1004,7 @@ namespace cs460
 
 		// Create the nodes
 		SceneNode* xBot = root->create_child("X-BOT");
-		xBot->m_localTr.m_position = glm::vec3(0.0f, 0.0f, 20.0f);
+		xBot->set_local_position(glm::vec3(0.0f, 0.0f, 20.0f));
 		sphericalCam->set_focal_node(xBot);
 		sphericalCam->set_focal_offset(glm::vec3(0.0f, 1.0f, 0.0f));
 
@@ -858,11 +1028,11 @@ namespace cs460
 		BlendAnim* blendAnim4 = static_cast<BlendAnim*>(xBotAnim->get_blend_tree()->add_child(BlendNodeTypes::BLEND_ANIM));
 		BlendAnim* blendAnim5 = static_cast<BlendAnim*>(xBotAnim->get_blend_tree()->add_child(BlendNodeTypes::BLEND_ANIM));
 
-		blendAnim1->m_blendPos = glm::vec2(0.0f, 0.0f);
-		blendAnim2->m_blendPos = glm::vec2(0.0f, 1.0f);
-		blendAnim3->m_blendPos = glm::vec2(-1.0f, 0.0f);
-		blendAnim4->m_blendPos = glm::vec2(1.0f, 0.0f);
-		blendAnim5->m_blendPos = glm::vec2(0.0f, -1.0f);
+		blendAnim1->set_blend_pos(glm::vec2(0.0f, 0.0f));
+		blendAnim2->set_blend_pos(glm::vec2(0.0f, 1.0f));
+		blendAnim3->set_blend_pos(glm::vec2(-1.0f, 0.0f));
+		blendAnim4->set_blend_pos(glm::vec2(1.0f, 0.0f));
+		blendAnim5->set_blend_pos(glm::vec2(0.0f, -1.0f));
 
 		// 14(RUMBA-DANCING), 4(HIP HOP DANCING), 22(WALK), 23(WALK-LEFT), 24(WALK-RIGHT), 25(WALK-BACK)
 		blendAnim1->m_animSource = &(xBotInstance->get_owner()->get_model()->m_animations[14]);
@@ -893,7 +1063,7 @@ namespace cs460
 
 		// Create the nodes
 		SceneNode* xBot = root->create_child("X-BOT");
-		xBot->m_localTr.m_position = glm::vec3(0.0f, 0.0f, 0.0f);
+		xBot->set_local_position(glm::vec3(0.0f, 0.0f, 0.0f));
 
 
 		// Add the model
@@ -915,11 +1085,11 @@ namespace cs460
 		BlendAnim* blendAnim4 = static_cast<BlendAnim*>(xBotAnim->get_blend_tree()->add_child(BlendNodeTypes::BLEND_ANIM));
 		BlendAnim* blendAnim5 = static_cast<BlendAnim*>(xBotAnim->get_blend_tree()->add_child(BlendNodeTypes::BLEND_ANIM));
 
-		blendAnim1->m_blendPos.x = 0.0f;
-		blendAnim2->m_blendPos.x = 0.5f;
-		blendAnim3->m_blendPos.x = 1.0f;
-		blendAnim4->m_blendPos.x = 1.5f;
-		blendAnim5->m_blendPos.x = 2.0f;
+		blendAnim1->set_blend_pos(glm::vec2(0.0f, 0.0f));
+		blendAnim2->set_blend_pos(glm::vec2(0.5f, 0.0f));
+		blendAnim3->set_blend_pos(glm::vec2(1.0f, 0.0f));
+		blendAnim4->set_blend_pos(glm::vec2(1.5f, 0.0f));
+		blendAnim5->set_blend_pos(glm::vec2(2.0f, 0.0f));
 
 		// 14(RUMBA-DANCING), 4(HIP HOP DANCING), 5(IDLE), 22(WALK), 6(JOG), 15(RUN), 3(FAST RUN)
 		blendAnim1->m_animSource = &(xBotInstance->get_owner()->get_model()->m_animations[4]);
@@ -951,7 +1121,7 @@ namespace cs460
 
 		// Create the nodes
 		SceneNode* xBot = root->create_child("X-BOT");
-		xBot->m_localTr.m_position = glm::vec3(0.0f, 0.0f, 0.0f);
+		xBot->set_local_position(glm::vec3(0.0f, 0.0f, 0.0f));
 
 
 		// Add the model
@@ -973,11 +1143,11 @@ namespace cs460
 		BlendAnim* blendAnim4 = static_cast<BlendAnim*>(xBotAnim->get_blend_tree()->add_child(BlendNodeTypes::BLEND_ANIM));
 		BlendAnim* blendAnim5 = static_cast<BlendAnim*>(xBotAnim->get_blend_tree()->add_child(BlendNodeTypes::BLEND_ANIM));
 
-		blendAnim1->m_blendPos = glm::vec2(0.0f, 0.0f);
-		blendAnim2->m_blendPos = glm::vec2(0.0f, 1.0f);
-		blendAnim3->m_blendPos = glm::vec2(-1.0f, 0.0f);
-		blendAnim4->m_blendPos = glm::vec2(1.0f, 0.0f);
-		blendAnim5->m_blendPos = glm::vec2(0.0f, -1.0f);
+		blendAnim1->set_blend_pos(glm::vec2(0.0f, 0.0f));
+		blendAnim2->set_blend_pos(glm::vec2(0.0f, 1.0f));
+		blendAnim3->set_blend_pos(glm::vec2(-1.0f, 0.0f));
+		blendAnim4->set_blend_pos(glm::vec2(1.0f, 0.0f));
+		blendAnim5->set_blend_pos(glm::vec2(0.0f, -1.0f));
 
 		// 14(RUMBA-DANCING), 4(HIP HOP DANCING), 22(WALK), 23(WALK-LEFT), 24(WALK-RIGHT), 25(WALK-BACK)
 		blendAnim1->m_animSource = &(xBotInstance->get_owner()->get_model()->m_animations[14]);
@@ -993,6 +1163,46 @@ namespace cs460
 	}
 
 
+	void MainMenuBarGUI::load_blend_layers_scene()
+	{
+		// Clear the scene
+		load_empty_scene();
+
+		Scene& scene = Scene::get_instance();
+		SceneNode* root = scene.get_root();
+
+		DebugRenderer::s_enableGridDrawing = true;
+		scene.change_camera(false);
+		ICamera* cam = scene.get_active_camera();
+		cam->set_is_active(true);
+		SphericalCamera* sphericalCam = dynamic_cast<SphericalCamera*>(cam);
+
+		// Create the nodes
+		SceneNode* xBot = root->create_child("X-BOT");
+		sphericalCam->set_focal_node(xBot);
+		sphericalCam->set_focal_offset(glm::vec3(0.0f, 1.5f, 0.0f));
+
+
+		// Add the model
+		ModelInstance* xBotInstance = xBot->add_component<ModelInstance>();
+		xBotInstance->change_model("data/Models/xbot/xbot.gltf");
+		Model* model = xBotInstance->get_owner()->get_model();
+
+
+		// Set the animation component and blend tree usage
+		AnimationReference* xBotAnim = xBot->get_component<AnimationReference>();
+		xBotAnim->set_blend_tree_type(3);
+
+		// Walk with the legs, and punch with the upper body (only the joints from the spine are sampled for the punch)
+		BlendAnim* baseAnim = static_cast<BlendAnim*>(xBotAnim->get_blend_tree()->m_children[0]);
+		BlendAnim* upperBodyAnim = static_cast<BlendAnim*>(xBotAnim->get_blend_tree()->m_children[1]);
+
+		// 22(WALK), 13(PUNCH_LEFT)
+		baseAnim->m_animSource = &model->m_animations[22];
+		upperBodyAnim->m_animSource = &model->m_animations[13];
+		upperBodyAnim->set_blend_mask(create_hierarchy_mask(model, "mixamorig:Spine"));
+	}
+
 	void MainMenuBarGUI::load_ik_analytical_2d_scene()
 	{
 		// Clear the scene
@@ -1020,9 +1230,9 @@ namespace cs460
 		SceneNode* target = root->create_child("TARGET");
 
 		// Place the joints
-		joint1->m_localTr.m_position.x = 2.0f;
-		joint2->m_localTr.m_position.x = 4.0f;
-		target->m_localTr.m_position.x = 6.0f;
+		joint1->modify_local_tr().m_position.x = 2.0f;
+		joint2->modify_local_tr().m_position.x = 4.0f;
+		target->modify_local_tr().m_position.x = 6.0f;
 
 
 		// Setup the ik chain component
@@ -1066,11 +1276,11 @@ namespace cs460
 		SceneNode* target = root->create_child("TARGET");
 
 		// Place the joints
-		joint1->m_localTr.m_position.x = 2.0f;
-		joint2->m_localTr.m_position.x = 2.0f;
-		joint3->m_localTr.m_position.x = 2.0f;
-		joint4->m_localTr.m_position.x = 2.0f;
-		target->m_localTr.m_position.x = 8.0f;
+		joint1->modify_local_tr().m_position.x = 2.0f;
+		joint2->modify_local_tr().m_position.x = 2.0f;
+		joint3->modify_local_tr().m_position.x = 2.0f;
+		joint4->modify_local_tr().m_position.x = 2.0f;
+		target->modify_local_tr().m_position.x = 8.0f;
 
 
 		// Setup the ik chain component
@@ -1115,11 +1325,11 @@ namespace cs460
 		SceneNode* target = root->create_child("TARGET");
 
 		// Place the joints
-		joint1->m_localTr.m_position.x = 2.0f;
-		joint2->m_localTr.m_position.x = 2.0f;
-		joint3->m_localTr.m_position.x = 2.0f;
-		joint4->m_localTr.m_position.x = 2.0f;
-		target->m_localTr.m_position.x = 8.0f;
+		joint1->modify_local_tr().m_position.x = 2.0f;
+		joint2->modify_local_tr().m_position.x = 2.0f;
+		joint3->modify_local_tr().m_position.x = 2.0f;
+		joint4->modify_local_tr().m_position.x = 2.0f;
+		target->modify_local_tr().m_position.x = 8.0f;
 
 
 		// Setup the ik chain component
@@ -1174,7 +1384,7 @@ namespace cs460
 
 		// Create and set the target of the ik chain
 		SceneNode* target = root->create_child("TARGET");
-		target->m_localTr.m_position = glm::vec3(-0.12f, 0.05f, 0.0f);
+		target->set_local_position(glm::vec3(-0.12f, 0.05f, 0.0f));
 		chainRootComp->set_target(target);
 
 		// Make the target the selected node in the editor
@@ -1247,8 +1457,8 @@ namespace cs460
 		SceneNode* sphereNode = root->create_child("Sphere");
 		ModelInstance* modelComp = sphereNode->add_component<ModelInstance>();
 		modelComp->change_model("data/Models/Sphere/Sphere.gltf");
-		sphereNode->m_localTr.m_position = glm::vec3(1.6f, -2.5f, 0.0f);
-		sphereNode->m_localTr.m_scale = glm::vec3(0.7f, 0.7f, 0.7f);
+		sphereNode->set_local_position(glm::vec3(1.6f, -2.5f, 0.0f));
+		sphereNode->set_local_scale(glm::vec3(0.7f, 0.7f, 0.7f));
 
 		// Place the object with the cloth
 		SceneNode* clothNode = root->create_child("CLOTH");
@@ -1261,4 +1471,56 @@ namespace cs460
 		EditorState& editorState = EditorState::get_main_editor_state();
 		editorState.m_selectedNode = sphereNode;
 	}
+
+
+	// Create the given number of model instances under the root and delete them, printing the time of both
+	void MainMenuBarGUI::benchmark_spawn_despawn(const std::string& modelPath, unsigned count, unsigned rounds)
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		// Load the model before timing, so that only the creation of the nodes/components is measured
+		Model* model = ResourceManager::get_instance().get_model(modelPath);
+		if (model == nullptr)
+		{
+			std::cout << "ERROR: Couldn't load the model used by the spawn/despawn benchmark\n";
+			return;
+		}
+
+		load_empty_scene();
+		Scene& scene = Scene::get_instance();
+		SceneNode* root = scene.get_root();
+		std::string name = fs::path(modelPath).stem().generic_string();
+
+		std::cout << "Spawn/despawn of " << count << " " << name << " instances:\n";
+		for (unsigned round = 0; round < 2 * rounds; ++round)
+		{
+			ObjectPool::PoolStats before = ObjectPool::get_total_stats();
+
+			// Alternate creating them one by one from the path, and all at once from the model
+			bool batch = round % 2 == 1;
+			Clock::time_point start = Clock::now();
+			if (batch)
+				scene.instantiate(model, count);
+			else
+			{
+				for (unsigned i = 0; i < count; ++i)
+					root->create_child_with_model(name + " " + std::to_string(i), modelPath);
+			}
+			Clock::time_point spawned = Clock::now();
+
+			ObjectPool::PoolStats afterSpawn = ObjectPool::get_total_stats();
+
+			scene.clear();
+			Clock::time_point despawned = Clock::now();
+
+			// Remove the freed transforms like the next scene update would
+			scene.get_transforms().compact();
+
+			double spawnMs = std::chrono::duration<double, std::milli>(spawned - start).count();
+			double despawnMs = std::chrono::duration<double, std::milli>(despawned - spawned).count();
+			std::cout << "  Round " << round / 2 << (batch ? " (instantiate)" : " (one by one)") << ": spawn " << spawnMs << " ms, despawn " << despawnMs << " ms, "
+				<< afterSpawn.m_allocations - before.m_allocations << " nodes/components from the pools, "
+				<< afterSpawn.m_heapAllocations - before.m_heapAllocations << " new pool blocks from the heap\n";
+		}
+	}
 }
\ No newline at end of file
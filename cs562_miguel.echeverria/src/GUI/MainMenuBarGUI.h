@@ -24,12 +24,14 @@ namespace cs460
 		CATMULL_ROM,
 		BEZIER,
 		SKINNED_ANIMATION,
+		ANIMATION_CROWD,
 		NESTED_MODELS,
 		PATH_FOLLOWING,
 		BLENDING_1D,
 		BLENDING_2D,
 		BLEND_EDITOR_1D,
 		BLEND_EDITOR_2D,
+		BLEND_LAYERS,
 		IK_ANALYTICAL_2D,
 		IK_CCD_3D,
 		IK_FABRIK_3D,
@@ -62,12 +64,14 @@ namespace cs460
 		void load_catmull_rom_curve_scene();
 		void load_bezier_curve_scene();
 		void load_skinned_animation_scene();
+		void load_animation_crowd_scene();
 		void load_nested_models_scene();
 		void load_path_following_scene();
 		void load_blending_1d_scene();
 		void load_blending_2d_scene();
 		void load_blend_editor_1d_scene();
 		void load_blend_editor_2d_scene();
+		void load_blend_layers_scene();
 		void load_ik_analytical_2d_scene();
 		void load_ik_ccd_3d_scene();
 		void load_ik_fabrik_3d_scene();
@@ -75,6 +79,10 @@ namespace cs460
 		void load_cloth_simulation_scene();
 		void load_cloth_collision_scene();
 
+		// Create the given number of instances of the model under the root and delete them a few times (one by one and in a
+		// batch), printing the time of both and the allocations of the object pools (the first round fills the pools)
+		void benchmark_spawn_despawn(const std::string& modelPath, unsigned count, unsigned rounds);
+
 
 		MainMenuBarGUI();
 		MainMenuBarGUI(const MainMenuBarGUI&) = delete;
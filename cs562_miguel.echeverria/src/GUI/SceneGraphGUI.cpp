@@ -12,6 +12,7 @@
 #include "Composition/Scene.h"
 #include "Composition/SceneNode.h"
 #include "EditorState.h"
+#include "Composition/SceneCommandQueue.h"
 
 
 namespace cs460
@@ -173,8 +174,8 @@ namespace cs460
 		EditorState& state = EditorState::get_main_editor_state();
 		Scene& scene = Scene::get_instance();
 
-		// TODO: Because we don't set the last parameter, there are problems when deleting childs
-		scene.delete_tree(state.m_selectedNode);
+		// Deleted at the end of the frame, once the gui and the systems are done with it
+		scene.get_command_queue().destroy_node(state.m_selectedNode);
 		state.m_selectedNode = nullptr;
 	}
 }
\ No newline at end of file
@@ -116,17 +116,17 @@ namespace cs460
 			stickAngle = glm::radians(stickAngle - 90);
 
 			// Get the current rotation quaternion and the target rotation quaternion based on the stick input
-			glm::quat currQuat = get_owner()->m_localTr.m_orientation;
+			glm::quat currQuat = get_owner()->get_local_tr().m_orientation;
 			glm::quat stickQuat(glm::vec3(0.0f, -stickAngle, 0.0f));
 
 			// Slerp the rotation to make it smooth
 			glm::quat currOrientation = glm::normalize(glm::slerp(currQuat, stickQuat, dt * 10.0f));
-			get_owner()->m_localTr.m_orientation = currOrientation;
+			get_owner()->set_local_orientation(currOrientation);
 
 			// Apply movement in the current forward direction
 
 			m_currentForward = glm::normalize(currOrientation * m_startingForward);
-			get_owner()->m_localTr.m_position += m_currentForward * MAX_SPEED * blendParam * dt;
+			get_owner()->modify_local_tr().m_position += m_currentForward * MAX_SPEED * blendParam * dt;
 		}
 	}
 
@@ -139,7 +139,7 @@ namespace cs460
 		float paramLength = glm::length(param);
 
 		if (paramLength > 0.1f)
-			get_owner()->m_localTr.m_position += leftStickWorldSpace * MAX_SPEED * paramLength * dt;
+			get_owner()->modify_local_tr().m_position += leftStickWorldSpace * MAX_SPEED * paramLength * dt;
 	}
 
 	glm::vec2 PlayerController::clamp_parameter_to_romboid(const glm::vec2& param)
@@ -96,4 +96,10 @@ namespace cs460
 	{
 		glBindVertexArray(0);
 	}
+
+	// To draw it through render commands
+	unsigned Cube::get_vao() const
+	{
+		return m_vao;
+	}
 }
\ No newline at end of file
@@ -23,6 +23,8 @@ namespace cs460
 		void bind() const;
 		void unbind() const;
 
+		unsigned get_vao() const;		// To draw it through render commands
+
 	private:
 		unsigned m_vao = -1;
 		unsigned m_vbo = -1;
@@ -9,6 +9,7 @@
 
 #include "pch.h"
 #include "Mesh.h"
+#include "Animation/Skinning/JointBounds.h"
 #include <gltf/tiny_gltf.h>
 
 
@@ -34,6 +35,7 @@ namespace cs460
 			m_primitives[i].delete_gl_buffers();
 
 		m_primitives.clear();
+		m_jointBounds.clear();
 	}
 
 
@@ -47,6 +49,8 @@ namespace cs460
 		{
 			m_primitives[i].load_primitive_data(model, mesh.primitives[i]);
 
+			// Update the boxes of the joints that deform this primitive
+			compute_joint_bounds(m_primitives[i].get_skinned_vertices(), m_jointBounds);
 
 			// Update the bounding volume
 			const glm::vec3& currentMin = m_primitives[i].get_min_pos();
@@ -38,5 +38,6 @@ namespace cs460
 		std::string m_name;
 		std::vector<Primitive> m_primitives;
 		AABB m_boundingVolume;
+		std::vector<AABB> m_jointBounds;		// Bind pose box of the vertices each joint deforms (empty if the mesh isn't skinned)
 	};
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 #include "pch.h"
 #include "Model.h"
+#include "Composition/ModelPrefab.h"
 #include <gltf/tiny_gltf.h>
 
 
@@ -25,8 +26,9 @@ namespace cs460
 		clear();
 	}
 
-	// Loads the given gltf file and stores all its data
-	void Model::load_gltf_file(const std::string& filePath)
+	// Loads the given gltf file and stores all its data (without meshes the
+	// nodes, skins and animations can be used without a graphics context)
+	void Model::load_gltf_file(const std::string& filePath, bool loadMeshes)
 	{
 		// Store the filepath and filename
 		m_filePath = filePath;
@@ -53,12 +55,12 @@ namespace cs460
 			return;
 		}
 
-		load_model_data(model);
+		load_model_data(model, loadMeshes);
 	}
 
 
 	// Process the tinygltf model structure into our own
-	void Model::load_model_data(const tinygltf::Model& model)
+	void Model::load_model_data(const tinygltf::Model& model, bool loadMeshes)
 	{
 		// Reallocate the vector of meshes, skins etc with enough size
 		clear();
@@ -82,7 +84,7 @@ namespace cs460
 			m_nodes[i].load_node_data(model, i, skinNodes);
 
 		// Load the meshes
-		for (int i = 0; i < m_meshes.size(); ++i)
+		for (int i = 0; loadMeshes && i < m_meshes.size(); ++i)
 			m_meshes[i].load_mesh_data(model, model.meshes[i]);
 
 		// Load the skins
@@ -105,6 +107,19 @@ namespace cs460
 		m_nodes.clear();
 		m_meshes.clear();
 		m_skins.clear();
+		m_prefab.reset();
+	}
+
+	// Nodes and components of an instance of this model, gathered the first time it is instanced
+	const ModelPrefab& Model::get_prefab()
+	{
+		if (m_prefab == nullptr)
+		{
+			m_prefab = std::make_unique<ModelPrefab>();
+			m_prefab->build(this);
+		}
+
+		return *m_prefab;
 	}
 
 	// Compare two models based on their filename
@@ -14,6 +14,7 @@
 #include "Composition/GLTFNode.h"
 #include "Composition/GLTFScene.h"
 #include "Animation/Animation.h"
+#include <memory>
 
 
 namespace tinygltf
@@ -24,20 +25,27 @@ namespace tinygltf
 
 namespace cs460
 {
+	class ModelPrefab;
+
+
 	struct Model
 	{
 		Model();
 		~Model();
 
-		// Loads the given gltf file and stores all its data
-		void load_gltf_file(const std::string& filePath);
+		// Loads the given gltf file and stores all its data (without meshes the
+		// nodes, skins and animations can be used without a graphics context)
+		void load_gltf_file(const std::string& filePath, bool loadMeshes = true);
 
 		// Process the tinygltf model structure into our own
-		void load_model_data(const tinygltf::Model& model);
+		void load_model_data(const tinygltf::Model& model, bool loadMeshes = true);
 
 		// Releases all the resources used by the meshes
 		void clear();
 
+		// Nodes and components of an instance of this model, gathered the first time it is instanced
+		const ModelPrefab& get_prefab();
+
 		// Compare two models based on their filename
 		bool operator==(const Model& other) const;
 
@@ -50,5 +58,6 @@ namespace cs460
 		std::vector<Skin> m_skins;
 		std::vector<Animation> m_animations;
 		int m_defaultScene;
+		std::unique_ptr<ModelPrefab> m_prefab;
 	};
 }
\ No newline at end of file
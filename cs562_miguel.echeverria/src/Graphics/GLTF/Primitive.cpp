@@ -13,12 +13,18 @@
 //#include "Components/MeshRenderable.h"
 #include "Graphics/Rendering/Shader.h"
 #include "Resources/ResourceManager.h"
+#include "Graphics/Rendering/RenderCommandBuffer.h"
 #include <gltf/tiny_gltf.h>
 #include <GL/glew.h>
 
 
 namespace cs460
 {
+	// Load time preprocessing of the skin weights (the smaller ones are removed, and the rest quantized)
+	static const float s_skinWeightThreshold = 0.01f;
+	static const SkinWeightFormat s_skinWeightFormat = SkinWeightFormat::UNORM8;
+
+
 	Primitive::Primitive()
 	{
 		m_shader = ResourceManager::get_instance().get_shader("phong_color");
@@ -80,6 +86,14 @@ namespace cs460
 			setup_vertex_attribute(attArrayIdx, attAccessor, bufView);
 		}
 
+		// Keep the skinning data on the cpu if it has any
+		load_skinned_vertices(model, primitive);
+		if (!m_skinnedVertices.is_empty())
+		{
+			setup_skin_partitions(model, primitive);
+			setup_deformed_vao(model, primitive);
+		}
+
 		// Process all the material data (color, textures etc)
 		const tinygltf::Material& material = model.materials[primitive.material];
 		load_material_data(model, material);
@@ -146,23 +160,62 @@ namespace cs460
 	}
 
 
-	// Draw the primitive
-	void Primitive::render() const
+	// Record the commands that draw the primitive (the shader and its uniforms have to be recorded before)
+	void Primitive::record(RenderCommandBuffer& commands) const
 	{
-		if (m_material.m_usesBaseTexture)
-			m_material.m_baseColorTex.bind();
+		record_textures(commands);
+		commands.draw(m_vao, m_mode, (unsigned)m_elementCount, m_usesEbo ? m_eboComponentType : -1, m_offset);
+	}
 
-		if (m_material.m_usesNormalTexture)
-			m_material.m_normalMapTex.bind();
+	// Same as record, but the positions and normals are replaced by the given vertices deformed on the cpu
+	void Primitive::record_deformed(RenderCommandBuffer& commands, const glm::vec3* positions, const glm::vec3* normals) const
+	{
+		if (m_deformedVao == 0)
+		{
+			record(commands);
+			return;
+		}
 
-		glBindVertexArray(m_vao);
+		// The buffers are shared by every instance of the model, so they are updated right before each draw
+		unsigned byteCount = m_skinnedVertices.get_vertex_count() * sizeof(glm::vec3);
+		commands.update_buffer(m_deformedVbos[0], positions, byteCount);
+		if (!m_skinnedVertices.m_normals.empty())
+			commands.update_buffer(m_deformedVbos[1], normals, byteCount);
 
-		if (m_usesEbo)
-			glDrawElements(m_mode, (GLsizei)m_elementCount, m_eboComponentType, (void*)m_offset);
-		else
-			glDrawArrays(m_mode, 0, (GLsizei)m_elementCount);
+		record_textures(commands);
+		commands.draw(m_deformedVao, m_mode, (unsigned)m_elementCount, m_usesEbo ? m_eboComponentType : -1, m_offset);
+	}
 
-		glBindVertexArray(0);
+	// Same as record, but only draws the triangles of the given skin partition (its palette has to be recorded before).
+	// Each group of triangles is drawn telling the shader how many influences its vertices need.
+	void Primitive::record_partition(RenderCommandBuffer& commands, unsigned partitionIdx) const
+	{
+		if (partitionIdx >= m_partitionVaos.size())
+			return;
+
+		record_textures(commands);
+
+		// Primitives that aren't made of triangles are drawn whole, like record does
+		if (m_partitionEbo == 0)
+		{
+			commands.set_uniform("influenceCount", 4);
+			commands.draw(m_partitionVaos[partitionIdx], m_mode, (unsigned)m_elementCount, m_usesEbo ? m_eboComponentType : -1, m_offset);
+			return;
+		}
+
+		const SkinPartition& partition = m_skinPartitions[partitionIdx];
+		const int groupInfluences[3] = { 1, 2, 4 };
+		unsigned firstIndex = partition.m_firstIndex;
+		for (int g = 0; g < 3; ++g)
+		{
+			unsigned indexCount = partition.m_influenceIndexCounts[g];
+			if (indexCount == 0)
+				continue;
+
+			commands.set_uniform("influenceCount", groupInfluences[g]);
+			commands.draw(m_partitionVaos[partitionIdx], GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, firstIndex * sizeof(unsigned));
+			firstIndex += indexCount;
+		}
 	}
 
 
@@ -198,10 +251,44 @@ namespace cs460
 		return m_maxPos;
 	}
 
+	// Bind pose positions, normals, joints and weights (empty if the primitive isn't skinned)
+	const SkinnedVertices& Primitive::get_skinned_vertices() const
+	{
+		return m_skinnedVertices;
+	}
+
+	// Groups of triangles with the joints each one uses (empty if the primitive isn't skinned)
+	const std::vector<SkinPartition>& Primitive::get_skin_partitions() const
+	{
+		return m_skinPartitions;
+	}
+
+	// Bytes of the joints and weights as stored in the file, and as uploaded after the preprocessing
+	unsigned Primitive::get_file_skin_bytes() const
+	{
+		return m_fileSkinBytes;
+	}
+
+	unsigned Primitive::get_skin_bytes() const
+	{
+		return m_skinBytes;
+	}
+
 	// Free all the opengl buffers used by this primitive
 	void Primitive::delete_gl_buffers()
 	{
 		glDeleteVertexArrays(1, &m_vao);
+		glDeleteVertexArrays(1, &m_deformedVao);
+		glDeleteBuffers(2, m_deformedVbos);
+
+		glDeleteVertexArrays((int)m_partitionVaos.size(), m_partitionVaos.data());
+		glDeleteBuffers((int)m_partitionJointVbos.size(), m_partitionJointVbos.data());
+		glDeleteBuffers(1, &m_partitionEbo);
+		glDeleteBuffers(1, &m_skinWeightsVbo);
+		m_partitionVaos.clear();
+		m_partitionJointVbos.clear();
+		m_partitionEbo = 0;
+		m_skinWeightsVbo = 0;
 
 		for(auto it = m_vbos.begin(); it != m_vbos.end(); ++it)
 			glDeleteBuffers(1, &it->second);
@@ -282,6 +369,224 @@ namespace cs460
 	}
 
 
+	// Read a component of an accessor as a float (normalized integers are mapped to [0, 1])
+	static float read_accessor_component(const unsigned char* data, int componentType, bool normalized)
+	{
+		switch (componentType)
+		{
+		case TINYGLTF_COMPONENT_TYPE_FLOAT:
+			return *reinterpret_cast<const float*>(data);
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+			return normalized ? *data / 255.0f : (float)*data;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+			return normalized ? *reinterpret_cast<const unsigned short*>(data) / 65535.0f : (float)*reinterpret_cast<const unsigned short*>(data);
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+			return (float)*reinterpret_cast<const unsigned*>(data);
+		}
+		return 0.0f;
+	}
+
+	// Read the first 4 components of every element of the given accessor
+	static void read_accessor_vec4(const tinygltf::Model& model, const tinygltf::Accessor& accessor, std::vector<glm::vec4>& result)
+	{
+		const tinygltf::BufferView& bufView = model.bufferViews[accessor.bufferView];
+		const unsigned char* data = model.buffers[bufView.buffer].data.data() + bufView.byteOffset + accessor.byteOffset;
+		int stride = accessor.ByteStride(bufView);
+		int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+		int componentCount = glm::min(tinygltf::GetNumComponentsInType(accessor.type), 4);
+
+		result.resize(accessor.count, glm::vec4(0.0f));
+		for (size_t i = 0; i < accessor.count; ++i)
+			for (int c = 0; c < componentCount; ++c)
+				result[i][c] = read_accessor_component(data + i * stride + c * componentSize, accessor.componentType, accessor.normalized);
+	}
+
+	// Read every index of the given accessor
+	static void read_accessor_indices(const tinygltf::Model& model, const tinygltf::Accessor& accessor, std::vector<unsigned>& result)
+	{
+		const tinygltf::BufferView& bufView = model.bufferViews[accessor.bufferView];
+		const unsigned char* data = model.buffers[bufView.buffer].data.data() + bufView.byteOffset + accessor.byteOffset;
+		int stride = accessor.ByteStride(bufView);
+
+		result.resize(accessor.count);
+		for (size_t i = 0; i < accessor.count; ++i)
+			result[i] = (unsigned)read_accessor_component(data + i * stride, accessor.componentType, false);
+	}
+
+	// Keep a copy of the positions, normals, joints and weights if the primitive is skinned
+	void Primitive::load_skinned_vertices(const tinygltf::Model& model, const tinygltf::Primitive& primitive)
+	{
+		m_skinnedVertices = SkinnedVertices();
+
+		auto posIt = primitive.attributes.find("POSITION");
+		auto jointsIt = primitive.attributes.find("JOINTS_0");
+		auto weightsIt = primitive.attributes.find("WEIGHTS_0");
+		auto normalIt = primitive.attributes.find("NORMAL");
+		if (posIt == primitive.attributes.end() || jointsIt == primitive.attributes.end() || weightsIt == primitive.attributes.end())
+			return;
+
+		std::vector<glm::vec4> positions;
+		std::vector<glm::vec4> joints;
+		read_accessor_vec4(model, model.accessors[posIt->second], positions);
+		read_accessor_vec4(model, model.accessors[jointsIt->second], joints);
+		read_accessor_vec4(model, model.accessors[weightsIt->second], m_skinnedVertices.m_weights);
+
+		if (positions.size() != joints.size() || positions.size() != m_skinnedVertices.m_weights.size())
+		{
+			std::cout << "ERROR: Skinned primitive with a different number of positions, joints and weights" << std::endl;
+			m_skinnedVertices = SkinnedVertices();
+			return;
+		}
+
+		std::vector<glm::vec4> normals;
+		if (normalIt != primitive.attributes.end())
+			read_accessor_vec4(model, model.accessors[normalIt->second], normals);
+		if (normals.size() == positions.size())
+		{
+			m_skinnedVertices.m_normals.resize(normals.size());
+			for (size_t i = 0; i < normals.size(); ++i)
+				m_skinnedVertices.m_normals[i] = glm::vec3(normals[i]);
+		}
+
+		m_skinnedVertices.m_positions.resize(positions.size());
+		m_skinnedVertices.m_joints.resize(joints.size());
+		for (size_t i = 0; i < positions.size(); ++i)
+		{
+			m_skinnedVertices.m_positions[i] = glm::vec3(positions[i]);
+			m_skinnedVertices.m_joints[i] = glm::u16vec4(joints[i]);
+		}
+	}
+
+
+	// Prepare the weights, compute the joints used by each partition of the skinned vertices and create the buffers to draw them
+	void Primitive::setup_skin_partitions(const tinygltf::Model& model, const tinygltf::Primitive& primitive)
+	{
+		// Size of the skinning attributes as stored in the file, for comparison
+		const tinygltf::Accessor& jointsAccessor = model.accessors[primitive.attributes.at("JOINTS_0")];
+		const tinygltf::Accessor& weightsAccessor = model.accessors[primitive.attributes.at("WEIGHTS_0")];
+		m_fileSkinBytes = m_skinnedVertices.get_vertex_count() * 4 * (tinygltf::GetComponentSizeInBytes(jointsAccessor.componentType) +
+																	tinygltf::GetComponentSizeInBytes(weightsAccessor.componentType));
+
+		std::vector<unsigned char> quantizedWeights;
+		prepare_skin_weights(m_skinnedVertices, s_skinWeightThreshold, s_skinWeightFormat, quantizedWeights);
+
+		// Only triangles can be split and grouped by influence count, the rest of modes always use a single partition
+		std::vector<unsigned> indices;
+		if (m_mode == GL_TRIANGLES && m_usesEbo)
+			read_accessor_indices(model, model.accessors[primitive.indices], indices);
+		else if (m_mode == GL_TRIANGLES)
+		{
+			indices.resize(m_skinnedVertices.get_vertex_count());
+			for (unsigned i = 0; i < indices.size(); ++i)
+				indices[i] = i;
+		}
+
+		if (!partition_skin(m_skinnedVertices, indices, SkinPartition::MAX_JOINTS, m_skinPartitions))
+			std::cout << "ERROR: Skinned primitive that uses more than " << SkinPartition::MAX_JOINTS << " joints and can't be split" << std::endl;
+
+		// The weights are shared by all the partitions
+		glGenBuffers(1, &m_skinWeightsVbo);
+		glBindBuffer(GL_ARRAY_BUFFER, m_skinWeightsVbo);
+		glBufferData(GL_ARRAY_BUFFER, quantizedWeights.size(), quantizedWeights.data(), GL_STATIC_DRAW);
+		m_skinBytes = (unsigned)quantizedWeights.size();
+
+		// Each partition has its own vertex array, that shares the rest of vbos with the regular one. The ebo
+		// has the reordered triangles, or is the original one if the primitive isn't made of triangles.
+		m_partitionVaos.resize(m_skinPartitions.size());
+		m_partitionJointVbos.resize(m_skinPartitions.size());
+		glGenVertexArrays((int)m_partitionVaos.size(), m_partitionVaos.data());
+		glGenBuffers((int)m_partitionJointVbos.size(), m_partitionJointVbos.data());
+		if (!indices.empty())
+			glGenBuffers(1, &m_partitionEbo);
+
+		for (unsigned p = 0; p < m_skinPartitions.size(); ++p)
+		{
+			glBindVertexArray(m_partitionVaos[p]);
+
+			if (m_partitionEbo != 0)
+			{
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_partitionEbo);
+				if (p == 0)
+					glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), indices.data(), GL_STATIC_DRAW);
+			}
+			else if (m_usesEbo)
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vbos[model.accessors[primitive.indices].bufferView]);
+
+			for (auto it = primitive.attributes.begin(); it != primitive.attributes.end(); ++it)
+			{
+				int attArrayIdx = get_attribute_index(it->first);
+				if (attArrayIdx < 0 || attArrayIdx == 4 || attArrayIdx == 5)
+					continue;
+
+				const tinygltf::Accessor& attAccessor = model.accessors[it->second];
+				setup_vertex_attribute(attArrayIdx, attAccessor, model.bufferViews[attAccessor.bufferView]);
+			}
+
+			// The joints are indices into the palette of the partition, so they always fit in a byte
+			const std::vector<glm::u8vec4>& localJoints = m_skinPartitions[p].m_localJoints;
+			glBindBuffer(GL_ARRAY_BUFFER, m_partitionJointVbos[p]);
+			glBufferData(GL_ARRAY_BUFFER, localJoints.size() * sizeof(glm::u8vec4), localJoints.data(), GL_STATIC_DRAW);
+			glEnableVertexAttribArray(4);
+			glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(glm::u8vec4), (void*)0);
+			m_skinBytes += (unsigned)(localJoints.size() * sizeof(glm::u8vec4));
+
+			GLenum weightType = s_skinWeightFormat == SkinWeightFormat::UNORM8 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
+			glBindBuffer(GL_ARRAY_BUFFER, m_skinWeightsVbo);
+			glEnableVertexAttribArray(5);
+			glVertexAttribPointer(5, 4, weightType, GL_TRUE, get_skin_weight_size(s_skinWeightFormat), (void*)0);
+		}
+
+		glBindVertexArray(m_vao);
+	}
+
+
+	// Create the vertex array used to draw cpu skinned vertices (the other attributes and the ebo are shared)
+	void Primitive::setup_deformed_vao(const tinygltf::Model& model, const tinygltf::Primitive& primitive)
+	{
+		glGenVertexArrays(1, &m_deformedVao);
+		glBindVertexArray(m_deformedVao);
+
+		if (primitive.indices >= 0)
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vbos[model.accessors[primitive.indices].bufferView]);
+
+		// Positions and normals come from the dynamic buffers (the normals are only used if the primitive has them)
+		unsigned byteCount = m_skinnedVertices.get_vertex_count() * sizeof(glm::vec3);
+		glGenBuffers(2, m_deformedVbos);
+		for (int i = 0; i < 2; ++i)
+		{
+			if (i == 1 && m_skinnedVertices.m_normals.empty())
+				break;
+
+			glBindBuffer(GL_ARRAY_BUFFER, m_deformedVbos[i]);
+			glBufferData(GL_ARRAY_BUFFER, byteCount, nullptr, GL_DYNAMIC_DRAW);
+			glEnableVertexAttribArray(i);
+			glVertexAttribPointer(i, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+		}
+
+		// The texture coordinates and tangents come from the same vbos as in the regular vertex array
+		for (auto it = primitive.attributes.begin(); it != primitive.attributes.end(); ++it)
+		{
+			int attArrayIdx = get_attribute_index(it->first);
+			if (attArrayIdx != 2 && attArrayIdx != 3)
+				continue;
+
+			const tinygltf::Accessor& attAccessor = model.accessors[it->second];
+			setup_vertex_attribute(attArrayIdx, attAccessor, model.bufferViews[attAccessor.bufferView]);
+		}
+	}
+
+
+	// Record the binding of the textures of the material
+	void Primitive::record_textures(RenderCommandBuffer& commands) const
+	{
+		if (m_material.m_usesBaseTexture)
+			commands.bind_texture(TextureTarget::TEXTURE_2D, m_material.m_baseColorTex.get_id(), m_material.m_baseColorTex.get_texture_unit());
+
+		if (m_material.m_usesNormalTexture)
+			commands.bind_texture(TextureTarget::TEXTURE_2D, m_material.m_normalMapTex.get_id(), m_material.m_normalMapTex.get_texture_unit());
+	}
+
+
 	// Create and upload the data of the vbo with the given index, if it hasn't been already created.
 	void Primitive::setup_vbo(const tinygltf::Model& model, const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView)
 	{
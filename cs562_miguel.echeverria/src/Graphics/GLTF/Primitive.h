@@ -11,6 +11,7 @@
 #pragma once
 
 #include "Graphics/Rendering/Material.h"
+#include "Animation/Skinning/SkinPartition.h"
 
 
 namespace tinygltf
@@ -29,6 +30,7 @@ namespace cs460
 {
 	//class MeshRenderable;
 	class Shader;
+	class RenderCommandBuffer;
 
 
 	class Primitive
@@ -46,8 +48,15 @@ namespace cs460
 		void load_material_data(const tinygltf::Model& model, const tinygltf::Material& material);
 
 
-		// Draw the primitive
-		void render() const;
+		// Record the commands that draw the primitive (the shader and its uniforms have to be recorded before)
+		void record(RenderCommandBuffer& commands) const;
+
+		// Same as record, but the positions and normals are replaced by the given vertices deformed on the cpu
+		void record_deformed(RenderCommandBuffer& commands, const glm::vec3* positions, const glm::vec3* normals) const;
+
+		// Same as record, but only draws the triangles of the given skin partition (its palette has to be recorded before).
+		// Each group of triangles is drawn telling the shader how many influences its vertices need.
+		void record_partition(RenderCommandBuffer& commands, unsigned partitionIdx) const;
 
 
 		// Set the shader this primitive will use for drawing (from its name key) and returns it
@@ -60,6 +69,16 @@ namespace cs460
 		glm::vec3 get_min_pos() const;
 		glm::vec3 get_max_pos() const;
 
+		// Bind pose positions, normals, joints and weights (empty if the primitive isn't skinned)
+		const SkinnedVertices& get_skinned_vertices() const;
+
+		// Groups of triangles with the joints each one uses (empty if the primitive isn't skinned)
+		const std::vector<SkinPartition>& get_skin_partitions() const;
+
+		// Bytes of the joints and weights as stored in the file, and as uploaded after the preprocessing
+		unsigned get_file_skin_bytes() const;
+		unsigned get_skin_bytes() const;
+
 		// Free all the opengl buffers used by this primitive
 		void delete_gl_buffers();
 
@@ -75,10 +94,27 @@ namespace cs460
 		int m_mode = -1;						// GL_POINTS, GL_LINES, GL_TRIANGLES etc
 		bool m_usesEbo = false;
 
+		// Vertex array that takes the positions and normals from dynamic buffers, used to draw vertices skinned on the cpu
+		unsigned m_deformedVao = 0;
+		unsigned m_deformedVbos[2] = { 0, 0 };		// Positions and normals
+
+		// Each skin partition is drawn with its own vertex array, whose joints are indices into the partition palette
+		// and whose weights are the quantized ones (the rest of attributes are shared with the regular vertex array)
+		std::vector<SkinPartition> m_skinPartitions;
+		std::vector<unsigned> m_partitionVaos;
+		std::vector<unsigned> m_partitionJointVbos;
+		unsigned m_partitionEbo = 0;			// Triangles grouped by partition and influence count (only for triangles)
+		unsigned m_skinWeightsVbo = 0;
+		unsigned m_fileSkinBytes = 0;
+		unsigned m_skinBytes = 0;
+
 		// For mesh bv computation
 		glm::vec3 m_minPos{  FLT_MAX,  FLT_MAX,  FLT_MAX };
 		glm::vec3 m_maxPos{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
 
+		// Cpu copy of the skinning data, for reference skinning on the cpu
+		SkinnedVertices m_skinnedVertices;
+
 
 		// Save the necessary variables that are needed for drawing, and load
 		// the ebo into one of the elements in m_vbos if it uses ebo.
@@ -90,6 +126,18 @@ namespace cs460
 		// Get the position attibutes' min and max values from its accessor and store those values in m_minPos and m_maxPos
 		void get_bounding_values(const tinygltf::Accessor& posAccessor);
 
+		// Keep a copy of the positions, normals, joints and weights if the primitive is skinned
+		void load_skinned_vertices(const tinygltf::Model& model, const tinygltf::Primitive& primitive);
+
+		// Prepare the weights, compute the joints used by each partition of the skinned vertices and create the buffers to draw them
+		void setup_skin_partitions(const tinygltf::Model& model, const tinygltf::Primitive& primitive);
+
+		// Create the vertex array used to draw cpu skinned vertices (the other attributes and the ebo are shared)
+		void setup_deformed_vao(const tinygltf::Model& model, const tinygltf::Primitive& primitive);
+
+		// Record the binding of the textures of the material
+		void record_textures(RenderCommandBuffer& commands) const;
+
 		// Create and upload the data of the vbo with the given index, if it hasn't been already created.
 		void setup_vbo(const tinygltf::Model& model, const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView);
 
@@ -0,0 +1,65 @@
+/**
+* @file GLCallCounter.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Counts the opengl calls made by the renderer in each frame, so that changes
+*		 in the number of calls can be checked without a profiler (even with a
+*		 software or null context). Only used from the thread that owns the context.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "GLCallCounter.h"
+
+
+namespace cs460
+{
+	GLCallCounter::FrameCounts GLCallCounter::s_currentFrame;
+	GLCallCounter::FrameCounts GLCallCounter::s_lastFrame;
+
+
+	unsigned GLCallCounter::FrameCounts::get_total() const
+	{
+		unsigned total = 0;
+		for (unsigned calls : m_calls)
+			total += calls;
+		return total;
+	}
+
+
+	// Add calls of the given type to the current frame
+	void GLCallCounter::count(GLCallType type, unsigned calls)
+	{
+		s_currentFrame.m_calls[(unsigned)type] += calls;
+	}
+
+	// Store the counts of the current frame and start a new one
+	void GLCallCounter::end_frame()
+	{
+		s_lastFrame = s_currentFrame;
+		s_currentFrame = FrameCounts();
+	}
+
+	// Counts of the last finished frame
+	const GLCallCounter::FrameCounts& GLCallCounter::get_last_frame()
+	{
+		return s_lastFrame;
+	}
+
+	// Print the counts of the last frame
+	void GLCallCounter::print_last_frame(std::ostream& os)
+	{
+		os << "GL calls (last frame): " << s_lastFrame.get_total() << " total\n";
+		for (unsigned i = 0; i < (unsigned)GLCallType::COUNT; ++i)
+			os << "  " << get_type_name((GLCallType)i) << ": " << s_lastFrame.m_calls[i] << "\n";
+	}
+
+	const char* GLCallCounter::get_type_name(GLCallType type)
+	{
+		static const char* names[] = { "USE_PROGRAM", "UNIFORM", "UNIFORM_LOCATION", "BIND", "BUFFER_UPLOAD", "DRAW", "STATE", "DELETE" };
+		static_assert(sizeof(names) / sizeof(names[0]) == (unsigned)GLCallType::COUNT, "Missing GL call type names");
+
+		return names[(unsigned)type];
+	}
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+/**
+* @file GLCallCounter.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Counts the opengl calls made by the renderer in each frame, so that changes
+*		 in the number of calls can be checked without a profiler (even with a
+*		 software or null context). Only used from the thread that owns the context.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+
+namespace cs460
+{
+	enum class GLCallType
+	{
+		USE_PROGRAM,
+		UNIFORM,				// glUniform* calls (an array upload is a single call)
+		UNIFORM_LOCATION,		// glGetUniformLocation
+		BIND,					// Textures, buffers and vertex arrays
+		BUFFER_UPLOAD,
+		DRAW,
+		STATE,
+		DELETE,
+		COUNT
+	};
+
+
+	class GLCallCounter
+	{
+	public:
+
+		struct FrameCounts
+		{
+			unsigned m_calls[(unsigned)GLCallType::COUNT] = {};
+
+			unsigned get_total() const;
+		};
+
+		// Add calls of the given type to the current frame
+		static void count(GLCallType type, unsigned calls = 1);
+
+		// Store the counts of the current frame and start a new one
+		static void end_frame();
+
+		// Counts of the last finished frame
+		static const FrameCounts& get_last_frame();
+
+		// Print the counts of the last frame
+		static void print_last_frame(std::ostream& os);
+
+		static const char* get_type_name(GLCallType type);
+
+	private:
+
+		static FrameCounts s_currentFrame;
+		static FrameCounts s_lastFrame;
+	};
+}
\ No newline at end of file
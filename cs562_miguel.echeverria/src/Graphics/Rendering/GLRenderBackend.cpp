@@ -0,0 +1,212 @@
+/**
+* @file GLRenderBackend.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Executes render command buffers with opengl. Must be used from the thread
+*		 that owns the opengl context.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "GLRenderBackend.h"
+#include "RenderCommandBuffer.h"
+#include "Shader.h"
+#include "GLCallCounter.h"
+#include <GL/glew.h>
+
+
+namespace cs460
+{
+	GLRenderBackend::~GLRenderBackend()
+	{
+	}
+
+
+	void GLRenderBackend::submit(const RenderCommandBuffer& commands)
+	{
+		for (unsigned i = 0; i < commands.size(); ++i)
+		{
+			const RenderCommand& command = commands[i];
+			const unsigned char* data = commands.get_data(command.m_dataOffset);
+
+			switch (command.m_type)
+			{
+			case RenderCommandType::USE_SHADER:
+				m_shader = command.m_shader;
+				m_shader->use();
+				break;
+
+			case RenderCommandType::SET_UNIFORM:
+				set_uniform(command, data);
+				break;
+
+			case RenderCommandType::BIND_TEXTURE:
+				glActiveTexture(GL_TEXTURE0 + command.m_mode);
+				glBindTexture(command.m_textureTarget == TextureTarget::CUBE_MAP ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D, command.m_handle);
+				GLCallCounter::count(GLCallType::BIND, 2);
+				break;
+
+			case RenderCommandType::UPDATE_BUFFER:
+				glBindBuffer(GL_ARRAY_BUFFER, command.m_handle);
+				glBufferSubData(GL_ARRAY_BUFFER, 0, command.m_count, data);
+				GLCallCounter::count(GLCallType::BIND);
+				GLCallCounter::count(GLCallType::BUFFER_UPLOAD);
+				break;
+
+			case RenderCommandType::DRAW:
+				glBindVertexArray(command.m_handle);
+				if (command.m_indexType >= 0)
+					glDrawElements(command.m_mode, (GLsizei)command.m_count, command.m_indexType, (void*)command.m_indexOffset);
+				else
+					glDrawArrays(command.m_mode, 0, (GLsizei)command.m_count);
+				glBindVertexArray(0);
+				GLCallCounter::count(GLCallType::BIND, 2);
+				GLCallCounter::count(GLCallType::DRAW);
+				break;
+
+			case RenderCommandType::DRAW_VERTICES:
+				draw_vertices(command, data);
+				break;
+
+			case RenderCommandType::SET_STATE:
+				switch (command.m_state)
+				{
+				case RenderState::DEPTH_TEST:
+					command.m_mode ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+					break;
+				case RenderState::CULL_FACE:
+					command.m_mode ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE);
+					break;
+				case RenderState::WIREFRAME:
+					glPolygonMode(GL_FRONT_AND_BACK, command.m_mode ? GL_LINE : GL_FILL);
+					break;
+				case RenderState::DEPTH_LESS_EQUAL:
+					glDepthFunc(command.m_mode ? GL_LEQUAL : GL_LESS);
+					break;
+				}
+				GLCallCounter::count(GLCallType::STATE);
+				break;
+
+			case RenderCommandType::DELETE_HANDLES:
+			{
+				const unsigned* handles = reinterpret_cast<const unsigned*>(data);
+				if (command.m_mode == (int)HandleType::VERTEX_ARRAY)
+					glDeleteVertexArrays(command.m_count, handles);
+				else if (command.m_mode == (int)HandleType::BUFFER)
+					glDeleteBuffers(command.m_count, handles);
+				else
+					glDeleteTextures(command.m_count, handles);
+				GLCallCounter::count(GLCallType::DELETE);
+				break;
+			}
+
+			default:
+				break;
+			}
+		}
+	}
+
+
+	// Free the buffers used for the vertices stored in the commands
+	void GLRenderBackend::close()
+	{
+		if (m_vertexArray == 0)
+			return;
+
+		glDeleteBuffers(1, &m_positionBuffer);
+		glDeleteBuffers(1, &m_normalBuffer);
+		glDeleteVertexArrays(1, &m_vertexArray);
+		m_vertexArray = m_positionBuffer = m_normalBuffer = 0;
+	}
+
+
+	void GLRenderBackend::set_uniform(const RenderCommand& command, const unsigned char* data)
+	{
+		if (m_shader == nullptr)
+			return;
+
+		// Only look up by name if the buffer didn't know the shader when it was recorded
+		UniformHandle handle{ command.m_location };
+		if (!command.m_locationResolved)
+			handle = m_shader->get_uniform_handle(command.m_name);
+
+		switch (command.m_uniformType)
+		{
+		case UniformType::INT:
+			m_shader->set_uniform(handle, *reinterpret_cast<const int*>(data));
+			break;
+		case UniformType::FLOAT:
+			m_shader->set_uniform(handle, *reinterpret_cast<const float*>(data));
+			break;
+		case UniformType::VEC2:
+			m_shader->set_uniform(handle, *reinterpret_cast<const glm::vec2*>(data));
+			break;
+		case UniformType::VEC3:
+			m_shader->set_uniform(handle, *reinterpret_cast<const glm::vec3*>(data));
+			break;
+		case UniformType::VEC4:
+			m_shader->set_uniform(handle, *reinterpret_cast<const glm::vec4*>(data));
+			break;
+		case UniformType::MAT3:
+			m_shader->set_uniform(handle, *reinterpret_cast<const glm::mat3*>(data));
+			break;
+		case UniformType::MAT4:
+			m_shader->set_uniform(handle, *reinterpret_cast<const glm::mat4*>(data));
+			break;
+		case UniformType::MAT3X4:
+			m_shader->set_uniform_array(handle, reinterpret_cast<const glm::mat3x4*>(data), command.m_count / sizeof(glm::mat3x4));
+			break;
+		case UniformType::MAT2X4:
+			m_shader->set_uniform_array(handle, reinterpret_cast<const glm::mat2x4*>(data), command.m_count / sizeof(glm::mat2x4));
+			break;
+		}
+	}
+
+	void GLRenderBackend::draw_vertices(const RenderCommand& command, const unsigned char* data)
+	{
+		// Create the vertex array the first time
+		if (m_vertexArray == 0)
+		{
+			glGenVertexArrays(1, &m_vertexArray);
+			glGenBuffers(1, &m_positionBuffer);
+			glGenBuffers(1, &m_normalBuffer);
+		}
+
+		unsigned byteCount = command.m_count * sizeof(glm::vec3);
+		glBindVertexArray(m_vertexArray);
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
+		glBufferData(GL_ARRAY_BUFFER, byteCount, data, GL_STREAM_DRAW);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, false, 3 * sizeof(float), (void*)0);
+
+		// The normals are right after the positions
+		if (command.m_hasNormals)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, m_normalBuffer);
+			glBufferData(GL_ARRAY_BUFFER, byteCount, data + byteCount, GL_STREAM_DRAW);
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 3, GL_FLOAT, false, 3 * sizeof(float), (void*)0);
+		}
+		else
+			glDisableVertexAttribArray(1);
+
+		// For different point sizes
+		if (command.m_mode == GL_POINTS)
+		{
+			glPointSize(command.m_pointSize);
+			GLCallCounter::count(GLCallType::STATE);
+		}
+
+		glDrawArrays(command.m_mode, 0, (GLsizei)command.m_count);
+		glBindVertexArray(0);
+
+		// Vertex array and buffer binds, uploads, and the attribute setup of each buffer
+		unsigned bufferCount = command.m_hasNormals ? 2 : 1;
+		GLCallCounter::count(GLCallType::BIND, 2 + bufferCount);
+		GLCallCounter::count(GLCallType::BUFFER_UPLOAD, bufferCount);
+		GLCallCounter::count(GLCallType::STATE, command.m_hasNormals ? 4 : 3);
+		GLCallCounter::count(GLCallType::DRAW);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+/**
+* @file GLRenderBackend.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Executes render command buffers with opengl. Must be used from the thread
+*		 that owns the opengl context.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "IRenderBackend.h"
+
+
+namespace cs460
+{
+	class Shader;
+	struct RenderCommand;
+
+
+	class GLRenderBackend : public IRenderBackend
+	{
+	public:
+
+		~GLRenderBackend();
+
+		void submit(const RenderCommandBuffer& commands) override;
+
+		// Free the buffers used for the vertices stored in the commands
+		void close();
+
+	private:
+
+		const Shader* m_shader = nullptr;			// Shader of the last USE_SHADER command
+
+		// Buffers reused by all the DRAW_VERTICES commands (created the first time they are needed)
+		unsigned m_vertexArray = 0;
+		unsigned m_positionBuffer = 0;
+		unsigned m_normalBuffer = 0;
+
+		void set_uniform(const RenderCommand& command, const unsigned char* data);
+		void draw_vertices(const RenderCommand& command, const unsigned char* data);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+/**
+* @file IRenderBackend.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Interface of the objects that execute render command buffers.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+
+namespace cs460
+{
+	class RenderCommandBuffer;
+
+
+	class IRenderBackend
+	{
+	public:
+
+		virtual ~IRenderBackend() {}
+
+		// Execute all the commands of the buffer in order. Called from the submission thread only.
+		virtual void submit(const RenderCommandBuffer& commands) = 0;
+	};
+}
\ No newline at end of file
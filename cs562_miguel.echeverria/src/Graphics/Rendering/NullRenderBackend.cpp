@@ -0,0 +1,128 @@
+/**
+* @file NullRenderBackend.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Backend that doesn't draw anything. It checks that the commands are valid
+*		 and counts them, so that the generation of commands can be tested and
+*		 benchmarked without a gpu.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "NullRenderBackend.h"
+
+
+namespace cs460
+{
+	void NullRenderBackend::submit(const RenderCommandBuffer& commands)
+	{
+		++m_stats.m_submissions;
+
+		for (unsigned i = 0; i < commands.size(); ++i)
+		{
+			const RenderCommand& command = commands[i];
+
+			if ((unsigned)command.m_type >= (unsigned)RenderCommandType::COUNT)
+			{
+				report_error(i, "unknown command type");
+				continue;
+			}
+
+			++m_stats.m_commands[(unsigned)command.m_type];
+
+			// Size of the data the command reads from the buffer
+			unsigned dataSize = 0;
+
+			switch (command.m_type)
+			{
+			case RenderCommandType::USE_SHADER:
+				if (command.m_shader == nullptr)
+					report_error(i, "null shader");
+				m_hasShader = command.m_shader != nullptr;
+				break;
+
+			case RenderCommandType::SET_UNIFORM:
+				if (!m_hasShader)
+					report_error(i, "uniform set without a shader");
+				if (command.m_name == nullptr)
+					report_error(i, "uniform without a name");
+				dataSize = command.m_count;
+				break;
+
+			case RenderCommandType::BIND_TEXTURE:
+				if (command.m_mode < 0)
+					report_error(i, "negative texture unit");
+				break;
+
+			case RenderCommandType::UPDATE_BUFFER:
+				if (command.m_handle == 0)
+					report_error(i, "update of buffer 0");
+				dataSize = command.m_count;
+				break;
+
+			case RenderCommandType::DRAW:
+				if (!m_hasShader)
+					report_error(i, "draw without a shader");
+				if (command.m_handle == 0)
+					report_error(i, "draw of vertex array 0");
+				m_stats.m_drawnVertices += command.m_count;
+				break;
+
+			case RenderCommandType::DRAW_VERTICES:
+				if (!m_hasShader)
+					report_error(i, "draw without a shader");
+				m_stats.m_drawnVertices += command.m_count;
+				dataSize = command.m_count * sizeof(glm::vec3) * (command.m_hasNormals ? 2 : 1);
+				break;
+
+			case RenderCommandType::DELETE_HANDLES:
+				if (command.m_mode < 0 || command.m_mode > (int)HandleType::TEXTURE)
+					report_error(i, "unknown type of handle");
+				dataSize = command.m_count * sizeof(unsigned);
+				break;
+
+			default:
+				break;
+			}
+
+			if ((size_t)command.m_dataOffset + dataSize > commands.get_data_size())
+				report_error(i, "data out of the bounds of the command buffer");
+			else if (command.m_type != RenderCommandType::DELETE_HANDLES)
+				m_stats.m_uploadedBytes += dataSize;
+		}
+	}
+
+
+	const NullRenderBackend::Stats& NullRenderBackend::get_stats() const
+	{
+		return m_stats;
+	}
+
+	void NullRenderBackend::reset_stats()
+	{
+		m_stats = Stats();
+		m_hasShader = false;
+	}
+
+
+	// Print the counts of the commands
+	void NullRenderBackend::print_stats(std::ostream& os) const
+	{
+		os << m_stats.m_submissions << " submissions:";
+		for (unsigned i = 0; i < (unsigned)RenderCommandType::COUNT; ++i)
+			os << " " << RenderCommandBuffer::get_type_name(RenderCommandType(i)) << " " << m_stats.m_commands[i];
+		os << ", " << m_stats.m_drawnVertices << " vertices/indices drawn, " << m_stats.m_uploadedBytes << " bytes uploaded, "
+			<< m_stats.m_errors << " errors\n";
+	}
+
+
+	void NullRenderBackend::report_error(unsigned commandIdx, const char* message)
+	{
+		// Only print the first ones, the rest are just counted
+		if (m_stats.m_errors < 8)
+			std::cout << "ERROR: Render command " << commandIdx << ": " << message << "\n";
+
+		++m_stats.m_errors;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+/**
+* @file NullRenderBackend.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Backend that doesn't draw anything. It checks that the commands are valid
+*		 and counts them, so that the generation of commands can be tested and
+*		 benchmarked without a gpu.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "IRenderBackend.h"
+#include "RenderCommandBuffer.h"
+
+
+namespace cs460
+{
+	class NullRenderBackend : public IRenderBackend
+	{
+	public:
+
+		struct Stats
+		{
+			unsigned m_commands[(unsigned)RenderCommandType::COUNT] = {};	// Number of commands of each type
+			unsigned m_submissions = 0;
+			unsigned m_drawnVertices = 0;		// Vertices or indices of all the draws
+			size_t m_uploadedBytes = 0;			// Uniforms, buffer updates and vertices stored in the commands
+			unsigned m_errors = 0;				// Commands that would fail (printed the first times)
+		};
+
+		void submit(const RenderCommandBuffer& commands) override;
+
+		const Stats& get_stats() const;
+		void reset_stats();
+
+		// Print the counts of the commands
+		void print_stats(std::ostream& os) const;
+
+	private:
+
+		Stats m_stats;
+		bool m_hasShader = false;
+
+		void report_error(unsigned commandIdx, const char* message);
+	};
+}
\ No newline at end of file
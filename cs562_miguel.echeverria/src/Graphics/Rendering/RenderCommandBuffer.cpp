@@ -0,0 +1,304 @@
+/**
+* @file RenderCommandBuffer.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief List of rendering commands (shader and uniform changes, texture binds, buffer
+*		 updates and draws) recorded without calling the graphics api, so that any thread
+*		 can record them and a backend can replay them later in the thread that owns the
+*		 context. The primitive modes and index types use the gltf values (same as opengl).
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "RenderCommandBuffer.h"
+#include "Shader.h"
+
+
+namespace cs460
+{
+	void RenderCommandBuffer::use_shader(const Shader* shader)
+	{
+		RenderCommand command;
+		command.m_type = RenderCommandType::USE_SHADER;
+		command.m_shader = shader;
+		m_commands.push_back(command);
+		m_currentShader = shader;
+	}
+
+	void RenderCommandBuffer::set_uniform(const char* name, int value)
+	{
+		push_uniform(name, UniformType::INT, &value, sizeof(value));
+	}
+
+	void RenderCommandBuffer::set_uniform(const char* name, bool value)
+	{
+		int intValue = value ? 1 : 0;
+		push_uniform(name, UniformType::INT, &intValue, sizeof(intValue));
+	}
+
+	void RenderCommandBuffer::set_uniform(const char* name, float value)
+	{
+		push_uniform(name, UniformType::FLOAT, &value, sizeof(value));
+	}
+
+	void RenderCommandBuffer::set_uniform(const char* name, const glm::vec2& value)
+	{
+		push_uniform(name, UniformType::VEC2, &value, sizeof(value));
+	}
+
+	void RenderCommandBuffer::set_uniform(const char* name, const glm::vec3& value)
+	{
+		push_uniform(name, UniformType::VEC3, &value, sizeof(value));
+	}
+
+	void RenderCommandBuffer::set_uniform(const char* name, const glm::vec4& value)
+	{
+		push_uniform(name, UniformType::VEC4, &value, sizeof(value));
+	}
+
+	void RenderCommandBuffer::set_uniform(const char* name, const glm::mat3& value)
+	{
+		push_uniform(name, UniformType::MAT3, &value, sizeof(value));
+	}
+
+	void RenderCommandBuffer::set_uniform(const char* name, const glm::mat4& value)
+	{
+		push_uniform(name, UniformType::MAT4, &value, sizeof(value));
+	}
+
+	void RenderCommandBuffer::set_uniform(const char* name, const glm::mat3x4& value)
+	{
+		push_uniform(name, UniformType::MAT3X4, &value, sizeof(value));
+	}
+
+	void RenderCommandBuffer::set_uniform(const char* name, const glm::mat2x4& value)
+	{
+		push_uniform(name, UniformType::MAT2X4, &value, sizeof(value));
+	}
+
+	// Upload consecutive elements of an array uniform with a single call (name is the array without index)
+	void RenderCommandBuffer::set_uniform_array(const char* name, const glm::mat3x4* values, unsigned count)
+	{
+		push_uniform(name, UniformType::MAT3X4, values, count * sizeof(glm::mat3x4));
+	}
+
+	void RenderCommandBuffer::set_uniform_array(const char* name, const glm::mat2x4* values, unsigned count)
+	{
+		push_uniform(name, UniformType::MAT2X4, values, count * sizeof(glm::mat2x4));
+	}
+
+
+	void RenderCommandBuffer::bind_texture(TextureTarget target, unsigned textureId, int textureUnit)
+	{
+		RenderCommand command;
+		command.m_type = RenderCommandType::BIND_TEXTURE;
+		command.m_textureTarget = target;
+		command.m_handle = textureId;
+		command.m_mode = textureUnit;
+		m_commands.push_back(command);
+	}
+
+
+	// Copy the given data to upload it to the start of the buffer when the commands are submitted
+	void RenderCommandBuffer::update_buffer(unsigned buffer, const void* data, unsigned byteCount)
+	{
+		RenderCommand command;
+		command.m_type = RenderCommandType::UPDATE_BUFFER;
+		command.m_handle = buffer;
+		command.m_count = byteCount;
+		command.m_dataOffset = push_data(data, byteCount);
+		m_commands.push_back(command);
+	}
+
+
+	// Draw a vertex array. indexType is -1 when the vertex array doesn't use indices.
+	void RenderCommandBuffer::draw(unsigned vertexArray, int mode, unsigned count, int indexType, size_t indexOffset)
+	{
+		RenderCommand command;
+		command.m_type = RenderCommandType::DRAW;
+		command.m_handle = vertexArray;
+		command.m_mode = mode;
+		command.m_count = count;
+		command.m_indexType = indexType;
+		command.m_indexOffset = indexOffset;
+		m_commands.push_back(command);
+	}
+
+	// Draw vertices that are copied into the command buffer (normals can be null)
+	void RenderCommandBuffer::draw_vertices(int mode, const glm::vec3* positions, const glm::vec3* normals, unsigned count, float pointSize)
+	{
+		RenderCommand command;
+		command.m_type = RenderCommandType::DRAW_VERTICES;
+		command.m_mode = mode;
+		command.m_count = count;
+		command.m_pointSize = pointSize;
+		command.m_hasNormals = normals != nullptr;
+
+		// The normals go right after the positions
+		command.m_dataOffset = push_data(positions, count * sizeof(glm::vec3));
+		if (normals != nullptr)
+			push_data(normals, count * sizeof(glm::vec3));
+
+		m_commands.push_back(command);
+	}
+
+
+	void RenderCommandBuffer::set_state(RenderState state, bool enabled)
+	{
+		RenderCommand command;
+		command.m_type = RenderCommandType::SET_STATE;
+		command.m_state = state;
+		command.m_mode = enabled ? 1 : 0;
+		m_commands.push_back(command);
+	}
+
+
+	// Free the given handles once the previous commands have been submitted
+	void RenderCommandBuffer::delete_handles(HandleType type, const unsigned* handles, unsigned count)
+	{
+		RenderCommand command;
+		command.m_type = RenderCommandType::DELETE_HANDLES;
+		command.m_mode = (int)type;
+		command.m_count = count;
+		command.m_dataOffset = push_data(handles, count * sizeof(unsigned));
+		m_commands.push_back(command);
+	}
+
+
+	// Add the commands of another buffer at the end of this one
+	void RenderCommandBuffer::append(const RenderCommandBuffer& other)
+	{
+		unsigned dataStart = (unsigned)m_data.size();
+		m_data.insert(m_data.end(), other.m_data.begin(), other.m_data.end());
+
+		for (RenderCommand command : other.m_commands)
+		{
+			command.m_dataOffset += dataStart;
+			m_commands.push_back(command);
+		}
+	}
+
+	// Remove all the commands, but keep the memory for the next frame
+	void RenderCommandBuffer::clear()
+	{
+		m_commands.clear();
+		m_data.clear();
+		m_currentShader = nullptr;
+	}
+
+
+	unsigned RenderCommandBuffer::size() const
+	{
+		return (unsigned)m_commands.size();
+	}
+
+	bool RenderCommandBuffer::empty() const
+	{
+		return m_commands.empty();
+	}
+
+	const RenderCommand& RenderCommandBuffer::operator[](unsigned idx) const
+	{
+		return m_commands[idx];
+	}
+
+
+	// Data stored by the commands (uniform values, buffer updates and vertices)
+	const unsigned char* RenderCommandBuffer::get_data(unsigned offset) const
+	{
+		return m_data.data() + offset;
+	}
+
+	unsigned RenderCommandBuffer::get_data_size() const
+	{
+		return (unsigned)m_data.size();
+	}
+
+
+	// Print the commands in a readable way
+	void RenderCommandBuffer::dump(std::ostream& os) const
+	{
+		os << m_commands.size() << " render commands, " << m_data.size() << " bytes of data\n";
+
+		for (unsigned i = 0; i < m_commands.size(); ++i)
+		{
+			const RenderCommand& command = m_commands[i];
+			os << "  [" << i << "] " << get_type_name(command.m_type);
+
+			switch (command.m_type)
+			{
+			case RenderCommandType::USE_SHADER:
+				os << " " << command.m_shader;
+				break;
+			case RenderCommandType::SET_UNIFORM:
+				os << " " << command.m_name << " (type " << (int)command.m_uniformType << ", location " << command.m_location << ", " << command.m_count << " bytes)";
+				break;
+			case RenderCommandType::BIND_TEXTURE:
+				os << " texture " << command.m_handle << " to unit " << command.m_mode;
+				break;
+			case RenderCommandType::UPDATE_BUFFER:
+				os << " buffer " << command.m_handle << ", " << command.m_count << " bytes";
+				break;
+			case RenderCommandType::DRAW:
+				os << " vertex array " << command.m_handle << ", mode " << command.m_mode << ", " << command.m_count
+					<< (command.m_indexType >= 0 ? " indices" : " vertices");
+				break;
+			case RenderCommandType::DRAW_VERTICES:
+				os << " mode " << command.m_mode << ", " << command.m_count << " vertices" << (command.m_hasNormals ? " with normals" : "");
+				break;
+			case RenderCommandType::SET_STATE:
+				os << " state " << (int)command.m_state << (command.m_mode ? " on" : " off");
+				break;
+			case RenderCommandType::DELETE_HANDLES:
+				os << " " << command.m_count << " handles of type " << command.m_mode;
+				break;
+			default:
+				break;
+			}
+
+			os << "\n";
+		}
+	}
+
+	const char* RenderCommandBuffer::get_type_name(RenderCommandType type)
+	{
+		static const char* names[] = { "USE_SHADER", "SET_UNIFORM", "BIND_TEXTURE", "UPDATE_BUFFER", "DRAW",
+									   "DRAW_VERTICES", "SET_STATE", "DELETE_HANDLES" };
+
+		if ((unsigned)type >= (unsigned)RenderCommandType::COUNT)
+			return "UNKNOWN";
+
+		return names[(unsigned)type];
+	}
+
+
+	// Copy the given bytes at the end of the data (aligned to 4 bytes), and return their offset
+	unsigned RenderCommandBuffer::push_data(const void* data, unsigned byteCount)
+	{
+		unsigned offset = (unsigned)m_data.size();
+		unsigned alignedCount = (byteCount + 3u) & ~3u;
+
+		m_data.resize(offset + alignedCount);
+		if (byteCount > 0)
+			std::memcpy(m_data.data() + offset, data, byteCount);
+
+		return offset;
+	}
+
+	void RenderCommandBuffer::push_uniform(const char* name, UniformType type, const void* value, unsigned byteCount)
+	{
+		RenderCommand command;
+		command.m_type = RenderCommandType::SET_UNIFORM;
+		command.m_name = name;
+		command.m_uniformType = type;
+		command.m_count = byteCount;
+		if (m_currentShader)
+		{
+			command.m_location = m_currentShader->get_uniform_handle(name).m_location;
+			command.m_locationResolved = true;
+		}
+		command.m_dataOffset = push_data(value, byteCount);
+		m_commands.push_back(command);
+	}
+}
\ No newline at end of file
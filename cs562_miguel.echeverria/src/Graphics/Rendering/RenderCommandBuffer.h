@@ -0,0 +1,159 @@
+/**
+* @file RenderCommandBuffer.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief List of rendering commands (shader and uniform changes, texture binds, buffer
+*		 updates and draws) recorded without calling the graphics api, so that any thread
+*		 can record them and a backend can replay them later in the thread that owns the
+*		 context. The primitive modes and index types use the gltf values (same as opengl).
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+
+namespace cs460
+{
+	class Shader;
+
+
+	enum class RenderCommandType
+	{
+		USE_SHADER,			// Shader used by the next uniforms and draws
+		SET_UNIFORM,		// Value of a uniform of the current shader
+		BIND_TEXTURE,		// Bind a texture to a texture unit
+		UPDATE_BUFFER,		// Replace the start of a vertex buffer with data stored in the command buffer
+		DRAW,				// Draw a vertex array, with or without indices
+		DRAW_VERTICES,		// Draw positions (and optionally normals) stored in the command buffer
+		SET_STATE,			// Enable or disable a render state
+		DELETE_HANDLES,		// Free vertex arrays, buffers or textures once the previous commands don't need them
+		COUNT
+	};
+
+	enum class UniformType
+	{
+		INT,
+		FLOAT,
+		VEC2,
+		VEC3,
+		VEC4,
+		MAT3,
+		MAT4,
+		MAT3X4,
+		MAT2X4
+	};
+
+	enum class TextureTarget
+	{
+		TEXTURE_2D,
+		CUBE_MAP
+	};
+
+	enum class HandleType
+	{
+		VERTEX_ARRAY,
+		BUFFER,
+		TEXTURE
+	};
+
+	enum class RenderState
+	{
+		DEPTH_TEST,
+		CULL_FACE,
+		WIREFRAME,
+		DEPTH_LESS_EQUAL	// Use less or equal as depth function instead of less
+	};
+
+
+	// A single command. Which members are used depends on the type.
+	struct RenderCommand
+	{
+		RenderCommandType m_type = RenderCommandType::USE_SHADER;
+		const Shader* m_shader = nullptr;			// USE_SHADER
+		const char* m_name = nullptr;				// SET_UNIFORM (has to be valid until the commands are submitted)
+		int m_location = -1;						// SET_UNIFORM location in the current shader (if resolved when recorded)
+		bool m_locationResolved = false;
+		UniformType m_uniformType = UniformType::INT;
+		TextureTarget m_textureTarget = TextureTarget::TEXTURE_2D;
+		RenderState m_state = RenderState::DEPTH_TEST;
+		unsigned m_handle = 0;						// Texture, buffer or vertex array
+		int m_mode = 0;								// Primitive mode for draws, texture unit for binds, enabled for states, HandleType for deletes
+		int m_indexType = -1;						// DRAW with indices (-1 if not indexed)
+		size_t m_indexOffset = 0;					// DRAW with indices (byte offset in the index buffer)
+		unsigned m_count = 0;						// Vertices/indices to draw, bytes of data (several elements for uniform arrays), or handles to delete
+		unsigned m_dataOffset = 0;					// Start of the data of the command in the command buffer
+		bool m_hasNormals = false;					// DRAW_VERTICES
+		float m_pointSize = 1.0f;					// DRAW_VERTICES
+	};
+
+
+	class RenderCommandBuffer
+	{
+	public:
+
+		// Shaders and uniforms. The uniform names aren't copied, so they must outlive the submission (like literals).
+		// The locations are looked up in the shader when recording, so no lookup by name happens when submitting.
+		void use_shader(const Shader* shader);
+		void set_uniform(const char* name, int value);
+		void set_uniform(const char* name, bool value);
+		void set_uniform(const char* name, float value);
+		void set_uniform(const char* name, const glm::vec2& value);
+		void set_uniform(const char* name, const glm::vec3& value);
+		void set_uniform(const char* name, const glm::vec4& value);
+		void set_uniform(const char* name, const glm::mat3& value);
+		void set_uniform(const char* name, const glm::mat4& value);
+		void set_uniform(const char* name, const glm::mat3x4& value);
+		void set_uniform(const char* name, const glm::mat2x4& value);
+
+		// Upload consecutive elements of an array uniform with a single call (name is the array without index)
+		void set_uniform_array(const char* name, const glm::mat3x4* values, unsigned count);
+		void set_uniform_array(const char* name, const glm::mat2x4* values, unsigned count);
+
+		void bind_texture(TextureTarget target, unsigned textureId, int textureUnit);
+
+		// Copy the given data to upload it to the start of the buffer when the commands are submitted
+		void update_buffer(unsigned buffer, const void* data, unsigned byteCount);
+
+		// Draw a vertex array. indexType is -1 when the vertex array doesn't use indices.
+		void draw(unsigned vertexArray, int mode, unsigned count, int indexType = -1, size_t indexOffset = 0);
+
+		// Draw vertices that are copied into the command buffer (normals can be null)
+		void draw_vertices(int mode, const glm::vec3* positions, const glm::vec3* normals, unsigned count, float pointSize = 1.0f);
+
+		void set_state(RenderState state, bool enabled);
+
+		// Free the given handles once the previous commands have been submitted
+		void delete_handles(HandleType type, const unsigned* handles, unsigned count);
+
+		// Add the commands of another buffer at the end of this one
+		void append(const RenderCommandBuffer& other);
+
+		// Remove all the commands, but keep the memory for the next frame
+		void clear();
+
+		unsigned size() const;
+		bool empty() const;
+		const RenderCommand& operator[](unsigned idx) const;
+
+		// Data stored by the commands (uniform values, buffer updates and vertices)
+		const unsigned char* get_data(unsigned offset) const;
+		unsigned get_data_size() const;
+
+		// Print the commands in a readable way
+		void dump(std::ostream& os) const;
+
+		static const char* get_type_name(RenderCommandType type);
+
+	private:
+
+		std::vector<RenderCommand> m_commands;
+		std::vector<unsigned char> m_data;
+		const Shader* m_currentShader = nullptr;		// Shader of the last USE_SHADER, used to find the uniform locations when recording
+
+		// Copy the given bytes at the end of the data (aligned to 4 bytes), and return their offset
+		unsigned push_data(const void* data, unsigned byteCount);
+
+		void push_uniform(const char* name, UniformType type, const void* value, unsigned byteCount);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+/**
+* @file RenderView.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Copy of everything the renderer needs from the scene in one frame. The
+*		 renderer keeps two of them, so that a frame can be drawn while the
+*		 simulation of the next one writes the scene.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "RenderView.h"
+
+
+namespace cs460
+{
+	// Remove the items, but keep the memory so that the next extraction doesn't allocate
+	void RenderView::clear()
+	{
+		m_meshes.clear();
+		m_jointMatrices.clear();
+		m_jointDualQuats.clear();
+		m_deformedPositions.clear();
+		m_deformedNormals.clear();
+		m_cloths.clear();
+		m_clothPositions.clear();
+		m_clothNormals.clear();
+		m_clothTangents.clear();
+
+		for (RenderCommandBuffer& commands : m_meshCommands)
+			commands.clear();
+		m_clothCommands.clear();
+	}
+}
\ No newline at end of file
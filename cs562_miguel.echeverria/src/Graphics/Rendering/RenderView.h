@@ -0,0 +1,80 @@
+/**
+* @file RenderView.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Copy of everything the renderer needs from the scene in one frame. The
+*		 renderer keeps two of them, so that a frame can be drawn while the
+*		 simulation of the next one writes the scene.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include "Composition/Scene.h"
+#include "Composition/ComponentRegistry.h"
+#include "RenderCommandBuffer.h"
+#include "Animation/Skinning/DualQuaternion.h"
+
+
+namespace cs460
+{
+	struct Model;
+
+
+	// A mesh to draw, with its transform and skin at the time it was extracted
+	struct RenderMeshItem
+	{
+		Model* m_model = nullptr;				// Resources are never freed while the scene runs, so it can be kept
+		int m_meshIdx = -1;
+		glm::mat4 m_modelToWorld{ 1.0f };
+		unsigned m_firstJointMatrix = 0;		// Range in the joint matrices or dual quaternions of the view (no joints if not skinned)
+		unsigned m_jointCount = 0;
+		bool m_skinned = false;
+		bool m_dualQuaternions = false;			// Whether the joints are in the dual quaternions instead of the matrices
+		bool m_cpuSkinned = false;				// Whether the vertices were skinned on the cpu (then it has no joints)
+		unsigned m_firstDeformedVertex = 0;		// Start of the vertices of its skinned primitives in the deformed vertices of the view
+	};
+
+	// The triangle strips of a cloth. The cloth owns the buffers they are uploaded
+	// to, so it is looked up by handle in case it was deleted after the extraction.
+	struct RenderClothItem
+	{
+		RegistryHandle m_cloth;
+		unsigned m_firstVertex = 0;				// Range in the cloth vertices of the view, one strip after another
+		unsigned m_stripCount = 0;
+		unsigned m_stripVertexCount = 0;
+	};
+
+
+	struct RenderView
+	{
+		std::vector<RenderMeshItem> m_meshes;
+		JointPalette m_jointMatrices;
+		DualQuatPalette m_jointDualQuats;
+		std::vector<glm::vec3> m_deformedPositions;		// Vertices of the cpu skinned meshes, one primitive after another
+		std::vector<glm::vec3> m_deformedNormals;
+
+		std::vector<RenderClothItem> m_cloths;
+		std::vector<glm::vec3> m_clothPositions;
+		std::vector<glm::vec3> m_clothNormals;
+		std::vector<glm::vec3> m_clothTangents;
+
+		// Camera and lighting
+		glm::mat4 m_worldToView{ 1.0f };
+		glm::mat4 m_perspectiveProj{ 1.0f };
+		glm::vec3 m_camPosition{ 0.0f, 0.0f, 0.0f };
+		LightProperties m_light;
+		bool m_useNormalMap = true;
+
+		unsigned m_frameIdx = 0;				// Number of the frame it was extracted in
+
+		// Commands that draw the view, recorded after the extraction. The meshes are recorded
+		// in chunks by different threads, and submitted in order followed by the cloths.
+		std::vector<RenderCommandBuffer> m_meshCommands;
+		RenderCommandBuffer m_clothCommands;
+
+		// Remove the items, but keep the memory so that the next extraction doesn't allocate
+		void clear();
+	};
+}
\ No newline at end of file
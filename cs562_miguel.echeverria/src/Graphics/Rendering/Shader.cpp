@@ -9,6 +9,7 @@
 
 #include "pch.h"
 #include "Shader.h"
+#include "GLCallCounter.h"
 #include <GL/glew.h>
 
 
@@ -193,6 +194,7 @@ namespace cs460
         else
         {
             m_linked = true;
+            cache_uniform_locations();
             return m_linked;
         }
     }
@@ -203,6 +205,7 @@ namespace cs460
             return;
 
         glUseProgram(m_handle);
+        GLCallCounter::count(GLCallType::USE_PROGRAM);
     }
 
     std::string Shader::log() const
@@ -232,88 +235,220 @@ namespace cs460
 
     void Shader::set_uniform(const std::string& name, float x, float y, float z) const
     {
-        int loc = get_uniform_location(name);
-
-        if (loc >= 0)
-            glUniform3f(loc, x, y, z);
-        else
-            debug << "Uniform: " << name << " not found." << std::endl;
+        set_uniform(name, glm::vec3(x, y, z));
     }
 
     void Shader::set_uniform(const std::string& name, const glm::vec2& v) const
     {
-        int loc = get_uniform_location(name);
+        UniformHandle handle = get_uniform_handle(name.c_str());
 
-        if (loc >= 0)
-            glUniform2f(loc, v.x, v.y);
+        if (handle.m_location >= 0)
+            set_uniform(handle, v);
         else
             debug << "Uniform: " << name << " not found." << std::endl;
     }
 
     void Shader::set_uniform(const std::string& name, const glm::vec3& v) const
     {
-        set_uniform(name, v.x, v.y, v.z);
+        UniformHandle handle = get_uniform_handle(name.c_str());
+
+        if (handle.m_location >= 0)
+            set_uniform(handle, v);
+        else
+            debug << "Uniform: " << name << " not found." << std::endl;
     }
 
     void Shader::set_uniform(const std::string& name, const glm::vec4& v) const
     {
-        int loc = get_uniform_location(name);
+        UniformHandle handle = get_uniform_handle(name.c_str());
 
-        if (loc >= 0)
-            glUniform4f(loc, v.x, v.y, v.z, v.w);
+        if (handle.m_location >= 0)
+            set_uniform(handle, v);
         else
             debug << "Uniform: " << name << " not found." << std::endl;
     }
 
     void Shader::set_uniform(const std::string& name, const glm::mat4& m) const
     {
-        int loc = get_uniform_location(name);
-        if (loc >= 0)
-            glUniformMatrix4fv(loc, 1, GL_FALSE, &m[0][0]);
+        UniformHandle handle = get_uniform_handle(name.c_str());
+
+        if (handle.m_location >= 0)
+            set_uniform(handle, m);
         else
             debug << "Uniform: " << name << " not found." << std::endl;
     }
 
     void Shader::set_uniform(const std::string& name, const glm::mat3& m) const
     {
-        int loc = get_uniform_location(name);
+        UniformHandle handle = get_uniform_handle(name.c_str());
 
-        if (loc >= 0)
-            glUniformMatrix3fv(loc, 1, GL_FALSE, &m[0][0]);
+        if (handle.m_location >= 0)
+            set_uniform(handle, m);
+        else
+            debug << "Uniform: " << name << " not found." << std::endl;
+    }
+
+    void Shader::set_uniform(const std::string& name, const glm::mat3x4& m) const
+    {
+        UniformHandle handle = get_uniform_handle(name.c_str());
+
+        if (handle.m_location >= 0)
+            set_uniform(handle, m);
+        else
+            debug << "Uniform: " << name << " not found." << std::endl;
+    }
+
+    void Shader::set_uniform(const std::string& name, const glm::mat2x4& m) const
+    {
+        UniformHandle handle = get_uniform_handle(name.c_str());
+
+        if (handle.m_location >= 0)
+            set_uniform(handle, m);
         else
             debug << "Uniform: " << name << " not found." << std::endl;
     }
 
     void Shader::set_uniform(const std::string& name, float val) const
     {
-        int loc = get_uniform_location(name);
+        UniformHandle handle = get_uniform_handle(name.c_str());
 
-        if (loc >= 0)
-            glUniform1f(loc, val);
+        if (handle.m_location >= 0)
+            set_uniform(handle, val);
         else
             debug << "Uniform: " << name << " not found." << std::endl;
     }
 
     void Shader::set_uniform(const std::string& name, int val) const
     {
-        int loc = get_uniform_location(name);
+        UniformHandle handle = get_uniform_handle(name.c_str());
 
-        if (loc >= 0)
-            glUniform1i(loc, val);
+        if (handle.m_location >= 0)
+            set_uniform(handle, val);
         else
             debug << "Uniform: " << name << " not found." << std::endl;
     }
 
     void Shader::set_uniform(const std::string& name, bool val) const
     {
-        int loc = get_uniform_location(name);
+        UniformHandle handle = get_uniform_handle(name.c_str());
 
-        if (loc >= 0)
-            glUniform1i(loc, val);
+        if (handle.m_location >= 0)
+            set_uniform(handle, val);
         else
             debug << "Uniform: " << name << " not found." << std::endl;
     }
 
+
+    // Setters from a handle obtained with get_uniform_handle (they don't look up anything, and do nothing with invalid handles)
+    void Shader::set_uniform(UniformHandle handle, const glm::vec2& v) const
+    {
+        if (handle.m_location < 0)
+            return;
+
+        glUniform2f(handle.m_location, v.x, v.y);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
+    void Shader::set_uniform(UniformHandle handle, const glm::vec3& v) const
+    {
+        if (handle.m_location < 0)
+            return;
+
+        glUniform3f(handle.m_location, v.x, v.y, v.z);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
+    void Shader::set_uniform(UniformHandle handle, const glm::vec4& v) const
+    {
+        if (handle.m_location < 0)
+            return;
+
+        glUniform4f(handle.m_location, v.x, v.y, v.z, v.w);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
+    void Shader::set_uniform(UniformHandle handle, const glm::mat4& m) const
+    {
+        if (handle.m_location < 0)
+            return;
+
+        glUniformMatrix4fv(handle.m_location, 1, GL_FALSE, &m[0][0]);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
+    void Shader::set_uniform(UniformHandle handle, const glm::mat3& m) const
+    {
+        if (handle.m_location < 0)
+            return;
+
+        glUniformMatrix3fv(handle.m_location, 1, GL_FALSE, &m[0][0]);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
+    void Shader::set_uniform(UniformHandle handle, const glm::mat3x4& m) const
+    {
+        if (handle.m_location < 0)
+            return;
+
+        glUniformMatrix3x4fv(handle.m_location, 1, GL_FALSE, &m[0][0]);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
+    void Shader::set_uniform(UniformHandle handle, const glm::mat2x4& m) const
+    {
+        if (handle.m_location < 0)
+            return;
+
+        glUniformMatrix2x4fv(handle.m_location, 1, GL_FALSE, &m[0][0]);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
+    void Shader::set_uniform(UniformHandle handle, float val) const
+    {
+        if (handle.m_location < 0)
+            return;
+
+        glUniform1f(handle.m_location, val);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
+    void Shader::set_uniform(UniformHandle handle, int val) const
+    {
+        if (handle.m_location < 0)
+            return;
+
+        glUniform1i(handle.m_location, val);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
+    void Shader::set_uniform(UniformHandle handle, bool val) const
+    {
+        if (handle.m_location < 0)
+            return;
+
+        glUniform1i(handle.m_location, val);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
+    // Upload consecutive elements of an array uniform with a single call (the handle is the one of the array or its first element)
+    void Shader::set_uniform_array(UniformHandle handle, const glm::mat3x4* values, unsigned count) const
+    {
+        if (handle.m_location < 0 || count == 0)
+            return;
+
+        glUniformMatrix3x4fv(handle.m_location, count, GL_FALSE, &values[0][0][0]);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
+    void Shader::set_uniform_array(UniformHandle handle, const glm::mat2x4* values, unsigned count) const
+    {
+        if (handle.m_location < 0 || count == 0)
+            return;
+
+        glUniformMatrix2x4fv(handle.m_location, count, GL_FALSE, &values[0][0][0]);
+        GLCallCounter::count(GLCallType::UNIFORM);
+    }
+
     void Shader::set_subroutine_uniform(const std::string& name, const std::string& funcName) const
     {
         GLuint funcLoc = glGetSubroutineIndex(m_handle, GL_FRAGMENT_SHADER, funcName.c_str());
@@ -409,7 +544,74 @@ namespace cs460
 
     int Shader::get_uniform_location(const std::string& name) const
     {
-        return glGetUniformLocation(m_handle, name.c_str());
+        return get_uniform_handle(name.c_str()).m_location;
+    }
+
+    // Location of the uniform with the given name, from the locations cached when linking. Arrays can also
+    // be found by their name without index. Doesn't call opengl, so it can be used from any thread.
+    UniformHandle Shader::get_uniform_handle(const char* name) const
+    {
+        auto found = m_uniformLocations.find(name);
+        if (found != m_uniformLocations.end())
+            return UniformHandle{ found->second };
+
+        return UniformHandle();
+    }
+
+    // Query the location of every active uniform (and every element of the arrays) once
+    void Shader::cache_uniform_locations()
+    {
+        m_uniformLocations.clear();
+        m_uniformNames.clear();
+
+        GLint uniformCount = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(m_handle, GL_ACTIVE_UNIFORMS, &uniformCount);
+        glGetProgramiv(m_handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        // First store all the names, since the map points into them
+        std::vector<char> nameBuffer(glm::max(maxLength, 1));
+        for (GLint i = 0; i < uniformCount; ++i)
+        {
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(m_handle, i, maxLength, nullptr, &size, &type, nameBuffer.data());
+            std::string name = nameBuffer.data();
+
+            // Arrays are reported as "name[0]"
+            size_t bracket = name.find("[0]");
+            if (size > 1 && bracket != std::string::npos && bracket + 3 == name.size())
+            {
+                std::string baseName = name.substr(0, bracket);
+                m_uniformNames.push_back(baseName);
+                for (GLint e = 0; e < size; ++e)
+                    m_uniformNames.push_back(baseName + "[" + std::to_string(e) + "]");
+            }
+            else
+                m_uniformNames.push_back(name);
+        }
+
+        for (const std::string& name : m_uniformNames)
+        {
+            int location = glGetUniformLocation(m_handle, name.c_str());
+            GLCallCounter::count(GLCallType::UNIFORM_LOCATION);
+            m_uniformLocations[name.c_str()] = location;
+        }
+    }
+
+
+    size_t Shader::CStringHash::operator()(const char* str) const
+    {
+        // FNV-1a
+        size_t hash = 14695981039346656037ull;
+        for (; *str; ++str)
+            hash = (hash ^ (unsigned char)*str) * 1099511628211ull;
+        return hash;
+    }
+
+    bool Shader::CStringEqual::operator()(const char* a, const char* b) const
+    {
+        return std::strcmp(a, b) == 0;
     }
 
     bool Shader::file_exists(const std::string& fileName)
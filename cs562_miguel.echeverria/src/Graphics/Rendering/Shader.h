@@ -12,6 +12,13 @@
 
 namespace cs460
 {
+    // Location of a uniform in a shader, looked up once by name (invalid if the shader doesn't use it)
+    struct UniformHandle
+    {
+        int m_location = -1;
+    };
+
+
     // This class was mainly adapted from cs350
 	class Shader
 	{
@@ -56,9 +63,32 @@ namespace cs460
         void set_uniform(const std::string& name, const glm::vec4& v) const;
         void set_uniform(const std::string& name, const glm::mat4& m) const;
         void set_uniform(const std::string& name, const glm::mat3& m) const;
+        void set_uniform(const std::string& name, const glm::mat3x4& m) const;
+        void set_uniform(const std::string& name, const glm::mat2x4& m) const;
         void set_uniform(const std::string& name, float val) const;
         void set_uniform(const std::string& name, int val) const;
         void set_uniform(const std::string& name, bool val) const;
+
+        // Location of the uniform with the given name, from the locations cached when linking. Arrays can also
+        // be found by their name without index. Doesn't call opengl, so it can be used from any thread.
+        UniformHandle get_uniform_handle(const char* name) const;
+
+        // Setters from a handle obtained with get_uniform_handle (they don't look up anything, and do nothing with invalid handles)
+        void set_uniform(UniformHandle handle, const glm::vec2& v) const;
+        void set_uniform(UniformHandle handle, const glm::vec3& v) const;
+        void set_uniform(UniformHandle handle, const glm::vec4& v) const;
+        void set_uniform(UniformHandle handle, const glm::mat4& m) const;
+        void set_uniform(UniformHandle handle, const glm::mat3& m) const;
+        void set_uniform(UniformHandle handle, const glm::mat3x4& m) const;
+        void set_uniform(UniformHandle handle, const glm::mat2x4& m) const;
+        void set_uniform(UniformHandle handle, float val) const;
+        void set_uniform(UniformHandle handle, int val) const;
+        void set_uniform(UniformHandle handle, bool val) const;
+
+        // Upload consecutive elements of an array uniform with a single call (the handle is the one of the array or its first element)
+        void set_uniform_array(UniformHandle handle, const glm::mat3x4* values, unsigned count) const;
+        void set_uniform_array(UniformHandle handle, const glm::mat2x4* values, unsigned count) const;
+
         void set_subroutine_uniform(const std::string& name, const std::string& funcName) const;
 
         // Print all the active uniforms and attributes
@@ -69,8 +99,24 @@ namespace cs460
         int  get_uniform_location(const std::string& name) const;   // Helper function to get the uniform location of the variable "name"
         bool file_exists(const std::string& fileName);              // Helper function to check whether the given path leads to an existing file
 
+        void cache_uniform_locations();                            // Query the location of every active uniform (and every element of the arrays) once
+
+        struct CStringHash
+        {
+            size_t operator()(const char* str) const;
+        };
+
+        struct CStringEqual
+        {
+            bool operator()(const char* a, const char* b) const;
+        };
+
         unsigned m_handle;
         bool m_linked;
         std::string m_log;
+
+        // Uniform locations by name. The keys point into the names, which don't change after linking.
+        std::vector<std::string> m_uniformNames;
+        std::unordered_map<const char*, int, CStringHash, CStringEqual> m_uniformLocations;
 	};
 }
\ No newline at end of file
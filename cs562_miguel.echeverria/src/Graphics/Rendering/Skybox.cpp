@@ -13,6 +13,7 @@
 #include "Graphics/Rendering/Shader.h"
 #include "Composition/Scene.h"
 #include "Cameras/ICamera.h"
+#include "RenderCommandBuffer.h"
 #include <GL/glew.h>
 
 
@@ -28,7 +29,7 @@ namespace cs460
 	}
 
 	// Render the skybox. Supposed to be the last thing rendered in the scene.
-	void Skybox::render()
+	void Skybox::record(RenderCommandBuffer& commands) const
 	{
 		if (!m_isActive)
 			return;
@@ -36,31 +37,22 @@ namespace cs460
 		ResourceManager& resourceManager = ResourceManager::get_instance();
 		Scene& scene = Scene::get_instance();
 		Cube& geometry = resourceManager.get_cube();
-		Shader* shader = resourceManager.get_shader("skybox");
 
-		glDepthFunc(GL_LEQUAL);
+		commands.set_state(RenderState::DEPTH_LESS_EQUAL, true);
 
 		// Bind the shader and set its uniforms
-		shader->use();
-		//shader->set_uniform("modelToWorld", glm::mat4(1.0f));
-		shader->set_uniform("worldToView", glm::mat4(glm::mat3(scene.get_active_camera()->get_view_mtx())));
-		shader->set_uniform("perspectiveProj", scene.get_active_camera()->get_projection_mtx());
-		shader->set_uniform("skyboxSampler", m_cubeMap.get_texture_unit());
-
-		// Bind the geometry data
-		geometry.bind();
+		commands.use_shader(resourceManager.get_shader("skybox"));
+		commands.set_uniform("worldToView", glm::mat4(glm::mat3(scene.get_active_camera()->get_view_mtx())));
+		commands.set_uniform("perspectiveProj", scene.get_active_camera()->get_projection_mtx());
+		commands.set_uniform("skyboxSampler", m_cubeMap.get_texture_unit());
 
 		// Bind the cubemap texture
-		m_cubeMap.bind();
+		commands.bind_texture(TextureTarget::CUBE_MAP, m_cubeMap.get_id(), m_cubeMap.get_texture_unit());
 
 		// Draw the cube
-		//glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, nullptr);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-
-		// Unbind the geometry
-		geometry.unbind();
+		commands.draw(geometry.get_vao(), GL_TRIANGLES, 36);
 
-		glDepthFunc(GL_LESS);
+		commands.set_state(RenderState::DEPTH_LESS_EQUAL, false);
 	}
 
 	// Start/stop using the skybox (rendering it)
@@ -15,6 +15,7 @@
 namespace cs460
 {
 	class Cube;
+	class RenderCommandBuffer;
 
 
 	class Skybox
@@ -24,8 +25,8 @@ namespace cs460
 		Skybox();
 		~Skybox();
 
-		// Render the skybox. Supposed to be the last thing rendered in the scene.
-		void render();
+		// Record the commands that render the skybox. Supposed to be the last thing rendered in the scene.
+		void record(RenderCommandBuffer& commands) const;
 
 		// Start/stop using the skybox (rendering it)
 		void set_active(bool newActive);
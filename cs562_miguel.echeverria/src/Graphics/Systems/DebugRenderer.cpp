@@ -21,6 +21,7 @@
 #include "Cameras/ICamera.h"
 #include "Components/Animation/IKChainRoot.h"
 #include "Animation/InverseKinematics/IKChain.h"
+#include "Graphics/Rendering/RenderCommandBuffer.h"
 #include <GL/glew.h>
 
 
@@ -74,104 +75,54 @@ namespace cs460
 	int DebugRenderer::s_clothDrawingMode = 1;
 
 
-	// TODO: Make this more efficient by saving the meshes
+	// Commands recorded by all the draw functions, submitted and cleared by the renderer after the overlays
+	RenderCommandBuffer& DebugRenderer::get_command_buffer()
+	{
+		static RenderCommandBuffer commands;
+		return commands;
+	}
 
-	void DebugRenderer::draw_point(const glm::vec3& position, const glm::vec4& color, float pointSize)
+
+	// Record the "simple" shader with its uniforms, using the active camera
+	static void record_simple_shader(RenderCommandBuffer& commands, const glm::vec4& color, const glm::mat4& m2w)
 	{
-		// Shader and uniform setup
 		ResourceManager& resourceMgr = ResourceManager::get_instance();
-		Shader* shader = resourceMgr.get_shader("simple");
-		shader->use();
-		shader->set_uniform("color", color);
-		shader->set_uniform("modelToWorld", glm::mat4(1.0f));	// Identity matrix since point is already in world space
+		commands.use_shader(resourceMgr.get_shader("simple"));
+		commands.set_uniform("color", color);
+		commands.set_uniform("modelToWorld", m2w);
 
 		Scene& scene = Scene::get_instance();
 		ICamera* cam = scene.get_active_camera();
-		shader->set_uniform("worldToView", cam->get_view_mtx());
-		shader->set_uniform("perspectiveProj", cam->get_projection_mtx());
-
-		// Buffer setup
-		glBindVertexArray(0);
-
-		unsigned vao;
-		glGenVertexArrays(1, &vao);
-		glBindVertexArray(vao);
-
-		unsigned vbo;
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		commands.set_uniform("worldToView", cam->get_view_mtx());
+		commands.set_uniform("perspectiveProj", cam->get_projection_mtx());
+	}
 
-		glBufferData(GL_ARRAY_BUFFER, sizeof(position), glm::value_ptr(position), GL_STATIC_DRAW);
 
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, false, 3 * sizeof(float), (void*)0);
+	void DebugRenderer::draw_point(const glm::vec3& position, const glm::vec4& color, float pointSize)
+	{
+		RenderCommandBuffer& commands = get_command_buffer();
 
-		// For different point sizes
-		glPointSize(pointSize);
+		// Identity matrix since point is already in world space
+		record_simple_shader(commands, color, glm::mat4(1.0f));
 
 		// Draw the actual point
-		glDrawArrays(GL_POINTS, 0, 1);
-
-		// Buffer cleanup
-		glBindVertexArray(0);
-		glDeleteBuffers(1, &vbo);
-		glDeleteVertexArrays(1, &vao);
+		commands.draw_vertices(GL_POINTS, &position, nullptr, 1, pointSize);
 	}
 
 	void DebugRenderer::draw_segment(const Segment& segment, const glm::vec4& color)
 	{
-		// Shader and uniform setup
-		ResourceManager& resourceMgr = ResourceManager::get_instance();
-		Shader* shader = resourceMgr.get_shader("simple");
-		shader->use();
-		shader->set_uniform("color", color);
-		shader->set_uniform("modelToWorld", glm::mat4(1.0f));	// Identity matrix since segment is already in world space
-
-		Scene& scene = Scene::get_instance();
-		ICamera* cam = scene.get_active_camera();
-		shader->set_uniform("worldToView", cam->get_view_mtx());
-		shader->set_uniform("perspectiveProj", cam->get_projection_mtx());
-
-		// Buffer setup
-		glBindVertexArray(0);
+		RenderCommandBuffer& commands = get_command_buffer();
 
-		unsigned vao;
-		glGenVertexArrays(1, &vao);
-		glBindVertexArray(vao);
-
-		unsigned vbo;
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-		float data[6] = { segment.m_start.x, segment.m_start.y, segment.m_start.z,
-						  segment.m_end.x,   segment.m_end.y,   segment.m_end.z };
-		glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
-
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, false, 3 * sizeof(float), (void*)0);
+		// Identity matrix since segment is already in world space
+		record_simple_shader(commands, color, glm::mat4(1.0f));
 
 		// Draw the segment
-		glDrawArrays(GL_LINES, 0, 2);
-
-		// Buffer cleanup
-		glBindVertexArray(0);
-		glDeleteBuffers(1, &vbo);
-		glDeleteVertexArrays(1, &vao);
+		glm::vec3 positions[2] = { segment.m_start, segment.m_end };
+		commands.draw_vertices(GL_LINES, positions, nullptr, 2);
 	}
 
 	void DebugRenderer::draw_aabb(const AABB& aabb, const glm::vec4& color, bool wireframe)
 	{
-		// Shader and uniform setup
-		ResourceManager& resourceMgr = ResourceManager::get_instance();
-		Shader* shader = resourceMgr.get_shader("simple");
-		shader->use();
-		shader->set_uniform("color", color);
-
-		Scene& scene = Scene::get_instance();
-		ICamera* cam = scene.get_active_camera();
-		shader->set_uniform("worldToView", cam->get_view_mtx());
-		shader->set_uniform("perspectiveProj", cam->get_projection_mtx());
-		
 		// Compute model to world from the given aabb data
 		glm::vec3 diagonal = aabb.m_max - aabb.m_min;
 		glm::vec3 pos = aabb.m_min + diagonal * 0.5f;
@@ -179,170 +130,72 @@ namespace cs460
 		glm::mat4 m2w = glm::translate(glm::mat4(1.0f), pos);
 		m2w = glm::scale(m2w, diagonal);
 
-		shader->set_uniform("modelToWorld", m2w);
-
-		// Get the already created cube (range [-0.5f, 0.5f])
-		Cube& cube = resourceMgr.get_cube();
-		cube.bind();
-
-		if (wireframe)
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-		// Draw the cube
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-		cube.unbind();
+		draw_aabb(m2w, color, wireframe);
 	}
 
 
 	void DebugRenderer::draw_aabb(const glm::mat4& m2w, const glm::vec4& color, bool wireframe)
 	{
-		// Shader and uniform setup
-		ResourceManager& resourceMgr = ResourceManager::get_instance();
-		Shader* shader = resourceMgr.get_shader("simple");
-		shader->use();
-		shader->set_uniform("color", color);
-
-		Scene& scene = Scene::get_instance();
-		ICamera* cam = scene.get_active_camera();
-		shader->set_uniform("worldToView", cam->get_view_mtx());
-		shader->set_uniform("perspectiveProj", cam->get_projection_mtx());
-		shader->set_uniform("modelToWorld", m2w);
-
-		// Get the already created cube (range [-0.5, 0.5])
-		Cube& cube = resourceMgr.get_cube();
-		cube.bind();
+		RenderCommandBuffer& commands = get_command_buffer();
+		record_simple_shader(commands, color, m2w);
 
 		if (wireframe)
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+			commands.set_state(RenderState::WIREFRAME, true);
 
-		// Draw the cube
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+		// Draw the already created cube (range [-0.5, 0.5])
+		Cube& cube = ResourceManager::get_instance().get_cube();
+		commands.draw(cube.get_vao(), GL_TRIANGLES, 36);
 
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-		cube.unbind();
+		if (wireframe)
+			commands.set_state(RenderState::WIREFRAME, false);
 	}
 
 
 	void DebugRenderer::draw_triangle(const Triangle& triangle, const glm::vec4& color, bool wireframe)
 	{
-		// Shader and uniform setup
-		ResourceManager& resourceMgr = ResourceManager::get_instance();
-		Shader* shader = resourceMgr.get_shader("simple");
-		shader->use();
-		shader->set_uniform("color", color);
-
-		Scene& scene = Scene::get_instance();
-		ICamera* cam = scene.get_active_camera();
-		shader->set_uniform("worldToView", cam->get_view_mtx());
-		shader->set_uniform("perspectiveProj", cam->get_projection_mtx());
-		shader->set_uniform("modelToWorld", glm::mat4(1.0f));
-
-		// Buffer setup
-		glBindVertexArray(0);
-
-		unsigned vao;
-		glGenVertexArrays(1, &vao);
-		glBindVertexArray(vao);
-
-		unsigned vbo;
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-		float data[9] = { triangle.m_v1.x, triangle.m_v1.y, triangle.m_v1.z,
-						  triangle.m_v2.x, triangle.m_v2.y, triangle.m_v2.z,
-						  triangle.m_v3.x, triangle.m_v3.y, triangle.m_v3.z, };
-
-		glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
-
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, false, 3 * sizeof(float), (void*)0);
+		RenderCommandBuffer& commands = get_command_buffer();
+		record_simple_shader(commands, color, glm::mat4(1.0f));
 
 		if (wireframe)
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-		// Draw the segment
-		glDrawArrays(GL_TRIANGLES, 0, 3);
+			commands.set_state(RenderState::WIREFRAME, true);
 
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		// Draw the triangle
+		glm::vec3 positions[3] = { triangle.m_v1, triangle.m_v2, triangle.m_v3 };
+		commands.draw_vertices(GL_TRIANGLES, positions, nullptr, 3);
 
-		// Buffer cleanup
-		glBindVertexArray(0);
-		glDeleteBuffers(1, &vbo);
-		glDeleteVertexArrays(1, &vao);
+		if (wireframe)
+			commands.set_state(RenderState::WIREFRAME, false);
 	}
 
 	void DebugRenderer::draw_triangle_shaded(const Triangle& triangle, const glm::vec4& color)
 	{
+		RenderCommandBuffer& commands = get_command_buffer();
+
 		// Shader and uniform setup
 		ResourceManager& resourceMgr = ResourceManager::get_instance();
-		Shader* shader = resourceMgr.get_shader("phong_color");
-		shader->use();
-		shader->set_uniform("mat.m_diffuse", glm::vec3(color));
-		shader->set_uniform("mat.m_shininess", 128.0f);
-		shader->set_uniform("useSkinning", false);
+		commands.use_shader(resourceMgr.get_shader("phong_color"));
+		commands.set_uniform("mat.m_diffuse", glm::vec3(color));
+		commands.set_uniform("mat.m_shininess", 128.0f);
+		commands.set_uniform("useSkinning", false);
 
 		Scene& scene = Scene::get_instance();
 		ICamera* cam = scene.get_active_camera();
-		shader->set_uniform("worldToView", cam->get_view_mtx());
-		shader->set_uniform("perspectiveProj", cam->get_projection_mtx());
-		shader->set_uniform("modelToWorld", glm::mat4(1.0f));
-		shader->set_uniform("normalViewMtx", glm::transpose(glm::inverse(glm::mat3(cam->get_view_mtx() * glm::mat4(1.0f)))));
+		commands.set_uniform("worldToView", cam->get_view_mtx());
+		commands.set_uniform("perspectiveProj", cam->get_projection_mtx());
+		commands.set_uniform("modelToWorld", glm::mat4(1.0f));
+		commands.set_uniform("normalViewMtx", glm::transpose(glm::inverse(glm::mat3(cam->get_view_mtx() * glm::mat4(1.0f)))));
 
 		// Set the light properties
-		shader->set_uniform("light.m_direction", scene.m_lightProperties.m_direction);
-		shader->set_uniform("light.m_ambient", scene.m_lightProperties.m_ambient);
-		shader->set_uniform("light.m_diffuse", scene.m_lightProperties.m_diffuse);
-		shader->set_uniform("light.m_specular", scene.m_lightProperties.m_specular);
-
-
-		// Buffer setup
-		glBindVertexArray(0);
-
-		unsigned vao;
-		glGenVertexArrays(1, &vao);
-		glBindVertexArray(vao);
-
-		// Setup the vbo for positions
-		unsigned vbo;
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-		float data[9] = { triangle.m_v1.x, triangle.m_v1.y, triangle.m_v1.z,
-						  triangle.m_v2.x, triangle.m_v2.y, triangle.m_v2.z,
-						  triangle.m_v3.x, triangle.m_v3.y, triangle.m_v3.z, };
-
-		glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
-
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, false, 3 * sizeof(float), (void*)0);
-
-		// Setup the vbo for normals
-		unsigned vbo2;
-		glGenBuffers(1, &vbo2);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo2);
+		commands.set_uniform("light.m_direction", scene.m_lightProperties.m_direction);
+		commands.set_uniform("light.m_ambient", scene.m_lightProperties.m_ambient);
+		commands.set_uniform("light.m_diffuse", scene.m_lightProperties.m_diffuse);
+		commands.set_uniform("light.m_specular", scene.m_lightProperties.m_specular);
 
+		// Draw the triangle with a flat normal
+		glm::vec3 positions[3] = { triangle.m_v1, triangle.m_v2, triangle.m_v3 };
 		glm::vec3 normal = glm::normalize(glm::cross(triangle.m_v2 - triangle.m_v1, triangle.m_v3 - triangle.m_v1));
-		float normalData[9] = { normal.x, normal.y, normal.z,
-								normal.x, normal.y, normal.z,
-								normal.x, normal.y, normal.z, };
-
-		glBufferData(GL_ARRAY_BUFFER, sizeof(normalData), normalData, GL_STATIC_DRAW);
-
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 3, GL_FLOAT, false, 3 * sizeof(float), (void*)0);
-
-		// Draw the segment
-		glDrawArrays(GL_TRIANGLES, 0, 3);
-
-		// Buffer cleanup
-		glBindVertexArray(0);
-		glDeleteBuffers(1, &vbo);
-		glDeleteBuffers(1, &vbo2);
-		glDeleteVertexArrays(1, &vao);
+		glm::vec3 normals[3] = { normal, normal, normal };
+		commands.draw_vertices(GL_TRIANGLES, positions, normals, 3);
 	}
 
 
@@ -416,11 +269,14 @@ namespace cs460
 	}
 
 
-	void DebugRenderer::draw_skeleton_hierarchy(const glm::vec4& boneColor, const glm::vec4& jointColor, float jointSize, Model* sourceModel, const Skin& skin, std::unordered_map<int, SceneNode*>& modelInstNodes, int rootIdx)
+	void DebugRenderer::draw_skeleton_hierarchy(const glm::vec4& boneColor, const glm::vec4& jointColor, float jointSize, Model* sourceModel, const Skin& skin, const std::vector<SceneNode*>& modelInstNodes, int rootIdx)
 	{
-		// Draw the joint of the root
+		// Draw the joint of the root (the nodes outside of the scene of the instance are null)
 		SceneNode* rootNode = modelInstNodes[rootIdx];
-		draw_joint(rootNode->m_worldTr.m_position, jointColor, jointSize);
+		if (rootNode == nullptr)
+			return;
+
+		draw_joint(rootNode->get_world_tr().m_position, jointColor, jointSize);
 
 		// Draw the hierarchy of each of the children
 		GLTFNode& gltfNode = sourceModel->m_nodes[rootIdx];
@@ -428,10 +284,12 @@ namespace cs460
 		{
 			int childIdx = gltfNode.m_childrenIndices[i];
 			SceneNode* childNode = modelInstNodes[childIdx];
+			if (childNode == nullptr)
+				continue;
 
 			Segment seg;
-			seg.m_start = rootNode->m_worldTr.m_position;
-			seg.m_end = childNode->m_worldTr.m_position;
+			seg.m_start = rootNode->get_world_tr().m_position;
+			seg.m_end = childNode->get_world_tr().m_position;
 
 			draw_segment(seg, boneColor);
 			draw_skeleton_hierarchy(boneColor, jointColor, jointSize, sourceModel, skin, modelInstNodes, gltfNode.m_childrenIndices[i]);
@@ -527,8 +385,8 @@ namespace cs460
 		while (traverser != chainRoot && traverser->get_parent() != nullptr)
 		{
 			// Get the "forward" vector (from the parent world pos to the child current joint world pos)
-			const glm::vec3& pos = traverser->m_worldTr.m_position;
-			const glm::vec3& parentPos = traverser->get_parent()->m_worldTr.m_position;
+			const glm::vec3& pos = traverser->get_world_tr().m_position;
+			const glm::vec3& parentPos = traverser->get_parent()->get_world_tr().m_position;
 			const glm::vec3& forward = pos - parentPos;
 
 			float boneLength = glm::length(forward);
@@ -579,10 +437,8 @@ namespace cs460
 			botTri.m_v3 = topTri.m_v3;
 			draw_triangle_shaded(botTri, boneColor);
 
-			// Disable depth test if necessary
-			bool isDepthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
-			if (isDepthTestEnabled)
-				glDisable(GL_DEPTH_TEST);
+			// Disable depth test (the ik chains are drawn with depth test enabled)
+			get_command_buffer().set_state(RenderState::DEPTH_TEST, false);
 
 			// Draw the top triangle with wireframe
 			draw_triangle(topTri, boneHighlightColor, true);
@@ -590,9 +446,8 @@ namespace cs460
 			// Draw the bottom triangle with wireframe
 			draw_triangle(botTri, boneHighlightColor, true);
 
-			// If the depth test was enabled before, enable it again
-			if (isDepthTestEnabled)
-				glEnable(GL_DEPTH_TEST);
+			// Enable it again
+			get_command_buffer().set_state(RenderState::DEPTH_TEST, true);
 		}
 	}
 }
\ No newline at end of file
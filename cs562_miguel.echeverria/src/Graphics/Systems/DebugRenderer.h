@@ -20,12 +20,16 @@ namespace cs460
 	class SceneNode;
 	struct Model;
 	struct IKChain;
+	class RenderCommandBuffer;
 
 
 	class DebugRenderer
 	{
 	public:
 
+		// The draw functions only record commands here, submitted by the renderer after the overlays
+		static RenderCommandBuffer& get_command_buffer();
+
 		static void draw_point(const glm::vec3& position, const glm::vec4& color, float pointSize);
 		static void draw_segment(const Segment& segment, const glm::vec4& color);
 		static void draw_aabb(const AABB& aabb, const glm::vec4& color, bool wireframe = false);
@@ -37,7 +41,7 @@ namespace cs460
 
 		static void draw_all_skeletons(const glm::vec4& boneColor, const glm::vec4& jointColor, float jointSize);
 		static void draw_joint(const glm::vec3& worldPos, const glm::vec4& color, float jointSize);
-		static void draw_skeleton_hierarchy(const glm::vec4& boneColor, const glm::vec4& jointColor, float joinSize, Model* sourceModel, const Skin& skin, std::unordered_map<int, SceneNode*>& modelInstNodes, int rootIdx);
+		static void draw_skeleton_hierarchy(const glm::vec4& boneColor, const glm::vec4& jointColor, float joinSize, Model* sourceModel, const Skin& skin, const std::vector<SceneNode*>& modelInstNodes, int rootIdx);
 
 		static void draw_grid(float worldXSize, float worldZSize, unsigned xSubdivisions, unsigned zSubdivisions);
 
@@ -21,6 +21,12 @@
 #include "Math/Geometry/Geometry.h"
 #include "Math/Geometry/IntersectionTests.h"
 #include "Animation/ParticleSimulations/ClothMgr.h"
+#include "Composition/Scene.h"
+#include "Cameras/ICamera.h"
+#include "Platform/InputMgr.h"
+#include "Platform/JobSystem.h"
+#include "Graphics/Rendering/NullRenderBackend.h"
+#include <chrono>
 #include <GL/glew.h>
 
 
@@ -64,45 +70,183 @@ namespace cs460
 		return true;
 	}
 
-	void Renderer::render()
+	// Copy what the render stage needs from the scene (meshes, joint matrices, cloths, camera and lights).
+	// Only reads the scene, so it can run in a worker once the simulation of the frame is done.
+	void Renderer::extract_render_view()
 	{
-		// Draw each renderable
-		for (int i = 0; i < m_renderables.size(); ++i)
+		RenderView& view = m_views[m_extractIdx];
+		view.clear();
+		view.m_frameIdx = m_frameIdx;
+
+		Scene& scene = Scene::get_instance();
+		ICamera* camera = scene.get_active_camera();
+		view.m_worldToView = camera->get_view_mtx();
+		view.m_perspectiveProj = camera->get_projection_mtx();
+		view.m_camPosition = camera->get_position();
+		view.m_light = scene.m_lightProperties;
+		view.m_useNormalMap = !InputMgr::get_instance().is_key_down(KEYS::key_n);
+
+		for (MeshRenderable* renderable : m_renderables)
 		{
-			// Skip drawing the mesh if it is not active
-			if (!m_renderables[i]->get_active())
+			// Skip the mesh if it is not active
+			if (!renderable->get_active())
 				continue;
 
-			// Skip drawing the mesh if its entire model is not active
-			ModelInstance* modelInst = m_renderables[i]->get_owner()->get_model_root_node()->get_component<ModelInstance>();
+			// Skip the mesh if its entire model is not active
+			ModelInstance* modelInst = renderable->get_owner()->get_model_root_node()->get_component<ModelInstance>();
 			if (modelInst == nullptr || !modelInst->get_active())	// TODO: modelInst == nullptr is a very temporary fix so that it doesn't crash when deleting a ModelInstance component
 				continue;
 
-			// Render all the primitives in the current mesh
-			m_renderables[i]->render_primitives();
+			renderable->extract_render_data(view);
 		}
 
+		if (DebugRenderer::s_clothDrawingMode == 1)
+			ClothMgr::get_instance().extract_render_data(view);
+
+		record_render_view(view);
+	}
+
+	// Record the commands that draw the meshes and cloths of the given view (the meshes in parallel)
+	void Renderer::record_render_view(RenderView& view) const
+	{
+		// Each job records a chunk of the meshes into its own buffer, so that they are submitted in order
+		unsigned meshCount = (unsigned)view.m_meshes.size();
+		unsigned bufferCount = (meshCount + s_meshesPerCommandBuffer - 1) / s_meshesPerCommandBuffer;
+		view.m_meshCommands.resize(bufferCount);
+
+		auto recordRange = [&view, meshCount](unsigned begin, unsigned end)
+		{
+			for (unsigned b = begin; b < end; ++b)
+			{
+				RenderCommandBuffer& commands = view.m_meshCommands[b];
+				commands.clear();
+
+				unsigned last = std::min((b + 1) * s_meshesPerCommandBuffer, meshCount);
+				for (unsigned i = b * s_meshesPerCommandBuffer; i < last; ++i)
+					MeshRenderable::record_primitives(view, view.m_meshes[i], commands);
+			}
+		};
+		JobSystem::get_instance().parallel_for(bufferCount, 1, recordRange);
+
+		view.m_clothCommands.clear();
+		ClothMgr::get_instance().record_draw(view);
+	}
+
+	// Submit the commands of a render view. With no latency it is the one extracted in this frame,
+	// otherwise it is the one of the previous frame, so it can be drawn while the simulation runs.
+	void Renderer::render()
+	{
+		const RenderView& view = m_views[m_frameLatency == 0 ? m_extractIdx : m_extractIdx ^ 1];
+
+		for (const RenderCommandBuffer& commands : view.m_meshCommands)
+			m_backend->submit(commands);
+		m_backend->submit(view.m_clothCommands);
+
+		// Nothing recorded before this point uses the released resources anymore
+		m_backend->submit(m_releaseCommands);
+		m_releaseCommands.clear();
+	}
+
+	// Draw the skybox and the debug drawing of all the systems, from the current state of the scene
+	void Renderer::render_overlays()
+	{
+		RenderCommandBuffer& commands = DebugRenderer::get_command_buffer();
+
 		// Draw the skybox last if active
-		m_skybox->render();
+		m_skybox->record(commands);
 
 		// Debug draw all systems that require debug drawing
-		glDisable(GL_DEPTH_TEST);
+		commands.set_state(RenderState::DEPTH_TEST, false);
 		DebugRenderer::draw_all_skeletons(DebugRenderer::s_boneColor, DebugRenderer::s_jointColor, DebugRenderer::s_jointSize);
 		PiecewiseCurveMgr::get_instance().debug_draw();
-		glEnable(GL_DEPTH_TEST);
+		commands.set_state(RenderState::DEPTH_TEST, true);
 		DebugRenderer::draw_all_ik_chains();
-		glDisable(GL_CULL_FACE);
+		commands.set_state(RenderState::CULL_FACE, false);
 		debug_draw_bvs();
 		DebugRenderer::draw_grid(DebugRenderer::s_xGridSize, DebugRenderer::s_zGridSize, DebugRenderer::s_xSubdivisions, DebugRenderer::s_zSubdivisions);
 		if (DebugRenderer::s_clothDrawingMode == 0)
 			ClothMgr::get_instance().debug_draw();
-		else if (DebugRenderer::s_clothDrawingMode == 1)
-			ClothMgr::get_instance().draw_textured();
-		glEnable(GL_CULL_FACE);
+		commands.set_state(RenderState::CULL_FACE, true);
+
+		m_backend->submit(commands);
+		commands.clear();
+	}
+
+	// Commands that free graphics resources that recorded commands may still use. They
+	// are submitted after the render view of each frame. Only used from the main thread.
+	RenderCommandBuffer& Renderer::get_release_commands()
+	{
+		return m_releaseCommands;
+	}
+
+	// Backend the render commands are submitted to (opengl by default)
+	void Renderer::set_backend(IRenderBackend* backend)
+	{
+		m_backend = backend != nullptr ? backend : &m_glBackend;
+	}
+
+	IRenderBackend* Renderer::get_backend() const
+	{
+		return m_backend;
+	}
+
+	// Record the commands of the last extracted view many times, and submit them to a null backend,
+	// printing the time of both and the number of commands (doesn't draw anything)
+	void Renderer::benchmark_command_recording(unsigned iterations)
+	{
+		using Clock = std::chrono::high_resolution_clock;
+		iterations = glm::max(iterations, 1u);
+
+		// Work on a copy, so that the views used by the frames aren't modified
+		RenderView view = m_views[m_extractIdx ^ 1];
+		NullRenderBackend backend;
+
+		Clock::time_point start = Clock::now();
+		for (unsigned i = 0; i < iterations; ++i)
+			record_render_view(view);
+		Clock::time_point recorded = Clock::now();
+
+		for (unsigned i = 0; i < iterations; ++i)
+		{
+			for (const RenderCommandBuffer& commands : view.m_meshCommands)
+				backend.submit(commands);
+			backend.submit(view.m_clothCommands);
+		}
+		Clock::time_point submitted = Clock::now();
+
+		double recordMs = std::chrono::duration<double, std::milli>(recorded - start).count() / iterations;
+		double submitMs = std::chrono::duration<double, std::milli>(submitted - recorded).count() / iterations;
+		std::cout << "Render command recording: " << view.m_meshes.size() << " meshes, " << view.m_cloths.size() << " cloths, "
+			<< view.m_meshCommands.size() << " mesh command buffers, " << JobSystem::get_instance().get_thread_count() << " threads\n";
+		std::cout << "Record: " << recordMs << " ms per frame, null submission: " << submitMs << " ms per frame\n";
+		std::cout << "Commands of " << iterations << " frames:\n";
+		backend.print_stats(std::cout);
+	}
+
+	// Make the view that was just extracted the one to draw in the next frame
+	void Renderer::swap_render_views()
+	{
+		m_extractIdx ^= 1;
+		++m_frameIdx;
+	}
+
+	// Number of frames between the simulation and the rendering of the meshes (0 or 1)
+	void Renderer::set_frame_latency(unsigned latency)
+	{
+		m_frameLatency = latency > 1 ? 1 : latency;
+	}
+
+	unsigned Renderer::get_frame_latency() const
+	{
+		return m_frameLatency;
 	}
 
 	void Renderer::close()
 	{
+		// Free whatever is still waiting to be released
+		m_glBackend.submit(m_releaseCommands);
+		m_releaseCommands.clear();
+		m_glBackend.close();
 	}
 
 	void Renderer::set_viewport(int x, int y, int width, int height)
@@ -117,22 +261,17 @@ namespace cs460
 	}
 
 
-	// Adds a mesh renderable component to the internal vector, so that it can be rendered
+	// Adds a mesh renderable component to the internal registry, so that it can be rendered
 	void Renderer::add_mesh_renderable(MeshRenderable* renderable)
 	{
-		m_renderables.push_back(renderable);
+		renderable->set_registry_handle(m_renderables.add(renderable));
 	}
 
-	// Removes a mesh renderable component from the internal vector that is being rendered
+	// Removes a mesh renderable component from the internal registry (O(1)) that is being rendered
 	void Renderer::remove_mesh_renderable(MeshRenderable* renderable)
 	{
-		auto foundIt = std::find(m_renderables.begin(), m_renderables.end(), renderable);
-
-		// Nothing to remove if not in the vector
-		if (foundIt == m_renderables.end())
-			return;
-
-		m_renderables.erase(foundIt);
+		m_renderables.remove(renderable->get_registry_handle());
+		renderable->set_registry_handle(RegistryHandle());
 	}
 
 
@@ -10,6 +10,9 @@
 #pragma once
 
 #include "Platform/Window.h"
+#include "Composition/ComponentRegistry.h"
+#include "Graphics/Rendering/RenderView.h"
+#include "Graphics/Rendering/GLRenderBackend.h"
 
 
 namespace cs460
@@ -28,16 +31,49 @@ namespace cs460
 		static Renderer& get_instance();
 
 		bool initialize();
-		void render();
 		void close();
 
+		// Copy what the render stage needs from the scene (meshes, joint matrices, cloths, camera and lights),
+		// and record the commands that draw it. Only reads the scene, so it can run in a worker once the
+		// simulation of the frame is done.
+		void extract_render_view();
+
+		// Record the commands that draw the meshes and cloths of the given view (the meshes in parallel)
+		void record_render_view(RenderView& view) const;
+
+		// Submit the commands of a render view. With no latency it is the one extracted in this frame,
+		// otherwise it is the one of the previous frame, so it can be drawn while the simulation runs.
+		void render();
+
+		// Draw the skybox and the debug drawing of all the systems, from the current state of the scene
+		void render_overlays();
+
+		// Commands that free graphics resources that recorded commands may still use. They
+		// are submitted after the render view of each frame. Only used from the main thread.
+		RenderCommandBuffer& get_release_commands();
+
+		// Backend the render commands are submitted to (opengl by default)
+		void set_backend(IRenderBackend* backend);
+		IRenderBackend* get_backend() const;
+
+		// Record the commands of the last extracted view many times, and submit them to a null backend,
+		// printing the time of both and the number of commands (doesn't draw anything)
+		void benchmark_command_recording(unsigned iterations);
+
+		// Make the view that was just extracted the one to draw in the next frame
+		void swap_render_views();
+
+		// Number of frames between the simulation and the rendering of the meshes (0 or 1)
+		void set_frame_latency(unsigned latency);
+		unsigned get_frame_latency() const;
+
 		void set_viewport(int x, int y, int width, int height);
 
 		// Clear the frame buffer color and depth
 		void clear_fb();
 		
-		void add_mesh_renderable(MeshRenderable* renderable);		// Adds a mesh renderable component to the internal vector, so that it can be rendered
-		void remove_mesh_renderable(MeshRenderable* renderable);	// Removes a mesh renderable component from the internal vector that is being rendered
+		void add_mesh_renderable(MeshRenderable* renderable);		// Adds a mesh renderable component to the internal registry, so that it can be rendered
+		void remove_mesh_renderable(MeshRenderable* renderable);	// Removes a mesh renderable component from the internal registry (O(1)) that is being rendered
 
 		// Change the skybox resource that will be rendered. Return true
 		// if the skybox was found in the resource manager, false otherwise.
@@ -57,9 +93,22 @@ namespace cs460
 	private:
 
 		Window m_window;
-		std::vector<MeshRenderable*> m_renderables;		// All the components that reference a mesh in a model
+		ComponentRegistry<MeshRenderable> m_renderables;		// All the components that reference a mesh in a model
 		Skybox* m_skybox;
 
+		// The view written by the extraction is m_views[m_extractIdx], the other one is drawn with one frame of latency
+		RenderView m_views[2];
+		unsigned m_extractIdx = 0;
+		unsigned m_frameLatency = 0;
+		unsigned m_frameIdx = 0;
+
+		GLRenderBackend m_glBackend;
+		IRenderBackend* m_backend = &m_glBackend;
+		RenderCommandBuffer m_releaseCommands;
+
+		// Number of meshes recorded by each job of record_render_view
+		static const unsigned s_meshesPerCommandBuffer = 64;
+
 		void set_gl_properties();
 
 		// For singleton pattern
@@ -56,6 +56,15 @@ namespace cs460
 	void ITexture::clear()
 	{
 		glDeleteTextures(1, &m_id);
+		m_id = 0;
+	}
+
+	// Stop owning the texture and return its handle, so that it can be freed later by someone else
+	unsigned ITexture::release()
+	{
+		unsigned id = m_id;
+		m_id = 0;
+		return id;
 	}
 
 	// Setter for the texture unit
@@ -40,6 +40,9 @@ namespace cs460
 		void generate();
 		void clear();
 
+		// Stop owning the texture and return its handle, so that it can be freed later by someone else
+		unsigned release();
+
 		// Getter and setter for the texture unit
 		void set_texture_unit(int unit);
 		int get_texture_unit() const;
@@ -31,17 +31,12 @@ namespace cs460
 
 	void RigidbodyMgr::add_rigidbody(Rigidbody* rigidbody)
 	{
-		m_rigidbodies.push_back(rigidbody);
+		rigidbody->set_registry_handle(m_rigidbodies.add(rigidbody));
 	}
 
 	void RigidbodyMgr::remove_rigidbody(Rigidbody* rigidbody)
 	{
-		auto foundIt = std::find(m_rigidbodies.begin(), m_rigidbodies.end(), rigidbody);
-
-		// Nothing to remove if not in the vector
-		if (foundIt == m_rigidbodies.end())
-			return;
-
-		m_rigidbodies.erase(foundIt);
+		m_rigidbodies.remove(rigidbody->get_registry_handle());
+		rigidbody->set_registry_handle(RegistryHandle());
 	}
 }
\ No newline at end of file
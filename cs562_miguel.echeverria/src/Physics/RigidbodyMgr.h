@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "Composition/ComponentRegistry.h"
+
 
 namespace cs460
 {
@@ -26,7 +28,7 @@ namespace cs460
 		void remove_rigidbody(Rigidbody* rigidbody);
 
 	private:
-		std::vector<Rigidbody*> m_rigidbodies;
+		ComponentRegistry<Rigidbody> m_rigidbodies;
 
 		RigidbodyMgr();
 		RigidbodyMgr(const RigidbodyMgr&) = delete;
@@ -0,0 +1,160 @@
+/**
+* @file FrameArena.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Linear allocator for data that only lives during the current frame. Every
+*		 thread has its own arena, and all of them are reset at the end of the frame.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "FrameArena.h"
+
+
+namespace cs460
+{
+	// Size of the first block of every arena
+	static const size_t INITIAL_BLOCK_SIZE = 64 * 1024;
+
+	std::mutex FrameArena::s_arenasMutex;
+	std::vector<FrameArena*> FrameArena::s_arenas;
+	FrameArena::FrameStats FrameArena::s_lastFrameStats;
+
+
+	FrameArena::FrameArena()
+	{
+		std::lock_guard<std::mutex> lock(s_arenasMutex);
+		s_arenas.push_back(this);
+	}
+
+	FrameArena::~FrameArena()
+	{
+		std::lock_guard<std::mutex> lock(s_arenasMutex);
+		s_arenas.erase(std::find(s_arenas.begin(), s_arenas.end(), this));
+	}
+
+
+	// Arena of the calling thread
+	FrameArena& FrameArena::get_thread_arena()
+	{
+		static thread_local FrameArena arena;
+		return arena;
+	}
+
+
+	// Bump the current block. A new (bigger) block is allocated from the heap if it doesn't fit.
+	void* FrameArena::allocate(size_t bytes, size_t alignment)
+	{
+		++m_allocations;
+
+		if (!m_blocks.empty())
+		{
+			const Block& block = m_blocks.back();
+			size_t alignedOffset = align_offset(block, m_offset, alignment);
+
+			if (alignedOffset + bytes <= block.m_size)
+			{
+				m_offset = alignedOffset + bytes;
+				m_lastAllocation = block.m_memory.get() + alignedOffset;
+				return m_lastAllocation;
+			}
+
+			m_usedBytes += m_offset;
+		}
+
+		// Doesn't fit, get a new block at least twice as big as the previous one
+		size_t blockSize = m_blocks.empty() ? INITIAL_BLOCK_SIZE : m_blocks.back().m_size * 2;
+		blockSize = glm::max(blockSize, bytes + alignment);
+
+		Block block;
+		block.m_memory = std::make_unique<char[]>(blockSize);
+		block.m_size = blockSize;
+		m_blocks.push_back(std::move(block));
+		++m_heapAllocations;
+
+		size_t alignedOffset = align_offset(m_blocks.back(), 0, alignment);
+		m_offset = alignedOffset + bytes;
+		m_lastAllocation = m_blocks.back().m_memory.get() + alignedOffset;
+		return m_lastAllocation;
+	}
+
+	// Only the last allocation can be given back (so that growing containers don't waste space)
+	void FrameArena::deallocate(void* ptr, size_t bytes)
+	{
+		if (ptr == nullptr || ptr != m_lastAllocation)
+			return;
+
+		// It must end at the top of the current block, otherwise it isn't the whole last allocation
+		char* blockMemory = m_blocks.back().m_memory.get();
+		if (static_cast<char*>(ptr) + bytes != blockMemory + m_offset)
+			return;
+
+		m_offset = static_cast<char*>(ptr) - blockMemory;
+		m_lastAllocation = nullptr;
+	}
+
+
+	// Reset all the arenas. Nothing allocated in this frame can be used after this, so it must
+	// be called when no other thread is running jobs (at the end of the frame).
+	void FrameArena::reset_all()
+	{
+		std::lock_guard<std::mutex> lock(s_arenasMutex);
+
+		FrameStats stats;
+		for (FrameArena* arena : s_arenas)
+		{
+			stats.m_allocations += arena->m_allocations;
+			stats.m_heapAllocations += arena->m_heapAllocations;
+			stats.m_bytesUsed += arena->m_usedBytes + arena->m_offset;
+			for (const Block& block : arena->m_blocks)
+				stats.m_bytesReserved += block.m_size;
+
+			arena->reset();
+		}
+
+		s_lastFrameStats = stats;
+	}
+
+	// Counters of the last frame (before the last reset_all)
+	FrameArena::FrameStats FrameArena::get_last_frame_stats()
+	{
+		std::lock_guard<std::mutex> lock(s_arenasMutex);
+		return s_lastFrameStats;
+	}
+
+
+	// First offset after the given one with the given alignment (alignment is a power of 2)
+	size_t FrameArena::align_offset(const Block& block, size_t offset, size_t alignment)
+	{
+		size_t address = (size_t)block.m_memory.get() + offset;
+		size_t alignedAddress = (address + alignment - 1) & ~(alignment - 1);
+		return offset + (alignedAddress - address);
+	}
+
+
+	// Go back to the start. If more than one block was needed, they are merged into a single
+	// one, so that in the next frames the arena doesn't allocate anything from the heap.
+	void FrameArena::reset()
+	{
+		if (m_blocks.size() > 1)
+		{
+			size_t totalSize = 0;
+			for (const Block& block : m_blocks)
+				totalSize += block.m_size;
+
+			m_blocks.clear();
+
+			Block block;
+			block.m_memory = std::make_unique<char[]>(totalSize);
+			block.m_size = totalSize;
+			m_blocks.push_back(std::move(block));
+		}
+
+		m_offset = 0;
+		m_usedBytes = 0;
+		m_lastAllocation = nullptr;
+		m_allocations = 0;
+		m_heapAllocations = 0;
+	}
+}
\ No newline at end of file
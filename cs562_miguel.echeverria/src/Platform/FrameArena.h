@@ -0,0 +1,121 @@
+/**
+* @file FrameArena.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Linear allocator for data that only lives during the current frame. Every
+*		 thread has its own arena, and all of them are reset at the end of the frame.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include <mutex>
+#include <memory>
+
+
+namespace cs460
+{
+	class FrameArena
+	{
+	public:
+
+		// Allocation counters since the last reset of all the arenas
+		struct FrameStats
+		{
+			unsigned m_allocations = 0;			// Allocations served by the arenas
+			unsigned m_heapAllocations = 0;		// Times an arena had to get a new block from the heap
+			size_t m_bytesUsed = 0;
+			size_t m_bytesReserved = 0;
+		};
+
+		~FrameArena();
+
+		// Arena of the calling thread
+		static FrameArena& get_thread_arena();
+
+		// Bump the current block. A new (bigger) block is allocated from the heap if it doesn't fit.
+		void* allocate(size_t bytes, size_t alignment);
+
+		// Only the last allocation can be given back (so that growing containers don't waste space)
+		void deallocate(void* ptr, size_t bytes);
+
+		// Reset all the arenas. Nothing allocated in this frame can be used after this, so it must
+		// be called when no other thread is running jobs (at the end of the frame).
+		static void reset_all();
+
+		// Counters of the last frame (before the last reset_all)
+		static FrameStats get_last_frame_stats();
+
+	private:
+
+		struct Block
+		{
+			std::unique_ptr<char[]> m_memory;
+			size_t m_size = 0;
+		};
+
+		std::vector<Block> m_blocks;
+		size_t m_offset = 0;			// Used bytes in the last block
+		size_t m_usedBytes = 0;			// Used bytes in the previous blocks
+		void* m_lastAllocation = nullptr;
+		unsigned m_allocations = 0;
+		unsigned m_heapAllocations = 0;
+
+		// All the arenas that exist (one per thread that has used one)
+		static std::mutex s_arenasMutex;
+		static std::vector<FrameArena*> s_arenas;
+		static FrameStats s_lastFrameStats;
+
+		FrameArena();
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		// First offset after the given one with the given alignment (alignment is a power of 2)
+		static size_t align_offset(const Block& block, size_t offset, size_t alignment);
+
+		// Go back to the start. If more than one block was needed, they are merged into a single
+		// one, so that in the next frames the arena doesn't allocate anything from the heap.
+		void reset();
+	};
+
+
+	// Allocator for the standard containers that takes its memory from the arena of the thread
+	// that creates it. The containers must not be used after the end of the frame.
+	template<typename T>
+	struct FrameAllocator
+	{
+		using value_type = T;
+
+		FrameArena* m_arena;
+
+		FrameAllocator() : m_arena(&FrameArena::get_thread_arena()) {}
+
+		template<typename U>
+		FrameAllocator(const FrameAllocator<U>& other) : m_arena(other.m_arena) {}
+
+		T* allocate(size_t count)
+		{
+			return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* ptr, size_t count)
+		{
+			m_arena->deallocate(ptr, count * sizeof(T));
+		}
+
+		template<typename U>
+		bool operator==(const FrameAllocator<U>& other) const { return m_arena == other.m_arena; }
+
+		template<typename U>
+		bool operator!=(const FrameAllocator<U>& other) const { return m_arena != other.m_arena; }
+	};
+
+
+	// Containers that live in the frame arena
+	template<typename T>
+	using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+	template<typename T>
+	using FrameList = std::list<T, FrameAllocator<T>>;
+}
\ No newline at end of file
@@ -9,6 +9,8 @@
 
 #include "pch.h"
 #include "FrameRateController.h"
+#include "FrameArena.h"
+#include "Graphics/Rendering/GLCallCounter.h"
 #include <GLFW/glfw3.h>			// Time
 
 
@@ -38,6 +40,10 @@ namespace cs460
 		double currentTime = glfwGetTime();
 		m_dt = currentTime - m_lastTime;
 		m_lastTime = currentTime;
+
+		// The temporary data of this frame isn't needed anymore
+		FrameArena::reset_all();
+		GLCallCounter::end_frame();
 	}
 
 
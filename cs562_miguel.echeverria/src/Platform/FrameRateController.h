@@ -20,7 +20,7 @@ namespace cs460
 		~FrameRateController();
 		static FrameRateController& get_instance();
 
-		// Keep track of time ellapsed on each frame
+		// Keep track of time ellapsed on each frame (also resets the frame arenas)
 		void end_frame();
 
 		// Getters for the delta time of this frame
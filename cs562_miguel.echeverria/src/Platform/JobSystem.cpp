@@ -0,0 +1,233 @@
+/**
+* @file JobSystem.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Work stealing job system. Every thread has its own queue of jobs, it takes
+*		 the newest jobs from its own queue, and steals the oldest ones from the
+*		 queues of the other threads when it runs out of work.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "JobSystem.h"
+
+
+namespace cs460
+{
+	// Index of the thread in the job system (the main thread and any unknown thread use 0)
+	static thread_local unsigned s_threadIdx = 0;
+
+
+	JobSystem& JobSystem::get_instance()
+	{
+		static JobSystem instance;
+		return instance;
+	}
+
+	JobSystem::JobSystem()
+	{
+	}
+
+	JobSystem::~JobSystem()
+	{
+		close();
+	}
+
+
+	// System management functions. 0 threads means one per hardware thread.
+	bool JobSystem::initialize(unsigned threadCount)
+	{
+		set_thread_count(threadCount);
+		return true;
+	}
+
+	void JobSystem::close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_exit = true;
+		}
+		m_wakeUp.notify_all();
+
+		for (std::thread& worker : m_workers)
+			worker.join();
+
+		m_workers.clear();
+		m_queues.clear();
+		m_exit = false;
+	}
+
+
+	// Change the number of threads used (the main thread counts as one of them). There can't be jobs in flight.
+	void JobSystem::set_thread_count(unsigned threadCount)
+	{
+		if (threadCount == 0)
+			threadCount = glm::max(std::thread::hardware_concurrency(), 1u);
+
+		if (threadCount == get_thread_count() && !m_queues.empty())
+			return;
+
+		close();
+
+		for (unsigned i = 0; i < threadCount; ++i)
+			m_queues.push_back(std::make_unique<JobQueue>());
+
+		for (unsigned i = 1; i < threadCount; ++i)
+			m_workers.emplace_back(&JobSystem::worker_loop, this, i);
+	}
+
+	unsigned JobSystem::get_thread_count() const
+	{
+		return (unsigned)m_workers.size() + 1;
+	}
+
+	// Index of the calling thread (0 is the main thread, and the workers go from 1 to thread count - 1)
+	unsigned JobSystem::get_thread_index() const
+	{
+		return s_threadIdx;
+	}
+
+
+	// Push a job to the queue of the calling thread. If a counter is given, it is incremented
+	// now and decremented when the job finishes.
+	void JobSystem::submit(Job job, JobCounter* counter)
+	{
+		if (counter)
+			++(*counter);
+
+		// Not initialized, just run it
+		if (m_queues.empty())
+		{
+			job();
+			if (counter)
+				--(*counter);
+			return;
+		}
+
+		JobQueue& queue = *m_queues[s_threadIdx];
+		{
+			std::lock_guard<std::mutex> lock(queue.m_mutex);
+			queue.m_jobs.push_back({ std::move(job), counter });
+		}
+
+		// Incremented under the sleep mutex, so that a worker can't miss it while going to sleep
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			++m_queuedJobs;
+		}
+		m_wakeUp.notify_one();
+	}
+
+	// Run jobs until the counter reaches 0
+	void JobSystem::wait(const JobCounter& counter)
+	{
+		while (counter > 0)
+		{
+			if (!run_pending_job())
+				std::this_thread::yield();
+		}
+	}
+
+	// Run a single job, taken from the queue of this thread or stolen from another one.
+	// Returns false if there were no jobs to run.
+	bool JobSystem::run_pending_job()
+	{
+		if (m_queues.empty())
+			return false;
+
+		QueuedJob job;
+		if (!pop_job(s_threadIdx, job) && !steal_job(s_threadIdx, job))
+			return false;
+
+		--m_queuedJobs;
+		job.m_job();
+
+		if (job.m_counter)
+			--(*job.m_counter);
+
+		return true;
+	}
+
+
+	// Call func over the items [0, count) in chunks of at most grainSize items, and wait for all of them.
+	// The items of a chunk are always processed in order, but the chunks can be processed in any order by any thread.
+	void JobSystem::parallel_for(unsigned count, unsigned grainSize, const RangeFunction& func)
+	{
+		if (count == 0)
+			return;
+
+		grainSize = glm::max(grainSize, 1u);
+
+		// Not worth splitting
+		if (m_workers.empty() || count <= grainSize)
+		{
+			func(0, count);
+			return;
+		}
+
+		// The first chunk is done by this thread, once the rest are available to be stolen
+		JobCounter counter{ 0 };
+		for (unsigned begin = grainSize; begin < count; begin += grainSize)
+		{
+			unsigned end = glm::min(begin + grainSize, count);
+			submit([&func, begin, end]() { func(begin, end); }, &counter);
+		}
+
+		func(0, grainSize);
+		wait(counter);
+	}
+
+
+	// Main loop of the worker threads
+	void JobSystem::worker_loop(unsigned threadIdx)
+	{
+		s_threadIdx = threadIdx;
+
+		while (true)
+		{
+			if (run_pending_job())
+				continue;
+
+			std::unique_lock<std::mutex> lock(m_sleepMutex);
+			m_wakeUp.wait(lock, [this]() { return m_exit || m_queuedJobs > 0; });
+
+			if (m_exit)
+				return;
+		}
+	}
+
+
+	// Take a job from the back of the own queue, or steal one from the front of the others
+	bool JobSystem::pop_job(unsigned threadIdx, QueuedJob& job)
+	{
+		JobQueue& queue = *m_queues[threadIdx];
+		std::lock_guard<std::mutex> lock(queue.m_mutex);
+
+		if (queue.m_jobs.empty())
+			return false;
+
+		job = std::move(queue.m_jobs.back());
+		queue.m_jobs.pop_back();
+		return true;
+	}
+
+	bool JobSystem::steal_job(unsigned threadIdx, QueuedJob& job)
+	{
+		// Start with the next thread, so that the thieves don't all go to the same queue
+		for (unsigned i = 1; i < m_queues.size(); ++i)
+		{
+			JobQueue& queue = *m_queues[(threadIdx + i) % m_queues.size()];
+			std::lock_guard<std::mutex> lock(queue.m_mutex);
+
+			if (queue.m_jobs.empty())
+				continue;
+
+			job = std::move(queue.m_jobs.front());
+			queue.m_jobs.pop_front();
+			return true;
+		}
+
+		return false;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+/**
+* @file JobSystem.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Work stealing job system. Every thread has its own queue of jobs, it takes
+*		 the newest jobs from its own queue, and steals the oldest ones from the
+*		 queues of the other threads when it runs out of work.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <memory>
+
+
+namespace cs460
+{
+	// Number of jobs that haven't finished yet. Used to wait for a group of jobs.
+	using JobCounter = std::atomic<int>;
+
+
+	class JobSystem
+	{
+	public:
+
+		using Job = std::function<void()>;
+
+		// Function called with a range [begin, end) of the items to process
+		using RangeFunction = std::function<void(unsigned, unsigned)>;
+
+		static JobSystem& get_instance();
+		~JobSystem();
+
+		// System management functions. 0 threads means one per hardware thread.
+		bool initialize(unsigned threadCount = 0);
+		void close();
+
+		// Change the number of threads used (the main thread counts as one of them). There can't be jobs in flight.
+		void set_thread_count(unsigned threadCount);
+		unsigned get_thread_count() const;
+
+		// Index of the calling thread (0 is the main thread, and the workers go from 1 to thread count - 1)
+		unsigned get_thread_index() const;
+
+		// Push a job to the queue of the calling thread. If a counter is given, it is incremented
+		// now and decremented when the job finishes.
+		void submit(Job job, JobCounter* counter = nullptr);
+
+		// Run jobs until the counter reaches 0
+		void wait(const JobCounter& counter);
+
+		// Run a single job, taken from the queue of this thread or stolen from another one.
+		// Returns false if there were no jobs to run.
+		bool run_pending_job();
+
+		// Call func over the items [0, count) in chunks of at most grainSize items, and wait for all of them.
+		// The items of a chunk are always processed in order, but the chunks can be processed in any order by any thread.
+		void parallel_for(unsigned count, unsigned grainSize, const RangeFunction& func);
+
+	private:
+
+		struct QueuedJob
+		{
+			Job m_job;
+			JobCounter* m_counter = nullptr;
+		};
+
+		// Jobs of a single thread. Its owner works at the back, and the thieves at the front.
+		struct JobQueue
+		{
+			std::mutex m_mutex;
+			std::deque<QueuedJob> m_jobs;
+		};
+
+		std::vector<std::thread> m_workers;
+		std::vector<std::unique_ptr<JobQueue>> m_queues;		// One per thread, the main thread included
+
+		// Used to put the workers to sleep when there is nothing to do
+		std::mutex m_sleepMutex;
+		std::condition_variable m_wakeUp;
+		std::atomic<int> m_queuedJobs{ 0 };
+		bool m_exit = false;
+
+		JobSystem();
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		// Main loop of the worker threads
+		void worker_loop(unsigned threadIdx);
+
+		// Take a job from the back of the own queue, or steal one from the front of the others
+		bool pop_job(unsigned threadIdx, QueuedJob& job);
+		bool steal_job(unsigned threadIdx, QueuedJob& job);
+	};
+}
\ No newline at end of file
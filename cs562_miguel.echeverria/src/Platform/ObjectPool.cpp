@@ -0,0 +1,171 @@
+/**
+* @file ObjectPool.cpp
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Allocator of objects of a fixed size in big blocks, reusing the freed
+*		 ones. The objects never move, so pointers to them stay valid.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#include "pch.h"
+#include "ObjectPool.h"
+
+
+namespace cs460
+{
+	std::mutex ObjectPool::s_poolsMutex;
+	std::mutex ObjectPool::s_sharedPoolsMutex;
+	std::atomic<ObjectPool*> ObjectPool::s_sharedPools[MAX_POOLED_SIZE / ALIGNMENT];
+
+
+	// The size is rounded up to the alignment. The name is only for the stats.
+	ObjectPool::ObjectPool(size_t objectSize, const std::string& name)
+		:	m_name(name)
+	{
+		m_objectSize = (glm::max(objectSize, sizeof(FreeObject)) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+		m_objectsPerBlock = glm::max(BLOCK_SIZE / m_objectSize, (size_t)1);
+
+		std::lock_guard<std::mutex> lock(s_poolsMutex);
+		get_all_pools().push_back(this);
+	}
+
+
+	// Reuse the last freed object, or take the next one of the last block (a new block is allocated if it's full)
+	void* ObjectPool::allocate()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_stats.m_allocations;
+		++m_stats.m_liveObjects;
+
+		if (m_freeList != nullptr)
+		{
+			FreeObject* object = m_freeList;
+			m_freeList = object->m_next;
+			return object;
+		}
+
+		if (m_blocks.empty() || m_usedInLastBlock == m_objectsPerBlock)
+		{
+			m_blocks.push_back(std::make_unique<char[]>(m_objectsPerBlock * m_objectSize));
+			m_usedInLastBlock = 0;
+			++m_stats.m_heapAllocations;
+			m_stats.m_bytesReserved += m_objectsPerBlock * m_objectSize;
+		}
+
+		return m_blocks.back().get() + m_objectSize * m_usedInLastBlock++;
+	}
+
+	void ObjectPool::deallocate(void* ptr)
+	{
+		if (ptr == nullptr)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_stats.m_frees;
+		--m_stats.m_liveObjects;
+
+		FreeObject* object = static_cast<FreeObject*>(ptr);
+		object->m_next = m_freeList;
+		m_freeList = object;
+	}
+
+
+	size_t ObjectPool::get_object_size() const
+	{
+		return m_objectSize;
+	}
+
+	const std::string& ObjectPool::get_name() const
+	{
+		return m_name;
+	}
+
+	ObjectPool::PoolStats ObjectPool::get_stats() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_stats;
+	}
+
+
+	// Shared pool for the objects of the given size, created the first time. Objects of the same type always
+	// get the same pool. The pools are never destroyed, so that the scene can free its nodes at exit.
+	ObjectPool& ObjectPool::get_pool(size_t objectSize)
+	{
+		size_t poolIdx = (glm::max(objectSize, (size_t)1) - 1) / ALIGNMENT;
+		ObjectPool* pool = s_sharedPools[poolIdx].load(std::memory_order_acquire);
+		if (pool != nullptr)
+			return *pool;
+
+		// Only the first allocation of each size locks (another thread may have created it meanwhile)
+		std::lock_guard<std::mutex> lock(s_sharedPoolsMutex);
+		pool = s_sharedPools[poolIdx].load(std::memory_order_relaxed);
+		if (pool == nullptr)
+		{
+			size_t size = (poolIdx + 1) * ALIGNMENT;
+			pool = new ObjectPool(size, std::to_string(size) + " bytes");
+			s_sharedPools[poolIdx].store(pool, std::memory_order_release);
+		}
+
+		return *pool;
+	}
+
+
+	// From the shared pool of the size, or from the heap if it's bigger than MAX_POOLED_SIZE
+	void* ObjectPool::allocate_object(size_t size)
+	{
+		if (size > MAX_POOLED_SIZE)
+			return ::operator new(size);
+		return get_pool(size).allocate();
+	}
+
+	void ObjectPool::deallocate_object(void* ptr, size_t size)
+	{
+		if (size > MAX_POOLED_SIZE)
+			::operator delete(ptr);
+		else
+			get_pool(size).deallocate(ptr);
+	}
+
+
+	// Sum of the counters of every pool
+	ObjectPool::PoolStats ObjectPool::get_total_stats()
+	{
+		std::lock_guard<std::mutex> lock(s_poolsMutex);
+
+		PoolStats total;
+		for (const ObjectPool* pool : get_all_pools())
+		{
+			PoolStats stats = pool->get_stats();
+			total.m_allocations += stats.m_allocations;
+			total.m_frees += stats.m_frees;
+			total.m_heapAllocations += stats.m_heapAllocations;
+			total.m_liveObjects += stats.m_liveObjects;
+			total.m_bytesReserved += stats.m_bytesReserved;
+		}
+
+		return total;
+	}
+
+	// Counters of every pool
+	void ObjectPool::print_stats(std::ostream& os)
+	{
+		std::lock_guard<std::mutex> lock(s_poolsMutex);
+
+		for (const ObjectPool* pool : get_all_pools())
+		{
+			PoolStats stats = pool->get_stats();
+			os << pool->m_name << " pool (" << pool->m_objectSize << " bytes): " << stats.m_liveObjects << " live, "
+				<< stats.m_allocations << " allocations, " << stats.m_heapAllocations << " blocks, "
+				<< stats.m_bytesReserved / 1024 << " KB reserved" << std::endl;
+		}
+	}
+
+
+	// Every pool that exists (never destroyed either)
+	std::vector<ObjectPool*>& ObjectPool::get_all_pools()
+	{
+		static std::vector<ObjectPool*>* pools = new std::vector<ObjectPool*>;
+		return *pools;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+/**
+* @file ObjectPool.h
+* @author Miguel Echeverria , 540000918 , miguel.echeverria@digipen.edu
+* @date 2020/20/11
+* @brief Allocator of objects of a fixed size in big blocks, reusing the freed
+*		 ones. The objects never move, so pointers to them stay valid.
+*
+* @copyright Copyright (C) 2020 DigiPen Institute of Technology .
+*/
+
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <atomic>
+
+
+namespace cs460
+{
+	class ObjectPool
+	{
+	public:
+
+		// Allocation counters of a pool (or the sum of all of them) since it was created
+		struct PoolStats
+		{
+			unsigned m_allocations = 0;			// Objects given by the pool
+			unsigned m_frees = 0;
+			unsigned m_heapAllocations = 0;		// Times the pool had to get a new block from the heap
+			unsigned m_liveObjects = 0;
+			size_t m_bytesReserved = 0;
+		};
+
+		static const size_t ALIGNMENT = 16;					// Of every object (the heap gives blocks with this alignment)
+		static const size_t BLOCK_SIZE = 64 * 1024;			// Bytes of each block (at least one object)
+		static const size_t MAX_POOLED_SIZE = 4096;			// Bigger objects are allocated from the heap directly
+
+		// The size is rounded up to the alignment. The name is only for the stats.
+		ObjectPool(size_t objectSize, const std::string& name);
+
+		// Reuse the last freed object, or take the next one of the last block (a new block is allocated if it's full)
+		void* allocate();
+		void deallocate(void* ptr);
+
+		size_t get_object_size() const;
+		const std::string& get_name() const;
+		PoolStats get_stats() const;
+
+		// Shared pool for the objects of the given size, created the first time. Objects of the same type always
+		// get the same pool. The pools are never destroyed, so that the scene can free its nodes at exit.
+		static ObjectPool& get_pool(size_t objectSize);
+
+		// From the shared pool of the size, or from the heap if it's bigger than MAX_POOLED_SIZE
+		static void* allocate_object(size_t size);
+		static void deallocate_object(void* ptr, size_t size);
+
+		static PoolStats get_total_stats();				// Sum of the counters of every pool
+		static void print_stats(std::ostream& os);		// Counters of every pool
+
+	private:
+
+		struct FreeObject
+		{
+			FreeObject* m_next;
+		};
+
+		std::string m_name;
+		size_t m_objectSize;
+		std::vector<std::unique_ptr<char[]>> m_blocks;
+		size_t m_objectsPerBlock;
+		size_t m_usedInLastBlock = 0;		// Objects of the last block given at least once
+		FreeObject* m_freeList = nullptr;
+		PoolStats m_stats;
+		mutable std::mutex m_mutex;
+
+		static std::mutex s_poolsMutex;					// For the list of all the pools
+		static std::mutex s_sharedPoolsMutex;			// For creating the shared pools
+		static std::atomic<ObjectPool*> s_sharedPools[MAX_POOLED_SIZE / ALIGNMENT];
+
+		ObjectPool(const ObjectPool&) = delete;
+		ObjectPool& operator=(const ObjectPool&) = delete;
+
+		// Every pool that exists (never destroyed either)
+		static std::vector<ObjectPool*>& get_all_pools();
+	};
+}
\ No newline at end of file
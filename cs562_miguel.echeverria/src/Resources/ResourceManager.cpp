@@ -10,6 +10,7 @@
 #include "pch.h"
 #include "ResourceManager.h"
 #include "Graphics/GLTF/Model.h"
+#include "Animation/Skinning/PaletteAtlas.h"
 #include "Graphics/Rendering/Shader.h"
 #include "Graphics/Rendering/Skybox.h"
 
@@ -63,6 +64,9 @@ namespace cs460
 
 	void ResourceManager::clear_models()
 	{
+		// The atlases are keyed by model
+		clear_palette_atlases();
+
 		// Free the memory of the models
 		for (auto it : m_models)
 		{
@@ -76,6 +80,14 @@ namespace cs460
 		m_models.clear();
 	}
 
+	void ResourceManager::clear_palette_atlases()
+	{
+		for (auto it : m_paletteAtlases)
+			delete it.second;
+
+		m_paletteAtlases.clear();
+	}
+
 	void ResourceManager::clear_shaders()
 	{
 		// Free the memory of the shaders
@@ -126,6 +138,28 @@ namespace cs460
 	}
 
 
+	// Get the baked joint palettes of every animation of the given skin of the model.
+	// Bakes them if they don't exist yet (so it can't be called from the worker threads).
+	PaletteAtlas* ResourceManager::get_palette_atlas(Model* model, int skinIdx)
+	{
+		PaletteAtlas*& atlas = m_paletteAtlases[std::make_pair(model, skinIdx)];
+		if (atlas == nullptr)
+		{
+			atlas = new PaletteAtlas;
+			atlas->bake(*model, skinIdx, PaletteAtlas::DEFAULT_SAMPLE_RATE, PaletteAtlasFormat::UNORM16);
+		}
+
+		return atlas;
+	}
+
+	// Same, but returns nullptr instead of baking them (safe to call while updating the skins in parallel)
+	const PaletteAtlas* ResourceManager::find_palette_atlas(const Model* model, int skinIdx) const
+	{
+		auto foundIt = m_paletteAtlases.find(std::make_pair(model, skinIdx));
+		return foundIt != m_paletteAtlases.end() ? foundIt->second : nullptr;
+	}
+
+
 	// Get the shader associated to the name provided.
 	// Returns nullptr if the shader hasn't been loaded already.
 	Shader* ResourceManager::get_shader(const std::string& shaderIdName)
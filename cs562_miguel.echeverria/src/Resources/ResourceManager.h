@@ -16,6 +16,7 @@
 namespace cs460
 {
 	struct Model;
+	class PaletteAtlas;
 	class Shader;
 	class Skybox;
 
@@ -33,6 +34,7 @@ namespace cs460
 		// Release all the resources allocated.
 		void clear_resources();
 		void clear_models();
+		void clear_palette_atlases();
 		void clear_shaders();
 		void clear_skyboxes();
 
@@ -40,6 +42,13 @@ namespace cs460
 		// Loads it if it is not already loaded.
 		Model* get_model(const std::string& filePath);
 
+		// Get the baked joint palettes of every animation of the given skin of the model.
+		// Bakes them if they don't exist yet (so it can't be called from the worker threads).
+		PaletteAtlas* get_palette_atlas(Model* model, int skinIdx);
+
+		// Same, but returns nullptr instead of baking them (safe to call while updating the skins in parallel)
+		const PaletteAtlas* find_palette_atlas(const Model* model, int skinIdx) const;
+
 		// Get the shader associated to the name provided.
 		// Returns nullptr if the shader hasn't been loaded already.
 		Shader* get_shader(const std::string& shaderIdName);
@@ -67,6 +76,7 @@ namespace cs460
 	private:
 
 		std::unordered_map<std::string, Model*> m_models;
+		std::map<std::pair<const Model*, int>, PaletteAtlas*> m_paletteAtlases;		// Keyed by model and skin index
 		std::unordered_map<std::string, Shader*> m_shaders;
 		std::unordered_map<std::string, Skybox*> m_skyboxes;
 		Cube m_cube;
@@ -14,8 +14,11 @@ uniform mat4 worldToView;		// World to view/camera space transformation matrix
 uniform mat4 perspectiveProj;	// Perspective projection transformation matrix
 uniform mat3 normalViewMtx;		// Model to view space transformation specifically for normals
 
-uniform mat4 jointMatrices[MAX_JOINTS];
+uniform mat3x4 jointMatrices[MAX_JOINTS];		// Affine transforms, each column is a row of the matrix
+uniform mat2x4 jointDualQuats[MAX_JOINTS];		// Dual quaternions, real part in the first column (x, y, z, w)
 uniform bool useSkinning;
+uniform bool useDualQuaternions;				// Whether to blend jointDualQuats instead of jointMatrices
+uniform int influenceCount;						// Joints that affect the vertices being drawn (1, 2 or 4, sorted by weight)
 
 // The current vertex position and normal in view space, as well as the texture coordinates
 out vec3 fragViewPos;
@@ -23,6 +26,32 @@ out vec3 viewNormal;
 out vec2 texCoords;
 
 
+// Blend the dual quaternions of the joints of the vertex, and convert the result to a matrix
+mat4 blend_dual_quaternions()
+{
+	mat2x4 dq0 = jointDualQuats[int(attJoints.x)];
+	mat2x4 blended = attJointWeights.x * dq0;
+
+	// Flip the quaternions that are in the other hemisphere from the first one, so that they take the shortest path
+	for (int i = 1; i < influenceCount; ++i)
+	{
+		mat2x4 dq = jointDualQuats[int(attJoints[i])];
+		blended += (dot(dq0[0], dq[0]) < 0.0 ? -attJointWeights[i] : attJointWeights[i]) * dq;
+	}
+
+	blended /= length(blended[0]);
+	vec4 r = blended[0];
+	vec4 d = blended[1];
+
+	// Rotation matrix of the real part, and translation 2 * dual * conjugate(real)
+	vec3 t = 2.0 * (r.w * d.xyz - d.w * r.xyz + cross(r.xyz, d.xyz));
+	return mat4(1.0 - 2.0 * (r.y * r.y + r.z * r.z), 2.0 * (r.x * r.y + r.w * r.z), 2.0 * (r.x * r.z - r.w * r.y), 0.0,
+				2.0 * (r.x * r.y - r.w * r.z), 1.0 - 2.0 * (r.x * r.x + r.z * r.z), 2.0 * (r.y * r.z + r.w * r.x), 0.0,
+				2.0 * (r.x * r.z + r.w * r.y), 2.0 * (r.y * r.z - r.w * r.x), 1.0 - 2.0 * (r.x * r.x + r.y * r.y), 0.0,
+				t, 1.0);
+}
+
+
 void main()
 {
 	// Set out parameters
@@ -32,12 +61,17 @@ void main()
 
 	// Compute the skinning matrix if necessary
 	mat4 skinMatrix = mat4(1.0);
-	if (useSkinning)
+	if (useSkinning && useDualQuaternions)
+		skinMatrix = blend_dual_quaternions();
+	else if (useSkinning)
 	{
-		skinMatrix = attJointWeights.x * jointMatrices[int(attJoints.x)] +
-					 attJointWeights.y * jointMatrices[int(attJoints.y)] +
-					 attJointWeights.z * jointMatrices[int(attJoints.z)] +
-					 attJointWeights.w * jointMatrices[int(attJoints.w)];
+		// The loop is uniform for the whole draw, so the vertices with less influences skip the rest
+		mat3x4 blendedMatrix = attJointWeights.x * jointMatrices[int(attJoints.x)];
+		for (int i = 1; i < influenceCount; ++i)
+			blendedMatrix += attJointWeights[i] * jointMatrices[int(attJoints[i])];
+
+		// Transposing gives the first three rows of the 4x4 matrix (the last one is 0, 0, 0, 1)
+		skinMatrix = mat4(transpose(blendedMatrix));
 	}
 
 	// Output position
@@ -31,4 +31,36 @@ namespace cs460
 	{
 		return extractClassOrStruct(typeid(instance).name());
 	}
+
+
+	/**
+	* @brief List of types. Each type gets a compile time id, which is its position in the list.
+	* @param Ts				The types of the list.
+	*/
+	template<typename... Ts>
+	struct TypeList
+	{
+		static constexpr unsigned size = sizeof...(Ts);
+	};
+
+
+	/**
+	* @brief Position of the type T in a TypeList, in value. Doesn't compile if T isn't in the list.
+	* @param T				The type of which we want to obtain the position.
+	* @param List			The TypeList in which T is.
+	*/
+	template<typename T, typename List>
+	struct TypeIndex;
+
+	template<typename T, typename... Ts>
+	struct TypeIndex<T, TypeList<T, Ts...>>
+	{
+		static constexpr unsigned value = 0;
+	};
+
+	template<typename T, typename U, typename... Ts>
+	struct TypeIndex<T, TypeList<U, Ts...>>
+	{
+		static constexpr unsigned value = 1 + TypeIndex<T, TypeList<Ts...>>::value;
+	};
 }
\ No newline at end of file
@@ -1,9 +1,27 @@
 #include "pch.h"
 #include "Application/Engine.h"
+#include "Animation/Skinning/PaletteAtlas.h"
 
 
-int main(void)
+int main(int argc, char* argv[])
 {
+	// Headless bake of the joint palettes of a model, without opening a window:
+	// --bake-palettes <model.gltf> <output file> [frames per second] [--quantize]
+	if (argc >= 4 && std::string(argv[1]) == "--bake-palettes")
+	{
+		float sampleRate = cs460::PaletteAtlas::DEFAULT_SAMPLE_RATE;
+		cs460::PaletteAtlasFormat format = cs460::PaletteAtlasFormat::FLOAT32;
+		for (int i = 4; i < argc; ++i)
+		{
+			if (std::string(argv[i]) == "--quantize")
+				format = cs460::PaletteAtlasFormat::UNORM16;
+			else
+				sampleRate = std::stof(argv[i]);
+		}
+
+		return cs460::bake_palette_atlas_files(argv[2], argv[3], sampleRate, format) ? 0 : -1;
+	}
+
 	cs460::Engine engine;
 
 	if (!engine.initialize())